@@ -0,0 +1,61 @@
+/* format_bench.c -- time ansi_snprintf() on the library's own formats.
+ *
+ * Built twice by measure_features.sh, with ANSI_PRINT_FORMAT=0 (C library
+ * vsnprintf) and =1 (built-in formatter).  Results are printed through
+ * ansi_print() into write(2), so the probe itself links no stdio and the
+ * two linked sizes differ only by the formatter. */
+#include "ansi_print.h"
+#include <time.h>
+#include <unistd.h>
+
+#define ITERATIONS 200000UL
+
+static void out_putc(int ch)
+{
+    char c = (char)ch;
+    (void)!write(1, &c, 1);
+}
+
+static char fmt_buf[128];
+
+/* Keep the formatted text alive so the loop is not optimized out */
+static volatile int sink;
+
+static unsigned long ns_per_call(clock_t t0, clock_t t1, unsigned long calls)
+{
+    unsigned long long ns = (unsigned long long)(t1 - t0) * 1000000000ULL
+                          / CLOCKS_PER_SEC;
+    return (unsigned long)(ns / calls);
+}
+
+int main(void)
+{
+    char buf[64];
+    ansi_init(out_putc, NULL, fmt_buf, sizeof(fmt_buf));
+
+    /* Cursor moves and SGR codes: the TUI's hot formats */
+    clock_t t0 = clock();
+    for (unsigned long i = 0; i < ITERATIONS; i++) {
+        sink += ansi_snprintf(buf, sizeof(buf), "\x1b[%d;%dH", (int)(i % 50) + 1, (int)(i % 132) + 1);
+        sink += ansi_snprintf(buf, sizeof(buf), "\x1b[38;5;%dm", (int)(i & 0xFF));
+    }
+    clock_t t1 = clock();
+    ansi_print("  escape sequences   %4lu ns/call\n", ns_per_call(t0, t1, ITERATIONS * 2));
+
+    /* Widget text: label, padding and a counter */
+    t0 = clock();
+    for (unsigned long i = 0; i < ITERATIONS; i++)
+        sink += ansi_snprintf(buf, sizeof(buf), "%-8s %5lu %08x", "rx", i, (unsigned)i);
+    t1 = clock();
+    ansi_print("  text and integers  %4lu ns/call\n", ns_per_call(t0, t1, ITERATIONS));
+
+#if ANSI_PRINT_FORMAT_FLOAT || !ANSI_PRINT_FORMAT
+    /* Metric value */
+    t0 = clock();
+    for (unsigned long i = 0; i < ITERATIONS; i++)
+        sink += ansi_snprintf(buf, sizeof(buf), "%0.2f m/sec", (double)i / 7.0);
+    t1 = clock();
+    ansi_print("  %%0.2f metric       %4lu ns/call\n", ns_per_call(t0, t1, ITERATIONS));
+#endif
+    return 0;
+}
@@ -1,6 +1,6 @@
 #!/bin/bash
 # Measure .text section size for each feature flag individually.
-# Usage: bash measure_features.sh
+# Usage: bash scripts/measure_features.sh  (from the repository root)
 # Requires: clang (or set CC), size
 
 CC="${CC:-clang}"
@@ -114,3 +114,88 @@ $CC $BASE_FLAGS -DANSI_PRINT_NO_APP_CFG -c "$TUI_SRC" -o "$TUI_OUT" 2>/dev/null
 tui_bss_full=$(size "$TUI_OUT" | awk 'NR==2 { print $3 }')
 echo "  Minimal: $tui_bss_min bytes"
 echo "  Full:    $tui_bss_full bytes"
+
+# ── Formatter: C library vsnprintf vs built-in ────────────────
+
+# Linked size of a probe that formats through ansi_print (section GC on),
+# so the C library's printf is counted.  The probe writes with write(2),
+# and an empty program linked the same way is subtracted, so the growth
+# column holds only what the library and its formatter pull in.  Cross
+# compilers: set LDFLAGS, e.g. LDFLAGS="--specs=nano.specs --specs=nosys.specs".
+LDFLAGS="${LDFLAGS:--static}"
+BENCH="scripts/format_bench.c"
+EMPTY="build/format_empty"
+
+echo ""
+echo "=== Formatter (ANSI_PRINT_FORMAT) ==="
+echo ""
+
+empty=0
+if echo 'int main(void) { return 0; }' |
+   $CC $BASE_FLAGS -Wl,--gc-sections $LDFLAGS -x c - -o "$EMPTY" 2>/dev/null; then
+    empty=$(size "$EMPTY" | awk 'NR==2 { print $1 }')
+    # Static glibc links its printf engine into every program (malloc and
+    # assert diagnostics), so vsnprintf costs nothing extra there
+    if nm "$EMPTY" 2>/dev/null | grep -q 'vfprintf'; then
+        echo "note: this C library links printf into an empty program; the"
+        echo "      built-in formatter saves flash only where it does not"
+        echo "      (newlib-nano, picolibc)"
+        echo ""
+    fi
+fi
+
+for fmt in 0 1; do
+    if [ "$fmt" = 0 ]; then label="C library vsnprintf"; else label="Built-in formatter"; fi
+    flags="-DANSI_PRINT_NO_APP_CFG -DANSI_PRINT_FORMAT=$fmt"
+    obj=$(get_text "$flags")
+    bin="build/format_bench_$fmt"
+    if $CC $BASE_FLAGS $flags -Wl,--gc-sections $LDFLAGS "$BENCH" "$SRC" -o "$bin" 2>/dev/null; then
+        image=$(size "$bin" | awk 'NR==2 { print $1 }')
+        image="$image B  (+$((image - empty)) over empty)"
+    else
+        image="n/a"
+    fi
+    printf "%-30s %6s B  (ansi_print.o)  %s\n" "$label" "$obj" "$image"
+    [ -x "$bin" ] && "$bin" 2>/dev/null
+done
+
+# ── Color and emoji tables ────────────────────────────────────
+
+# Read-only data of ansi_print.o (.rodata plus .data.rel.ro, where
+# pointer tables land in PIC builds) and the relocations inside it.  The
+# pointer table behind ansi_emoji_table() is linked only when that
+# function is called, so it is reported on its own.
+# Set TABLE_BASE to a git revision to compare against that tree, and
+# TABLE_ARCH="-m32" (or a cross CC) for 4-byte pointers.
+TABLE_ARCH="${TABLE_ARCH:-}"
+
+get_tables() {
+    $CC $BASE_FLAGS $TABLE_ARCH $1 -c "$2" -o "$OUT" 2>/dev/null || { echo "n/a n/a n/a"; return; }
+    size -A "$OUT" | awk '$1 ~ /^\.rodata|^\.data\.rel\.ro/ {
+                              if ($1 ~ /EMOJI_TABLE/) compat += $2; else ro += $2 }
+                          END { printf "%d %d ", ro, compat }'
+    readelf -r "$OUT" | awk '/^Relocation section/ && $3 ~ /\.rela?\.(rodata|data\.rel\.ro)/ &&
+                             $3 !~ /EMOJI_TABLE/ { n += $(NF-1) } END { print n + 0 }'
+}
+
+echo ""
+echo "=== Color and emoji tables (.rodata of ansi_print.o) ==="
+echo ""
+
+if [ -n "$TABLE_BASE" ]; then
+    base_dir=$(mktemp -d)
+    if git archive "$TABLE_BASE" src | tar -x -C "$base_dir"; then
+        label="$TABLE_BASE"
+        for cfg in "Minimal:$MINIMAL" "Full:-DANSI_PRINT_NO_APP_CFG"; do
+            set -- $(get_tables "${cfg#*:}" "$base_dir/src/ansi_print.c")
+            printf "%-30s %6s B  (%s relocations)\n" "$label ${cfg%%:*}" "$1" "$3"
+        done
+    fi
+    rm -rf "$base_dir"
+fi
+for cfg in "Minimal:$MINIMAL" "Full:-DANSI_PRINT_NO_APP_CFG"; do
+    set -- $(get_tables "${cfg#*:}" "$SRC")
+    printf "%-30s %6s B  (%s relocations)" "Current ${cfg%%:*}" "$1" "$3"
+    [ "$2" != 0 ] && printf "  +%s B if ansi_emoji_table() is used" "$2"
+    echo ""
+done
@@ -0,0 +1,187 @@
+/**
+ * @file ansi_async.c
+ * @brief Lock-free multi-producer front-end for ansi_print.
+ *
+ * Bounded queue with a per-slot sequence number (Vyukov style):
+ *   seq == pos            slot is free for the producer claiming pos
+ *   seq == pos + 1        slot holds the record for pos
+ *   seq == pos + capacity slot was consumed and is free for the next lap
+ * Producers claim a position with a CAS on @c tail; the consumer (and a
+ * producer dropping the oldest record) claim one with a CAS on @c head.
+ */
+
+#include "ansi_async.h"
+
+#if ANSI_PRINT_ASYNC
+
+#include <stdio.h>
+#include <string.h>
+
+int ansi_async_init(ansi_async_t *q, ansi_async_slot_t *slots, size_t count,
+                    ansi_ctx_t *ctx, ansi_async_overflow_t overflow,
+                    void (*idle)(void))
+{
+    if (!q || !slots || count < 2 || (count & (count - 1))) return 0;
+
+    q->slots    = slots;
+    q->mask     = count - 1;
+    q->ctx      = ctx ? ctx : ansi_default_ctx();
+    q->overflow = overflow;
+    q->idle     = idle;
+    for (size_t i = 0; i < count; i++)
+        atomic_init(&slots[i].seq, i);
+    atomic_init(&q->head, 0);
+    atomic_init(&q->tail, 0);
+    atomic_init(&q->busy, 0);
+    atomic_init(&q->dropped, 0);
+    return 1;
+}
+
+static void async_wait(const ansi_async_t *q)
+{
+    if (q->idle) q->idle();
+}
+
+/** Claim the oldest published record.  Returns its slot, or NULL if the
+ *  ring is empty.  The slot stays owned until async_release(). */
+static ansi_async_slot_t *async_claim_oldest(ansi_async_t *q, size_t *out_pos)
+{
+    size_t pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+    for (;;) {
+        ansi_async_slot_t *s = &q->slots[pos & q->mask];
+        size_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            /* seq_cst: ordered against the consumer's busy flag */
+            if (atomic_compare_exchange_weak(&q->head, &pos, pos + 1)) {
+                *out_pos = pos;
+                return s;
+            }
+        } else if (diff < 0) {
+            return NULL;   /* empty (or the producer has not published yet) */
+        } else {
+            pos = atomic_load_explicit(&q->head, memory_order_relaxed);
+        }
+    }
+}
+
+/** Hand a consumed slot back to producers for the next lap. */
+static void async_release(ansi_async_t *q, ansi_async_slot_t *s, size_t pos)
+{
+    atomic_store_explicit(&s->seq, pos + q->mask + 1, memory_order_release);
+}
+
+/** Claim a free slot for writing, applying the overflow policy when the
+ *  ring is full.  Returns NULL when the record is to be dropped. */
+static ansi_async_slot_t *async_claim_free(ansi_async_t *q, size_t *out_pos)
+{
+    size_t pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    for (;;) {
+        ansi_async_slot_t *s = &q->slots[pos & q->mask];
+        size_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->tail, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                *out_pos = pos;
+                return s;
+            }
+        } else if (diff < 0) {
+            /* Full: the slot still holds the record from one lap ago */
+            if (q->overflow == ANSI_ASYNC_DROP_NEWEST) {
+                atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+                return NULL;
+            }
+            if (q->overflow == ANSI_ASYNC_DROP_OLDEST) {
+                size_t old;
+                ansi_async_slot_t *o = async_claim_oldest(q, &old);
+                if (o) {
+                    async_release(q, o, old);
+                    atomic_fetch_add_explicit(&q->dropped, 1, memory_order_relaxed);
+                } else {
+                    async_wait(q);   /* oldest not yet published */
+                }
+            } else {
+                async_wait(q);
+            }
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&q->tail, memory_order_relaxed);
+        }
+    }
+}
+
+int ansi_async_vprint(ansi_async_t *q, const char *fmt, va_list ap)
+{
+    if (!q || !fmt) return 0;
+    size_t pos;
+    ansi_async_slot_t *s = async_claim_free(q, &pos);
+    if (!s) return 0;
+    ansi_vsnprintf(s->text, sizeof(s->text), fmt, ap);
+    atomic_store_explicit(&s->seq, pos + 1, memory_order_release);
+    return 1;
+}
+
+int ansi_async_print(ansi_async_t *q, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    int queued = ansi_async_vprint(q, fmt, ap);
+    va_end(ap);
+    return queued;
+}
+
+int ansi_async_puts(ansi_async_t *q, const char *s)
+{
+    if (!q || !s) return 0;
+    size_t pos;
+    ansi_async_slot_t *slot = async_claim_free(q, &pos);
+    if (!slot) return 0;
+    size_t n = strlen(s);
+    if (n >= sizeof(slot->text)) n = sizeof(slot->text) - 1;
+    memcpy(slot->text, s, n);
+    slot->text[n] = '\0';
+    atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+    return 1;
+}
+
+int ansi_async_drain(ansi_async_t *q, int max)
+{
+    if (!q) return 0;
+    int n = 0;
+    ansi_ctx_batch_begin(q->ctx);
+    while (max <= 0 || n < max) {
+        /* busy is raised before the claim so ansi_async_flush() never sees
+           head past a record that is still being rendered */
+        atomic_store(&q->busy, 1);
+        size_t pos;
+        ansi_async_slot_t *s = async_claim_oldest(q, &pos);
+        if (!s) break;
+        ansi_ctx_puts(q->ctx, s->text);
+        async_release(q, s, pos);
+        n++;
+    }
+    ansi_ctx_batch_end(q->ctx);
+    atomic_store(&q->busy, 0);
+    return n;
+}
+
+void ansi_async_flush(ansi_async_t *q)
+{
+    if (!q) return;
+    size_t target = atomic_load(&q->tail);
+    for (;;) {
+        /* A claimed position may still be unpublished (producer mid-copy):
+           head only passes it once the record is in the ring. */
+        size_t head = atomic_load(&q->head);
+        if ((intptr_t)(head - target) >= 0 && !atomic_load(&q->busy)) return;
+        async_wait(q);
+    }
+}
+
+unsigned long ansi_async_dropped(ansi_async_t *q)
+{
+    return q ? atomic_load_explicit(&q->dropped, memory_order_relaxed) : 0;
+}
+
+#endif /* ANSI_PRINT_ASYNC */
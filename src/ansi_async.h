@@ -0,0 +1,162 @@
+/**
+ * @file ansi_async.h
+ * @brief Optional asynchronous front-end: many producer threads, one
+ *        rendering/output thread.
+ *
+ * Producers format their message (printf arguments resolved, markup left
+ * intact) into a slot of a bounded lock-free ring and return.  A single
+ * consumer thread drains the ring with ansi_async_drain(), doing the markup
+ * rendering and putc/flush I/O on its own ansi_ctx_t -- so workers never
+ * contend for the format buffer or tag state and never wait on the
+ * terminal.
+ *
+ * The ring is a bounded multi-producer queue with a sequence number per
+ * slot (no locks, no allocation): a producer claims a slot with one
+ * compare-and-swap, copies its text, and publishes it with a release
+ * store.  Storage is caller-provided.
+ *
+ * Requires C11 atomics; disabled unless ANSI_PRINT_ASYNC is set to 1.
+ *
+ * @code
+ * static ansi_async_slot_t slots[256];          // power of two
+ * static ansi_async_t      logq;
+ * static ansi_ctx_t        out;
+ * static char              out_buf[256];
+ *
+ * ansi_ctx_init(&out, my_putc, my_flush, out_buf, sizeof(out_buf));
+ * ansi_async_init(&logq, slots, 256, &out, ANSI_ASYNC_DROP_OLDEST, sched_yield_fn);
+ *
+ * // worker threads
+ * ansi_async_print(&logq, "[yellow]worker %d:[/] %s\n", id, msg);
+ *
+ * // render thread
+ * while (running)
+ *     if (!ansi_async_drain(&logq, 0)) sleep_ms(1);
+ *
+ * // shutdown: everything queued so far is written
+ * ansi_async_flush(&logq);
+ * @endcode
+ */
+
+#ifndef ANSI_ASYNC_H
+#define ANSI_ASYNC_H
+
+#include "ansi_print.h"
+
+/** @def ANSI_PRINT_ASYNC
+ *  Enable the ansi_async_* multi-producer front-end.  Needs a C11 compiler
+ *  with <stdatomic.h>, so it is off by default (also without
+ *  ANSI_PRINT_MINIMAL).  Default: 0. */
+#ifndef ANSI_PRINT_ASYNC
+#  define ANSI_PRINT_ASYNC  0
+#endif
+
+/** @def ANSI_PRINT_ASYNC_RECORD
+ *  Bytes per queued record, including the terminating NUL.  Longer
+ *  messages are truncated.  Default: 128. */
+#ifndef ANSI_PRINT_ASYNC_RECORD
+#  define ANSI_PRINT_ASYNC_RECORD  128
+#endif
+
+#if ANSI_PRINT_ASYNC
+
+#if !defined(__STDC_VERSION__) || __STDC_VERSION__ < 201112L || \
+    defined(__STDC_NO_ATOMICS__)
+#error "ANSI_PRINT_ASYNC requires C11 atomics (compile with -std=c11)"
+#endif
+
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** What a producer does when the ring is full. */
+typedef enum {
+    ANSI_ASYNC_BLOCK,        /**< Wait (calling @c idle) until a slot frees up. */
+    ANSI_ASYNC_DROP_NEWEST,  /**< Discard the new record. */
+    ANSI_ASYNC_DROP_OLDEST,  /**< Discard the oldest queued record, keep the new one. */
+} ansi_async_overflow_t;
+
+/** One ring slot (caller-provided array, see ansi_async_init()). */
+typedef struct {
+    atomic_size_t seq;                        /**< Slot sequence number (internal). */
+    char          text[ANSI_PRINT_ASYNC_RECORD]; /**< Formatted markup record. */
+} ansi_async_slot_t;
+
+/** Ring state.  Fields are internal; read counters with the accessors. */
+typedef struct {
+    ansi_async_slot_t    *slots;
+    size_t                mask;     /* capacity - 1 */
+    ansi_ctx_t           *ctx;      /* consumer's output context */
+    ansi_async_overflow_t overflow;
+    void                (*idle)(void);
+    atomic_size_t         head;     /* next record to consume */
+    atomic_size_t         tail;     /* next slot to fill */
+    atomic_int            busy;     /* consumer is rendering a record */
+    atomic_ulong          dropped;  /* records discarded on overflow */
+} ansi_async_t;
+
+/**
+ * @brief Prepare a ring over caller-provided slots.
+ *
+ * @param q         Ring to initialize (not yet shared with other threads).
+ * @param slots     Slot array.
+ * @param count     Number of slots; must be a power of two >= 2.
+ * @param ctx       Context the consumer renders to (NULL = default context).
+ * @param overflow  Full-ring policy.
+ * @param idle      Called while a producer blocks or ansi_async_flush()
+ *                  waits (e.g. sched_yield or an RTOS delay), or NULL to spin.
+ * @return 1 on success, 0 if @p count is not a power of two >= 2.
+ */
+int ansi_async_init(ansi_async_t *q, ansi_async_slot_t *slots, size_t count,
+                    ansi_ctx_t *ctx, ansi_async_overflow_t overflow,
+                    void (*idle)(void));
+
+/**
+ * @brief Format a markup message into the ring (any thread).
+ *
+ * printf arguments are resolved immediately; markup tags are rendered
+ * later by the consumer.
+ *
+ * @return 1 if queued, 0 if dropped (ANSI_ASYNC_DROP_NEWEST on a full ring).
+ */
+int ansi_async_print(ansi_async_t *q, const char *fmt, ...);
+
+/** @brief va_list variant of ansi_async_print(). */
+int ansi_async_vprint(ansi_async_t *q, const char *fmt, va_list ap);
+
+/** @brief Queue a pre-formatted markup string (no printf processing). */
+int ansi_async_puts(ansi_async_t *q, const char *s);
+
+/**
+ * @brief Render queued records (consumer thread only).
+ *
+ * Records are rendered in queue order as one ansi_ctx_batch_begin/end
+ * group, so the context flushes once per call.
+ *
+ * @param q    Ring to drain.
+ * @param max  Maximum records to render, or 0 for all currently queued.
+ * @return Number of records rendered.
+ */
+int ansi_async_drain(ansi_async_t *q, int max);
+
+/**
+ * @brief Barrier: wait until every record queued before the call has been
+ *        rendered (or dropped) by the consumer.
+ *
+ * Call from any thread other than the consumer, e.g. at shutdown before
+ * stopping the render thread.
+ */
+void ansi_async_flush(ansi_async_t *q);
+
+/** @brief Records discarded by the overflow policy since init. */
+unsigned long ansi_async_dropped(ansi_async_t *q);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANSI_PRINT_ASYNC */
+
+#endif /* ANSI_ASYNC_H */
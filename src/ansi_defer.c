@@ -0,0 +1,406 @@
+/**
+ * @file ansi_defer.c
+ * @brief Deferred (binary) logging encoder and host-side decoder.
+ *
+ * Both sides walk the same format string with defer_next_spec(), so the
+ * argument layout on the wire is implied by the table entry and never
+ * described in the record itself.
+ */
+
+#include "ansi_defer.h"
+
+#if ANSI_PRINT_DEFER
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ------------------------------------------------------------------ */
+/* Format string scanning                                              */
+/* ------------------------------------------------------------------ */
+
+/** One printf conversion.  Length modifiers are normalized to a single
+ *  char: 'H' (hh), 'h', 'l', 'q' (ll), 'j', 'z', 't', 'L', or 0. */
+typedef struct {
+    const char *start;       /* the '%' */
+    const char *end;         /* one past the conversion char */
+    int         star_width;
+    int         star_prec;
+    int         prec;        /* literal precision, or -1 */
+    char        len;
+    char        conv;
+} defer_spec_t;
+
+/** Find the next conversion at or after @p p (skipping "%%").
+ *  Returns NULL when the format has no more conversions. */
+static const char *defer_next_spec(const char *p, defer_spec_t *s)
+{
+    for (; *p; p++) {
+        if (*p != '%') continue;
+        if (p[1] == '%') { p++; continue; }
+
+        s->start = p++;
+        while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') p++;
+        s->star_width = (*p == '*');
+        if (s->star_width) p++;
+        else while (*p >= '0' && *p <= '9') p++;
+
+        s->star_prec = 0;
+        s->prec = -1;
+        if (*p == '.') {
+            p++;
+            if (*p == '*') { s->star_prec = 1; p++; }
+            else {
+                s->prec = 0;
+                while (*p >= '0' && *p <= '9') s->prec = s->prec * 10 + (*p++ - '0');
+            }
+        }
+
+        s->len = 0;
+        switch (*p) {
+        case 'h': p++; s->len = 'h'; if (*p == 'h') { p++; s->len = 'H'; } break;
+        case 'l': p++; s->len = 'l'; if (*p == 'l') { p++; s->len = 'q'; } break;
+        case 'j': case 'z': case 't': case 'L': s->len = *p++; break;
+        default: break;
+        }
+
+        s->conv = *p;
+        if (*p) p++;
+        s->end = p;
+        return p;
+    }
+    return NULL;
+}
+
+static int defer_is_float(char conv)
+{
+    return conv == 'f' || conv == 'F' || conv == 'e' || conv == 'E' ||
+           conv == 'g' || conv == 'G' || conv == 'a' || conv == 'A';
+}
+
+static int defer_is_unsigned(char conv)
+{
+    return conv == 'u' || conv == 'x' || conv == 'X' || conv == 'o';
+}
+
+/* ------------------------------------------------------------------ */
+/* Encoder                                                             */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    unsigned char *buf;
+    size_t         size;
+    size_t         pos;
+    int            overflow;
+} defer_out_t;
+
+static void out_byte(defer_out_t *o, unsigned char b)
+{
+    if (o->pos < o->size) o->buf[o->pos++] = b;
+    else o->overflow = 1;
+}
+
+static void out_varint(defer_out_t *o, unsigned long long v)
+{
+    while (v >= 0x80) {
+        out_byte(o, (unsigned char)(v | 0x80));
+        v >>= 7;
+    }
+    out_byte(o, (unsigned char)v);
+}
+
+static void out_zigzag(defer_out_t *o, long long v)
+{
+    out_varint(o, ((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63));
+}
+
+static long long arg_signed(char len, va_list *ap)
+{
+    switch (len) {
+    case 'H': return (signed char)va_arg(*ap, int);
+    case 'h': return (short)va_arg(*ap, int);
+    case 'l': return va_arg(*ap, long);
+    case 'q': return va_arg(*ap, long long);
+    case 'j': return (long long)va_arg(*ap, intmax_t);
+    case 'z': return (long long)va_arg(*ap, size_t);
+    case 't': return (long long)va_arg(*ap, ptrdiff_t);
+    default:  return va_arg(*ap, int);
+    }
+}
+
+static unsigned long long arg_unsigned(char len, va_list *ap)
+{
+    switch (len) {
+    case 'H': return (unsigned char)va_arg(*ap, unsigned);
+    case 'h': return (unsigned short)va_arg(*ap, unsigned);
+    case 'l': return va_arg(*ap, unsigned long);
+    case 'q': return va_arg(*ap, unsigned long long);
+    case 'j': return (unsigned long long)va_arg(*ap, uintmax_t);
+    case 'z': return (unsigned long long)va_arg(*ap, size_t);
+    case 't': return (unsigned long long)va_arg(*ap, ptrdiff_t);
+    default:  return va_arg(*ap, unsigned);
+    }
+}
+
+static void encode_args(defer_out_t *o, const char *fmt, va_list *ap)
+{
+    defer_spec_t s;
+    const char *p = fmt;
+
+    while ((p = defer_next_spec(p, &s)) != NULL) {
+        int prec = s.prec;
+        if (s.star_width) out_zigzag(o, va_arg(*ap, int));
+        if (s.star_prec) {
+            prec = va_arg(*ap, int);
+            out_zigzag(o, prec);
+        }
+
+        if (s.conv == 'd' || s.conv == 'i') {
+            out_zigzag(o, arg_signed(s.len, ap));
+        } else if (defer_is_unsigned(s.conv)) {
+            out_varint(o, arg_unsigned(s.len, ap));
+        } else if (s.conv == 'c') {
+            out_varint(o, (unsigned char)va_arg(*ap, int));
+        } else if (s.conv == 'p') {
+            out_varint(o, (uintptr_t)va_arg(*ap, void *));
+        } else if (defer_is_float(s.conv)) {
+#if ANSI_PRINT_FLOAT
+            float f = (s.len == 'L') ? (float)va_arg(*ap, long double)
+                                     : (float)va_arg(*ap, double);
+            uint32_t bits;
+            memcpy(&bits, &f, sizeof(bits));
+            for (int i = 0; i < 4; i++) out_byte(o, (unsigned char)(bits >> (8 * i)));
+#else
+            /* No FPU code: the double argument cannot be read, and every
+               argument after it would be misread, so drop the record */
+            o->overflow = 1;
+            return;
+#endif
+        } else if (s.conv == 's') {
+            const char *str = va_arg(*ap, const char *);
+            if (!str) str = "(null)";
+            size_t n = 0;
+            while (str[n] && (prec < 0 || n < (size_t)prec)) n++;
+            out_varint(o, n);
+            for (size_t i = 0; i < n; i++) out_byte(o, (unsigned char)str[i]);
+        } else if (s.conv == 'n') {
+            (void)va_arg(*ap, int *);
+        }
+    }
+}
+
+static size_t varint_size(unsigned long long v)
+{
+    size_t n = 1;
+    while (v >= 0x80) { v >>= 7; n++; }
+    return n;
+}
+
+size_t ansi_defer_encode(unsigned char *buf, size_t size, unsigned id,
+                         const char *fmt, va_list ap)
+{
+    if (!buf || size < 2 || !fmt) return 0;
+
+    /* Payload goes after a one-byte length; widened below if needed */
+    defer_out_t o = { buf + 1, size - 1, 0, 0 };
+    va_list args;
+    va_copy(args, ap);
+    out_varint(&o, id);
+    encode_args(&o, fmt, &args);
+    va_end(args);
+    if (o.overflow) return 0;
+
+    size_t hdr = varint_size(o.pos);
+    if (hdr + o.pos > size) return 0;
+    if (hdr > 1) memmove(buf + hdr, buf + 1, o.pos);
+
+    defer_out_t h = { buf, hdr, 0, 0 };
+    out_varint(&h, o.pos);
+    return hdr + o.pos;
+}
+
+void ansi_defer_init(ansi_defer_t *d, ansi_ctx_t *ctx,
+                     const char *const *fmts, unsigned count)
+{
+    if (!d) return;
+    d->ctx   = ctx ? ctx : ansi_default_ctx();
+    d->fmts  = fmts;
+    d->count = fmts ? count : 0;
+}
+
+size_t ansi_defer_vlog(const ansi_defer_t *d, unsigned id, va_list ap)
+{
+    if (!d || id >= d->count || !d->fmts[id]) return 0;
+    unsigned char rec[ANSI_PRINT_DEFER_RECORD];
+    size_t n = ansi_defer_encode(rec, sizeof(rec), id, d->fmts[id], ap);
+    if (n) ansi_ctx_write(d->ctx, (const char *)rec, n);
+    return n;
+}
+
+size_t ansi_defer_log(const ansi_defer_t *d, unsigned id, ...)
+{
+    va_list ap;
+    va_start(ap, id);
+    size_t n = ansi_defer_vlog(d, id, ap);
+    va_end(ap);
+    return n;
+}
+
+/* ------------------------------------------------------------------ */
+/* Decoder                                                             */
+/* ------------------------------------------------------------------ */
+
+typedef struct {
+    const unsigned char *p;
+    const unsigned char *end;
+    int                  bad;
+} defer_in_t;
+
+static unsigned long long in_varint(defer_in_t *in)
+{
+    unsigned long long v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (in->p >= in->end) break;
+        unsigned char b = *in->p++;
+        v |= (unsigned long long)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+    }
+    in->bad = 1;
+    return 0;
+}
+
+static long long in_zigzag(defer_in_t *in)
+{
+    unsigned long long u = in_varint(in);
+    return (long long)(u >> 1) ^ -(long long)(u & 1);
+}
+
+/** Append @p n chars of text to the output buffer, keeping it terminated. */
+static void text_append(char *out, size_t size, size_t *pos, const char *s, size_t n)
+{
+    while (n-- && *pos + 1 < size) out[(*pos)++] = *s++;
+    out[*pos] = '\0';
+}
+
+/** Rebuild a conversion spec for the host's printf: stars become the
+ *  decoded numbers, and the length modifier is replaced with @p mod. */
+static void spec_rebuild(char *spec, size_t size, const defer_spec_t *s,
+                         int width, int prec, const char *mod)
+{
+    size_t n = 0;
+    int stars = 0;
+    for (const char *p = s->start; p < s->end - 1 && n + 12 < size; p++) {
+        if (*p == '*') {
+            int v = (stars++ == 0 && s->star_width) ? width : prec;
+            n += (size_t)snprintf(spec + n, size - n, "%d", v);
+        } else if (!strchr("hljztL", *p)) {
+            spec[n++] = *p;
+        }
+    }
+    while (*mod && n + 2 < size) spec[n++] = *mod++;
+    spec[n++] = s->conv;
+    spec[n] = '\0';
+}
+
+static void decode_text(defer_in_t *in, const char *fmt, char *out, size_t size)
+{
+    size_t pos = 0;
+    defer_spec_t s;
+    const char *lit = fmt;
+    const char *p = fmt;
+    char spec[32];
+    char tmp[ANSI_PRINT_DEFER_RECORD + 1];
+
+    out[0] = '\0';
+    while ((p = defer_next_spec(p, &s)) != NULL) {
+        /* Literal text before the conversion, with "%%" collapsed */
+        for (const char *q = lit; q < s.start; q++) {
+            text_append(out, size, &pos, q, 1);
+            if (q[0] == '%' && q[1] == '%') q++;
+        }
+        lit = s.end;
+
+        int width = s.star_width ? (int)in_zigzag(in) : 0;
+        int prec  = s.star_prec  ? (int)in_zigzag(in) : s.prec;
+        int n = 0;
+        char *dst = out + pos;
+        size_t room = size - pos;
+
+        if (s.conv == 'd' || s.conv == 'i') {
+            spec_rebuild(spec, sizeof(spec), &s, width, prec, "ll");
+            n = snprintf(dst, room, spec, in_zigzag(in));
+        } else if (defer_is_unsigned(s.conv)) {
+            spec_rebuild(spec, sizeof(spec), &s, width, prec, "ll");
+            n = snprintf(dst, room, spec, in_varint(in));
+        } else if (s.conv == 'c') {
+            spec_rebuild(spec, sizeof(spec), &s, width, prec, "");
+            n = snprintf(dst, room, spec, (int)in_varint(in));
+        } else if (s.conv == 'p') {
+            spec_rebuild(spec, sizeof(spec), &s, width, prec, "");
+            n = snprintf(dst, room, spec, (void *)(uintptr_t)in_varint(in));
+        } else if (defer_is_float(s.conv)) {
+            uint32_t bits = 0;
+            if (in->end - in->p < 4) { in->bad = 1; break; }
+            for (int i = 0; i < 4; i++) bits |= (uint32_t)*in->p++ << (8 * i);
+#if ANSI_PRINT_FLOAT
+            float f;
+            memcpy(&f, &bits, sizeof(f));
+            spec_rebuild(spec, sizeof(spec), &s, width, prec, "");
+            n = snprintf(dst, room, spec, (double)f);
+#else
+            n = snprintf(dst, room, "<f:%08lx>", (unsigned long)bits);   /* raw IEEE bits */
+#endif
+        } else if (s.conv == 's') {
+            size_t len = (size_t)in_varint(in);
+            if (len >= sizeof(tmp) || (size_t)(in->end - in->p) < len) {
+                in->bad = 1;
+                break;
+            }
+            memcpy(tmp, in->p, len);
+            tmp[len] = '\0';
+            in->p += len;
+            spec_rebuild(spec, sizeof(spec), &s, width, prec, "");
+            n = snprintf(dst, room, spec, tmp);
+        }
+
+        if (in->bad) break;
+        if (n > 0) pos += ((size_t)n < room) ? (size_t)n : room - 1;
+    }
+
+    /* Trailing literal text */
+    for (const char *q = lit; *q; q++) {
+        text_append(out, size, &pos, q, 1);
+        if (q[0] == '%' && q[1] == '%') q++;
+    }
+}
+
+size_t ansi_defer_decode(const ansi_defer_t *d, const unsigned char *buf,
+                         size_t len)
+{
+    if (!d || !buf || !len) return 0;
+
+    defer_in_t hdr = { buf, buf + len, 0 };
+    unsigned long long plen = in_varint(&hdr);
+    if (hdr.bad) return 0;
+    size_t used = (size_t)(hdr.p - buf);
+    if (plen > len - used) return 0;
+
+    defer_in_t in = { hdr.p, hdr.p + plen, 0 };
+    unsigned long long id = in_varint(&in);
+
+    size_t size;
+    char *out = ansi_ctx_get_buf(d->ctx, &size);
+    if (!out || !size) return used + (size_t)plen;
+
+    if (in.bad || id >= d->count || !d->fmts[id]) {
+        snprintf(out, size, "<defer: unknown id %llu>\n", id);
+    } else {
+        decode_text(&in, d->fmts[id], out, size);
+        if (in.bad) snprintf(out, size, "<defer: bad record id %llu>\n", id);
+    }
+    ansi_ctx_puts(d->ctx, out);
+    return used + (size_t)plen;
+}
+
+#endif /* ANSI_PRINT_DEFER */
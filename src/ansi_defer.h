@@ -0,0 +1,150 @@
+/**
+ * @file ansi_defer.h
+ * @brief Deferred (binary) logging: the target sends a format ID and raw
+ *        argument bytes, the host renders the markup later.
+ *
+ * On a slow link the cost of a log line is vsnprintf, markup parsing and
+ * the colored text itself.  Deferred logging replaces all three with a
+ * compact record: the index of a format string in a shared table plus the
+ * printf arguments in binary.  The host (e.g. `ansiprint --decode`) holds
+ * the same table, rebuilds the text and renders it with full markup.
+ *
+ * The table is an X-macro file compiled into both sides, so IDs can never
+ * drift apart:
+ *
+ * @code
+ * // log_formats.inc -- one entry per call site, ID = line order
+ * ANSI_DEFER_FMT(LOG_BOOT, "[bold green]boot[/] fw %u.%u\n")
+ * ANSI_DEFER_FMT(LOG_TEMP, "[yellow]temp[/] %d mC  fan %s\n")
+ *
+ * // target
+ * #define ANSI_DEFER_FMT(id, fmt) id,
+ * enum log_id {
+ * #include "log_formats.inc"
+ * };
+ * #undef ANSI_DEFER_FMT
+ * #define ANSI_DEFER_FMT(id, fmt) fmt,
+ * static const char *const log_fmts[] = {
+ * #include "log_formats.inc"
+ * };
+ * #undef ANSI_DEFER_FMT
+ *
+ * ansi_defer_t dl;
+ * ansi_defer_init(&dl, NULL, log_fmts, sizeof(log_fmts) / sizeof(log_fmts[0]));
+ * ansi_defer_log(&dl, LOG_TEMP, 41250, "on");   // 8 bytes on the wire
+ *
+ * // host
+ * //   ansiprint --decode log_formats.inc capture.bin
+ * @endcode
+ *
+ * @section defer_wire Wire Format
+ * Each record is `varint(length) varint(id) args...`, where @c length
+ * counts the bytes after itself so a decoder can skip unknown IDs.  The
+ * format string defines the argument layout, so no type tags are sent:
+ *
+ * | Conversion            | Encoding                                   |
+ * |-----------------------|--------------------------------------------|
+ * | %d %i                 | zigzag varint                              |
+ * | %u %x %X %o %c %p     | varint                                     |
+ * | %f %e %g %a (any case)| 4-byte IEEE float, little-endian           |
+ * | %s                    | varint(length) + bytes (no NUL)            |
+ * | `*` width/precision   | zigzag varint, before the value            |
+ *
+ * Varints are LEB128 (7 bits per byte, low group first).  Floating-point
+ * arguments are narrowed to float; %n is ignored.  With ANSI_PRINT_FLOAT=0
+ * the encoder uses no floating-point code: a record whose format has a
+ * float conversion is dropped (0 is returned), and the decoder prints
+ * float fields as their raw bits, `<f:XXXXXXXX>`.
+ *
+ * The target still walks the format string to find argument types, but
+ * that is a byte scan -- no vsnprintf, no tag lookup, no SGR output.
+ */
+
+#ifndef ANSI_DEFER_H
+#define ANSI_DEFER_H
+
+#include "ansi_print.h"
+
+/** @def ANSI_PRINT_DEFER
+ *  Enable the ansi_defer_* encoder and decoder.
+ *  Default: 1 (0 if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_PRINT_DEFER
+#  define ANSI_PRINT_DEFER         ANSI_PRINT_DEFAULT_
+#endif
+
+/** @def ANSI_PRINT_DEFER_RECORD
+ *  Maximum encoded record size in bytes (encoder stack buffer).  Records
+ *  that do not fit are dropped.  Default: 64. */
+#ifndef ANSI_PRINT_DEFER_RECORD
+#  define ANSI_PRINT_DEFER_RECORD  64
+#endif
+
+#if ANSI_PRINT_DEFER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Format table and output context shared by encoder and decoder. */
+typedef struct {
+    ansi_ctx_t        *ctx;    /**< Target: raw record bytes; host: rendered text. */
+    const char *const *fmts;   /**< Format strings indexed by ID. */
+    unsigned           count;  /**< Number of entries in @c fmts. */
+} ansi_defer_t;
+
+/**
+ * @brief Bind a format table to an output context.
+ *
+ * @param d      Logger to initialize.
+ * @param ctx    Output context (NULL = default context).
+ * @param fmts   Format strings indexed by ID (see the X-macro pattern above).
+ * @param count  Number of entries in @p fmts.
+ */
+void ansi_defer_init(ansi_defer_t *d, ansi_ctx_t *ctx,
+                     const char *const *fmts, unsigned count);
+
+/**
+ * @brief Encode one record and write it to the context as raw bytes.
+ *
+ * @param d   Logger.
+ * @param id  Index into the format table.
+ * @param ... Arguments matching the format string.
+ * @return Bytes written, or 0 if @p id is out of range or the record
+ *         exceeds ANSI_PRINT_DEFER_RECORD.
+ */
+size_t ansi_defer_log(const ansi_defer_t *d, unsigned id, ...);
+
+/** @brief va_list variant of ansi_defer_log(). */
+size_t ansi_defer_vlog(const ansi_defer_t *d, unsigned id, va_list ap);
+
+/**
+ * @brief Encode a record into a caller buffer without writing it.
+ *
+ * @return Record length, or 0 if it does not fit in @p size bytes.
+ */
+size_t ansi_defer_encode(unsigned char *buf, size_t size, unsigned id,
+                         const char *fmt, va_list ap);
+
+/**
+ * @brief Decode one record from @p buf and render it through the context.
+ *
+ * The text is rebuilt in the context's format buffer, then rendered with
+ * ansi_ctx_puts() so markup is processed as if the target had printed it.
+ * Records with an unknown ID or malformed arguments are skipped with a
+ * short "<defer: ...>" notice.
+ *
+ * @param d    Logger holding the same format table as the target.
+ * @param buf  Received bytes, starting at a record boundary.
+ * @param len  Number of bytes available.
+ * @return Bytes consumed, or 0 if @p buf does not yet hold a whole record.
+ */
+size_t ansi_defer_decode(const ansi_defer_t *d, const unsigned char *buf,
+                         size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANSI_PRINT_DEFER */
+
+#endif /* ANSI_DEFER_H */
@@ -0,0 +1,178 @@
+/**
+ * @file ansi_driver.c
+ * @brief timerfd/signalfd driver for a TUI screen.
+ *
+ * The frame clock is a periodic timerfd armed only while the screen has
+ * dirty widgets (or an on_frame callback).  Its first expiry is immediate,
+ * so an update made while idle is drawn as soon as the caller's loop gets
+ * back to the descriptor; updates made in the same pass coalesce.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+#define _POSIX_C_SOURCE 200809L   /* clock_gettime(), sigprocmask() under -std=c99 */
+#endif
+
+#include "ansi_driver.h"
+
+#if ANSI_TUI_DRIVER
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+
+static uint32_t driver_now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)ts.tv_sec * 1000u + (uint32_t)(ts.tv_nsec / 1000000);
+}
+
+static void driver_arm(tui_driver_t *d, int on)
+{
+    struct itimerspec its;
+    memset(&its, 0, sizeof(its));
+    if (on) {
+        its.it_value.tv_nsec    = 1;   /* first frame right away */
+        its.it_interval.tv_sec  = d->frame_ms / 1000;
+        its.it_interval.tv_nsec = (long)(d->frame_ms % 1000) * 1000000L;
+    }
+    if (timerfd_settime(d->timer_fd, 0, &its, NULL) == 0) d->armed = on;
+}
+
+static void driver_wake_hook(void *user)
+{
+    tui_driver_wake((tui_driver_t *)user);
+}
+
+static int driver_watch(int epfd, int fd)
+{
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events  = EPOLLIN;
+    ev.data.fd = fd;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &ev);
+}
+
+static void driver_winch_mask(sigset_t *set)
+{
+    sigemptyset(set);
+    sigaddset(set, SIGWINCH);
+}
+
+int tui_driver_init(tui_driver_t *d, tui_screen_t *s, int fps, int tty_fd)
+{
+    if (!d || !s || fps <= 0) return 0;
+    memset(d, 0, sizeof(*d));
+    d->screen    = s;
+    d->frame_ms  = (uint32_t)((1000 + fps - 1) / fps);
+    d->tty_fd    = tty_fd;
+    d->signal_fd = -1;
+
+    d->fd       = epoll_create1(EPOLL_CLOEXEC);
+    d->timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (d->fd < 0 || d->timer_fd < 0 || driver_watch(d->fd, d->timer_fd) < 0)
+        goto fail;
+
+    if (tty_fd >= 0) {
+        sigset_t set;
+        driver_winch_mask(&set);
+        if (sigprocmask(SIG_BLOCK, &set, NULL) < 0) goto fail;
+        d->signal_fd = signalfd(-1, &set, SFD_NONBLOCK | SFD_CLOEXEC);
+        if (d->signal_fd < 0 || driver_watch(d->fd, d->signal_fd) < 0) goto fail;
+    }
+
+    tui_screen_set_wake(s, driver_wake_hook, d);
+    if (tui_screen_dirty(s)) driver_arm(d, 1);
+    return 1;
+
+fail: {
+        int err = errno;
+        tui_driver_close(d);
+        errno = err;
+        return 0;
+    }
+}
+
+int tui_driver_fd(const tui_driver_t *d)
+{
+    return d ? d->fd : -1;
+}
+
+void tui_driver_wake(tui_driver_t *d)
+{
+    if (d && !d->armed && d->timer_fd >= 0) driver_arm(d, 1);
+}
+
+/** Drain pending SIGWINCH; return nonzero if at least one arrived. */
+static int driver_take_resize(tui_driver_t *d)
+{
+    if (d->signal_fd < 0) return 0;
+    struct signalfd_siginfo si[4];
+    int got = 0;
+    while (read(d->signal_fd, si, sizeof(si)) > 0) got = 1;
+    return got;
+}
+
+/** Expirations of the frame clock since the last read (0 if none). */
+static uint64_t driver_take_frames(tui_driver_t *d)
+{
+    uint64_t n = 0;
+    if (read(d->timer_fd, &n, sizeof(n)) != (ssize_t)sizeof(n)) return 0;
+    return n;
+}
+
+int tui_driver_dispatch(tui_driver_t *d)
+{
+    if (!d || !d->screen) return 0;
+    int drawn = 0;
+
+    if (driver_take_resize(d)) {
+        struct winsize ws;
+        if (ioctl(d->tty_fd, TIOCGWINSZ, &ws) == 0) {
+            d->rows = ws.ws_row;
+            d->cols = ws.ws_col;
+        }
+        d->resizes++;
+        if (d->on_resize) d->on_resize(d, d->rows, d->cols);
+        tui_screen_redraw_all(d->screen);
+    }
+
+    uint64_t n = driver_take_frames(d);
+    if (n) {
+        d->frames++;
+        d->missed += (unsigned long)(n - 1);
+        uint32_t now = driver_now_ms();
+        if (d->on_frame) d->on_frame(d, now);
+        drawn = tui_tick(d->screen, now);
+        if (!d->on_frame && tui_screen_dirty(d->screen) == 0) {
+            driver_arm(d, 0);
+            d->idles++;
+        }
+    }
+    return drawn;
+}
+
+void tui_driver_close(tui_driver_t *d)
+{
+    if (!d) return;
+    if (d->screen && d->screen->wake == driver_wake_hook && d->screen->wake_user == d)
+        tui_screen_set_wake(d->screen, NULL, NULL);
+    if (d->signal_fd >= 0) {
+        sigset_t set;
+        driver_winch_mask(&set);
+        close(d->signal_fd);
+        sigprocmask(SIG_UNBLOCK, &set, NULL);
+    }
+    if (d->timer_fd >= 0) close(d->timer_fd);
+    if (d->fd >= 0)       close(d->fd);
+    d->fd = d->timer_fd = d->signal_fd = -1;
+    d->armed = 0;
+}
+
+#endif /* ANSI_TUI_DRIVER */
@@ -0,0 +1,134 @@
+/**
+ * @file ansi_driver.h
+ * @brief Event-loop driver for a TUI screen: one pollable descriptor
+ *        instead of a sleep loop.
+ *
+ * A sleep-and-redraw loop needs a thread of its own and wakes up even
+ * when nothing changed.  The driver turns the frame clock into a timerfd
+ * and (optionally) SIGWINCH into a signalfd, both behind a single epoll
+ * descriptor that fits into an existing poll()/epoll/libuv loop.  When
+ * the descriptor becomes readable, tui_driver_dispatch() renders the
+ * frame that is due and handles a terminal resize.
+ *
+ * The timer only runs while there is work: a frame that finds nothing
+ * dirty disarms it, and the first widget update after that re-arms it
+ * (through tui_screen_set_wake()), so an idle display costs no wakeups.
+ * With an @c on_frame callback (data sampled every frame, e.g. tui_poll())
+ * the timer keeps running.
+ *
+ * @code
+ * static tui_driver_t drv;
+ *
+ * tui_driver_init(&drv, &screen, 30, STDOUT_FILENO);  // before any threads
+ * drv.on_resize = relayout;                            // optional
+ *
+ * struct epoll_event ev = { .events = EPOLLIN, .data.ptr = &drv };
+ * epoll_ctl(service_epoll, EPOLL_CTL_ADD, tui_driver_fd(&drv), &ev);
+ *
+ * // in the service loop, when drv's descriptor is readable:
+ * tui_driver_dispatch(&drv);
+ * @endcode
+ *
+ * Linux only (timerfd, signalfd, epoll).
+ */
+
+#ifndef ANSI_DRIVER_H
+#define ANSI_DRIVER_H
+
+#include "ansi_tui.h"
+
+/** @def ANSI_TUI_DRIVER
+ *  Enable the tui_driver_* event-loop driver.  Requires ANSI_TUI_SCREEN.
+ *  Default: 1 on Linux (0 elsewhere or if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_TUI_DRIVER
+#  if defined(__linux__)
+#    define ANSI_TUI_DRIVER  ANSI_PRINT_DEFAULT_
+#  else
+#    define ANSI_TUI_DRIVER  0
+#  endif
+#endif
+
+#if ANSI_TUI_DRIVER && !ANSI_TUI_SCREEN
+#  undef  ANSI_TUI_DRIVER
+#  define ANSI_TUI_DRIVER  0
+#endif
+
+#if ANSI_TUI_DRIVER
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tui_driver tui_driver_t;
+
+/** Event-loop driver state.  Set the callbacks after tui_driver_init(). */
+struct tui_driver {
+    tui_screen_t *screen;    /**< Screen rendered on each frame. */
+    int           fd;        /**< epoll descriptor handed to the caller's loop. */
+    int           timer_fd;  /**< Frame clock (timerfd). */
+    int           signal_fd; /**< SIGWINCH (signalfd), or -1. */
+    int           tty_fd;    /**< Terminal queried for its size, or -1. */
+    uint32_t      frame_ms;  /**< Frame interval. */
+    int           armed;     /**< Nonzero while the frame clock runs. */
+    int           rows;      /**< Terminal rows after the last resize (0 = unknown). */
+    int           cols;      /**< Terminal columns after the last resize. */
+
+    /** Called before each frame is rendered (sample data, tui_poll()), or
+     *  NULL.  Keeps the frame clock running while set (start it with
+     *  tui_driver_wake()). */
+    void (*on_frame)(tui_driver_t *d, uint32_t now_ms);
+    /** Called after a resize, before the full redraw, to re-lay out, or NULL. */
+    void (*on_resize)(tui_driver_t *d, int rows, int cols);
+    void *user;              /**< Free for the callbacks. */
+
+    unsigned long frames;    /**< Frame clock expirations handled. */
+    unsigned long missed;    /**< Expirations that passed while the loop was busy. */
+    unsigned long resizes;   /**< Resizes handled. */
+    unsigned long idles;     /**< Times the clock was stopped for lack of work. */
+};
+
+/**
+ * @brief Create the descriptors and attach the driver to a screen.
+ *
+ * The driver paces frames itself, so leave the screen's tui_screen_set_fps()
+ * at 0.  With @p tty_fd >= 0, SIGWINCH is blocked in the calling thread
+ * and received through a signalfd; call this before starting other
+ * threads so they inherit the mask.
+ *
+ * @param d       Driver to initialize.
+ * @param s       Screen to drive (its wake hook is taken by the driver).
+ * @param fps     Frames per second (> 0).
+ * @param tty_fd  Terminal to watch for resizes (e.g. STDOUT_FILENO), or -1.
+ * @return 1 on success, 0 on bad arguments or if a descriptor cannot be
+ *         created (errno is set).
+ */
+int tui_driver_init(tui_driver_t *d, tui_screen_t *s, int fps, int tty_fd);
+
+/** @brief Descriptor to watch for readability (EPOLLIN / POLLIN). */
+int tui_driver_fd(const tui_driver_t *d);
+
+/**
+ * @brief Handle whatever made the descriptor readable.  Never blocks.
+ *
+ * On a resize: reads the new size from @c tty_fd, calls @c on_resize and
+ * repaints with tui_screen_redraw_all().  On a frame: calls @c on_frame,
+ * then tui_tick() (so tui_screen_set_budget() applies), and stops the
+ * clock if the screen has nothing left to draw.
+ *
+ * @return Number of widgets drawn.
+ */
+int tui_driver_dispatch(tui_driver_t *d);
+
+/** @brief Start the frame clock (done automatically on widget updates). */
+void tui_driver_wake(tui_driver_t *d);
+
+/** @brief Close the descriptors, detach from the screen and unblock SIGWINCH. */
+void tui_driver_close(tui_driver_t *d);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANSI_TUI_DRIVER */
+
+#endif /* ANSI_DRIVER_H */
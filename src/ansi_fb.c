@@ -0,0 +1,681 @@
+/**
+ * @file ansi_fb.c
+ * @brief Cell framebuffer, terminal-output interpreter and per-client diff.
+ */
+
+#include "ansi_fb.h"
+
+#if ANSI_PRINT_FB
+
+#include <stdio.h>
+#include <string.h>
+
+/** Unchanged cells bridged inside one output run rather than paying for
+ *  a cursor move (a CUP costs 6-8 bytes). */
+#define FB_GAP  4
+
+enum { FB_GROUND, FB_ESC, FB_CSI, FB_STRING, FB_G0 };
+
+/* ------------------------------------------------------------------ */
+/* Cells                                                               */
+/* ------------------------------------------------------------------ */
+
+static void cell_set(ansi_cell_t *c, const ansi_pen_t *pen,
+                     const char *glyph, int len)
+{
+    memset(c, 0, sizeof(*c));
+    c->fg     = pen->fg;
+    c->bg     = pen->bg;
+    c->styles = pen->styles;
+    c->len    = (uint8_t)len;
+    memcpy(c->glyph, glyph, (size_t)len);
+}
+
+/** Blank cell as erased by the terminal: space, default fg, current bg. */
+static void cell_erase(ansi_cell_t *c, uint32_t bg)
+{
+    ansi_pen_t pen = { ANSI_CELL_DEFAULT, bg, 0 };
+    cell_set(c, &pen, " ", 1);
+}
+
+static int cell_eq(const ansi_cell_t *a, const ansi_cell_t *b)
+{
+    return memcmp(a, b, sizeof(*a)) == 0;
+}
+
+static ansi_cell_t *fb_at(ansi_fb_t *fb, int row, int col)
+{
+    return &fb->cells[row * fb->cols + col];
+}
+
+/** Before overwriting (row, col), blank the other half of any two-cell
+ *  glyph that covers it so no half glyph is left behind. */
+static void fb_unsplit(ansi_fb_t *fb, int row, int col)
+{
+    ansi_cell_t *c = fb_at(fb, row, col);
+    if (c->len == 0 && col > 0)
+        cell_erase(c - 1, c[-1].bg);
+    else if (col + 1 < fb->cols && c[1].len == 0)
+        cell_erase(c + 1, c[1].bg);
+}
+
+static void fb_erase(ansi_fb_t *fb, int row, int from, int to)
+{
+    if (from >= to) return;
+    fb_unsplit(fb, row, from);
+    fb_unsplit(fb, row, to - 1);
+    for (int col = from; col < to; col++)
+        cell_erase(fb_at(fb, row, col), fb->pen.bg);
+}
+
+/** Display width of a glyph: emoji from the shortcode table use their
+ *  declared width (lowercase name = 2 cells), everything else is 1. */
+static int fb_glyph_width(const char *g, int len)
+{
+#if ANSI_PRINT_EMOJI
+    if (len >= 3) {
+        ansi_emoji_entry_t e;
+        for (int i = 0; ansi_emoji_get(i, &e); i++) {
+            if (strncmp(e.utf8, g, (size_t)len) == 0 && e.utf8[len] == '\0')
+                return (e.name[0] >= 'A' && e.name[0] <= 'Z') ? 1 : 2;
+        }
+    }
+#else
+    (void)g;
+    (void)len;
+#endif
+    return 1;
+}
+
+static void fb_glyph(ansi_fb_t *fb, const char *g, int len)
+{
+    int w = fb_glyph_width(g, len);
+    if (fb->col + w > fb->cols) {       /* clipped, no autowrap */
+        fb->col = fb->cols;
+        return;
+    }
+    fb_unsplit(fb, fb->row, fb->col);
+    if (w == 2) fb_unsplit(fb, fb->row, fb->col + 1);
+
+    ansi_cell_t *c = fb_at(fb, fb->row, fb->col);
+    cell_set(c, &fb->pen, g, len);
+    if (w == 2) cell_set(c + 1, &fb->pen, "", 0);
+    fb->col += w;
+
+    if (g != fb->last) memcpy(fb->last, g, (size_t)len);
+    fb->last_len = (uint8_t)len;
+}
+
+/* ------------------------------------------------------------------ */
+/* Interpreter                                                         */
+/* ------------------------------------------------------------------ */
+
+static int clampi(int v, int lo, int hi)
+{
+    return v < lo ? lo : (v > hi ? hi : v);
+}
+
+/** UTF-8 for a DEC Special Graphics line-drawing byte, or NULL when the
+ *  byte has no line glyph (it then prints as itself). */
+static const char *fb_dec_glyph(unsigned char b)
+{
+    switch (b) {
+    case 'j': return "\xe2\x94\x98";   /* ┘ */
+    case 'k': return "\xe2\x94\x90";   /* ┐ */
+    case 'l': return "\xe2\x94\x8c";   /* ┌ */
+    case 'm': return "\xe2\x94\x94";   /* └ */
+    case 'n': return "\xe2\x94\xbc";   /* ┼ */
+    case 'q': return "\xe2\x94\x80";   /* ─ */
+    case 't': return "\xe2\x94\x9c";   /* ├ */
+    case 'u': return "\xe2\x94\xa4";   /* ┤ */
+    case 'v': return "\xe2\x94\xb4";   /* ┴ */
+    case 'w': return "\xe2\x94\xac";   /* ┬ */
+    case 'x': return "\xe2\x94\x82";   /* │ */
+    default:  return NULL;
+    }
+}
+
+static void fb_control(ansi_fb_t *fb, int ch)
+{
+    switch (ch) {
+    case '\n':
+        fb->col = 0;
+        if (fb->row < fb->rows - 1) fb->row++;
+        break;
+    case '\r': fb->col = 0; break;
+    case '\b': if (fb->col > 0) fb->col--; break;
+    case '\t': fb->col = clampi((fb->col / 8 + 1) * 8, 0, fb->cols - 1); break;
+    default:   break;
+    }
+}
+
+static void fb_sgr(ansi_fb_t *fb, const int *p, int n)
+{
+    ansi_pen_t *pen = &fb->pen;
+    if (n == 0) { memset(pen, 0, sizeof(*pen)); return; }
+
+    for (int i = 0; i < n; i++) {
+        int v = p[i] < 0 ? 0 : p[i];
+        if (v == 38 || v == 48) {
+            uint32_t color = ANSI_CELL_DEFAULT;
+            if (i + 2 < n && p[i + 1] == 5) {
+                color = ANSI_CELL_PALETTE | (uint32_t)(p[i + 2] & 0xFF);
+                i += 2;
+            } else if (i + 4 < n && p[i + 1] == 2) {
+                color = ANSI_CELL_RGB | (uint32_t)(p[i + 2] & 0xFF) << 16 |
+                        (uint32_t)(p[i + 3] & 0xFF) << 8 | (uint32_t)(p[i + 4] & 0xFF);
+                i += 4;
+            } else {
+                break;
+            }
+            if (v == 38) pen->fg = color; else pen->bg = color;
+            continue;
+        }
+        switch (v) {
+        case 0:  memset(pen, 0, sizeof(*pen)); break;
+        case 1:  pen->styles |= ANSI_CELL_BOLD; break;
+        case 2:  pen->styles |= ANSI_CELL_DIM; break;
+        case 3:  pen->styles |= ANSI_CELL_ITALIC; break;
+        case 4:  pen->styles |= ANSI_CELL_UNDERLINE; break;
+        case 5:
+        case 6:  pen->styles |= ANSI_CELL_BLINK; break;
+        case 7:  pen->styles |= ANSI_CELL_INVERT; break;
+        case 9:  pen->styles |= ANSI_CELL_STRIKE; break;
+        case 22: pen->styles &= (uint8_t)~(ANSI_CELL_BOLD | ANSI_CELL_DIM); break;
+        case 23: pen->styles &= (uint8_t)~ANSI_CELL_ITALIC; break;
+        case 24: pen->styles &= (uint8_t)~ANSI_CELL_UNDERLINE; break;
+        case 25: pen->styles &= (uint8_t)~ANSI_CELL_BLINK; break;
+        case 27: pen->styles &= (uint8_t)~ANSI_CELL_INVERT; break;
+        case 29: pen->styles &= (uint8_t)~ANSI_CELL_STRIKE; break;
+        case 39: pen->fg = ANSI_CELL_DEFAULT; break;
+        case 49: pen->bg = ANSI_CELL_DEFAULT; break;
+        default:
+            if (v >= 30 && v <= 37)        pen->fg = ANSI_CELL_PALETTE | (uint32_t)(v - 30);
+            else if (v >= 40 && v <= 47)   pen->bg = ANSI_CELL_PALETTE | (uint32_t)(v - 40);
+            else if (v >= 90 && v <= 97)   pen->fg = ANSI_CELL_PALETTE | (uint32_t)(v - 90 + 8);
+            else if (v >= 100 && v <= 107) pen->bg = ANSI_CELL_PALETTE | (uint32_t)(v - 100 + 8);
+            break;
+        }
+    }
+}
+
+static void fb_csi(ansi_fb_t *fb, int final)
+{
+    int p[16];
+    int n = 0;
+    const char *s = fb->seq;
+    int priv = (*s == '?');
+    if (priv) s++;
+
+    p[0] = -1;
+    for (; *s && n < 16; s++) {
+        if (*s >= '0' && *s <= '9') {
+            p[n] = (p[n] < 0 ? 0 : p[n]) * 10 + (*s - '0');
+        } else if (*s == ';' || *s == ':') {
+            if (++n < 16) p[n] = -1;
+        }
+    }
+    if (n < 16 && (p[n] >= 0 || n > 0)) n++;
+
+    int a = (n > 0 && p[0] > 0) ? p[0] : 1;   /* count / 1-based position */
+    int mode = (n > 0 && p[0] > 0) ? p[0] : 0;
+
+    if (priv) {
+        if (mode == 25 && (final == 'h' || final == 'l'))
+            fb->cursor_visible = (final == 'h');
+        return;
+    }
+
+    switch (final) {
+    case 'H':
+    case 'f':
+        fb->row = clampi(a - 1, 0, fb->rows - 1);
+        fb->col = clampi((n > 1 && p[1] > 0 ? p[1] : 1) - 1, 0, fb->cols - 1);
+        break;
+    case 'A': fb->row = clampi(fb->row - a, 0, fb->rows - 1); break;
+    case 'B': fb->row = clampi(fb->row + a, 0, fb->rows - 1); break;
+    case 'C': fb->col = clampi(fb->col + a, 0, fb->cols - 1); break;
+    case 'D': fb->col = clampi(fb->col - a, 0, fb->cols - 1); break;
+    case 'G': fb->col = clampi(a - 1, 0, fb->cols - 1); break;
+    case 'd': fb->row = clampi(a - 1, 0, fb->rows - 1); break;
+    case 'J':
+        if (mode == 0 || mode == 1) {
+            int col = clampi(fb->col, 0, fb->cols);
+            if (mode == 0) {
+                fb_erase(fb, fb->row, col, fb->cols);
+                for (int r = fb->row + 1; r < fb->rows; r++) fb_erase(fb, r, 0, fb->cols);
+            } else {
+                for (int r = 0; r < fb->row; r++) fb_erase(fb, r, 0, fb->cols);
+                fb_erase(fb, fb->row, 0, clampi(col + 1, 0, fb->cols));
+            }
+        } else {
+            for (int r = 0; r < fb->rows; r++) fb_erase(fb, r, 0, fb->cols);
+        }
+        break;
+    case 'K': {
+        int col = clampi(fb->col, 0, fb->cols);
+        if (mode == 0)      fb_erase(fb, fb->row, col, fb->cols);
+        else if (mode == 1) fb_erase(fb, fb->row, 0, clampi(col + 1, 0, fb->cols));
+        else                fb_erase(fb, fb->row, 0, fb->cols);
+        break;
+    }
+    case 'X':
+        fb_erase(fb, fb->row, clampi(fb->col, 0, fb->cols),
+                 clampi(fb->col + a, 0, fb->cols));
+        break;
+    case 'b':               /* REP: repeat the last glyph */
+        for (int i = 0; i < a && fb->last_len && fb->col < fb->cols; i++)
+            fb_glyph(fb, fb->last, fb->last_len);
+        break;
+    case 'm':
+        fb_sgr(fb, p, n);
+        break;
+    default:
+        break;
+    }
+}
+
+/** Output callback of the model's context: interpret one byte. */
+static void fb_putc(void *user, int ch)
+{
+    ansi_fb_t *fb = (ansi_fb_t *)user;
+    unsigned char b = (unsigned char)ch;
+
+    switch (fb->state) {
+    case FB_ESC:
+        if (b == '[') {
+            fb->state = FB_CSI;
+            fb->seq_len = 0;
+        } else {
+            fb->state = (b == ']' || b == 'P') ? FB_STRING
+                      : b == '(' ? FB_G0 : FB_GROUND;
+        }
+        return;
+    case FB_G0:             /* ESC ( F: designate G0 */
+        fb->dec   = b == '0';
+        fb->state = FB_GROUND;
+        return;
+    case FB_CSI:
+        if (b >= 0x40 && b <= 0x7E) {
+            fb->seq[fb->seq_len] = '\0';
+            fb->state = FB_GROUND;
+            fb_csi(fb, b);
+        } else if (fb->seq_len < sizeof(fb->seq) - 1) {
+            fb->seq[fb->seq_len++] = (char)b;
+        }
+        return;
+    case FB_STRING:         /* OSC/DCS: skip to BEL or ST */
+        if (b == 0x07) fb->state = FB_GROUND;
+        else if (b == 0x1B) fb->state = FB_ESC;
+        return;
+    default:
+        break;
+    }
+
+    if (fb->utf8_need) {
+        if ((b & 0xC0) == 0x80) {
+            fb->utf8[fb->utf8_len++] = (char)b;
+            if (--fb->utf8_need == 0) fb_glyph(fb, fb->utf8, fb->utf8_len);
+            return;
+        }
+        fb->utf8_need = 0;  /* truncated sequence: drop it */
+    }
+
+    if (b == 0x1B) {
+        fb->state = FB_ESC;
+    } else if (b < 0x20 || b == 0x7F) {
+        fb_control(fb, b);
+    } else if (b < 0x80) {
+        const char *dec = fb->dec ? fb_dec_glyph(b) : NULL;
+        char g = (char)b;
+        if (dec) fb_glyph(fb, dec, 3);
+        else     fb_glyph(fb, &g, 1);
+    } else if ((b & 0xE0) == 0xC0 || (b & 0xF0) == 0xE0 || (b & 0xF8) == 0xF0) {
+        fb->utf8[0]   = (char)b;
+        fb->utf8_len  = 1;
+        fb->utf8_need = (b & 0xE0) == 0xC0 ? 1 : ((b & 0xF0) == 0xE0 ? 2 : 3);
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Framebuffer and clients                                             */
+/* ------------------------------------------------------------------ */
+
+int ansi_fb_init(ansi_fb_t *fb, ansi_cell_t *cells, int rows, int cols,
+                 char *buf, size_t buf_size)
+{
+    if (!fb || !cells || rows < 1 || cols < 1) return 0;
+    memset(fb, 0, sizeof(*fb));
+    ansi_ctx_init(&fb->ctx, NULL, NULL, buf, buf_size);
+    ansi_ctx_set_output(&fb->ctx, fb_putc, NULL, fb);
+    fb->cells = cells;
+    fb->rows  = rows;
+    fb->cols  = cols;
+    for (int i = 0; i < rows * cols; i++) cell_erase(&cells[i], ANSI_CELL_DEFAULT);
+    return 1;
+}
+
+ansi_ctx_t *ansi_fb_ctx(ansi_fb_t *fb) { return fb ? &fb->ctx : NULL; }
+
+const ansi_cell_t *ansi_fb_cell(const ansi_fb_t *fb, int row, int col)
+{
+    if (!fb || row < 1 || col < 1 || row > fb->rows || col > fb->cols) return NULL;
+    return &fb->cells[(row - 1) * fb->cols + (col - 1)];
+}
+
+void ansi_fb_redraw(ansi_fb_client_t *client)
+{
+    if (client) client->full = 1;
+}
+
+void ansi_fb_attach(ansi_fb_t *fb, ansi_fb_client_t *client, ansi_ctx_t *out,
+                    ansi_cell_t *last)
+{
+    if (!fb || !client || !out || !last) return;
+    memset(client, 0, sizeof(*client));
+    client->out  = out;
+    client->last = last;
+    client->full = 1;
+
+    ansi_fb_client_t **pp = &fb->clients;   /* append: present in attach order */
+    while (*pp) pp = &(*pp)->next;
+    *pp = client;
+}
+
+void ansi_fb_detach(ansi_fb_t *fb, ansi_fb_client_t *client)
+{
+    if (!fb || !client) return;
+    for (ansi_fb_client_t **pp = &fb->clients; *pp; pp = &(*pp)->next) {
+        if (*pp == client) {
+            *pp = client->next;
+            client->next = NULL;
+            return;
+        }
+    }
+}
+
+/* ------------------------------------------------------------------ */
+/* Presenting                                                          */
+/* ------------------------------------------------------------------ */
+
+/** Output of one shard, or of a whole frame streamed to a client.
+ *
+ * Streaming (@c cl set): bytes are staged and drained into the client's
+ * context; the batch and sync-begin marker start with the first byte, so
+ * an unchanged frame sends and flushes nothing.
+ *
+ * Shard (@c cl NULL): bytes go to a fixed buffer and the presented rows
+ * are not recorded; on overflow the shard is abandoned and streamed again
+ * by the calling thread. */
+typedef struct {
+    ansi_fb_client_t *cl;
+    char             *buf;
+    size_t            size;
+    size_t            n;
+    size_t            total;
+    int               started;
+    int               overflow;
+    int               row;        /* terminal state as of this output */
+    int               col;
+    ansi_pen_t        pen;
+    int               pen_known;
+    int               depth;      /* client color depth (ANSI_DEPTH_*) */
+} fb_out_t;
+
+static void out_drain(fb_out_t *o)
+{
+    if (o->n) ansi_ctx_write(o->cl->out, o->buf, o->n);
+    o->n = 0;
+}
+
+static void out_bytes(fb_out_t *o, const char *s, size_t n)
+{
+    if (o->overflow) return;
+    if (!o->cl) {
+        if (n > o->size - o->n) { o->overflow = 1; return; }
+        memcpy(o->buf + o->n, s, n);
+        o->n += n;
+        o->total += n;
+        return;
+    }
+
+    if (!o->started) {
+        o->started = 1;
+        ansi_ctx_batch_begin(o->cl->out);
+        out_bytes(o, "\x1b[?2026h", 8);
+    }
+    o->total += n;
+    while (n) {
+        if (o->n == o->size) out_drain(o);
+        size_t k = o->size - o->n;
+        if (k > n) k = n;
+        memcpy(o->buf + o->n, s, k);
+        o->n += k;
+        s += k;
+        n -= k;
+    }
+}
+
+static void out_str(fb_out_t *o, const char *s) { out_bytes(o, s, strlen(s)); }
+
+/** Room for the longest color parameter, ";48;2;255;255;255" + NUL. */
+#define SGR_PARAM_MAX 18
+
+/** Append one color parameter, reduced to the client's color depth. */
+static int sgr_color(char *p, uint32_t color, int base, int depth)
+{
+    uint32_t v = color & 0xFFFFFFu;
+    if ((color & 0xFF000000u) == ANSI_CELL_RGB) {
+        unsigned r = (unsigned)(v >> 16), g = (unsigned)((v >> 8) & 0xFF), b = (unsigned)(v & 0xFF);
+        if (!ANSI_PRINT_COLOR_DEPTH || depth >= ANSI_DEPTH_TRUE)
+            return ansi_snprintf(p, SGR_PARAM_MAX, ";%d;2;%u;%u;%u", base + 8, r, g, b);
+#if ANSI_PRINT_COLOR_DEPTH
+        v = (uint32_t)ansi_rgb_to_256((int)r, (int)g, (int)b);
+#endif
+    }
+#if ANSI_PRINT_COLOR_DEPTH
+    if (v >= 16 && depth < ANSI_DEPTH_256) v = (uint32_t)ansi_256_to_16((int)v);
+#else
+    (void)depth;
+#endif
+    if (v < 8)  return ansi_snprintf(p, SGR_PARAM_MAX, ";%u", (unsigned)(base + v));
+    if (v < 16) return ansi_snprintf(p, SGR_PARAM_MAX, ";%u", (unsigned)(base + 60 + v - 8));
+    return ansi_snprintf(p, SGR_PARAM_MAX, ";%d;5;%u", base + 8, (unsigned)v);
+}
+
+/** Switch the pen to the cell's attributes (reset + full set). */
+static void out_pen(fb_out_t *o, const ansi_cell_t *c)
+{
+    static const uint8_t codes[] = { 1, 2, 3, 4, 5, 7, 9 };
+    if (o->pen_known && o->pen.fg == c->fg && o->pen.bg == c->bg &&
+        o->pen.styles == c->styles)
+        return;
+
+    char sgr[64];
+    int n = ansi_snprintf(sgr, sizeof(sgr), "\x1b[0");
+    for (int i = 0; i < 7; i++)
+        if (c->styles & (1u << i)) n += ansi_snprintf(sgr + n, sizeof(sgr) - (size_t)n, ";%u", codes[i]);
+    if (c->fg) n += sgr_color(sgr + n, c->fg, 30, o->depth);
+    if (c->bg) n += sgr_color(sgr + n, c->bg, 40, o->depth);
+    sgr[n++] = 'm';
+    out_bytes(o, sgr, (size_t)n);
+
+    o->pen.fg     = c->fg;
+    o->pen.bg     = c->bg;
+    o->pen.styles = c->styles;
+    o->pen_known  = 1;
+}
+
+/** Send cells [from, to) of one row. */
+static void out_run(fb_out_t *o, const ansi_fb_t *fb, int row, int from, int to,
+                    int color)
+{
+    const ansi_cell_t *cur = fb->cells + row * fb->cols;
+
+    if (o->row != row || o->col != from) {
+        char cup[32];
+        int n = ansi_snprintf(cup, sizeof(cup), "\x1b[%d;%dH", row + 1, from + 1);
+        out_bytes(o, cup, (size_t)n);
+    }
+    for (int col = from; col < to; col++) {
+        const ansi_cell_t *c = &cur[col];
+        if (c->len == 0) continue;          /* right half, drawn with its left */
+        if (color) out_pen(o, c);
+        out_bytes(o, c->glyph, c->len);
+    }
+
+    o->row = row;
+    o->col = to;
+    if (to >= fb->cols) o->row = o->col = -1;   /* pending wrap: unknown */
+}
+
+/** Send the changed cells of one row; a streamed row is recorded as
+ *  presented (shard rows are recorded by shard_job() once they fit). */
+static void diff_row(fb_out_t *o, const ansi_fb_t *fb, ansi_cell_t *last,
+                     int row, int color)
+{
+    const ansi_cell_t *cur = fb->cells + row * fb->cols;
+    ansi_cell_t *old = last + row * fb->cols;
+    int cols = fb->cols;
+
+    if (memcmp(cur, old, (size_t)cols * sizeof(*cur)) == 0) return;
+
+    int col = 0;
+    while (col < cols) {
+        if (cell_eq(&cur[col], &old[col])) { col++; continue; }
+        if (cur[col].len == 0 && col > 0) col--;   /* start at the glyph's left half */
+
+        int end_changed = col, gap = 0;
+        for (int k = col + 1; k < cols; k++) {
+            if (!cell_eq(&cur[k], &old[k])) { end_changed = k; gap = 0; }
+            else if (++gap > FB_GAP) break;
+        }
+        int end = end_changed + 1;
+        if (end < cols && cur[end].len == 0) end++;
+
+        out_run(o, fb, row, col, end, color);
+        col = end;
+    }
+    if (o->cl) memcpy(old, cur, (size_t)cols * sizeof(*cur));
+}
+
+/** Render one shard of rows.  The output starts from an unknown cursor
+ *  and pen, so it never depends on what an earlier shard sent. */
+static void render_shard(fb_out_t *o, const ansi_fb_t *fb, ansi_cell_t *last,
+                         int shard, int color)
+{
+    int r0 = shard * ANSI_FB_SHARD_ROWS;
+    int r1 = r0 + ANSI_FB_SHARD_ROWS;
+    if (r1 > fb->rows) r1 = fb->rows;
+
+    o->row = o->col = -1;
+    o->pen_known = 0;
+    for (int row = r0; row < r1 && !o->overflow; row++)
+        diff_row(o, fb, last, row, color);
+}
+
+int ansi_fb_shard_count(const ansi_fb_t *fb)
+{
+    return fb ? (fb->rows + ANSI_FB_SHARD_ROWS - 1) / ANSI_FB_SHARD_ROWS : 0;
+}
+
+void ansi_fb_set_parallel(ansi_fb_t *fb, ansi_fb_parallel_fn run, void *user,
+                          ansi_fb_shard_t *shards, int count)
+{
+    if (!fb) return;
+    fb->par_run     = run;
+    fb->par_user    = user;
+    fb->shards      = shards;
+    fb->shard_slots = count;
+}
+
+typedef struct {
+    const ansi_fb_t  *fb;
+    ansi_fb_client_t *cl;
+    int               color;
+} fb_job_t;
+
+static void shard_job(void *arg, int index)
+{
+    const fb_job_t *job = (const fb_job_t *)arg;
+    ansi_fb_shard_t *sh = &job->fb->shards[index];
+    fb_out_t o;
+    memset(&o, 0, sizeof(o));
+    o.buf  = sh->buf;
+    o.size = sh->size;
+    o.depth = ansi_ctx_depth(job->cl->out);
+    render_shard(&o, job->fb, job->cl->last, index, job->color);
+    sh->len      = o.overflow ? 0 : o.n;
+    sh->overflow = o.overflow;
+    if (o.overflow) return;
+
+    /* Record the shard's rows; disjoint from every other shard */
+    const ansi_fb_t *fb = job->fb;
+    int r0 = index * ANSI_FB_SHARD_ROWS;
+    int r1 = r0 + ANSI_FB_SHARD_ROWS;
+    if (r1 > fb->rows) r1 = fb->rows;
+    memcpy(job->cl->last + r0 * fb->cols, fb->cells + r0 * fb->cols,
+           (size_t)(r1 - r0) * (size_t)fb->cols * sizeof(ansi_cell_t));
+}
+
+size_t ansi_fb_present_client(ansi_fb_t *fb, ansi_fb_client_t *cl)
+{
+    if (!fb || !cl) return 0;
+    char stage[128];
+    fb_out_t o;
+    memset(&o, 0, sizeof(o));
+    o.cl   = cl;
+    o.buf  = stage;
+    o.size = sizeof(stage);
+    o.depth = ansi_ctx_depth(cl->out);
+    int color = ansi_ctx_is_enabled(cl->out);
+    int shards = ansi_fb_shard_count(fb);
+
+    if (cl->full) {
+        out_str(&o, color ? "\x1b[0m\x1b[2J" : "\x1b[2J");
+        for (int i = 0; i < fb->rows * fb->cols; i++)
+            cell_erase(&cl->last[i], ANSI_CELL_DEFAULT);
+        cl->cursor_visible = -1;
+        cl->full = 0;
+    }
+
+    if (fb->par_run && fb->shards && fb->shard_slots >= shards) {
+        /* Shards touch disjoint rows of the model and of cl->last */
+        fb_job_t job = { fb, cl, color };
+        fb->par_run(fb->par_user, shards, shard_job, &job);
+        for (int i = 0; i < shards; i++) {
+            if (fb->shards[i].overflow)     /* same bytes, streamed here */
+                render_shard(&o, fb, cl->last, i, color);
+            else if (fb->shards[i].len)
+                out_bytes(&o, fb->shards[i].buf, fb->shards[i].len);
+        }
+    } else {
+        for (int i = 0; i < shards; i++)
+            render_shard(&o, fb, cl->last, i, color);
+    }
+
+    if (cl->cursor_visible != fb->cursor_visible) {
+        out_str(&o, fb->cursor_visible ? "\x1b[?25h" : "\x1b[?25l");
+        cl->cursor_visible = fb->cursor_visible;
+    }
+    if (o.started) {
+        out_str(&o, "\x1b[?2026l");
+        out_drain(&o);
+        ansi_ctx_batch_end(cl->out);
+    }
+
+    if (o.total) cl->frames++;
+    cl->bytes += o.total;
+    return o.total;
+}
+
+size_t ansi_fb_present(ansi_fb_t *fb)
+{
+    size_t total = 0;
+    if (!fb) return 0;
+    for (ansi_fb_client_t *cl = fb->clients; cl; cl = cl->next)
+        total += ansi_fb_present_client(fb, cl);
+    return total;
+}
+
+#endif /* ANSI_PRINT_FB */
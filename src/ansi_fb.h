@@ -0,0 +1,250 @@
+/**
+ * @file ansi_fb.h
+ * @brief Cell framebuffer with per-client diffing: render a scene once,
+ *        present it to several terminals.
+ *
+ * The framebuffer owns an ansi_ctx_t whose output is interpreted as a
+ * terminal would (cursor moves, SGR, clears) into a grid of cells.  Point
+ * a TUI screen at it with tui_screen_set_ctx(screen, ansi_fb_ctx(&fb)) and
+ * every widget update lands in the shared model instead of on a device.
+ *
+ * Each attached client (serial console, pty, socket...) keeps its own copy
+ * of the last grid it was shown plus its cursor and SGR pen.
+ * ansi_fb_present() compares the model with that copy and sends each
+ * client only its own diff, so a viewer attached mid-session gets a full
+ * redraw while the others keep receiving small updates.
+ *
+ * All storage is caller-provided.
+ *
+ * @code
+ * static ansi_cell_t      model[24 * 80], serial_last[24 * 80], sock_last[24 * 80];
+ * static char             fb_buf[256];
+ * static ansi_fb_t        fb;
+ * static ansi_fb_client_t serial, sock;
+ *
+ * ansi_fb_init(&fb, model, 24, 80, fb_buf, sizeof(fb_buf));
+ * tui_screen_set_ctx(&screen, ansi_fb_ctx(&fb));
+ * ansi_fb_attach(&fb, &serial, &uart_ctx, serial_last);
+ *
+ * // later: a debug client connects
+ * ansi_fb_attach(&fb, &sock, &sock_ctx, sock_last);
+ *
+ * // each frame
+ * tui_screen_render(&screen);   // draws into the model only
+ * ansi_fb_present(&fb);         // per-client diffs
+ * @endcode
+ *
+ * The interpreter understands what ansi_print and ansi_tui emit: UTF-8
+ * text, CR/LF/BS/TAB, CUP/CUU/CUD/CUF/CUB/CHA/VPA, ED, EL, ECH, SGR
+ * (16/256/RGB colors and styles) and cursor show/hide.  Other sequences
+ * are ignored.  Emoji from the shortcode table take their declared width;
+ * other glyphs take one cell.  There is no scrolling or autowrap: output
+ * past the last row or column is clipped.
+ */
+
+#ifndef ANSI_FB_H
+#define ANSI_FB_H
+
+#include "ansi_print.h"
+
+/** @def ANSI_PRINT_FB
+ *  Enable the cell framebuffer and multi-client presenter.
+ *  Default: 1 (0 if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_PRINT_FB
+#  define ANSI_PRINT_FB  ANSI_PRINT_DEFAULT_
+#endif
+
+#if ANSI_PRINT_FB
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Cell style bits (ansi_cell_t::styles). */
+#define ANSI_CELL_BOLD       (1u << 0)
+#define ANSI_CELL_DIM        (1u << 1)
+#define ANSI_CELL_ITALIC     (1u << 2)
+#define ANSI_CELL_UNDERLINE  (1u << 3)
+#define ANSI_CELL_BLINK      (1u << 4)
+#define ANSI_CELL_INVERT     (1u << 5)
+#define ANSI_CELL_STRIKE     (1u << 6)
+
+/** Cell colors: 0 is the terminal default, otherwise a kind tag plus value. */
+#define ANSI_CELL_DEFAULT    0u
+#define ANSI_CELL_PALETTE    0x01000000u   /**< | index 0-255 */
+#define ANSI_CELL_RGB        0x02000000u   /**< | 0xRRGGBB */
+
+/** Rendering attributes of a cell (the "pen"). */
+typedef struct {
+    uint32_t fg;
+    uint32_t bg;
+    uint8_t  styles;
+} ansi_pen_t;
+
+/** One screen cell (16 bytes, no padding, so rows compare with memcmp).
+ *  @c len is the glyph's UTF-8 length, or 0 for the right half of a
+ *  two-cell glyph. */
+typedef struct {
+    uint32_t fg;
+    uint32_t bg;
+    uint8_t  styles;
+    uint8_t  len;
+    char     glyph[4];
+    uint8_t  reserved[2];   /* always 0 */
+} ansi_cell_t;
+
+/** A terminal receiving the scene (see ansi_fb_attach()). */
+typedef struct ansi_fb_client {
+    ansi_ctx_t            *out;      /**< Client's output context. */
+    ansi_cell_t           *last;     /**< Grid last presented to this client. */
+    int                    cursor_visible; /**< -1 = unknown. */
+    int                    full;     /**< Full redraw pending. */
+    unsigned long          frames;   /**< Presents that sent anything. */
+    unsigned long          bytes;    /**< Total bytes sent. */
+    struct ansi_fb_client *next;
+} ansi_fb_client_t;
+
+/** @def ANSI_FB_SHARD_ROWS
+ *  Rows per present shard, the unit of parallel work.  The row split is
+ *  fixed, so the bytes sent do not depend on how many workers run.
+ *  Default: 8. */
+#ifndef ANSI_FB_SHARD_ROWS
+#  define ANSI_FB_SHARD_ROWS  8
+#endif
+
+/** Output buffer for one shard (see ansi_fb_set_parallel()). */
+typedef struct {
+    char   *buf;
+    size_t  size;
+    size_t  len;     /**< Bytes rendered by the last present. */
+    int     overflow; /**< Last present did not fit; streamed by the caller. */
+} ansi_fb_shard_t;
+
+/** A job run by the parallel hook: render shard @p index. */
+typedef void (*ansi_fb_job_fn)(void *arg, int index);
+
+/**
+ * Parallel-for hook: call job(arg, i) for every i in [0, count), on any
+ * threads, and return once all calls have finished.
+ */
+typedef void (*ansi_fb_parallel_fn)(void *user, int count,
+                                    ansi_fb_job_fn job, void *arg);
+
+/** Shared scene model and its interpreter state. */
+typedef struct {
+    ansi_ctx_t        ctx;           /**< Render target (ansi_fb_ctx()). */
+    ansi_cell_t      *cells;         /**< rows * cols, row-major. */
+    int               rows;
+    int               cols;
+    int               row;           /* interpreter cursor */
+    int               col;
+    ansi_pen_t        pen;
+    int               cursor_visible;
+    /* escape / UTF-8 parser */
+    uint8_t           state;
+    uint8_t           seq_len;
+    char              seq[32];
+    uint8_t           utf8_need;
+    uint8_t           utf8_len;
+    char              utf8[4];
+    uint8_t           last_len;      /* last glyph drawn, for REP (CSI b) */
+    char              last[4];
+    uint8_t           dec;           /* G0 is DEC Special Graphics (ESC(0) */
+    ansi_fb_client_t *clients;
+    /* parallel present */
+    ansi_fb_parallel_fn par_run;
+    void              *par_user;
+    ansi_fb_shard_t   *shards;
+    int                shard_slots;
+} ansi_fb_t;
+
+/**
+ * @brief Initialize a framebuffer over caller-provided cells.
+ *
+ * The grid starts blank (spaces, default colors) with the cursor hidden.
+ *
+ * @param fb        Framebuffer to initialize.
+ * @param cells     Cell array of @p rows * @p cols entries.
+ * @param rows      Grid height.
+ * @param cols      Grid width.
+ * @param buf       Format buffer for the render context (ansi_ctx_print).
+ * @param buf_size  Size of @p buf.
+ * @return 1 on success, 0 on bad arguments.
+ */
+int ansi_fb_init(ansi_fb_t *fb, ansi_cell_t *cells, int rows, int cols,
+                 char *buf, size_t buf_size);
+
+/** @brief The context that renders into the model. */
+ansi_ctx_t *ansi_fb_ctx(ansi_fb_t *fb);
+
+/** @brief Cell at (@p row, @p col), 1-based like tui_goto(); NULL if outside. */
+const ansi_cell_t *ansi_fb_cell(const ansi_fb_t *fb, int row, int col);
+
+/**
+ * @brief Attach a client; it receives a full redraw on the next present.
+ *
+ * @param fb      Framebuffer.
+ * @param client  Client state (owned by the caller, must stay valid).
+ * @param out     Client output context.  Its color setting decides whether
+ *                SGR sequences are sent.
+ * @param last    Caller-provided grid of fb->rows * fb->cols cells.
+ */
+void ansi_fb_attach(ansi_fb_t *fb, ansi_fb_client_t *client, ansi_ctx_t *out,
+                    ansi_cell_t *last);
+
+/** @brief Detach a client.  Nothing is sent to it. */
+void ansi_fb_detach(ansi_fb_t *fb, ansi_fb_client_t *client);
+
+/** @brief Force a full redraw of one client on the next present
+ *         (e.g. after its terminal was reset). */
+void ansi_fb_redraw(ansi_fb_client_t *client);
+
+/**
+ * @brief Send every client the difference between the model and what it
+ *        was last shown.
+ *
+ * Each client's output is one ansi_ctx_batch_begin/end group wrapped in
+ * synchronized-update markers, so it flushes once per present; nothing is
+ * sent for an unchanged frame.  Every ANSI_FB_SHARD_ROWS-row shard starts
+ * with a cursor move and SGR reset (see ansi_fb_set_parallel()).
+ *
+ * @return Total bytes sent to all clients.
+ */
+size_t ansi_fb_present(ansi_fb_t *fb);
+
+/** @brief Present to one client only. @return Bytes sent. */
+size_t ansi_fb_present_client(ansi_fb_t *fb, ansi_fb_client_t *client);
+
+/** @brief Number of ANSI_FB_SHARD_ROWS-row shards in a frame. */
+int ansi_fb_shard_count(const ansi_fb_t *fb);
+
+/**
+ * @brief Render the diff of large frames on several workers.
+ *
+ * Each shard of ANSI_FB_SHARD_ROWS rows is rendered into its own buffer,
+ * starting with an absolute cursor move and a full SGR set, so shards are
+ * independent.  The buffers are then written in row order as one output.
+ * The serial path uses the same shard boundaries, so the bytes are
+ * identical whatever the worker count, including none.
+ *
+ * A shard whose output does not fit its buffer is rendered again on the
+ * calling thread, streamed straight to the client, so no row is dropped
+ * or delayed; size the buffers for the usual diff, not the worst case.
+ *
+ * @param fb      Framebuffer.
+ * @param run     Parallel-for hook (e.g. a pthread pool), or NULL for serial.
+ * @param user    Passed to @p run.
+ * @param shards  At least ansi_fb_shard_count() buffers; with fewer the
+ *                present falls back to serial.
+ * @param count   Number of entries in @p shards.
+ */
+void ansi_fb_set_parallel(ansi_fb_t *fb, ansi_fb_parallel_fn run, void *user,
+                          ansi_fb_shard_t *shards, int count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANSI_PRINT_FB */
+
+#endif /* ANSI_FB_H */
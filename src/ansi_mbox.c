@@ -0,0 +1,247 @@
+/**
+ * @file ansi_mbox.c
+ * @brief Lock-free cross-thread widget update mailbox.
+ *
+ * Same bounded ring as ansi_async.c (per-slot sequence numbers):
+ *   seq == pos            slot is free for the producer claiming pos
+ *   seq == pos + 1        slot holds the event for pos
+ *   seq == pos + capacity slot was consumed and is free for the next lap
+ * The UI thread and a producer dropping the oldest event both claim
+ * events with a CAS on @c head, so a dropped event is never applied.
+ */
+
+#include "ansi_mbox.h"
+
+#if ANSI_TUI_MBOX
+
+#include <stdint.h>
+
+int tui_mbox_init(tui_mbox_t *mb, tui_screen_t *screen,
+                  tui_mbox_slot_t *slots, size_t count)
+{
+    if (!mb || !screen || !slots || count < 2 || (count & (count - 1))) return 0;
+
+    mb->screen = screen;
+    mb->slots  = slots;
+    mb->mask   = count - 1;
+    for (size_t i = 0; i < count; i++)
+        atomic_init(&slots[i].seq, i);
+    atomic_init(&mb->head, 0);
+    atomic_init(&mb->tail, 0);
+    atomic_init(&mb->posted, 0);
+    atomic_init(&mb->dropped, 0);
+    atomic_init(&mb->applied, 0);
+    atomic_init(&mb->depth_max, 0);
+    return 1;
+}
+
+/** Claim the oldest published event, or NULL if there is none. */
+static tui_mbox_slot_t *mbox_claim_oldest(tui_mbox_t *mb, size_t *out_pos)
+{
+    size_t pos = atomic_load_explicit(&mb->head, memory_order_relaxed);
+    for (;;) {
+        tui_mbox_slot_t *s = &mb->slots[pos & mb->mask];
+        size_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&mb->head, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                *out_pos = pos;
+                return s;
+            }
+        } else if (diff < 0) {
+            return NULL;   /* empty (or the producer has not published yet) */
+        } else {
+            pos = atomic_load_explicit(&mb->head, memory_order_relaxed);
+        }
+    }
+}
+
+static void mbox_release(tui_mbox_t *mb, tui_mbox_slot_t *s, size_t pos)
+{
+    atomic_store_explicit(&s->seq, pos + mb->mask + 1, memory_order_release);
+}
+
+/** Raise the depth high-water mark to @p depth. */
+static void mbox_note_depth(tui_mbox_t *mb, size_t depth)
+{
+    size_t max = atomic_load_explicit(&mb->depth_max, memory_order_relaxed);
+    while (depth > max &&
+           !atomic_compare_exchange_weak_explicit(&mb->depth_max, &max, depth,
+                memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+/** Claim a free slot, discarding the oldest event while the ring is full.
+ *  Returns NULL when the ring is full and its oldest event is still being
+ *  written: that producer may be preempted by this one, so waiting could
+ *  livelock on a single core; the new event is dropped instead. */
+static tui_mbox_slot_t *mbox_claim_free(tui_mbox_t *mb, size_t *out_pos)
+{
+    size_t pos = atomic_load_explicit(&mb->tail, memory_order_relaxed);
+    for (;;) {
+        tui_mbox_slot_t *s = &mb->slots[pos & mb->mask];
+        size_t seq = atomic_load_explicit(&s->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&mb->tail, &pos, pos + 1,
+                    memory_order_relaxed, memory_order_relaxed)) {
+                *out_pos = pos;
+                return s;
+            }
+        } else if (diff < 0) {
+            /* Full: drop the oldest event */
+            size_t old;
+            tui_mbox_slot_t *o = mbox_claim_oldest(mb, &old);
+            if (o) {
+                mbox_release(mb, o, old);
+                atomic_fetch_add_explicit(&mb->dropped, 1, memory_order_relaxed);
+            } else if (atomic_load_explicit(&mb->tail, memory_order_relaxed) == pos &&
+                       atomic_load_explicit(&s->seq, memory_order_acquire) == seq) {
+                return NULL;   /* oldest not yet published, nothing moved */
+            }
+            pos = atomic_load_explicit(&mb->tail, memory_order_relaxed);
+        } else {
+            pos = atomic_load_explicit(&mb->tail, memory_order_relaxed);
+        }
+    }
+}
+
+static int mbox_post(tui_mbox_t *mb, tui_kind_t kind, const void *widget,
+                     tui_num_t v0, tui_num_t v1, tui_num_t v2)
+{
+    if (!mb || !widget) return 0;
+    size_t pos;
+    tui_mbox_slot_t *s = mbox_claim_free(mb, &pos);
+    if (!s) {
+        atomic_fetch_add_explicit(&mb->dropped, 1, memory_order_relaxed);
+        return 0;
+    }
+    s->kind     = kind;
+    s->widget   = widget;
+    s->value[0] = v0;
+    s->value[1] = v1;
+    s->value[2] = v2;
+    atomic_store_explicit(&s->seq, pos + 1, memory_order_release);
+
+    atomic_fetch_add_explicit(&mb->posted, 1, memory_order_relaxed);
+    intptr_t depth = (intptr_t)(pos + 1 - atomic_load_explicit(&mb->head, memory_order_relaxed));
+    if (depth > 0) mbox_note_depth(mb, (size_t)depth);
+    return 1;
+}
+
+#if ANSI_TUI_BAR
+int tui_mbox_bar(tui_mbox_t *mb, const tui_bar_t *w, tui_num_t value,
+                 tui_num_t min, tui_num_t max)
+{
+    return mbox_post(mb, ANSI_TUI_KIND_BAR, w, value, min, max);
+}
+#endif
+
+#if ANSI_TUI_PBAR
+int tui_mbox_pbar(tui_mbox_t *mb, const tui_pbar_t *w, int percent)
+{
+    return mbox_post(mb, ANSI_TUI_KIND_PBAR, w, percent, 0, 0);
+}
+#endif
+
+#if ANSI_TUI_CHECK
+int tui_mbox_check(tui_mbox_t *mb, const tui_check_t *w, int state)
+{
+    return mbox_post(mb, ANSI_TUI_KIND_CHECK, w, state, 0, 0);
+}
+#endif
+
+#if ANSI_TUI_EBAR
+int tui_mbox_ebar(tui_mbox_t *mb, const tui_ebar_t *w, int value)
+{
+    return mbox_post(mb, ANSI_TUI_KIND_EBAR, w, value, 0, 0);
+}
+#endif
+
+#if ANSI_TUI_METRIC
+int tui_mbox_metric(tui_mbox_t *mb, const tui_metric_t *w, tui_num_t value)
+{
+    return mbox_post(mb, ANSI_TUI_KIND_METRIC, w, value, 0, 0);
+}
+#endif
+
+static void mbox_apply(tui_kind_t kind, const void *widget, const tui_num_t *value)
+{
+    switch (kind) {
+#if ANSI_TUI_BAR
+    case ANSI_TUI_KIND_BAR:
+#if ANSI_PRINT_FLOAT
+        tui_bar_update((const tui_bar_t *)widget, value[0], value[1], value[2], 0);
+#else
+        tui_bar_update_i32((const tui_bar_t *)widget, value[0], value[1], value[2], 0);
+#endif
+        break;
+#endif
+#if ANSI_TUI_PBAR
+    case ANSI_TUI_KIND_PBAR:
+        tui_pbar_update((const tui_pbar_t *)widget, (int)value[0], 0);
+        break;
+#endif
+#if ANSI_TUI_CHECK
+    case ANSI_TUI_KIND_CHECK:
+        tui_check_update((const tui_check_t *)widget, (int)value[0], 0);
+        break;
+#endif
+#if ANSI_TUI_EBAR
+    case ANSI_TUI_KIND_EBAR:
+        tui_ebar_update((const tui_ebar_t *)widget, (int)value[0], 0);
+        break;
+#endif
+#if ANSI_TUI_METRIC
+    case ANSI_TUI_KIND_METRIC:
+        tui_metric_update((const tui_metric_t *)widget, value[0], 0);
+        break;
+#endif
+    default:
+        break;
+    }
+}
+
+int tui_mbox_drain(tui_mbox_t *mb)
+{
+    if (!mb) return 0;
+    ansi_ctx_t *ctx = mb->screen->ctx ? mb->screen->ctx : ansi_default_ctx();
+    int n = 0;
+    ansi_ctx_batch_begin(ctx);
+    for (;;) {
+        size_t pos;
+        tui_mbox_slot_t *s = mbox_claim_oldest(mb, &pos);
+        if (!s) break;
+        /* Copy out and free the slot before drawing */
+        tui_kind_t  kind   = s->kind;
+        const void *widget = s->widget;
+        tui_num_t   value[3] = { s->value[0], s->value[1], s->value[2] };
+        mbox_release(mb, s, pos);
+        mbox_apply(kind, widget, value);
+        n++;
+    }
+    ansi_ctx_batch_end(ctx);
+    atomic_fetch_add_explicit(&mb->applied, (unsigned long)n, memory_order_relaxed);
+    return n;
+}
+
+size_t tui_mbox_depth(tui_mbox_t *mb)
+{
+    if (!mb) return 0;
+    size_t head = atomic_load_explicit(&mb->head, memory_order_relaxed);
+    size_t tail = atomic_load_explicit(&mb->tail, memory_order_relaxed);
+    return (intptr_t)(tail - head) > 0 ? tail - head : 0;
+}
+
+void tui_mbox_stats(tui_mbox_t *mb, tui_mbox_stats_t *out)
+{
+    if (!mb || !out) return;
+    out->posted    = atomic_load_explicit(&mb->posted, memory_order_relaxed);
+    out->dropped   = atomic_load_explicit(&mb->dropped, memory_order_relaxed);
+    out->applied   = atomic_load_explicit(&mb->applied, memory_order_relaxed);
+    out->depth     = tui_mbox_depth(mb);
+    out->depth_max = atomic_load_explicit(&mb->depth_max, memory_order_relaxed);
+}
+
+#endif /* ANSI_TUI_MBOX */
@@ -0,0 +1,165 @@
+/**
+ * @file ansi_mbox.h
+ * @brief Cross-thread widget update mailbox: producers post values, the
+ *        UI thread applies them at frame time.
+ *
+ * The widget *_update calls write to the screen's context (or record a
+ * pending value for tui_screen_render()), so they belong to the thread
+ * that owns the screen.  A mailbox lets any number of other threads feed
+ * widgets without locks: each post copies (widget, value) into a slot of
+ * a bounded multi-producer ring, and the UI thread calls tui_mbox_drain()
+ * before rendering.
+ *
+ * Draining applies the values in post order.  For widgets with state on
+ * the screen an update only stores the value and marks the widget dirty,
+ * so a widget posted many times per frame is drawn once with its latest
+ * value (counted in the screen's @c stats.coalesced).  When the ring is
+ * full the oldest event is discarded: a newer post for the same widget
+ * normally follows it, so the display still converges on current values.
+ * Posting never waits: if the oldest event is itself still being written
+ * by another producer (e.g. one this thread preempted), the new event is
+ * dropped instead.
+ *
+ * Storage is caller-provided.  Requires C11 atomics, like ansi_async.h;
+ * enabled together with ANSI_PRINT_ASYNC.
+ *
+ * @code
+ * static tui_mbox_slot_t mbox_slots[64];        // power of two
+ * static tui_mbox_t      mbox;
+ *
+ * tui_mbox_init(&mbox, &screen, mbox_slots, 64);
+ *
+ * // sensor threads
+ * tui_mbox_metric(&mbox, &temp_gauge, read_temp());
+ * tui_mbox_bar(&mbox, &cpu_bar, load, 0.0, 100.0);
+ *
+ * // UI thread
+ * for (;;) {
+ *     tui_mbox_drain(&mbox);
+ *     tui_tick(&screen, millis());
+ * }
+ * @endcode
+ */
+
+#ifndef ANSI_MBOX_H
+#define ANSI_MBOX_H
+
+#include "ansi_tui.h"
+#include "ansi_async.h"
+
+/** @def ANSI_TUI_MBOX
+ *  Enable the tui_mbox_* cross-thread update mailbox.  Needs C11 atomics
+ *  and the screen registry.  Default: ANSI_PRINT_ASYNC. */
+#ifndef ANSI_TUI_MBOX
+#  define ANSI_TUI_MBOX  ANSI_PRINT_ASYNC
+#endif
+
+#if ANSI_TUI_MBOX && !ANSI_TUI_SCREEN
+#  undef  ANSI_TUI_MBOX
+#  define ANSI_TUI_MBOX  0
+#endif
+
+#if ANSI_TUI_MBOX
+
+#if !defined(__STDC_VERSION__) || __STDC_VERSION__ < 201112L || \
+    defined(__STDC_NO_ATOMICS__)
+#error "ANSI_TUI_MBOX requires C11 atomics (compile with -std=c11)"
+#endif
+
+#include <stdatomic.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** One queued update (caller-provided array, see tui_mbox_init()). */
+typedef struct {
+    atomic_size_t seq;      /**< Slot sequence number (internal). */
+    tui_kind_t    kind;     /**< Widget type. */
+    const void   *widget;   /**< Widget descriptor. */
+    tui_num_t     value[3]; /**< Value (and bar range). */
+} tui_mbox_slot_t;
+
+/** Mailbox counters (see tui_mbox_stats()). */
+typedef struct {
+    unsigned long posted;     /**< Events accepted by a post call. */
+    unsigned long dropped;    /**< Events discarded on a full ring. */
+    unsigned long applied;    /**< Events applied by tui_mbox_drain(). */
+    size_t        depth;      /**< Events queued right now. */
+    size_t        depth_max;  /**< Highest depth seen by a post. */
+} tui_mbox_stats_t;
+
+/** Mailbox state.  Fields are internal; read counters with tui_mbox_stats(). */
+typedef struct {
+    tui_screen_t    *screen;
+    tui_mbox_slot_t *slots;
+    size_t           mask;       /* capacity - 1 */
+    atomic_size_t    head;       /* next event to apply */
+    atomic_size_t    tail;       /* next slot to fill */
+    atomic_ulong     posted;
+    atomic_ulong     dropped;
+    atomic_ulong     applied;
+    atomic_size_t    depth_max;
+} tui_mbox_t;
+
+/**
+ * @brief Prepare a mailbox over caller-provided slots.
+ *
+ * @param mb      Mailbox to initialize (not yet shared with other threads).
+ * @param screen  Screen whose widgets are posted to; its context batches
+ *                the output of tui_mbox_drain().
+ * @param slots   Slot array.
+ * @param count   Number of slots; must be a power of two >= 2.
+ * @return 1 on success, 0 on bad arguments.
+ */
+int tui_mbox_init(tui_mbox_t *mb, tui_screen_t *screen,
+                  tui_mbox_slot_t *slots, size_t count);
+
+/*
+ * Post calls (any thread).  Each returns 1 when the event was queued and
+ * 0 on bad arguments or when it was dropped.  A full ring drops its oldest
+ * event instead of blocking the producer; if that event is still being
+ * written by another producer, the new event is dropped (counted in
+ * @c dropped) rather than waiting for it.
+ */
+#if ANSI_TUI_BAR
+int tui_mbox_bar(tui_mbox_t *mb, const tui_bar_t *w, tui_num_t value,
+                 tui_num_t min, tui_num_t max);
+#endif
+#if ANSI_TUI_PBAR
+int tui_mbox_pbar(tui_mbox_t *mb, const tui_pbar_t *w, int percent);
+#endif
+#if ANSI_TUI_CHECK
+int tui_mbox_check(tui_mbox_t *mb, const tui_check_t *w, int state);
+#endif
+#if ANSI_TUI_EBAR
+int tui_mbox_ebar(tui_mbox_t *mb, const tui_ebar_t *w, int value);
+#endif
+#if ANSI_TUI_METRIC
+int tui_mbox_metric(tui_mbox_t *mb, const tui_metric_t *w, tui_num_t value);
+#endif
+
+/**
+ * @brief Apply every queued event to its widget (UI thread only).
+ *
+ * Call before tui_screen_render() or tui_tick().  Output from widgets that
+ * draw immediately (no state, or not on the screen) is grouped into one
+ * ansi_ctx_batch_begin/end on the screen's context.
+ *
+ * @return Number of events applied.
+ */
+int tui_mbox_drain(tui_mbox_t *mb);
+
+/** @brief Events currently queued (a snapshot; producers may be racing). */
+size_t tui_mbox_depth(tui_mbox_t *mb);
+
+/** @brief Read the mailbox counters. */
+void tui_mbox_stats(tui_mbox_t *mb, tui_mbox_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANSI_TUI_MBOX */
+
+#endif /* ANSI_MBOX_H */
@@ -10,6 +10,7 @@
 
 #include <ctype.h>
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -33,7 +34,8 @@
 #define STRIKETHROUGH "\x1b[9m"
 
 /* Box-drawing characters (UTF-8 byte sequences) for ansi_banner/window.
-   Style selected at compile time via ANSI_PRINT_BOX_STYLE. */
+   Style selected at compile time via ANSI_PRINT_BOX_STYLE.  BOX_IN and
+   BOX_OUT bracket every run of box glyphs (charset switch, or empty). */
 #if ANSI_PRINT_BOX_STYLE == ANSI_BOX_LIGHT
 #define BOX_TOPLEFT     "\xe2\x94\x8c"  /* U+250C  ┌ */
 #define BOX_TOPRIGHT    "\xe2\x94\x90"  /* U+2510  ┐ */
@@ -70,12 +72,54 @@
 #define BOX_VERT        "\xe2\x94\x82"  /* U+2502  │ */
 #define BOX_MIDLEFT     "\xe2\x94\x9c"  /* U+251C  ├ */
 #define BOX_MIDRIGHT    "\xe2\x94\xa4"  /* U+2524  ┤ */
+#elif ANSI_PRINT_BOX_STYLE == ANSI_BOX_DEC
+#define BOX_IN          "\x1b(0"        /* G0 = DEC Special Graphics */
+#define BOX_OUT         "\x1b(B"        /* G0 = US ASCII */
+#define BOX_TOPLEFT     "l"             /* ┌ */
+#define BOX_TOPRIGHT    "k"             /* ┐ */
+#define BOX_BOTTOMLEFT  "m"             /* └ */
+#define BOX_BOTTOMRIGHT "j"             /* ┘ */
+#define BOX_HORZ        "q"             /* ─ */
+#define BOX_VERT        "x"             /* │ */
+#define BOX_MIDLEFT     "t"             /* ├ */
+#define BOX_MIDRIGHT    "u"             /* ┤ */
+#elif ANSI_PRINT_BOX_STYLE == ANSI_BOX_ASCII
+#define BOX_TOPLEFT     "+"
+#define BOX_TOPRIGHT    "+"
+#define BOX_BOTTOMLEFT  "+"
+#define BOX_BOTTOMRIGHT "+"
+#define BOX_HORZ        "-"
+#define BOX_VERT        "|"
+#define BOX_MIDLEFT     "+"
+#define BOX_MIDRIGHT    "+"
 #else
 #error "Unknown ANSI_PRINT_BOX_STYLE value"
 #endif
 
+#ifndef BOX_IN
+#define BOX_IN          ""
+#define BOX_OUT         ""
+#endif
+
 #if ANSI_PRINT_BAR
+#if ANSI_PRINT_BAR_ASCII
+/* One byte per cell: fills are rounded to half cells (see ansi_bar_span) */
+#define BAR_BLOCK_LEN 1
+static const char * const m_bar_block[] = {
+    NULL, "=", "=", "=", "=", "=", "=", "=", "#",
+};
+
+static const struct { const char *s; int len; } m_bar_track[] = {
+    { " ", 1 },  /* ANSI_BAR_BLANK */
+    { ".", 1 },  /* ANSI_BAR_LIGHT */
+    { ":", 1 },  /* ANSI_BAR_MED   */
+    { "%", 1 },  /* ANSI_BAR_HEAVY */
+    { ".", 1 },  /* ANSI_BAR_DOT   */
+    { "-", 1 },  /* ANSI_BAR_LINE  */
+};
+#else
 /* Block elements for bar rendering (UTF-8 byte sequences) */
+#define BAR_BLOCK_LEN 3
 #define BAR_1_OF_8  "\xe2\x96\x8f"  /* U+258F  Left One Eighth Block    */
 #define BAR_2_OF_8  "\xe2\x96\x8e"  /* U+258E  Left One Quarter Block   */
 #define BAR_3_OF_8  "\xe2\x96\x8d"  /* U+258D  Left Three Eighths Block */
@@ -107,6 +151,7 @@ static const struct { const char *s; int len; } m_bar_track[] = {
     { "\xc2\xb7",         2 },  /* ANSI_BAR_DOT    · U+00B7 */
     { "\xe2\x94\x80",     3 },  /* ANSI_BAR_LINE   ─ U+2500 */
 };
+#endif /* ANSI_PRINT_BAR_ASCII */
 
 #endif /* ANSI_PRINT_BAR */
 
@@ -114,26 +159,215 @@ static const struct { const char *s; int len; } m_bar_track[] = {
 /* Output plumbing                                                            */
 /* ------------------------------------------------------------------------- */
 
-static char   *m_buf      = NULL;
-static size_t  m_buf_size = 0;
-
-
 /* Default no-op functions */
 static void ansi_noop_putc(int ch)  { (void)ch; }
 static void ansi_noop_flush(void)   { }
 
-static ansi_putc_function  m_putc_function  = ansi_noop_putc;
-static ansi_flush_function m_flush_function = ansi_noop_flush;
-static int m_color_enabled = 1;
-#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
-static int m_no_color_lock = 0;  /* set by ansi_enable() when NO_COLOR env is present */
+/** Context behind the classic (non-ctx) API */
+static ansi_ctx_t m_default_ctx = {
+    .putc_fn       = ansi_noop_putc,
+    .flush_fn      = ansi_noop_flush,
+    .color_enabled = 1,
+    .rep           = ANSI_PRINT_REP_ON,
+    .ech           = ANSI_PRINT_ECH_ON,
+    .depth         = ANSI_DEPTH_TRUE,
+};
+
+#if defined(ANSI_PRINT_PUTC) && !defined(ANSI_PRINT_WRITE)
+#define ANSI_PRINT_WRITE(p, n) \
+    do { for (size_t i_ = 0; i_ < (n); i_++) ANSI_PRINT_PUTC((unsigned char)(p)[i_]); } while (0)
+#endif
+
+/** Hand one byte to the context's output callback */
+static void ctx_emit(ansi_ctx_t *c, int ch)
+{
+    c->out_bytes++;
+    if (c->out_fn) c->out_fn(c->out_user, ch);
+#ifdef ANSI_PRINT_PUTC
+    else           ANSI_PRINT_PUTC(ch);
+#else
+    else           c->putc_fn(ch);
 #endif
+}
+
+#if ANSI_PRINT_REP
+
+/* REP compression sits between the formatter and the output callback.
+ * Printable glyphs are assembled from their UTF-8 bytes; a glyph equal
+ * to the one just sent is only counted, and the count goes out (as
+ * ESC[nb or as copies, whichever is shorter) when anything else is
+ * emitted.  Bytes inside escape sequences are never compressed. */
+
+enum { REP_TEXT, REP_ESC, REP_CSI, REP_STRING, REP_STRING_ESC };
+
+static void rep_emit_bytes(ansi_ctx_t *c, const char *s, int n)
+{
+    for (int i = 0; i < n; i++) ctx_emit(c, (unsigned char)s[i]);
+}
+
+/** Send the repeats held back for the last glyph */
+static void rep_settle(ansi_ctx_t *c)
+{
+    unsigned n = c->rep_count;
+    if (!n) return;
+    c->rep_count = 0;
+
+    char seq[16];
+    int digits = ansi_snprintf(seq, sizeof(seq), "\x1b[%ub", n) - 3;
+    if ((unsigned long)c->rep_len * n > (unsigned long)(digits + 3)) {
+        rep_emit_bytes(c, seq, digits + 3);
+    } else {
+        while (n--) rep_emit_bytes(c, c->rep_glyph, c->rep_len);
+    }
+}
+
+/** Emit held repeats and any partial glyph; the next glyph starts a new run */
+static void rep_break(ansi_ctx_t *c)
+{
+    rep_settle(c);
+    rep_emit_bytes(c, c->rep_part, c->rep_part_len);
+    c->rep_part_len = 0;
+    c->rep_need     = 0;
+    c->rep_len      = 0;
+}
+
+/** A complete glyph is in rep_part: count it or send it */
+static void rep_glyph_done(ansi_ctx_t *c)
+{
+    int n = c->rep_part_len;
+    c->rep_part_len = 0;
+    if (c->rep_len == n && memcmp(c->rep_part, c->rep_glyph, (size_t)n) == 0) {
+        c->rep_count++;
+        return;
+    }
+    rep_settle(c);
+    rep_emit_bytes(c, c->rep_part, n);
+    /* 4-byte sequences are mostly wide emoji: never repeated */
+    c->rep_len = (uint8_t)(n <= 3 ? n : 0);
+    memcpy(c->rep_glyph, c->rep_part, (size_t)n);
+}
+
+static void rep_putc(ansi_ctx_t *c, unsigned char b)
+{
+    switch (c->rep_esc) {
+    case REP_ESC:           /* intermediates (e.g. the '(' of ESC(0) wait for the final */
+        c->rep_esc = b == '[' ? REP_CSI
+                   : (b == ']' || b == 'P' || b == '_' || b == '^') ? REP_STRING
+                   : (b >= 0x20 && b <= 0x2F) ? REP_ESC
+                   : REP_TEXT;
+        ctx_emit(c, b);
+        return;
+    case REP_CSI:
+        if (b >= 0x40 && b <= 0x7E) c->rep_esc = REP_TEXT;
+        ctx_emit(c, b);
+        return;
+    case REP_STRING:        /* OSC/DCS: up to BEL or ST */
+        if (b == 0x07)      c->rep_esc = REP_TEXT;
+        else if (b == 0x1B) c->rep_esc = REP_STRING_ESC;
+        ctx_emit(c, b);
+        return;
+    case REP_STRING_ESC:
+        c->rep_esc = REP_TEXT;
+        ctx_emit(c, b);
+        return;
+    default:
+        break;
+    }
+
+    if (c->rep_need) {
+        if ((b & 0xC0) == 0x80) {
+            c->rep_part[c->rep_part_len++] = (char)b;
+            if (--c->rep_need == 0) rep_glyph_done(c);
+            return;
+        }
+        rep_break(c);       /* truncated sequence: pass it on as is */
+    }
+
+    int need = -1;
+    if (b >= 0x20 && b < 0x7F)      need = 0;
+    else if ((b & 0xE0) == 0xC0)    need = 1;
+    else if ((b & 0xF0) == 0xE0)    need = 2;
+    else if ((b & 0xF8) == 0xF0)    need = 3;
+
+    if (need < 0) {         /* control byte, ESC or stray continuation */
+        rep_break(c);
+        if (b == 0x1B) c->rep_esc = REP_ESC;
+        ctx_emit(c, b);
+        return;
+    }
+    c->rep_part[0]  = (char)b;
+    c->rep_part_len = 1;
+    c->rep_need     = (uint8_t)need;
+    if (!need) rep_glyph_done(c);
+}
+
+#endif /* ANSI_PRINT_REP */
+
+/** Emit one byte to the context's output, or into the capture buffer
+ *  while ansi_sgr() is resolving a tag */
+static void ctx_putc(ansi_ctx_t *c, int ch)
+{
+    if (c->sink) {
+        if (c->sink_room > 1) {
+            *c->sink++ = (char)ch;
+            c->sink_room--;
+        }
+        return;
+    }
+#if ANSI_PRINT_REP
+    if (c->rep) {
+        rep_putc(c, (unsigned char)ch);
+        return;
+    }
+#endif
+    ctx_emit(c, ch);
+}
+
+static void ctx_flush(ansi_ctx_t *c)
+{
+#if ANSI_PRINT_REP
+    if (c->rep) rep_break(c);
+#endif
+    if (!c->out_fn)        c->flush_fn();
+    else if (c->out_flush) c->out_flush(c->out_user);
+}
+
+/** Flush unless a batch is open; ansi_batch_end() flushes once at the end */
+static void output_flush(ansi_ctx_t *c)
+{
+    if (c->batch_depth == 0) ctx_flush(c);
+}
 
 /** Emit a string by calling the user-provided putc function for each character */
-static void output_string(const char *s)
+#ifdef ANSI_PRINT_PUTC
+/** Bytes may bypass ctx_putc() and go straight to ANSI_PRINT_WRITE() */
+static int ctx_direct(const ansi_ctx_t *c)
+{
+    return !c->sink && !c->out_fn && !(ANSI_PRINT_REP && c->rep);
+}
+#endif
+
+/** Emit a run of bytes that needs no markup processing */
+static void output_bytes(ansi_ctx_t *c, const char *s, size_t n)
+{
+#ifdef ANSI_PRINT_PUTC
+    if (ctx_direct(c)) {
+        c->out_bytes += n;
+        ANSI_PRINT_WRITE(s, n);
+        return;
+    }
+#endif
+    for (size_t i = 0; i < n; i++) ctx_putc(c, (unsigned char)s[i]);
+}
+
+static void output_string(ansi_ctx_t *c, const char *s)
 {
     if (!s) return;
-    while (*s) m_putc_function(*s++);
+#ifdef ANSI_PRINT_PUTC
+    output_bytes(c, s, strlen(s));
+#else
+    while (*s) ctx_putc(c, *s++);
+#endif
 }
 
 /* ------------------------------------------------------------------------- */
@@ -154,74 +388,111 @@ typedef uint8_t StyleMask;
 /* Color & style table                                                        */
 /* ------------------------------------------------------------------------- */
 
-typedef struct { uint8_t r, g, b; } RGB;
+typedef ansi_rgb_t RGB;
 
-typedef struct {
-    const char *name;
-    uint8_t     len;
-    const char *fg_code;
-    const char *bg_code;
-    StyleMask   style; /* 0 for colors, style bitmask for attributes */
-    RGB         rgb;   /* for gradient interpolation; {0,0,0} for styles */
-} AttrEntry;
+/* SGR codes: what a color or style word sets, kept as a small integer and
+   turned into escape bytes by output_code().  fg and bg share one code
+   and differ only in the emitted parameter (30 vs 40, 38 vs 48). */
+#define CODE_NONE   0
+#define CODE_BASIC  0x100   /* | 0-15:  SGR 30-37, 90-97 (bg 40-47, 100-107) */
+#define CODE_INDEX  0x200   /* | 0-255: SGR 38;5;N (bg 48;5;N) */
+#define CODE_STYLE  0x400   /* | SGR parameter: 1 bold, 2 dim, ... */
 
-/* Pre-compute name length at compile time so lookup can reject on length
-   before calling memcmp — avoids O(table_size * name_len) per query. */
-#define ATTR(n, fg, bg, sty, r, g, b)  { (n), sizeof(n)-1, (fg), (bg), (sty), {(r),(g),(b)} }
-
-static const AttrEntry ATTRS[] = {
-    /* Standard colors */
-    ATTR("black",           "\x1b[30m",      "\x1b[40m",      0,    0,   0,   0),
-    ATTR("red",             "\x1b[31m",      "\x1b[41m",      0,  255,   0,   0),
-    ATTR("green",           "\x1b[32m",      "\x1b[42m",      0,    0, 205,   0),
-    ATTR("yellow",          "\x1b[33m",      "\x1b[43m",      0,  255, 255,   0),
-    ATTR("blue",            "\x1b[34m",      "\x1b[44m",      0,    0,   0, 255),
-    ATTR("magenta",         "\x1b[35m",      "\x1b[45m",      0,  255,   0, 255),
-    ATTR("cyan",            "\x1b[36m",      "\x1b[46m",      0,    0, 255, 255),
-    ATTR("white",           "\x1b[37m",      "\x1b[47m",      0,  255, 255, 255),
+/*
+ * Table rows: X(name, code, style, r, g, b).  Names are C identifiers so
+ * each group expands both into one packed name pool (a struct of char
+ * arrays, giving every name a compile-time offset) and into the entries
+ * that refer to it by 16-bit offset -- no pointers, no relocations.
+ */
+#define ATTR_STANDARD(X) \
+    X(black,          CODE_BASIC | 0,   0,    0,   0,   0) \
+    X(red,            CODE_BASIC | 1,   0,  255,   0,   0) \
+    X(green,          CODE_BASIC | 2,   0,    0, 205,   0) \
+    X(yellow,         CODE_BASIC | 3,   0,  255, 255,   0) \
+    X(blue,           CODE_BASIC | 4,   0,    0,   0, 255) \
+    X(magenta,        CODE_BASIC | 5,   0,  255,   0, 255) \
+    X(cyan,           CODE_BASIC | 6,   0,    0, 255, 255) \
+    X(white,          CODE_BASIC | 7,   0,  255, 255, 255)
 
 #if ANSI_PRINT_EXTENDED_COLORS
-    /* Extended colors */
-    ATTR("orange",          "\x1b[38;5;208m", "\x1b[48;5;208m", 0, 255, 135,   0),
-    ATTR("pink",            "\x1b[38;5;213m", "\x1b[48;5;213m", 0, 255, 135, 255),
-    ATTR("purple",          "\x1b[38;5;93m",  "\x1b[48;5;93m",  0, 135,   0, 255),
-    ATTR("brown",           "\x1b[38;5;94m",  "\x1b[48;5;94m",  0, 135,  95,   0),
-    ATTR("teal",            "\x1b[38;5;37m",  "\x1b[48;5;37m",  0,   0, 175, 175),
-    ATTR("lime",            "\x1b[38;5;118m", "\x1b[48;5;118m", 0, 135, 255,   0),
-    ATTR("navy",            "\x1b[38;5;18m",  "\x1b[48;5;18m",  0,   0,   0, 135),
-    ATTR("olive",           "\x1b[38;5;100m", "\x1b[48;5;100m", 0, 135, 135,   0),
-    ATTR("maroon",          "\x1b[38;5;52m",  "\x1b[48;5;52m",  0,  95,   0,   0),
-    ATTR("aqua",            "\x1b[38;5;51m",  "\x1b[48;5;51m",  0,   0, 255, 255),
-    ATTR("silver",          "\x1b[38;5;250m", "\x1b[48;5;250m", 0, 188, 188, 188),
-    ATTR("gray",            "\x1b[38;5;244m", "\x1b[48;5;244m", 0, 128, 128, 128),
+#define ATTR_EXTENDED(X) \
+    X(orange,         CODE_INDEX | 208, 0,  255, 135,   0) \
+    X(pink,           CODE_INDEX | 213, 0,  255, 135, 255) \
+    X(purple,         CODE_INDEX | 93,  0,  135,   0, 255) \
+    X(brown,          CODE_INDEX | 94,  0,  135,  95,   0) \
+    X(teal,           CODE_INDEX | 37,  0,    0, 175, 175) \
+    X(lime,           CODE_INDEX | 118, 0,  135, 255,   0) \
+    X(navy,           CODE_INDEX | 18,  0,    0,   0, 135) \
+    X(olive,          CODE_INDEX | 100, 0,  135, 135,   0) \
+    X(maroon,         CODE_INDEX | 52,  0,   95,   0,   0) \
+    X(aqua,           CODE_INDEX | 51,  0,    0, 255, 255) \
+    X(silver,         CODE_INDEX | 250, 0,  188, 188, 188) \
+    X(gray,           CODE_INDEX | 244, 0,  128, 128, 128)
+#else
+#define ATTR_EXTENDED(X)
 #endif
 
 #if ANSI_PRINT_BRIGHT_COLORS
-    /* Bright variants */
-    ATTR("bright_black",    "\x1b[90m",      "\x1b[100m",     0,  128, 128, 128),
-    ATTR("bright_red",      "\x1b[91m",      "\x1b[101m",     0,  255,  85,  85),
-    ATTR("bright_green",    "\x1b[92m",      "\x1b[102m",     0,   85, 255,  85),
-    ATTR("bright_yellow",   "\x1b[93m",      "\x1b[103m",     0,  255, 255,  85),
-    ATTR("bright_blue",     "\x1b[94m",      "\x1b[104m",     0,   85,  85, 255),
-    ATTR("bright_magenta",  "\x1b[95m",      "\x1b[105m",     0,  255,  85, 255),
-    ATTR("bright_cyan",     "\x1b[96m",      "\x1b[106m",     0,   85, 255, 255),
-    ATTR("bright_white",    "\x1b[97m",      "\x1b[107m",     0,  255, 255, 255),
+#define ATTR_BRIGHT(X) \
+    X(bright_black,   CODE_BASIC | 8,   0,  128, 128, 128) \
+    X(bright_red,     CODE_BASIC | 9,   0,  255,  85,  85) \
+    X(bright_green,   CODE_BASIC | 10,  0,   85, 255,  85) \
+    X(bright_yellow,  CODE_BASIC | 11,  0,  255, 255,  85) \
+    X(bright_blue,    CODE_BASIC | 12,  0,   85,  85, 255) \
+    X(bright_magenta, CODE_BASIC | 13,  0,  255,  85, 255) \
+    X(bright_cyan,    CODE_BASIC | 14,  0,   85, 255, 255) \
+    X(bright_white,   CODE_BASIC | 15,  0,  255, 255, 255)
+#else
+#define ATTR_BRIGHT(X)
 #endif
 
+/* Styles (rgb unused - gradient rejects via style != 0) */
 #if ANSI_PRINT_STYLES
-    /* Styles (rgb unused - gradient rejects via style != 0) */
-    ATTR("bold",            BOLD,          NULL, STYLE_BOLD,      0, 0, 0),
-    ATTR("dim",             DIM,           NULL, STYLE_DIM,       0, 0, 0),
-    ATTR("italic",          ITALIC,        NULL, STYLE_ITALIC,    0, 0, 0),
-    ATTR("underline",       UNDERLINE,     NULL, STYLE_UNDERLINE, 0, 0, 0),
-    ATTR("invert",          INVERT,        NULL, STYLE_INVERT,    0, 0, 0),
-    ATTR("strikethrough",   STRIKETHROUGH, NULL, STYLE_STRIKE,    0, 0, 0),
+#define ATTR_STYLES(X) \
+    X(bold,           CODE_STYLE | 1,   STYLE_BOLD,      0, 0, 0) \
+    X(dim,            CODE_STYLE | 2,   STYLE_DIM,       0, 0, 0) \
+    X(italic,         CODE_STYLE | 3,   STYLE_ITALIC,    0, 0, 0) \
+    X(underline,      CODE_STYLE | 4,   STYLE_UNDERLINE, 0, 0, 0) \
+    X(invert,         CODE_STYLE | 7,   STYLE_INVERT,    0, 0, 0) \
+    X(strikethrough,  CODE_STYLE | 9,   STYLE_STRIKE,    0, 0, 0)
+#else
+#define ATTR_STYLES(X)
 #endif
+
 #if ANSI_PRINT_GRADIENTS
-    ATTR("rainbow",         NULL,          NULL, STYLE_RAINBOW,   0, 0, 0),
+#define ATTR_EFFECTS(X) \
+    X(rainbow,        CODE_NONE,        STYLE_RAINBOW,   0, 0, 0)
+#else
+#define ATTR_EFFECTS(X)
 #endif
+
+#define ATTR_ROWS(X) \
+    ATTR_STANDARD(X) ATTR_EXTENDED(X) ATTR_BRIGHT(X) ATTR_STYLES(X) ATTR_EFFECTS(X)
+
+#define ATTR_POOL_FIELD(n, code, sty, r, g, b)  char n[sizeof(#n)];
+#define ATTR_POOL_TEXT(n, code, sty, r, g, b)   #n,
+
+static const struct attr_pool { ATTR_ROWS(ATTR_POOL_FIELD) } ATTR_NAMES = {
+    ATTR_ROWS(ATTR_POOL_TEXT)
 };
 
+typedef struct {
+    uint16_t  name;  /* offset into ATTR_NAMES */
+    uint8_t   len;
+    StyleMask style; /* 0 for colors, style bitmask for attributes */
+    uint16_t  code;  /* CODE_*; CODE_NONE for per-character effects */
+    RGB       rgb;   /* for gradient interpolation; {0,0,0} for styles */
+} AttrEntry;
+
+#define ATTR_NAME(a)  ((const char *)&ATTR_NAMES + (a)->name)
+
+/* Pre-compute name length at compile time so lookup can reject on length
+   before calling memcmp — avoids O(table_size * name_len) per query. */
+#define ATTR_ENTRY(n, code, sty, r, g, b) \
+    { (uint16_t)offsetof(struct attr_pool, n), sizeof(#n) - 1, (sty), (code), {(r), (g), (b)} },
+
+static const AttrEntry ATTRS[] = { ATTR_ROWS(ATTR_ENTRY) };
+
 /* ------------------------------------------------------------------------- */
 /* Emoji table (Rich-style :name: shortcodes)                                 */
 /* ------------------------------------------------------------------------- */
@@ -230,21 +501,54 @@ static const AttrEntry ATTRS[] = {
 
 /* ansi_emoji_entry_t is defined in ansi_print.h */
 
-/* Pre-compute name length at compile time via sizeof so lookup can reject
-   length mismatches immediately without calling strlen on every entry. */
-#define EMOJI(n, u)  { (n), sizeof(n)-1, (u) }
-
-/* Include the selected emoji font table.  Each .inc file provides EMOJI()
-   rows for both core and extended sets (gated by ANSI_PRINT_EXTENDED_EMOJI). */
-static const ansi_emoji_entry_t EMOJIS[] = {
+/* The selected emoji font table (EMOJI() rows for both core and extended
+   sets, gated by ANSI_PRINT_EXTENDED_EMOJI) is included once per view.  Pass one
+   packs every row as "name\0utf8" into one pool struct, naming each member
+   after the row's line number; pass two builds 4-byte slots holding the
+   16-bit pool offset and the name length (pre-computed via sizeof so lookup
+   can reject length mismatches without calling strlen on every entry). */
 #if ANSI_PRINT_EMOJI_FONT == ANSI_EMOJI_FONT_STD
-#  include "emoji_std.inc"
+#  define EMOJI_FONT "emoji_std.inc"
+#elif ANSI_PRINT_EMOJI_FONT == ANSI_EMOJI_FONT_ASCII
+#  define EMOJI_FONT "emoji_ascii.inc"
 #else
 #  error "Unknown ANSI_PRINT_EMOJI_FONT value"
 #endif
+
+#define EMOJI_CAT(a, b)  a##b
+#define EMOJI_ID(line)   EMOJI_CAT(e, line)
+
+/* Rows end in a comma, so the members form one declaration closed by end */
+#define EMOJI(n, u)  EMOJI_ID(__LINE__)[sizeof(n) + sizeof(u)]
+static const struct emoji_pool {
+    char
+#include EMOJI_FONT
+    end[1];
+} EMOJI_POOL = {
+#undef EMOJI
+#define EMOJI(n, u)  n "\0" u
+#include EMOJI_FONT
+    ""
 };
+#undef EMOJI
+
+typedef struct {
+    uint16_t off;  /* name, then utf8 after its NUL, in EMOJI_POOL */
+    uint8_t  len;
+} EmojiSlot;
+
+#define EMOJI(n, u)  { (uint16_t)offsetof(struct emoji_pool, EMOJI_ID(__LINE__)), sizeof(n) - 1 }
+static const EmojiSlot EMOJIS[] = {
+#include EMOJI_FONT
+};
+#undef EMOJI
+
+/* Offsets must fit the 16-bit slot field */
+typedef char emoji_pool_fits[sizeof(struct emoji_pool) <= 0xFFFF ? 1 : -1];
 
 #define EMOJI_COUNT (sizeof(EMOJIS) / sizeof(EMOJIS[0]))
+#define EMOJI_NAME(em)  ((const char *)&EMOJI_POOL + (em)->off)
+#define EMOJI_UTF8(em)  (EMOJI_NAME(em) + (em)->len + 1)
 
 /** Case-insensitive name comparison (ASCII only) */
 static int emoji_name_eq(const char *input, const char *table, size_t len)
@@ -262,10 +566,10 @@ static int emoji_name_eq(const char *input, const char *table, size_t len)
 /** Find emoji entry by shortcode name (case-insensitive linear scan).
     Terminal display width is encoded in the table name: leading uppercase
     letter = 1 cell, leading lowercase = 2 cells. */
-static const ansi_emoji_entry_t *lookup_emoji(const char *s, size_t len)
+static const EmojiSlot *lookup_emoji(const char *s, size_t len)
 {
     for (size_t i = 0; i < EMOJI_COUNT; ++i) {
-        if (len == EMOJIS[i].len && emoji_name_eq(s, EMOJIS[i].name, len))
+        if (len == EMOJIS[i].len && emoji_name_eq(s, EMOJI_NAME(&EMOJIS[i]), len))
             return &EMOJIS[i];
     }
     return NULL;
@@ -273,12 +577,32 @@ static const ansi_emoji_entry_t *lookup_emoji(const char *s, size_t len)
 
 /** Get terminal display width of an emoji from its table name.
     Leading uppercase = 1 cell (narrow symbol), lowercase = 2 cells. */
-static int emoji_name_width(const ansi_emoji_entry_t *em)
+static int emoji_name_width(const EmojiSlot *em)
 {
-    return (em->name[0] >= 'A' && em->name[0] <= 'Z') ? 1 : 2;
+    const char *name = EMOJI_NAME(em);
+    return (name[0] >= 'A' && name[0] <= 'Z') ? 1 : 2;
 }
 
-const ansi_emoji_entry_t *ansi_emoji_table(void) { return EMOJIS; }
+int ansi_emoji_get(int index, ansi_emoji_entry_t *out)
+{
+    if (index < 0 || (size_t)index >= EMOJI_COUNT || !out) return 0;
+    out->name = EMOJI_NAME(&EMOJIS[index]);
+    out->len  = EMOJIS[index].len;
+    out->utf8 = EMOJI_UTF8(&EMOJIS[index]);
+    return 1;
+}
+
+/* Pointer table for ansi_emoji_table(), built from the same pool.  Only
+   linked in (with section GC) when an application calls that function. */
+#define EMOJI(n, u)  { EMOJI_POOL.EMOJI_ID(__LINE__), sizeof(n) - 1, \
+                       EMOJI_POOL.EMOJI_ID(__LINE__) + sizeof(n) }
+static const ansi_emoji_entry_t EMOJI_TABLE[] = {
+#include EMOJI_FONT
+};
+#undef EMOJI
+
+const ansi_emoji_entry_t *ansi_emoji_table(void) { return EMOJI_TABLE; }
+
 int ansi_emoji_count(void) { return (int)EMOJI_COUNT; }
 
 #endif /* ANSI_PRINT_EMOJI */
@@ -287,22 +611,10 @@ int ansi_emoji_count(void) { return (int)EMOJI_COUNT; }
 /* Tag state                                                                  */
 /* ------------------------------------------------------------------------- */
 
-typedef struct {
-    const char *fg_code;
-    const char *bg_code;
-    StyleMask   styles;
-} TagState;
-
-static TagState m_tag_state;
-static const char *m_default_fg;   /* default fg restored on [/] reset */
-static const char *m_default_bg;   /* default bg restored on [/] reset */
-static char m_num_fg[16];  /* persistent storage for numeric fg code */
-static char m_num_bg[16];  /* persistent storage for numeric bg code */
-
+/* Current fg/bg/styles live in ansi_ctx_t.tag as CODE_* values; named
+   and numeric (fg:N/bg:N) colors alike need no string storage. */
 
 #if ANSI_PRINT_GRADIENTS
-static int  m_rainbow_idx; /* current visible char index for [rainbow] */
-static int  m_rainbow_len; /* total visible chars in rainbow span (pre-scan) */
 
 /* Full-spectrum rainbow: red -> yellow -> green -> cyan -> blue -> magenta
    Uses 256-color palette indices from the 6x6x6 color cube. */
@@ -316,17 +628,110 @@ static const uint8_t RAINBOW[] = {
 
 #define RAINBOW_LEN (sizeof(RAINBOW) / sizeof(RAINBOW[0]))
 
-/* --- Gradient interpolation state ---------------------------------------- */
+/* Gradient interpolation state is ansi_ctx_t.gradient: len is the visible
+   char count of the span (from the pre-scan), idx the current char. */
+#endif /* ANSI_PRINT_GRADIENTS */
+
+#if ANSI_PRINT_COLOR_DEPTH
+
+/* Nearest basic color (0-7 normal, 8-15 bright) for every xterm-256
+   index, by RGB distance against the xterm default palette.  Generated
+   offline; indices 0-15 map to themselves. */
+static const uint8_t COLOR_256_TO_16[256] = {
+     0,  1,  2,  3,  4,  5,  6,  7,  8,  9, 10, 11, 12, 13, 14, 15,
+     0,  0,  4,  4,  4,  4,  0,  0,  6,  4,  4, 12,  2,  2,  6,  6,
+     6,  6,  2,  2,  6,  6,  6,  6,  2,  2,  6,  6,  6, 14, 10, 10,
+     6,  6, 14, 14,  0,  0,  5,  4,  4, 12,  0,  8,  8,  8, 12, 12,
+     2,  8,  8,  8, 12, 12,  2,  8,  8,  8, 12, 12,  2,  8,  8,  6,
+     6, 14, 10, 10,  6,  6, 14, 14,  1,  1,  5,  5,  5,  5,  1,  8,
+     8,  8, 12, 12,  3,  8,  8,  8, 12, 12,  3,  8,  8,  8,  8, 12,
+     3,  8,  8,  8,  7,  7,  3,  3,  8,  7,  7,  7,  1,  1,  5,  5,
+     5,  5,  1,  8,  8,  8, 12, 12,  3,  8,  8,  8,  8, 12,  3,  8,
+     8,  8,  7,  7,  3,  3,  8,  7,  7,  7,  3,  3,  7,  7,  7,  7,
+     1,  1,  5,  5,  5, 13,  1,  8,  8,  5,  5, 13,  3,  8,  8,  8,
+     7,  7,  3,  3,  8,  7,  7,  7,  3,  3,  7,  7,  7,  7, 11, 11,
+     7,  7,  7,  7,  9,  9,  5,  5, 13, 13,  9,  9,  5,  5, 13, 13,
+     3,  3,  8,  7,  7,  7,  3,  3,  7,  7,  7,  7, 11, 11,  7,  7,
+     7,  7, 11, 11,  7,  7,  7, 15,  0,  0,  0,  0,  0,  0,  8,  8,
+     8,  8,  8,  8,  8,  8,  8,  8,  8,  7,  7,  7,  7,  7,  7,  7,
+};
 
-typedef struct {
-    RGB start;
-    RGB end;
-    int len;    /* total visible chars in gradient span (from pre-scan) */
-    int idx;    /* current visible char index */
-} GradientState;
+/* Levels of the 6x6x6 color cube (indices 16-231) */
+static const uint8_t CUBE_LEVEL[6] = { 0, 95, 135, 175, 215, 255 };
 
-static GradientState m_gradient;
-#endif /* ANSI_PRINT_GRADIENTS */
+static int cube_step(int v)
+{
+    return v < 48 ? 0 : v < 115 ? 1 : (v - 35) / 40;
+}
+
+int ansi_rgb_to_256(int r, int g, int b)
+{
+    int ri = cube_step(r), gi = cube_step(g), bi = cube_step(b);
+    int cr = CUBE_LEVEL[ri], cg = CUBE_LEVEL[gi], cb = CUBE_LEVEL[bi];
+
+    /* The grayscale ramp (232-255) may be closer for near-neutral colors */
+    int avg = (r + g + b) / 3;
+    int gray = avg > 238 ? 23 : (avg < 8 ? 0 : (avg - 3) / 10);
+    int gv = 8 + 10 * gray;
+
+    long dc = (long)(r - cr) * (r - cr) + (long)(g - cg) * (g - cg) + (long)(b - cb) * (b - cb);
+    long dg = (long)(r - gv) * (r - gv) + (long)(g - gv) * (g - gv) + (long)(b - gv) * (b - gv);
+    return dg < dc ? 232 + gray : 16 + 36 * ri + 6 * gi + bi;
+}
+
+int ansi_256_to_16(int index)
+{
+    return COLOR_256_TO_16[(uint8_t)index];
+}
+
+/** Emit a palette color at the context's depth (index 0-255). */
+static void output_index(ansi_ctx_t *c, int index, int bg)
+{
+    char buf[24];
+    index &= 0xFF;
+    if (c->depth < ANSI_DEPTH_256 && index >= 16) index = COLOR_256_TO_16[index];
+    if (index < 8)       ansi_snprintf(buf, sizeof(buf), "\x1b[%dm", (bg ? 40 : 30) + index);
+    else if (index < 16) ansi_snprintf(buf, sizeof(buf), "\x1b[%dm", (bg ? 100 : 90) + index - 8);
+    else                 ansi_snprintf(buf, sizeof(buf), "\x1b[%d;5;%dm", bg ? 48 : 38, index);
+    output_string(c, buf);
+}
+
+#if ANSI_PRINT_GRADIENTS
+/** Emit an RGB color at the context's depth. */
+static void output_rgb(ansi_ctx_t *c, int r, int g, int b, int bg)
+{
+    if (c->depth < ANSI_DEPTH_TRUE) {
+        output_index(c, ansi_rgb_to_256(r, g, b), bg);
+        return;
+    }
+    char buf[24];
+    ansi_snprintf(buf, sizeof(buf), "\x1b[%d;2;%d;%d;%dm", bg ? 48 : 38, r, g, b);
+    output_string(c, buf);
+}
+#endif
+
+#endif /* ANSI_PRINT_COLOR_DEPTH */
+
+/** Emit a CODE_* value as its SGR sequence (bg selects 40/48 for colors),
+ *  downsampling palette colors that exceed the context's depth. */
+static void output_code(ansi_ctx_t *c, uint16_t code, int bg)
+{
+    char buf[16];
+    int n = code & 0xFF;
+    if (code & CODE_STYLE) {
+        ansi_snprintf(buf, sizeof(buf), "\x1b[%dm", n);
+    } else if (code & CODE_BASIC) {
+        ansi_snprintf(buf, sizeof(buf), "\x1b[%dm", (n < 8 ? 30 : 82) + n + (bg ? 10 : 0));
+    } else if (code & CODE_INDEX) {
+#if ANSI_PRINT_COLOR_DEPTH
+        if (c->depth < ANSI_DEPTH_256) { output_index(c, n, bg); return; }
+#endif
+        ansi_snprintf(buf, sizeof(buf), "\x1b[%d;5;%dm", bg ? 48 : 38, n);
+    } else {
+        return;
+    }
+    output_string(c, buf);
+}
 
 /** Find " on " separator in tag content (splits fg from bg) */
 static const char *find_on(const char *s, size_t len)
@@ -341,17 +746,17 @@ static const char *find_on(const char *s, size_t len)
 
 
 /** Re-emit ANSI codes for current fg/bg/styles after a RESET */
-static void reapply_state(void)
+static void reapply_state(ansi_ctx_t *c)
 {
-    if (m_tag_state.fg_code) output_string(m_tag_state.fg_code);
-    if (m_tag_state.bg_code) output_string(m_tag_state.bg_code);
+    output_code(c, c->tag.fg, 0);
+    output_code(c, c->tag.bg, 1);
 #if ANSI_PRINT_STYLES
-    if (m_tag_state.styles & STYLE_BOLD)        output_string(BOLD);
-    if (m_tag_state.styles & STYLE_DIM)         output_string(DIM);
-    if (m_tag_state.styles & STYLE_ITALIC)      output_string(ITALIC);
-    if (m_tag_state.styles & STYLE_UNDERLINE)   output_string(UNDERLINE);
-    if (m_tag_state.styles & STYLE_INVERT)      output_string(INVERT);
-    if (m_tag_state.styles & STYLE_STRIKE)      output_string(STRIKETHROUGH);
+    if (c->tag.styles & STYLE_BOLD)        output_string(c, BOLD);
+    if (c->tag.styles & STYLE_DIM)         output_string(c, DIM);
+    if (c->tag.styles & STYLE_ITALIC)      output_string(c, ITALIC);
+    if (c->tag.styles & STYLE_UNDERLINE)   output_string(c, UNDERLINE);
+    if (c->tag.styles & STYLE_INVERT)      output_string(c, INVERT);
+    if (c->tag.styles & STYLE_STRIKE)      output_string(c, STRIKETHROUGH);
 #endif
 }
 
@@ -364,7 +769,7 @@ static const AttrEntry *lookup_attr(const char *s, size_t len)
 {
     for (size_t i = 0; i < sizeof(ATTRS)/sizeof(ATTRS[0]); ++i) {
         if (len == ATTRS[i].len &&
-            memcmp(s, ATTRS[i].name, len) == 0) {
+            memcmp(s, ATTR_NAME(&ATTRS[i]), len) == 0) {
             return &ATTRS[i];
         }
     }
@@ -463,10 +868,10 @@ static int next_markup_token(const char **pos, MarkupToken *tok)
             size_t name_len = (size_t)(end - (p + 1));
 #if ANSI_PRINT_EMOJI
             {
-                const ansi_emoji_entry_t *em = lookup_emoji(p + 1, name_len);
+                const EmojiSlot *em = lookup_emoji(p + 1, name_len);
                 if (em) {
                     tok->type = TOK_EMOJI;
-                    tok->val.emoji = em->utf8;
+                    tok->val.emoji = EMOJI_UTF8(em);
                     tok->emoji_width = emoji_name_width(em);
                     *pos = end + 1; return 1;
                 }
@@ -499,10 +904,9 @@ static int next_markup_token(const char **pos, MarkupToken *tok)
 }
 
 /** Emit all bytes of a TOK_CHAR token (handles multi-byte UTF-8) */
-static void emit_token_bytes(const MarkupToken *tok)
+static void emit_token_bytes(ansi_ctx_t *c, const MarkupToken *tok)
 {
-    for (size_t i = 0; i < tok->len; i++)
-        m_putc_function(tok->ptr[i]);
+    output_bytes(c, tok->ptr, tok->len);
 }
 
 /* ------------------------------------------------------------------------- */
@@ -538,7 +942,7 @@ static int count_effect_chars(const char *p, const char *name, size_t name_len)
 }
 
 /** Parse [gradient color1 color2] arguments and activate gradient state */
-static void parse_gradient_tag(const char *args, size_t len)
+static void parse_gradient_tag(ansi_ctx_t *c, const char *args, size_t len)
 {
     /* Extract first color name */
     while (len && isspace((unsigned char)*args)) { args++; len--; }
@@ -556,23 +960,23 @@ static void parse_gradient_tag(const char *args, size_t len)
     const AttrEntry *a2 = lookup_attr(c2, c2_len);
     if (!a1 || a1->style || !a2 || a2->style) return; /* unknown or non-color */
 
-    m_gradient.start = a1->rgb;
-    m_gradient.end   = a2->rgb;
-    m_gradient.idx   = 0;
-    m_gradient.len   = 0; /* filled by ansi_emit after pre-scan */
-    m_tag_state.styles |= STYLE_GRADIENT;
+    c->gradient.start = a1->rgb;
+    c->gradient.end   = a2->rgb;
+    c->gradient.idx   = 0;
+    c->gradient.len   = 0; /* filled by ansi_emit after pre-scan */
+    c->tag.styles |= STYLE_GRADIENT;
 }
 #endif /* ANSI_PRINT_GRADIENTS */
 
 /** Handle [/tag]: clear matching fg/bg/style and reset ANSI state */
-static void emit_close_tag(const char *tag, size_t len)
+static void emit_close_tag(ansi_ctx_t *c, const char *tag, size_t len)
 {
     if (len == 0) { /* [/] resets to defaults */
-        output_string(RESET);
-        m_tag_state.fg_code = m_default_fg;
-        m_tag_state.bg_code = m_default_bg;
-        m_tag_state.styles  = 0;
-        if (m_default_fg || m_default_bg) reapply_state();
+        output_string(c, RESET);
+        c->tag.fg     = c->default_fg;
+        c->tag.bg     = c->default_bg;
+        c->tag.styles = 0;
+        if (c->default_fg || c->default_bg) reapply_state(c);
         return;
     }
 
@@ -580,19 +984,19 @@ static void emit_close_tag(const char *tag, size_t len)
     /* [/gradient] or [/gradient ...] */
     if (len >= 8 && memcmp(tag, "gradient", 8) == 0 &&
         (len == 8 || tag[8] == ' ')) {
-        m_tag_state.styles &= ~STYLE_GRADIENT;
-        output_string(RESET);
-        reapply_state();
+        c->tag.styles &= ~STYLE_GRADIENT;
+        output_string(c, RESET);
+        reapply_state(c);
         return;
     }
 
     /* [/rainbow] */
     if (len == 7 && memcmp(tag, "rainbow", 7) == 0) {
-        m_tag_state.styles &= ~STYLE_RAINBOW;
-        m_rainbow_idx = 0;
-        m_rainbow_len = 0;
-        output_string(RESET);
-        reapply_state();
+        c->tag.styles &= ~STYLE_RAINBOW;
+        c->rainbow_idx = 0;
+        c->rainbow_len = 0;
+        output_string(c, RESET);
+        reapply_state(c);
         return;
     }
 #endif
@@ -616,63 +1020,59 @@ static void emit_close_tag(const char *tag, size_t len)
 
         const AttrEntry *a = lookup_attr(w, wl);
         if (a) {
-            if (a->style) m_tag_state.styles &= ~a->style;
-            else if (a->fg_code && a->fg_code == m_tag_state.fg_code) {
-                m_tag_state.fg_code = m_default_fg;
+            if (a->style) c->tag.styles &= ~a->style;
+            else if (a->code == c->tag.fg) {
+                c->tag.fg = c->default_fg;
             }
             continue;
         }
 
-        /* Numeric fg: fg:<num> — only clear if the built code matches current */
-        if (wl > 3 && memcmp(w, "fg:", 3) == 0 && m_tag_state.fg_code) {
+        /* Numeric fg: fg:<num> — only clear if the code matches current */
+        if (wl > 3 && memcmp(w, "fg:", 3) == 0 && c->tag.fg) {
             char *endptr;
             long val = strtol(w + 3, &endptr, 10);
             if (endptr != w + 3) {
                 int code = val < 0 ? 0 : val > 255 ? 255 : (int)val;
-                char tmp[16];
-                snprintf(tmp, sizeof(tmp), "\x1b[38;5;%dm", code);
-                if (strcmp(tmp, m_tag_state.fg_code) == 0)
-                    m_tag_state.fg_code = m_default_fg;
+                if ((CODE_INDEX | code) == c->tag.fg)
+                    c->tag.fg = c->default_fg;
             }
         }
     }
 
     /* Background: clear bg color only if the close tag names the active one */
-    if (bg && bg_len && m_tag_state.bg_code) {
+    if (bg && bg_len && c->tag.bg) {
         while (bg_len && isspace((unsigned char)*bg)) { bg++; bg_len--; }
         while (bg_len && isspace((unsigned char)bg[bg_len - 1])) bg_len--;
 
         const AttrEntry *a = lookup_attr(bg, bg_len);
-        if (a && !a->style && a->bg_code == m_tag_state.bg_code) {
-            m_tag_state.bg_code = m_default_bg;
+        if (a && !a->style && a->code == c->tag.bg) {
+            c->tag.bg = c->default_bg;
         } else if (bg_len > 3 && memcmp(bg, "bg:", 3) == 0) {
             char *endptr;
             long val = strtol(bg + 3, &endptr, 10);
             if (endptr != bg + 3) {
                 int code = val < 0 ? 0 : val > 255 ? 255 : (int)val;
-                char tmp[16];
-                snprintf(tmp, sizeof(tmp), "\x1b[48;5;%dm", code);
-                if (strcmp(tmp, m_tag_state.bg_code) == 0)
-                    m_tag_state.bg_code = m_default_bg;
+                if ((CODE_INDEX | code) == c->tag.bg)
+                    c->tag.bg = c->default_bg;
             }
         }
     }
 
-    output_string(RESET);
-    reapply_state();
+    output_string(c, RESET);
+    reapply_state(c);
 }
 
 /** Handle [tag]: apply fg/bg colors and styles, or delegate to close/gradient */
-static void emit_tag(const char *tag, size_t len)
+static void emit_tag(ansi_ctx_t *c, const char *tag, size_t len)
 {
-    if (!m_color_enabled || len == 0) return;
+    if (!c->color_enabled || len == 0) return;
 
-    if (tag[0] == '/') { emit_close_tag(tag + 1, len - 1); return; }
+    if (tag[0] == '/') { emit_close_tag(c, tag + 1, len - 1); return; }
 
 #if ANSI_PRINT_GRADIENTS
     /* [gradient color1 color2] - special prefix, not a regular attribute */
     if (len > 9 && memcmp(tag, "gradient ", 9) == 0) {
-        parse_gradient_tag(tag + 9, len - 9);
+        parse_gradient_tag(c, tag + 9, len - 9);
         return;
     }
 #endif
@@ -695,8 +1095,9 @@ static void emit_tag(const char *tag, size_t len)
 
         const AttrEntry *a = lookup_attr(w, wl);
         if (a) {
-            if (a->style) { output_string(a->fg_code); m_tag_state.styles |= a->style; }
-            else { output_string(a->fg_code); m_tag_state.fg_code = a->fg_code; }
+            output_code(c, a->code, 0);
+            if (a->style) c->tag.styles |= a->style;
+            else c->tag.fg = a->code;
             continue;
         }
 
@@ -706,8 +1107,8 @@ static void emit_tag(const char *tag, size_t len)
             long val = strtol(w + 3, &endptr, 10);
             if (endptr != w + 3) {
                 int code = val < 0 ? 0 : val > 255 ? 255 : (int)val;
-                snprintf(m_num_fg, sizeof(m_num_fg), "\x1b[38;5;%dm", code);
-                output_string(m_num_fg); m_tag_state.fg_code = m_num_fg;
+                c->tag.fg = (uint16_t)(CODE_INDEX | code);
+                output_code(c, c->tag.fg, 0);
             }
         }
     }
@@ -718,37 +1119,370 @@ static void emit_tag(const char *tag, size_t len)
         while (bg_len && isspace((unsigned char)bg[bg_len-1])) bg_len--;
 
         const AttrEntry *a = lookup_attr(bg, bg_len);
-        if (a && !a->style) { output_string(a->bg_code); m_tag_state.bg_code = a->bg_code; }
+        if (a && !a->style) { output_code(c, a->code, 1); c->tag.bg = a->code; }
         else if (bg_len > 3 && memcmp(bg, "bg:", 3) == 0) {
             char *endptr;
             long val = strtol(bg + 3, &endptr, 10);
             if (endptr != bg + 3) {
                 int code = val < 0 ? 0 : val > 255 ? 255 : (int)val;
-                snprintf(m_num_bg, sizeof(m_num_bg), "\x1b[48;5;%dm", code);
-                output_string(m_num_bg); m_tag_state.bg_code = m_num_bg;
+                c->tag.bg = (uint16_t)(CODE_INDEX | code);
+                output_code(c, c->tag.bg, 1);
+            }
+        }
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/* Formatter                                                                  */
+/* ------------------------------------------------------------------------- */
+
+#if ANSI_PRINT_FORMAT
+
+/* Conversion flags */
+#define FMT_LEFT   0x01   /* '-'   */
+#define FMT_ZERO   0x02   /* '0'   */
+#define FMT_PLUS   0x04   /* '+'   */
+#define FMT_SPACE  0x08   /* ' '   */
+
+#if ANSI_PRINT_FORMAT_LL
+typedef unsigned long long fmt_uint_t;
+#else
+typedef unsigned long      fmt_uint_t;
+#endif
+
+/* Bounded output: bytes past size - 1 are counted but not stored */
+typedef struct {
+    char  *buf;
+    size_t size;
+    size_t len;
+} fmt_out_t;
+
+static void fmt_putc(fmt_out_t *o, char ch)
+{
+    if (o->len + 1 < o->size) o->buf[o->len] = ch;
+    o->len++;
+}
+
+static void fmt_fill(fmt_out_t *o, char ch, int n)
+{
+    while (n-- > 0) fmt_putc(o, ch);
+}
+
+/** Emit one field, [sign][zeros]body, padded to @p width */
+static void fmt_field(fmt_out_t *o, int flags, int width, char sign,
+                      int zeros, const char *body, int len)
+{
+    int pad = width - len - zeros - (sign != 0);
+    if (!(flags & (FMT_LEFT | FMT_ZERO))) fmt_fill(o, ' ', pad);
+    if (sign) fmt_putc(o, sign);
+    if ((flags & (FMT_LEFT | FMT_ZERO)) == FMT_ZERO) fmt_fill(o, '0', pad);
+    fmt_fill(o, '0', zeros);
+    while (len-- > 0) fmt_putc(o, *body++);
+    if (flags & FMT_LEFT) fmt_fill(o, ' ', pad);
+}
+
+/** Write @p v in @p base backwards from @p end; returns the digit count */
+static int fmt_digits(char *end, fmt_uint_t v, unsigned base, const char *set)
+{
+    char *p = end;
+    do { *--p = set[v % base]; v /= base; } while (v);
+    return (int)(end - p);
+}
+
+#if ANSI_PRINT_FORMAT_FLOAT
+/** %f / %g in fixed notation (at most 9 decimals; %g trims zeros) */
+static void fmt_float(fmt_out_t *o, double v, int flags, int width,
+                      int prec, char conv)
+{
+    static const uint32_t pow10[10] = {
+        1u, 10u, 100u, 1000u, 10000u, 100000u,
+        1000000u, 10000000u, 100000000u, 1000000000u
+    };
+    char sign = 0;
+    if (v < 0)                   { sign = '-'; v = -v; }
+    else if (flags & FMT_PLUS)   sign = '+';
+    else if (flags & FMT_SPACE)  sign = ' ';
+
+    if (v != v || v > 1.8e19) {
+        fmt_field(o, flags & ~FMT_ZERO, width, sign, 0, v != v ? "nan" : "inf", 3);
+        return;
+    }
+
+    if (prec < 0) prec = 6;
+    int trim = (conv == 'g' || conv == 'G');
+    if (trim) {
+        /* Significant digits -> decimals after the point */
+        int exp10 = 0;
+        double t = v;
+        if (t > 0) {
+            while (t >= 10.0) { t /= 10.0; exp10++; }
+            while (t < 1.0)   { t *= 10.0; exp10--; }
+        }
+        prec = (prec ? prec : 1) - 1 - exp10;
+        if (prec < 0) prec = 0;
+    }
+    if (prec > 9) prec = 9;
+
+    uint32_t scale = pow10[prec];
+    v += 0.5 / scale;
+    unsigned long long ip = (unsigned long long)v;
+    uint32_t frac = (uint32_t)((v - (double)ip) * scale);
+
+    char tmp[32];
+    char *end = tmp + sizeof(tmp), *p = end;
+    for (int i = 0; i < prec; i++) { *--p = (char)('0' + frac % 10); frac /= 10; }
+    if (prec) *--p = '.';
+    do { *--p = (char)('0' + ip % 10); ip /= 10; } while (ip);
+
+    int len = (int)(end - p);
+    if (trim && prec) {
+        while (p[len - 1] == '0') len--;
+        if (p[len - 1] == '.') len--;
+    }
+    fmt_field(o, flags, width, sign, 0, p, len);
+}
+#endif
+
+/*
+ * ansi_vsnprintf() -- built-in replacement for vsnprintf().  One pass
+ * over the format; each conversion renders into a small stack buffer
+ * and fmt_field() pads it.  Output past size - 1 is counted, so the
+ * return value matches C99 for sizing.
+ */
+int ansi_vsnprintf(char *buf, size_t size, const char *fmt, va_list ap)
+{
+    fmt_out_t o = { buf, buf ? size : 0, 0 };
+    char tmp[32];
+    char *end = tmp + sizeof(tmp);
+
+    while (fmt && *fmt) {
+        if (*fmt != '%') { fmt_putc(&o, *fmt++); continue; }
+        const char *spec = fmt++;
+
+        int flags = 0;
+        for (;; fmt++) {
+            if      (*fmt == '-') flags |= FMT_LEFT;
+            else if (*fmt == '0') flags |= FMT_ZERO;
+            else if (*fmt == '+') flags |= FMT_PLUS;
+            else if (*fmt == ' ') flags |= FMT_SPACE;
+            else if (*fmt != '#') break;
+        }
+
+        int width = 0;
+        if (*fmt == '*') {
+            width = va_arg(ap, int);
+            if (width < 0) { flags |= FMT_LEFT; width = -width; }
+            fmt++;
+        } else {
+            while (*fmt >= '0' && *fmt <= '9') width = width * 10 + (*fmt++ - '0');
+        }
+
+        int prec = -1;
+        if (*fmt == '.') {
+            fmt++;
+            if (*fmt == '*') {
+                prec = va_arg(ap, int);
+                if (prec < 0) prec = -1;
+                fmt++;
+            } else {
+                prec = 0;
+                while (*fmt >= '0' && *fmt <= '9') prec = prec * 10 + (*fmt++ - '0');
             }
         }
+
+        /* Length: 0 int, 1 long, 2 long long, 3 size_t, 4 short, 5 char */
+        int lng = 0;
+        if (*fmt == 'h') { fmt++; lng = 4; if (*fmt == 'h') { fmt++; lng = 5; } }
+        else if (*fmt == 'l') {
+            fmt++; lng = 1;
+#if ANSI_PRINT_FORMAT_LL
+            if (*fmt == 'l') { fmt++; lng = 2; }
+#endif
+        }
+        else if (*fmt == 'z') { fmt++; lng = 3; }
+
+        char conv = *fmt;
+        if (!conv) break;
+        fmt++;
+
+        switch (conv) {
+        case 'd': case 'i': {
+            fmt_uint_t mag;
+            int neg;
+            if (lng == 1)      { long v = va_arg(ap, long);           neg = v < 0; mag = (fmt_uint_t)v; }
+#if ANSI_PRINT_FORMAT_LL
+            else if (lng == 2) { long long v = va_arg(ap, long long); neg = v < 0; mag = (fmt_uint_t)v; }
+#endif
+            else if (lng == 3) { mag = va_arg(ap, size_t); neg = 0; }
+            else {
+                int v = va_arg(ap, int);
+                if (lng == 4) v = (short)v;
+                if (lng == 5) v = (signed char)v;
+                neg = v < 0; mag = (fmt_uint_t)(long)v;
+            }
+            if (neg) mag = 0 - mag;
+            char sign = neg ? '-' : (flags & FMT_PLUS) ? '+' : (flags & FMT_SPACE) ? ' ' : 0;
+            int len = (prec == 0 && mag == 0) ? 0 : fmt_digits(end, mag, 10, "0123456789");
+            if (prec >= 0) flags &= ~FMT_ZERO;
+            fmt_field(&o, flags, width, sign, prec > len ? prec - len : 0, end - len, len);
+            break;
+        }
+        case 'u': case 'x': case 'X': case 'p': {
+            fmt_uint_t v;
+            if (conv == 'p')   v = (fmt_uint_t)(uintptr_t)va_arg(ap, void *);
+            else if (lng == 1) v = va_arg(ap, unsigned long);
+#if ANSI_PRINT_FORMAT_LL
+            else if (lng == 2) v = va_arg(ap, unsigned long long);
+#endif
+            else if (lng == 3) v = va_arg(ap, size_t);
+            else               v = va_arg(ap, unsigned);
+            if (lng == 4) v = (unsigned short)v;
+            if (lng == 5) v = (unsigned char)v;
+            int len = (prec == 0 && v == 0) ? 0
+                    : fmt_digits(end, v, conv == 'u' ? 10 : 16,
+                                 conv == 'X' ? "0123456789ABCDEF" : "0123456789abcdef");
+            if (conv == 'p') { end[-++len] = 'x'; end[-++len] = '0'; }
+            if (prec >= 0) flags &= ~FMT_ZERO;
+            fmt_field(&o, flags, width, 0, prec > len ? prec - len : 0, end - len, len);
+            break;
+        }
+        case 'c':
+            tmp[0] = (char)va_arg(ap, int);
+            fmt_field(&o, flags & ~FMT_ZERO, width, 0, 0, tmp, 1);
+            break;
+        case 's': {
+            const char *s = va_arg(ap, const char *);
+            if (!s) s = "(null)";
+            int len = 0;
+            while (s[len] && (prec < 0 || len < prec)) len++;
+            fmt_field(&o, flags & ~FMT_ZERO, width, 0, 0, s, len);
+            break;
+        }
+#if ANSI_PRINT_FORMAT_FLOAT
+        case 'f': case 'F': case 'g': case 'G':
+            fmt_float(&o, va_arg(ap, double), flags, width, prec, conv);
+            break;
+#endif
+        case '%':
+            fmt_putc(&o, '%');
+            break;
+        default:
+            /* Unsupported: copy the spec, consume nothing */
+            while (spec < fmt) fmt_putc(&o, *spec++);
+            break;
+        }
     }
+
+    if (o.size) o.buf[o.len < o.size ? o.len : o.size - 1] = '\0';
+    return (int)o.len;
+}
+
+#else
+
+int ansi_vsnprintf(char *buf, size_t size, const char *fmt, va_list ap)
+{
+    return vsnprintf(buf, size, fmt, ap);
+}
+
+#endif /* ANSI_PRINT_FORMAT */
+
+int ansi_snprintf(char *buf, size_t size, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    int n = ansi_vsnprintf(buf, size, fmt, ap);
+    va_end(ap);
+    return n;
 }
 
 /* ------------------------------------------------------------------------- */
 /* Public API                                                                 */
 /* ------------------------------------------------------------------------- */
 
-void ansi_init(ansi_putc_function putc_fn, ansi_flush_function flush_fn,
-               char *buf, size_t buf_size)
+void ansi_ctx_init(ansi_ctx_t *c, ansi_putc_function putc_fn,
+                   ansi_flush_function flush_fn, char *buf, size_t buf_size)
 {
-    m_putc_function  = putc_fn  ? putc_fn  : ansi_noop_putc;
-    m_flush_function = flush_fn ? flush_fn : ansi_noop_flush;
-    m_buf      = buf;
-    m_buf_size = buf_size;
-    m_color_enabled = 1;
-#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
-    m_no_color_lock = 0;
+    if (!c) return;
+    memset(c, 0, sizeof(*c));
+    c->putc_fn  = putc_fn  ? putc_fn  : ansi_noop_putc;
+    c->flush_fn = flush_fn ? flush_fn : ansi_noop_flush;
+    c->buf      = buf;
+    c->buf_size = buf_size;
+    c->color_enabled = 1;
+    c->rep           = ANSI_PRINT_REP_ON;
+    c->ech           = ANSI_PRINT_ECH_ON;
+    c->depth         = ANSI_DEPTH_TRUE;
+}
+
+ansi_ctx_t *ansi_default_ctx(void) { return &m_default_ctx; }
+
+void ansi_ctx_set_output(ansi_ctx_t *c, ansi_user_putc_function putc_fn,
+                         ansi_user_flush_function flush_fn, void *user)
+{
+    if (!c) return;
+    c->out_fn    = putc_fn;
+    c->out_flush = putc_fn ? flush_fn : NULL;
+    c->out_user  = putc_fn ? user : NULL;
+}
+
+unsigned long ansi_ctx_bytes(const ansi_ctx_t *c)
+{
+    return c ? c->out_bytes : 0;
+}
+
+void ansi_ctx_set_rep(ansi_ctx_t *c, int enable)
+{
+    if (!c) return;
+#if ANSI_PRINT_REP
+    if (c->rep && !enable) rep_break(c);
+    c->rep = enable ? 1 : 0;
+#else
+    (void)enable;
 #endif
 }
 
-void ansi_enable(void)
+void ansi_ctx_set_erase(ansi_ctx_t *c, int enable)
+{
+    if (!c) return;
+#if ANSI_PRINT_ECH
+    c->ech = enable ? 1 : 0;
+#else
+    (void)enable;
+#endif
+}
+
+void ansi_ctx_set_depth(ansi_ctx_t *c, int depth)
+{
+    if (!c) return;
+#if ANSI_PRINT_COLOR_DEPTH
+    c->depth = (uint8_t)(depth <= ANSI_DEPTH_16  ? ANSI_DEPTH_16
+                       : depth <= ANSI_DEPTH_256 ? ANSI_DEPTH_256 : ANSI_DEPTH_TRUE);
+#if ANSI_PRINT_SGR_CACHE > 0
+    memset(c->sgr_cache, 0, sizeof(c->sgr_cache));   /* resolved at the old depth */
+#endif
+#else
+    (void)depth;
+#endif
+}
+
+int ansi_ctx_depth(const ansi_ctx_t *c)
+{
+    return c ? c->depth : ANSI_DEPTH_TRUE;
+}
+
+#if ANSI_PRINT_COLOR_DEPTH && (defined(_WIN32) || defined(__unix__) || defined(__APPLE__))
+/** Color depth advertised by the environment, or 0 if it does not say. */
+static int env_color_depth(void)
+{
+    const char *ct = getenv("COLORTERM");
+    if (ct && (strstr(ct, "truecolor") || strstr(ct, "24bit"))) return ANSI_DEPTH_TRUE;
+    const char *term = getenv("TERM");
+    if (!term || !term[0]) return 0;
+    return strstr(term, "256") ? ANSI_DEPTH_256 : ANSI_DEPTH_16;
+}
+#endif
+
+void ansi_ctx_enable(ansi_ctx_t *c)
 {
 #ifdef _WIN32
     SetConsoleOutputCP(CP_UTF8);
@@ -761,136 +1495,141 @@ void ansi_enable(void)
     /* Respect the NO_COLOR convention (https://no-color.org/).
        Once set, ansi_set_enabled() and ansi_toggle() cannot re-enable color. */
     if (getenv("NO_COLOR") != NULL) {
-        m_color_enabled = 0;
-        m_no_color_lock = 1;
+        c->color_enabled = 0;
+        c->no_color_lock = 1;
         return;
     }
 
+#if ANSI_PRINT_COLOR_DEPTH
+    {
+        int depth = env_color_depth();
+        if (depth) ansi_ctx_set_depth(c, depth);
+    }
+#endif
+
     /* Disable color when stdout is not a terminal (e.g. piped to file) */
 #if defined(_WIN32)
-    m_color_enabled = _isatty(_fileno(stdout));
+    c->color_enabled = _isatty(_fileno(stdout));
 #else
-    m_color_enabled = isatty(fileno(stdout));
+    c->color_enabled = isatty(fileno(stdout));
 #endif
 #else
     /* Embedded/freestanding -- no env or tty detection available */
-    m_color_enabled = 1;
+    c->color_enabled = 1;
 #endif
 }
 
-void ansi_set_enabled(int enabled)
+void ansi_ctx_set_enabled(ansi_ctx_t *c, int enabled)
 {
-#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
-    if (!m_no_color_lock)
-#endif
-        m_color_enabled = enabled;
+    if (!c->no_color_lock)
+        c->color_enabled = enabled;
 }
 
-int ansi_is_enabled(void)
+int ansi_ctx_is_enabled(const ansi_ctx_t *c)
 {
-    return m_color_enabled;
+    return c->color_enabled;
 }
 
-void ansi_toggle(void)
+void ansi_ctx_toggle(ansi_ctx_t *c)
 {
-#if defined(_WIN32) || defined(__unix__) || defined(__APPLE__)
-    if (!m_no_color_lock)
-#endif
-        m_color_enabled = !m_color_enabled;
+    if (!c->no_color_lock)
+        c->color_enabled = !c->color_enabled;
 }
 
-void ansi_set_fg(const char *color)
+void ansi_ctx_set_fg(ansi_ctx_t *c, const char *color)
 {
     if (!color) {
-        m_default_fg = NULL;
+        c->default_fg = CODE_NONE;
         return;
     }
     const AttrEntry *a = lookup_attr(color, strlen(color));
-    if (a && !a->style && a->fg_code) {
-        m_default_fg = a->fg_code;
-        m_tag_state.fg_code = a->fg_code;
-        if (m_color_enabled) output_string(a->fg_code);
+    if (a && !a->style) {
+        c->default_fg = a->code;
+        c->tag.fg     = a->code;
+        if (c->color_enabled) output_code(c, a->code, 0);
     }
 }
 
-void ansi_set_bg(const char *color)
+void ansi_ctx_set_bg(ansi_ctx_t *c, const char *color)
 {
     if (!color) {
-        m_default_bg = NULL;
+        c->default_bg = CODE_NONE;
         return;
     }
     const AttrEntry *a = lookup_attr(color, strlen(color));
-    if (a && !a->style && a->bg_code) {
-        m_default_bg = a->bg_code;
-        m_tag_state.bg_code = a->bg_code;
-        if (m_color_enabled) output_string(a->bg_code);
+    if (a && !a->style) {
+        c->default_bg = a->code;
+        c->tag.bg     = a->code;
+        if (c->color_enabled) output_code(c, a->code, 1);
     }
 }
 
 #if ANSI_PRINT_GRADIENTS
 /** Emit per-character gradient or rainbow color code (call before each visible char) */
-static void emit_char_color(void)
+static void emit_char_color(ansi_ctx_t *c)
 {
-    if ((m_tag_state.styles & STYLE_GRADIENT) && m_color_enabled) {
-        int i = m_gradient.idx;
-        int n = m_gradient.len > 1 ? m_gradient.len - 1 : 1;
+    if ((c->tag.styles & STYLE_GRADIENT) && c->color_enabled) {
+        int i = c->gradient.idx;
+        int n = c->gradient.len > 1 ? c->gradient.len - 1 : 1;
         if (i > n) i = n;
-        int r = (int)m_gradient.start.r + ((int)m_gradient.end.r - (int)m_gradient.start.r) * i / n;
-        int g = (int)m_gradient.start.g + ((int)m_gradient.end.g - (int)m_gradient.start.g) * i / n;
-        int b = (int)m_gradient.start.b + ((int)m_gradient.end.b - (int)m_gradient.start.b) * i / n;
+        int r = (int)c->gradient.start.r + ((int)c->gradient.end.r - (int)c->gradient.start.r) * i / n;
+        int g = (int)c->gradient.start.g + ((int)c->gradient.end.g - (int)c->gradient.start.g) * i / n;
+        int b = (int)c->gradient.start.b + ((int)c->gradient.end.b - (int)c->gradient.start.b) * i / n;
+#if ANSI_PRINT_COLOR_DEPTH
+        output_rgb(c, r, g, b, 0);
+#else
         char buf[24];
-        snprintf(buf, sizeof(buf), "\x1b[38;2;%d;%d;%dm", r, g, b);
-        output_string(buf);
-        m_gradient.idx++;
-    } else if ((m_tag_state.styles & STYLE_RAINBOW) && m_color_enabled) {
-        int pos = m_rainbow_idx * (int)(RAINBOW_LEN - 1) /
-                  (m_rainbow_len > 1 ? m_rainbow_len - 1 : 1);
+        ansi_snprintf(buf, sizeof(buf), "\x1b[38;2;%d;%d;%dm", r, g, b);
+        output_string(c, buf);
+#endif
+        c->gradient.idx++;
+    } else if ((c->tag.styles & STYLE_RAINBOW) && c->color_enabled) {
+        int pos = c->rainbow_idx * (int)(RAINBOW_LEN - 1) /
+                  (c->rainbow_len > 1 ? c->rainbow_len - 1 : 1);
         if (pos > (int)(RAINBOW_LEN - 1)) pos = (int)(RAINBOW_LEN - 1);
-        char buf[16];
-        snprintf(buf, sizeof(buf), "\x1b[38;5;%dm", RAINBOW[pos]);
-        output_string(buf);
-        m_rainbow_idx++;
+        output_code(c, CODE_INDEX | RAINBOW[pos], 0);
+        c->rainbow_idx++;
     }
 }
 #else
-static void emit_char_color(void) { }
+static void emit_char_color(ansi_ctx_t *c) { (void)c; }
 #endif /* ANSI_PRINT_GRADIENTS */
 
 #if ANSI_PRINT_UNICODE
 /** Encode a Unicode codepoint as UTF-8 and emit via putc function */
-static void emit_unicode_codepoint(uint32_t cp)
+static void emit_unicode_codepoint(ansi_ctx_t *c, uint32_t cp)
 {
     if (cp <= 0x7F) {
-        m_putc_function((int)cp);
+        ctx_putc(c, (int)cp);
     } else if (cp <= 0x7FF) {
-        m_putc_function((int)(0xC0 | (cp >> 6)));
-        m_putc_function((int)(0x80 | (cp & 0x3F)));
+        ctx_putc(c, (int)(0xC0 | (cp >> 6)));
+        ctx_putc(c, (int)(0x80 | (cp & 0x3F)));
     } else if (cp <= 0xFFFF) {
-        m_putc_function((int)(0xE0 | (cp >> 12)));
-        m_putc_function((int)(0x80 | ((cp >> 6) & 0x3F)));
-        m_putc_function((int)(0x80 | (cp & 0x3F)));
+        ctx_putc(c, (int)(0xE0 | (cp >> 12)));
+        ctx_putc(c, (int)(0x80 | ((cp >> 6) & 0x3F)));
+        ctx_putc(c, (int)(0x80 | (cp & 0x3F)));
     } else if (cp <= 0x10FFFF) {
-        m_putc_function((int)(0xF0 | (cp >> 18)));
-        m_putc_function((int)(0x80 | ((cp >> 12) & 0x3F)));
-        m_putc_function((int)(0x80 | ((cp >> 6) & 0x3F)));
-        m_putc_function((int)(0x80 | (cp & 0x3F)));
+        ctx_putc(c, (int)(0xF0 | (cp >> 18)));
+        ctx_putc(c, (int)(0x80 | ((cp >> 12) & 0x3F)));
+        ctx_putc(c, (int)(0x80 | ((cp >> 6) & 0x3F)));
+        ctx_putc(c, (int)(0x80 | (cp & 0x3F)));
     }
 }
 
 #endif /* ANSI_PRINT_UNICODE */
 
 /** Core markup renderer: tokenize Rich-style text and emit with ANSI codes */
-static void ansi_emit(const char *p)
+static void ansi_emit(ansi_ctx_t *c, const char *p)
 {
     if (!p) return;
-    m_tag_state.fg_code = NULL;
-    m_tag_state.bg_code = NULL;
-    m_tag_state.styles  = 0;
+    c->tag.fg     = CODE_NONE;
+    c->tag.bg     = CODE_NONE;
+    c->tag.styles = 0;
 #if ANSI_PRINT_GRADIENTS
-    m_rainbow_idx = 0;
-    m_rainbow_len = 0;
-    m_gradient.len = 0;
-    m_gradient.idx = 0;
+    c->rainbow_idx = 0;
+    c->rainbow_len = 0;
+    c->gradient.len = 0;
+    c->gradient.idx = 0;
 #endif
 
     MarkupToken tok;
@@ -899,96 +1638,232 @@ static void ansi_emit(const char *p)
         /* Always-on: literal escapes and plain characters */
         case TOK_ESC_BRACKET:
         case TOK_ESC_COLON:
-            m_putc_function(tok.val.ch);
+            ctx_putc(c, tok.val.ch);
             break;
         case TOK_TAG:
-            emit_tag(tok.ptr, tok.len);
+            emit_tag(c, tok.ptr, tok.len);
 #if ANSI_PRINT_GRADIENTS
-            if ((m_tag_state.styles & STYLE_GRADIENT) && m_gradient.len == 0)
-                m_gradient.len = count_effect_chars(p, "gradient", 8);
-            if ((m_tag_state.styles & STYLE_RAINBOW) && m_rainbow_len == 0)
-                m_rainbow_len = count_effect_chars(p, "rainbow", 7);
+            if ((c->tag.styles & STYLE_GRADIENT) && c->gradient.len == 0)
+                c->gradient.len = count_effect_chars(p, "gradient", 8);
+            if ((c->tag.styles & STYLE_RAINBOW) && c->rainbow_len == 0)
+                c->rainbow_len = count_effect_chars(p, "rainbow", 7);
 #endif
             break;
         case TOK_CHAR:
             if (tok.val.ch != ' ' && tok.val.ch != '\t' && tok.val.ch != '\n')
-                emit_char_color();
-            emit_token_bytes(&tok);
+                emit_char_color(c);
+            emit_token_bytes(c, &tok);
             break;
         /* Feature-gated: only emitted when the corresponding flag is on */
 #if ANSI_PRINT_EMOJI
         case TOK_EMOJI:
-            emit_char_color();
-            output_string(tok.val.emoji);
+            emit_char_color(c);
+            output_string(c, tok.val.emoji);
             break;
 #endif
 #if ANSI_PRINT_UNICODE
         case TOK_UNICODE:
-            emit_char_color();
-            emit_unicode_codepoint(tok.val.codepoint);
+            emit_char_color(c);
+            emit_unicode_codepoint(c, tok.val.codepoint);
             break;
 #endif
         default: break;
         }
     }
 
-    if (m_color_enabled && (m_tag_state.fg_code||m_tag_state.bg_code||m_tag_state.styles))
-        output_string(RESET);
+    if (c->color_enabled && (c->tag.fg || c->tag.bg || c->tag.styles))
+        output_string(c, RESET);
 
-    m_flush_function();
+    output_flush(c);
 }
 
 /** Emit a pre-built markup string (no formatting) */
-void ansi_puts(const char *s) { ansi_emit(s); }
+void ansi_ctx_puts(ansi_ctx_t *c, const char *s) { ansi_emit(c, s); }
+
+void ansi_ctx_batch_begin(ansi_ctx_t *c)
+{
+    c->batch_depth++;
+}
+
+void ansi_ctx_batch_end(ansi_ctx_t *c)
+{
+    if (c->batch_depth == 0) return;
+    if (--c->batch_depth == 0) ctx_flush(c);
+}
+
+void ansi_ctx_write(ansi_ctx_t *c, const char *s, size_t n)
+{
+    if (!s) return;
+    output_bytes(c, s, n);
+    output_flush(c);
+}
+
+int ansi_ctx_blank(ansi_ctx_t *c, int n, int advance)
+{
+    if (!c || n <= 0) return 0;
+#if ANSI_PRINT_ECH
+    if (c->ech) {
+        char seq[24];
+        int len = advance ? ansi_snprintf(seq, sizeof(seq), "\x1b[%dX\x1b[%dC", n, n)
+                          : ansi_snprintf(seq, sizeof(seq), "\x1b[%dX", n);
+        if (len > 0 && len < n) {
+            ansi_ctx_write(c, seq, (size_t)len);
+            return advance ? n : 0;
+        }
+    }
+#else
+    (void)advance;
+#endif
+    for (int i = 0; i < n; i++) ctx_putc(c, ' ');
+    output_flush(c);
+    return n;
+}
+
+/** Resolve a tag body to SGR bytes by running the tag emitter on a
+ *  scratch context whose output is captured into @p buf, so the result
+ *  matches what ansi_print() would emit exactly.  No caller-visible
+ *  context is touched. */
+static const char *ctx_sgr(int depth, char *buf, size_t buf_size, const char *tag)
+{
+    if (!buf || !buf_size) return "";
+    buf[0] = '\0';
+    if (!tag || !tag[0]) return buf;
+
+    ansi_ctx_t tmp;
+    ansi_ctx_init(&tmp, NULL, NULL, NULL, 0);
+    tmp.depth     = (uint8_t)depth;
+    tmp.sink      = buf;
+    tmp.sink_room = buf_size;
+    emit_tag(&tmp, tag, strlen(tag));
+    *tmp.sink = '\0';
+    return buf;
+}
+
+const char *ansi_sgr(char *buf, size_t buf_size, const char *tag)
+{
+    return ctx_sgr(ANSI_DEPTH_TRUE, buf, buf_size, tag);
+}
+
+const char *ansi_ctx_color(ansi_ctx_t *c, char *scratch, const char *color)
+{
+    if (!color || !color[0] || !c->color_enabled) return "";
+#if ANSI_PRINT_SGR_CACHE > 0
+    for (int i = 0; i < ANSI_PRINT_SGR_CACHE; i++)
+        if (strcmp(c->sgr_cache[i].name, color) == 0)
+            return c->sgr_cache[i].sgr;
+    if (strlen(color) < ANSI_PRINT_SGR_MAX) {
+        int slot = c->sgr_next;
+        c->sgr_next = (slot + 1) % ANSI_PRINT_SGR_CACHE;
+        strcpy(c->sgr_cache[slot].name, color);
+        return ctx_sgr(c->depth, c->sgr_cache[slot].sgr,
+                       sizeof(c->sgr_cache[slot].sgr), color);
+    }
+#endif
+    return ctx_sgr(c->depth, scratch, ANSI_PRINT_SGR_MAX, color);
+}
+
+/** Printf into the context buffer via va_list, return pointer (NULL on error) */
+static const char *ansi_vformat(ansi_ctx_t *c, const char *fmt, va_list ap)
+{
+    if (!fmt || !c->buf || !c->buf_size) return NULL;
+    ansi_vsnprintf(c->buf, c->buf_size, fmt, ap);
+    return c->buf;
+}
+
+/** Access the context's format buffer */
+char *ansi_ctx_get_buf(ansi_ctx_t *c, size_t *out_size)
+{
+    if (out_size) *out_size = c->buf_size;
+    return c->buf;
+}
+
+/** Printf into the context buffer and return pointer — does not emit */
+const char *ansi_ctx_format(ansi_ctx_t *c, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    const char *result = ansi_vformat(c, fmt, ap);
+    va_end(ap);
+    return result;
+}
+
+/** Printf into the context buffer, then emit with markup processing */
+void ansi_ctx_print(ansi_ctx_t *c, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    const char *result = ansi_vformat(c, fmt, ap);
+    va_end(ap);
+    ansi_emit(c, result);
+}
+
+/** va_list variant of ansi_ctx_print — format and emit with markup processing */
+void ansi_ctx_vprint(ansi_ctx_t *c, const char *fmt, va_list ap)
+{
+    ansi_emit(c, ansi_vformat(c, fmt, ap));
+}
 
-/** Printf into shared buffer via va_list, return pointer (NULL on error) */
-static const char *ansi_vformat(const char *fmt, va_list ap)
+/* ------------------------------------------------------------------------- */
+/* Default-context API                                                        */
+/* ------------------------------------------------------------------------- */
+
+void ansi_init(ansi_putc_function putc_fn, ansi_flush_function flush_fn,
+               char *buf, size_t buf_size)
+{
+    ansi_ctx_init(&m_default_ctx, putc_fn, flush_fn, buf, buf_size);
+}
+
+void ansi_enable(void)               { ansi_ctx_enable(&m_default_ctx); }
+void ansi_set_enabled(int enabled)   { ansi_ctx_set_enabled(&m_default_ctx, enabled); }
+void ansi_set_rep(int enable)        { ansi_ctx_set_rep(&m_default_ctx, enable); }
+void ansi_set_erase(int enable)      { ansi_ctx_set_erase(&m_default_ctx, enable); }
+void ansi_set_depth(int depth)       { ansi_ctx_set_depth(&m_default_ctx, depth); }
+int  ansi_is_enabled(void)           { return m_default_ctx.color_enabled; }
+void ansi_toggle(void)               { ansi_ctx_toggle(&m_default_ctx); }
+void ansi_set_fg(const char *color)  { ansi_ctx_set_fg(&m_default_ctx, color); }
+void ansi_set_bg(const char *color)  { ansi_ctx_set_bg(&m_default_ctx, color); }
+void ansi_puts(const char *s)        { ansi_emit(&m_default_ctx, s); }
+void ansi_batch_begin(void)          { ansi_ctx_batch_begin(&m_default_ctx); }
+void ansi_batch_end(void)            { ansi_ctx_batch_end(&m_default_ctx); }
+
+void ansi_write(const char *s, size_t n)
 {
-    if (!fmt || !m_buf || !m_buf_size) return NULL;
-    vsnprintf(m_buf, m_buf_size, fmt, ap);
-    return m_buf;
+    ansi_ctx_write(&m_default_ctx, s, n);
 }
 
-/** Access the shared format buffer */
 char *ansi_get_buf(size_t *out_size)
 {
-    if (out_size) *out_size = m_buf_size;
-    return m_buf;
+    return ansi_ctx_get_buf(&m_default_ctx, out_size);
 }
 
-/** Printf into shared buffer and return pointer — does not emit */
 const char *ansi_format(const char *fmt, ...)
 {
     va_list ap;
     va_start(ap, fmt);
-    const char *result = ansi_vformat(fmt, ap);
+    const char *result = ansi_vformat(&m_default_ctx, fmt, ap);
     va_end(ap);
     return result;
 }
 
-/** Printf into shared buffer, then emit with markup processing */
 void ansi_print(const char *fmt, ...)
 {
     va_list ap;
     va_start(ap, fmt);
-    const char *result = ansi_vformat(fmt, ap);
+    const char *result = ansi_vformat(&m_default_ctx, fmt, ap);
     va_end(ap);
-    ansi_emit(result);
+    ansi_emit(&m_default_ctx, result);
 }
 
-/** va_list variant of ansi_print — format and emit with markup processing */
 void ansi_vprint(const char *fmt, va_list ap)
 {
-    ansi_emit(ansi_vformat(fmt, ap));
+    ansi_ctx_vprint(&m_default_ctx, fmt, ap);
 }
 
 /* ------------------------------------------------------------------------- */
 /* Shared markup-aware visible-character counting and emission               */
-/* Used by both banner and window functions.                                 */
+/* Used by banner, window, and the TUI layer (via ansi_visible_width).       */
 /* ------------------------------------------------------------------------- */
 
-#if ANSI_PRINT_BANNER || ANSI_PRINT_WINDOW
-
 /** Count visible characters in Rich markup text (tags are zero-width,
     emoji use their declared display width). */
 static int markup_count_visible(const char *p)
@@ -1007,19 +1882,26 @@ static int markup_count_visible(const char *p)
     return count;
 }
 
+int ansi_visible_width(const char *s)
+{
+    return s ? markup_count_visible(s) : 0;
+}
+
+#if ANSI_PRINT_BANNER || ANSI_PRINT_WINDOW
+
 /** Emit Rich markup text, stopping after max_vis visible characters.
     Resets tag state before and after. Does NOT call flush. */
-static void markup_emit_text(const char *p, int max_vis)
+static void markup_emit_text(ansi_ctx_t *c, const char *p, int max_vis)
 {
     int vis = 0;
-    m_tag_state.fg_code = NULL;
-    m_tag_state.bg_code = NULL;
-    m_tag_state.styles  = 0;
+    c->tag.fg     = CODE_NONE;
+    c->tag.bg     = CODE_NONE;
+    c->tag.styles = 0;
 #if ANSI_PRINT_GRADIENTS
-    m_rainbow_idx  = 0;
-    m_rainbow_len  = 0;
-    m_gradient.len = 0;
-    m_gradient.idx = 0;
+    c->rainbow_idx  = 0;
+    c->rainbow_len  = 0;
+    c->gradient.len = 0;
+    c->gradient.idx = 0;
 #endif
 
     MarkupToken tok;
@@ -1028,36 +1910,36 @@ static void markup_emit_text(const char *p, int max_vis)
         /* Always-on: literal escapes and plain characters */
         case TOK_ESC_BRACKET:
         case TOK_ESC_COLON:
-            m_putc_function(tok.val.ch);
+            ctx_putc(c, tok.val.ch);
             vis++;
             break;
         case TOK_TAG:
-            emit_tag(tok.ptr, tok.len);
+            emit_tag(c, tok.ptr, tok.len);
 #if ANSI_PRINT_GRADIENTS
-            if ((m_tag_state.styles & STYLE_GRADIENT) && m_gradient.len == 0)
-                m_gradient.len = count_effect_chars(p, "gradient", 8);
-            if ((m_tag_state.styles & STYLE_RAINBOW) && m_rainbow_len == 0)
-                m_rainbow_len = count_effect_chars(p, "rainbow", 7);
+            if ((c->tag.styles & STYLE_GRADIENT) && c->gradient.len == 0)
+                c->gradient.len = count_effect_chars(p, "gradient", 8);
+            if ((c->tag.styles & STYLE_RAINBOW) && c->rainbow_len == 0)
+                c->rainbow_len = count_effect_chars(p, "rainbow", 7);
 #endif
             break;
         case TOK_CHAR:
             if (tok.val.ch != ' ' && tok.val.ch != '\t' && tok.val.ch != '\n')
-                emit_char_color();
-            emit_token_bytes(&tok);
+                emit_char_color(c);
+            emit_token_bytes(c, &tok);
             vis++;
             break;
         /* Feature-gated: only emitted when the corresponding flag is on */
 #if ANSI_PRINT_EMOJI
         case TOK_EMOJI:
-            emit_char_color();
-            output_string(tok.val.emoji);
+            emit_char_color(c);
+            output_string(c, tok.val.emoji);
             vis += tok.emoji_width;
             break;
 #endif
 #if ANSI_PRINT_UNICODE
         case TOK_UNICODE:
-            emit_char_color();
-            emit_unicode_codepoint(tok.val.codepoint);
+            emit_char_color(c);
+            emit_unicode_codepoint(c, tok.val.codepoint);
             vis++;
             break;
 #endif
@@ -1065,31 +1947,39 @@ static void markup_emit_text(const char *p, int max_vis)
         }
     }
 
-    if (m_color_enabled &&
-        (m_tag_state.fg_code || m_tag_state.bg_code || m_tag_state.styles))
-        output_string(RESET);
+    if (c->color_enabled &&
+        (c->tag.fg || c->tag.bg || c->tag.styles))
+        output_string(c, RESET);
+}
+
+/** Emit a horizontal border row (corner, n rules, corner) inside one
+    BOX_IN/BOX_OUT bracket. */
+static void box_rule(ansi_ctx_t *c, const char *left, int n, const char *right)
+{
+    output_string(c, BOX_IN);
+    output_string(c, left);
+    for (int i = 0; i < n; i++) output_string(c, BOX_HORZ);
+    output_string(c, right);
+    output_string(c, BOX_OUT);
 }
 
 #endif /* ANSI_PRINT_BANNER || ANSI_PRINT_WINDOW */
 
 #if ANSI_PRINT_BANNER
 
-void ansi_banner(const char *color, int width, ansi_align_t align,
-                 const char *fmt, ...)
+static void banner_v(ansi_ctx_t *c, const char *color, int width,
+                     ansi_align_t align, const char *fmt, va_list ap)
 {
-    if (!fmt || !m_buf || !m_buf_size) return;
+    if (!fmt || !c->buf || !c->buf_size) return;
 
     /* Format text into buffer */
-    va_list ap;
-    va_start(ap, fmt);
-    vsnprintf(m_buf, m_buf_size, fmt, ap);
-    va_end(ap);
+    ansi_vsnprintf(c->buf, c->buf_size, fmt, ap);
 
     /* Compute effective width: if 0, auto-size to longest line (visible chars).
        Uses markup-aware counting so emoji shortcodes are measured correctly. */
     if (width <= 0) {
         width = 0;
-        char *p = m_buf;
+        char *p = c->buf;
         while (*p) {
             char *eol = p;
             while (*eol && *eol != '\n') eol++;
@@ -1103,26 +1993,24 @@ void ansi_banner(const char *color, int width, ansi_align_t align,
     }
     if (width < 1) width = 1;
 
-    /* Resolve color name to ANSI foreground code */
-    const char *fg = NULL;
+    /* Resolve color name to its SGR code */
+    uint16_t fg = CODE_NONE;
     if (color) {
         const AttrEntry *a = lookup_attr(color, strlen(color));
-        if (a) fg = a->fg_code;
+        if (a) fg = a->code;
     }
 
-    if (fg && m_color_enabled) output_string(fg);
+    if (fg && c->color_enabled) output_code(c, fg, 0);
 
     /* Top border */
-    output_string(BOX_TOPLEFT);
-    for (int i = 0; i < width + 2; i++) output_string(BOX_HORZ);
-    output_string(BOX_TOPRIGHT);
-    m_putc_function('\n');
+    box_rule(c, BOX_TOPLEFT, width + 2, BOX_TOPRIGHT);
+    ctx_putc(c, '\n');
 
     /* Walk the buffer line-by-line (split on '\n'), emitting each
        as a bordered row:  ║ <pad> text <pad> ║
        Text is processed through the Rich markup parser so emoji
        shortcodes like :rocket: are expanded. */
-    char *p = m_buf;
+    char *p = c->buf;
     do {
         char *eol = p;
         while (*eol && *eol != '\n') eol++;
@@ -1131,8 +2019,8 @@ void ansi_banner(const char *color, int width, ansi_align_t align,
 
         int vis_len = markup_count_visible(p);
 
-        output_string(BOX_VERT);
-        m_putc_function(' ');
+        output_string(c, BOX_IN BOX_VERT BOX_OUT);
+        ctx_putc(c, ' ');
 
         /* Truncate line to box width, then compute alignment padding */
         int out = vis_len > width ? width : vis_len;
@@ -1142,28 +2030,44 @@ void ansi_banner(const char *color, int width, ansi_align_t align,
         else if (align == ANSI_ALIGN_RIGHT)  pad_left = pad;
         int pad_right = pad - pad_left;
 
-        for (int i = 0; i < pad_left; i++)  m_putc_function(' ');
-        markup_emit_text(p, out);
-        if (fg && m_color_enabled) output_string(fg);  /* restore border color */
-        for (int i = 0; i < pad_right; i++) m_putc_function(' ');
+        for (int i = 0; i < pad_left; i++)  ctx_putc(c, ' ');
+        markup_emit_text(c, p, out);
+        if (fg && c->color_enabled) output_code(c, fg, 0);  /* restore border color */
+        for (int i = 0; i < pad_right; i++) ctx_putc(c, ' ');
 
-        m_putc_function(' ');
-        output_string(BOX_VERT);
-        m_putc_function('\n');
+        ctx_putc(c, ' ');
+        output_string(c, BOX_IN BOX_VERT BOX_OUT);
+        ctx_putc(c, '\n');
 
         *eol = saved;                      /* restore original character */
         p = (saved == '\n') ? eol + 1 : eol;
     } while (*p);
 
     /* Bottom border */
-    output_string(BOX_BOTTOMLEFT);
-    for (int i = 0; i < width + 2; i++) output_string(BOX_HORZ);
-    output_string(BOX_BOTTOMRIGHT);
+    box_rule(c, BOX_BOTTOMLEFT, width + 2, BOX_BOTTOMRIGHT);
+
+    if (fg && c->color_enabled) output_string(c, RESET);
+    ctx_putc(c, '\n');
+
+    output_flush(c);
+}
 
-    if (fg && m_color_enabled) output_string(RESET);
-    m_putc_function('\n');
+void ansi_ctx_banner(ansi_ctx_t *c, const char *color, int width,
+                     ansi_align_t align, const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    banner_v(c, color, width, align, fmt, ap);
+    va_end(ap);
+}
 
-    m_flush_function();
+void ansi_banner(const char *color, int width, ansi_align_t align,
+                 const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    banner_v(&m_default_ctx, color, width, align, fmt, ap);
+    va_end(ap);
 }
 #endif /* ANSI_PRINT_BANNER */
 
@@ -1173,22 +2077,20 @@ void ansi_banner(const char *color, int width, ansi_align_t align,
 
 #if ANSI_PRINT_WINDOW
 
-static int         m_window_width = 0;
-static const char *m_window_fg    = NULL;  /* border color from start() */
 
-/** Resolve a color name to its ANSI foreground escape code (or NULL) */
-static const char *window_resolve_color(const char *color)
+/** Resolve a color name to its SGR code (or CODE_NONE) */
+static uint16_t window_resolve_color(const char *color)
 {
-    if (!color) return NULL;
+    if (!color) return CODE_NONE;
     const AttrEntry *a = lookup_attr(color, strlen(color));
-    return a ? a->fg_code : NULL;
+    return a ? a->code : CODE_NONE;
 }
 
 /* Emit one padded plain-text line between ║ borders (used for title) */
 /** Emit one padded plain-text line between box-drawing borders (for title) */
-static void window_emit_line(const char *text, int len, ansi_align_t align)
+static void window_emit_line(ansi_ctx_t *c, const char *text, int len, ansi_align_t align)
 {
-    int width     = m_window_width;
+    int width     = c->window_width;
     int emit_len  = len > width ? width : len;
     int total_pad = width - emit_len;
     int pad_left  = 0;
@@ -1196,57 +2098,51 @@ static void window_emit_line(const char *text, int len, ansi_align_t align)
     else if (align == ANSI_ALIGN_RIGHT)  pad_left = total_pad;
     int pad_right = total_pad - pad_left;
 
-    if (m_window_fg && m_color_enabled) output_string(m_window_fg);
-    output_string(BOX_VERT);
-    m_putc_function(' ');
-    for (int i = 0; i < pad_left; i++)  m_putc_function(' ');
-    for (int i = 0; i < emit_len; i++)  m_putc_function(text[i]);
-    for (int i = 0; i < pad_right; i++) m_putc_function(' ');
-    m_putc_function(' ');
-    output_string(BOX_VERT);
-    if (m_window_fg && m_color_enabled) output_string(RESET);
-    m_putc_function('\n');
+    if (c->window_fg && c->color_enabled) output_code(c, c->window_fg, 0);
+    output_string(c, BOX_IN BOX_VERT BOX_OUT);
+    ctx_putc(c, ' ');
+    for (int i = 0; i < pad_left; i++)  ctx_putc(c, ' ');
+    for (int i = 0; i < emit_len; i++)  ctx_putc(c, text[i]);
+    for (int i = 0; i < pad_right; i++) ctx_putc(c, ' ');
+    ctx_putc(c, ' ');
+    output_string(c, BOX_IN BOX_VERT BOX_OUT);
+    if (c->window_fg && c->color_enabled) output_string(c, RESET);
+    ctx_putc(c, '\n');
 }
 
-void ansi_window_start(const char *color, int width, ansi_align_t align,
-                       const char *title)
+void ansi_ctx_window_start(ansi_ctx_t *c, const char *color, int width,
+                           ansi_align_t align, const char *title)
 {
-    m_window_width = width < 1 ? 1 : width;
-    m_window_fg = window_resolve_color(color);
+    c->window_width = width < 1 ? 1 : width;
+    c->window_fg = window_resolve_color(color);
 
     /* Top border */
-    if (m_window_fg && m_color_enabled) output_string(m_window_fg);
-    output_string(BOX_TOPLEFT);
-    for (int i = 0; i < m_window_width + 2; i++) output_string(BOX_HORZ);
-    output_string(BOX_TOPRIGHT);
-    if (m_window_fg && m_color_enabled) output_string(RESET);
-    m_putc_function('\n');
+    if (c->window_fg && c->color_enabled) output_code(c, c->window_fg, 0);
+    box_rule(c, BOX_TOPLEFT, c->window_width + 2, BOX_TOPRIGHT);
+    if (c->window_fg && c->color_enabled) output_string(c, RESET);
+    ctx_putc(c, '\n');
 
     /* Title + separator (if title is non-NULL and non-empty) */
     if (title && *title) {
-        window_emit_line(title, (int)strlen(title), align);
+        window_emit_line(c, title, (int)strlen(title), align);
 
         /* Separator */
-        if (m_window_fg && m_color_enabled) output_string(m_window_fg);
-        output_string(BOX_MIDLEFT);
-        for (int i = 0; i < m_window_width + 2; i++) output_string(BOX_HORZ);
-        output_string(BOX_MIDRIGHT);
-        if (m_window_fg && m_color_enabled) output_string(RESET);
-        m_putc_function('\n');
+        if (c->window_fg && c->color_enabled) output_code(c, c->window_fg, 0);
+        box_rule(c, BOX_MIDLEFT, c->window_width + 2, BOX_MIDRIGHT);
+        if (c->window_fg && c->color_enabled) output_string(c, RESET);
+        ctx_putc(c, '\n');
     }
 }
 
-void ansi_window_line(ansi_align_t align, const char *fmt, ...)
+static void window_line_v(ansi_ctx_t *c, ansi_align_t align,
+                          const char *fmt, va_list ap)
 {
-    if (!fmt || !m_buf || !m_buf_size) return;
+    if (!fmt || !c->buf || !c->buf_size) return;
 
-    va_list ap;
-    va_start(ap, fmt);
-    vsnprintf(m_buf, m_buf_size, fmt, ap);
-    va_end(ap);
+    ansi_vsnprintf(c->buf, c->buf_size, fmt, ap);
 
-    int visible   = markup_count_visible(m_buf);
-    int width     = m_window_width;
+    int visible   = markup_count_visible(c->buf);
+    int width     = c->window_width;
     int emit_len  = visible > width ? width : visible;
     int total_pad = width - emit_len;
     int pad_left  = 0;
@@ -1255,26 +2151,35 @@ void ansi_window_line(ansi_align_t align, const char *fmt, ...)
     int pad_right = total_pad - pad_left;
 
     /* Left border in border color */
-    if (m_window_fg && m_color_enabled) output_string(m_window_fg);
-    output_string(BOX_VERT);
-    m_putc_function(' ');
-    if (m_window_fg && m_color_enabled) output_string(RESET);
+    if (c->window_fg && c->color_enabled) output_code(c, c->window_fg, 0);
+    output_string(c, BOX_IN BOX_VERT BOX_OUT);
+    ctx_putc(c, ' ');
+    if (c->window_fg && c->color_enabled) output_string(c, RESET);
 
     /* Left padding */
-    for (int i = 0; i < pad_left; i++) m_putc_function(' ');
+    for (int i = 0; i < pad_left; i++) ctx_putc(c, ' ');
 
     /* Text with Rich markup processing (truncated to window width) */
-    markup_emit_text(m_buf, emit_len);
+    markup_emit_text(c, c->buf, emit_len);
 
     /* Right padding */
-    for (int i = 0; i < pad_right; i++) m_putc_function(' ');
+    for (int i = 0; i < pad_right; i++) ctx_putc(c, ' ');
 
     /* Right border in border color */
-    if (m_window_fg && m_color_enabled) output_string(m_window_fg);
-    m_putc_function(' ');
-    output_string(BOX_VERT);
-    if (m_window_fg && m_color_enabled) output_string(RESET);
-    m_putc_function('\n');
+    if (c->window_fg && c->color_enabled) output_code(c, c->window_fg, 0);
+    ctx_putc(c, ' ');
+    output_string(c, BOX_IN BOX_VERT BOX_OUT);
+    if (c->window_fg && c->color_enabled) output_string(c, RESET);
+    ctx_putc(c, '\n');
+}
+
+void ansi_ctx_window_line(ansi_ctx_t *c, ansi_align_t align,
+                          const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    window_line_v(c, align, fmt, ap);
+    va_end(ap);
 }
 
 /**
@@ -1283,17 +2188,31 @@ void ansi_window_line(ansi_align_t align, const char *fmt, ...)
  * Emits the bottom border in the color set by ansi_window_start(),
  * then flushes output.
  */
-void ansi_window_end(void)
+void ansi_ctx_window_end(ansi_ctx_t *c)
+{
+    if (c->window_fg && c->color_enabled) output_code(c, c->window_fg, 0);
+    box_rule(c, BOX_BOTTOMLEFT, c->window_width + 2, BOX_BOTTOMRIGHT);
+    if (c->window_fg && c->color_enabled) output_string(c, RESET);
+    ctx_putc(c, '\n');
+    output_flush(c);
+}
+
+void ansi_window_start(const char *color, int width, ansi_align_t align,
+                       const char *title)
+{
+    ansi_ctx_window_start(&m_default_ctx, color, width, align, title);
+}
+
+void ansi_window_line(ansi_align_t align, const char *fmt, ...)
 {
-    if (m_window_fg && m_color_enabled) output_string(m_window_fg);
-    output_string(BOX_BOTTOMLEFT);
-    for (int i = 0; i < m_window_width + 2; i++) output_string(BOX_HORZ);
-    output_string(BOX_BOTTOMRIGHT);
-    if (m_window_fg && m_color_enabled) output_string(RESET);
-    m_putc_function('\n');
-    m_flush_function();
+    va_list ap;
+    va_start(ap, fmt);
+    window_line_v(&m_default_ctx, align, fmt, ap);
+    va_end(ap);
 }
 
+void ansi_window_end(void) { ansi_ctx_window_end(&m_default_ctx); }
+
 #endif /* ANSI_PRINT_WINDOW */
 
 /* ------------------------------------------------------------------------- */
@@ -1302,27 +2221,62 @@ void ansi_window_end(void)
 
 #if ANSI_PRINT_BAR
 
+#if ANSI_PRINT_FLOAT
 /*
- * ansi_bar() -- build a bar graph string into a caller-provided buffer.
- *
- * The buffer is passed directly rather than via an init function so that
- * multiple bars can coexist in the same printf argument list:
- *
- *   char b1[128], b2[128];
- *   ansi_print("CPU %s  MEM %s\n",
- *              ansi_bar(b1, sizeof(b1), "green", 15, ANSI_BAR_LIGHT, cpu, 0, 100),
- *              ansi_bar(b2, sizeof(b2), "cyan",  15, ANSI_BAR_LIGHT, mem, 0, 100));
- *
- * Each call writes to its own buffer, so there is no shared state and
- * no ordering dependency between argument evaluations.
+ * ansi_bar_eighths() -- quantize value/min/max to the fill the bar shows,
+ * in 1/8-cell units.  Two values that map to the same count render the
+ * same bar, which is what TUI widgets compare to skip redundant redraws.
  */
-const char *ansi_bar(char *buf, size_t buf_size,
-                     const char *color, int width, ansi_bar_track_t track,
-                     double value, double min, double max)
+int ansi_bar_eighths(int width, double value, double min, double max)
+{
+    if (width < 1) return 0;
+
+    /* Compute fill fraction, clamped to [0.0, 1.0] */
+    double fraction;
+    if (max == min) {
+        fraction = 1.0;           /* degenerate range -> full bar */
+    } else {
+        fraction = (value - min) / (max - min);
+    }
+    if (fraction < 0.0) fraction = 0.0;
+    if (fraction > 1.0) fraction = 1.0;
+
+    /* Convert fraction to 1/8-cell units */
+    return (int)(fraction * width * 8 + 0.5);
+}
+#endif
+
+/*
+ * ansi_bar_eighths_i32() -- integer ansi_bar_eighths().  The fill is
+ * num / den * width * 8 rounded half up, i.e. (2 * num * width * 8 + den)
+ * / (2 * den), exact in 64 bits for any int32_t range and sane width.
+ */
+int ansi_bar_eighths_i32(int width, int32_t value, int32_t min, int32_t max)
+{
+    if (width < 1) return 0;
+    if (max == min) return width * 8;   /* degenerate range -> full bar */
+
+    int64_t num = (int64_t)value - min;
+    int64_t den = (int64_t)max - min;
+    if (den < 0) { num = -num; den = -den; }   /* inverted range */
+    if (num < 0)   num = 0;
+    if (num > den) num = den;
+
+    return (int)((num * width * 16 + den) / (den * 2));
+}
+
+/*
+ * ansi_bar_span() -- render cells [first, first + count) of a bar whose
+ * fill is @p eighths.  ansi_bar() is the full-width case; TUI widgets use
+ * narrower spans to repaint only the cells around a moved fill boundary.
+ */
+const char *ansi_bar_span(char *buf, size_t buf_size,
+                          const char *color, ansi_bar_track_t track,
+                          int eighths, int first, int count)
 {
     /* Graceful fallback for NULL or tiny buffers */
     if (!buf || buf_size == 0) return "";
-    if (buf_size < 2) {
+    if (buf_size < 2 || count < 1 || first < 0) {
         buf[0] = '\0';
         return buf;
     }
@@ -1330,8 +2284,6 @@ const char *ansi_bar(char *buf, size_t buf_size,
     char *out = buf;
     char *end = buf + buf_size - 1;
 
-    if (width < 1) { buf[0] = '\0'; return buf; }
-
     /* Resolve track character -- default to space for unknown values */
     int tk_idx = (int)track;
     if (tk_idx < 0 || tk_idx >= (int)(sizeof(m_bar_track) / sizeof(m_bar_track[0])))
@@ -1339,20 +2291,14 @@ const char *ansi_bar(char *buf, size_t buf_size,
     const char *tk_str = m_bar_track[tk_idx].s;
     int         tk_len = m_bar_track[tk_idx].len;
 
-    /* Compute fill fraction, clamped to [0.0, 1.0] */
-    double fraction;
-    if (max == min) {
-        fraction = 1.0;           /* degenerate range -> full bar */
-    } else {
-        fraction = (value - min) / (max - min);
-    }
-    if (fraction < 0.0) fraction = 0.0;
-    if (fraction > 1.0) fraction = 1.0;
-
-    /* Convert fraction to 1/8-cell units */
-    int eighths     = (int)(fraction * width * 8 + 0.5);
+    /* Cells [first, filled_end) carry a block, the rest of the span is track */
+    if (eighths < 0) eighths = 0;
+#if ANSI_PRINT_BAR_ASCII
+    eighths = (eighths + 2) / 4 * 4;       /* nearest half cell */
+#endif
     int filled_cells = (eighths + 7) / 8;  /* ceil(eighths / 8) */
-    int empty        = width - filled_cells;
+    int filled_end   = filled_cells < first + count ? filled_cells : first + count;
+    int empty        = first + count - (filled_end > first ? filled_end : first);
 
     /* Resolve color name to tag string — only emit if both [color] and [/color]
        fit completely, so we never produce an incomplete tag like "[re" */
@@ -1360,7 +2306,7 @@ const char *ansi_bar(char *buf, size_t buf_size,
     size_t clen = 0;
     if (color) {
         const AttrEntry *a = lookup_attr(color, strlen(color));
-        if (a && a->fg_code) {
+        if (a && a->code) {
             clen = strlen(color);
             size_t need = (clen + 2) + (clen + 3);  /* [color] + [/color] */
             if (out + need <= end) {
@@ -1376,12 +2322,12 @@ const char *ansi_bar(char *buf, size_t buf_size,
        block-writing loops cannot consume space needed for it. */
     char *blk_end = has_color ? end - (ptrdiff_t)(clen + 3) : end;
 
-    /* Emit filled cells: consume eighths left-to-right, one cell at a time */
-    while (eighths > 0 && out + 3 <= blk_end) {
-        int fill = eighths >= 8 ? 8 : eighths;
-        memcpy(out, m_bar_block[fill], 3);
-        out += 3;
-        eighths -= fill;
+    /* Emit filled cells: each takes up to 8 eighths, left-to-right */
+    for (int i = first; i < filled_end && out + BAR_BLOCK_LEN <= blk_end; i++) {
+        int fill = eighths - i * 8;
+        if (fill > 8) fill = 8;
+        memcpy(out, m_bar_block[fill], BAR_BLOCK_LEN);
+        out += BAR_BLOCK_LEN;
     }
 
     /* Close only the bar's own color, preserving any surrounding color state */
@@ -1401,21 +2347,63 @@ const char *ansi_bar(char *buf, size_t buf_size,
     return buf;
 }
 
+#if ANSI_PRINT_FLOAT
+/*
+ * ansi_bar() -- build a bar graph string into a caller-provided buffer.
+ *
+ * The buffer is passed directly rather than via an init function so that
+ * multiple bars can coexist in the same printf argument list:
+ *
+ *   char b1[128], b2[128];
+ *   ansi_print("CPU %s  MEM %s\n",
+ *              ansi_bar(b1, sizeof(b1), "green", 15, ANSI_BAR_LIGHT, cpu, 0, 100),
+ *              ansi_bar(b2, sizeof(b2), "cyan",  15, ANSI_BAR_LIGHT, mem, 0, 100));
+ *
+ * Each call writes to its own buffer, so there is no shared state and
+ * no ordering dependency between argument evaluations.
+ */
+const char *ansi_bar(char *buf, size_t buf_size,
+                     const char *color, int width, ansi_bar_track_t track,
+                     double value, double min, double max)
+{
+    if (width < 1) {
+        if (!buf || buf_size == 0) return "";
+        buf[0] = '\0';
+        return buf;
+    }
+    return ansi_bar_span(buf, buf_size, color, track,
+                         ansi_bar_eighths(width, value, min, max), 0, width);
+}
+#endif
+
+const char *ansi_bar_i32(char *buf, size_t buf_size,
+                         const char *color, int width, ansi_bar_track_t track,
+                         int32_t value, int32_t min, int32_t max)
+{
+    if (width < 1) {
+        if (!buf || buf_size == 0) return "";
+        buf[0] = '\0';
+        return buf;
+    }
+    return ansi_bar_span(buf, buf_size, color, track,
+                         ansi_bar_eighths_i32(width, value, min, max), 0, width);
+}
+
 /*
  * ansi_bar_percent() -- bar graph with " XX%" appended.
- * Range is always 0-100. Calls ansi_bar() then appends the clamped percent.
+ * Range is always 0-100. Calls ansi_bar_i32() then appends the clamped percent.
  */
 const char *ansi_bar_percent(char *buf, size_t buf_size,
                              const char *color, int width,
                              ansi_bar_track_t track, int percent)
 {
     int pct = percent < 0 ? 0 : percent > 100 ? 100 : percent;
-    ansi_bar(buf, buf_size, color, width, track, pct, 0, 100);
+    ansi_bar_i32(buf, buf_size, color, width, track, pct, 0, 100);
 
     /* Append " XX%" to the bar string */
     size_t len = strlen(buf);
     if (len < buf_size - 1) {
-        snprintf(buf + len, buf_size - len, " %d%%", pct);
+        ansi_snprintf(buf + len, buf_size - len, " %d%%", pct);
     }
     return buf;
 }
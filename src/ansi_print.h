@@ -17,7 +17,8 @@
  * - Runtime enable/disable of color output (emoji/unicode always emitted)
  * - Platform-independent output via injected function pointers
  * - No dynamic memory allocation (caller provides buffer for formatting)
- * - NOT THREAD SAFE (intended for single-threaded/cooperative use)
+ * - Reentrant via explicit ansi_ctx_t contexts (one per thread/port); the
+ *   classic ansi_* API shares a single default context
  *
  * @section compile_flags Compile-Time Feature Flags
  * All features default to enabled (1). Set to 0 via -D flags or app_cfg.h
@@ -35,6 +36,17 @@
  * | ANSI_PRINT_BANNER           | 1       | ansi_banner() boxed text output      |
  * | ANSI_PRINT_WINDOW           | 1       | ansi_window_start/line/end() streams |
  * | ANSI_PRINT_BAR              | 1       | ansi_bar() inline bar graphs         |
+ * | ANSI_PRINT_BAR_ASCII        | 0       | bars drawn with # = and 1/2 cells    |
+ * | ANSI_PRINT_FLOAT            | 1       | double bar/metric APIs (0 = integer) |
+ * | ANSI_PRINT_SGR_CACHE        | 8       | cached color SGR codes per context   |
+ * | ANSI_PRINT_REP              | 1       | REP (CSI n b) run compression        |
+ * | ANSI_PRINT_REP_ON           | 0       | contexts start with REP enabled      |
+ * | ANSI_PRINT_ECH              | 1       | ECH (CSI n X) blanking               |
+ * | ANSI_PRINT_ECH_ON           | 1       | contexts start with ECH enabled      |
+ * | ANSI_PRINT_COLOR_DEPTH      | 1       | downsample colors to 256 / 16        |
+ * | ANSI_PRINT_FORMAT           | 0       | built-in formatter, no vsnprintf()   |
+ * | ANSI_PRINT_FORMAT_FLOAT     | 1       | built-in %f / %g                     |
+ * | ANSI_PRINT_FORMAT_LL        | 0       | built-in ll length modifier          |
  *
  * @section setup Setup
  * @code
@@ -102,6 +114,27 @@
  *  enabled (1). Individual flags can still be set to 1 to selectively
  *  re-enable features in a minimal build. */
 #define ANSI_PRINT_MINIMAL
+/** @def ANSI_PRINT_ASCII
+ *  When defined, every glyph table defaults to a 7-bit variant: emoji
+ *  become 1-2 character tags (ANSI_EMOJI_FONT_ASCII), boxes are drawn
+ *  with + - | (ANSI_BOX_ASCII) and bars with # = (ANSI_PRINT_BAR_ASCII).
+ *  Output is then one byte per cell, for slow serial maintenance ports.
+ *  Widths are unchanged, so banners, windows and TUI layouts line up. */
+#define ANSI_PRINT_ASCII
+/** @def ANSI_PRINT_PUTC
+ *  Optional compile-time output sink, e.g. in app_cfg.h:
+ *  @code
+ *  #define ANSI_PRINT_PUTC(ch)  (UART0->DR = (uint8_t)(ch))
+ *  @endcode
+ *  When defined, every context writes through this macro instead of
+ *  calling the putc_fn given to ansi_init() / ansi_ctx_init() (which is
+ *  then ignored), so the store can be inlined into the output loops.
+ *  Callbacks installed with ansi_ctx_set_output() still take precedence. */
+#define ANSI_PRINT_PUTC(ch)
+/** @def ANSI_PRINT_WRITE
+ *  Optional bulk form of ANSI_PRINT_PUTC for a run of @p n bytes (FIFO
+ *  fill, DMA).  Defaults to ANSI_PRINT_PUTC() per byte. */
+#define ANSI_PRINT_WRITE(p, n)
 #endif
 
 #if !defined(ANSI_PRINT_NO_APP_CFG)
@@ -118,6 +151,26 @@
 #  define ANSI_PRINT_DEFAULT_  1
 #endif
 
+#ifdef ANSI_PRINT_ASCII
+#  define ANSI_PRINT_ASCII_    1
+#else
+#  define ANSI_PRINT_ASCII_    0
+#endif
+
+/** @def ANSI_BARRIER
+ *  Memory barrier used wherever one side publishes data that another
+ *  thread or an ISR reads: the seqlock of bound TUI values (tui_seq_begin())
+ *  and the ring sink's index hand-off.  Default: a full fence on GCC/Clang,
+ *  nothing elsewhere (enough for a single-core MCU where the other side is
+ *  an ISR).  Override it here, once, for a port. */
+#ifndef ANSI_BARRIER
+#  if defined(__GNUC__)
+#    define ANSI_BARRIER()  __sync_synchronize()
+#  else
+#    define ANSI_BARRIER()  ((void)0)
+#  endif
+#endif
+
 /** @def ANSI_PRINT_EMOJI
  *  Enable core emoji shortcodes (21 emoji). Default: 1 (0 if ANSI_PRINT_MINIMAL). */
 #ifndef ANSI_PRINT_EMOJI
@@ -133,12 +186,17 @@
 /** @def ANSI_PRINT_EMOJI_FONT
  *  Select emoji table variant.  Each variant may differ in display-width
  *  capitalization (uppercase first letter = 1 cell, lowercase = 2 cells).
- *  Default: ANSI_EMOJI_FONT_STD. */
+ *  Default: ANSI_EMOJI_FONT_STD (ANSI_EMOJI_FONT_ASCII if ANSI_PRINT_ASCII). */
 #define ANSI_EMOJI_FONT_STD     0   /**< Standard terminal emoji widths. */
-/* #define ANSI_EMOJI_FONT_xxx  1 */  /* add future font variants here */
+#define ANSI_EMOJI_FONT_ASCII   1   /**< 7-bit tags, e.g. :check: -> "+". */
+/* #define ANSI_EMOJI_FONT_xxx  2 */  /* add future font variants here */
 
 #ifndef ANSI_PRINT_EMOJI_FONT
-#  define ANSI_PRINT_EMOJI_FONT  ANSI_EMOJI_FONT_STD
+#  if ANSI_PRINT_ASCII_
+#    define ANSI_PRINT_EMOJI_FONT  ANSI_EMOJI_FONT_ASCII
+#  else
+#    define ANSI_PRINT_EMOJI_FONT  ANSI_EMOJI_FONT_STD
+#  endif
 #endif
 
 /** @def ANSI_PRINT_EXTENDED_COLORS
@@ -198,20 +256,141 @@
 #  define ANSI_PRINT_BAR              ANSI_PRINT_DEFAULT_
 #endif
 
+/** @def ANSI_PRINT_BAR_ASCII
+ *  Draw bars with 1-byte glyphs: '#' for a full cell, '=' for a half
+ *  cell, and ASCII tracks ('.' ':' '%' '-').  Fill resolution drops
+ *  from 1/8 to 1/2 cell; bar width is unchanged.
+ *  Default: 0 (1 if ANSI_PRINT_ASCII). */
+#ifndef ANSI_PRINT_BAR_ASCII
+#  define ANSI_PRINT_BAR_ASCII        ANSI_PRINT_ASCII_
+#endif
+
+/** @def ANSI_PRINT_FLOAT
+ *  Compile the double-precision bar APIs (ansi_bar(), ansi_bar_eighths()).
+ *  With 0, bars take int32_t values only (ansi_bar_i32()) and the TUI bar,
+ *  percent-bar and metric widgets store int32_t, so those paths pull in
+ *  no soft-float code on FPU-less targets.  Changes the TUI state and
+ *  descriptor layouts, so it must match between the library and the
+ *  application.  Default: 1. */
+#ifndef ANSI_PRINT_FLOAT
+#  define ANSI_PRINT_FLOAT            1
+#endif
+
 /** Box style constants for ANSI_PRINT_BOX_STYLE selection. */
 #define ANSI_BOX_LIGHT    0   /* ┌─┐│└─┘├┤  single line   */
 #define ANSI_BOX_HEAVY    1   /* ┏━┓┃┗━┛┣┫  thick line    */
 #define ANSI_BOX_DOUBLE   2   /* ╔═╗║╚═╝╠╣  double line   */
 #define ANSI_BOX_ROUNDED  3   /* ╭─╮│╰─╯├┤  rounded corner */
+#define ANSI_BOX_DEC      4   /* lqkxmjtu   DEC line drawing, 1 byte each */
+#define ANSI_BOX_ASCII    5   /* +-+|+-+++  plain ASCII, 1 byte each */
 
 /** @def ANSI_PRINT_BOX_STYLE
  *  Select the box-drawing character set used by ansi_banner() and
  *  ansi_window_*(). Set to one of ANSI_BOX_LIGHT, ANSI_BOX_HEAVY,
- *  ANSI_BOX_DOUBLE, or ANSI_BOX_ROUNDED. Default: ANSI_BOX_DOUBLE. */
+ *  ANSI_BOX_DOUBLE, ANSI_BOX_ROUNDED, ANSI_BOX_DEC or ANSI_BOX_ASCII.
+ *  ANSI_BOX_DEC draws single lines from the DEC Special Graphics set:
+ *  each border row is wrapped in one ESC(0 ... ESC(B switch and every
+ *  glyph is one ASCII byte instead of three UTF-8 bytes (for serial links
+ *  and terminals without UTF-8).  ANSI_BOX_ASCII uses + - | and needs no
+ *  charset switch at all.  Default: ANSI_BOX_DOUBLE (ANSI_BOX_ASCII if
+ *  ANSI_PRINT_ASCII). */
 #ifndef ANSI_PRINT_BOX_STYLE
-#  define ANSI_PRINT_BOX_STYLE        ANSI_BOX_DOUBLE
+#  if ANSI_PRINT_ASCII_
+#    define ANSI_PRINT_BOX_STYLE      ANSI_BOX_ASCII
+#  else
+#    define ANSI_PRINT_BOX_STYLE      ANSI_BOX_DOUBLE
+#  endif
+#endif
+
+/** @def ANSI_PRINT_SGR_CACHE
+ *  Number of color names per context whose SGR codes are cached by
+ *  ansi_ctx_color() after the first lookup (each slot costs 48 bytes of
+ *  RAM in every ansi_ctx_t).  0 resolves the name on every call.
+ *  Sizes ansi_ctx_t, so it is not tied to ANSI_PRINT_MINIMAL and must
+ *  match between the library and the application.  Default: 8. */
+#ifndef ANSI_PRINT_SGR_CACHE
+#  define ANSI_PRINT_SGR_CACHE        8
+#endif
+
+/** @def ANSI_PRINT_REP
+ *  Compile support for REP run compression (see ansi_ctx_set_rep()):
+ *  a run of one repeated glyph is sent as the glyph plus @c ESC[nb.
+ *  Default: 1 (0 if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_PRINT_REP
+#  define ANSI_PRINT_REP              ANSI_PRINT_DEFAULT_
+#endif
+
+/** @def ANSI_PRINT_REP_ON
+ *  Initial REP setting of every context, for builds that always talk to
+ *  a terminal known to support it.  Default: 0 (enable at run time). */
+#ifndef ANSI_PRINT_REP_ON
+#  define ANSI_PRINT_REP_ON           0
+#endif
+
+/** @def ANSI_PRINT_ECH
+ *  Compile support for blanking cells with ECH (@c ESC[nX) instead of
+ *  spaces (see ansi_ctx_blank()).  Default: 1 (0 if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_PRINT_ECH
+#  define ANSI_PRINT_ECH              ANSI_PRINT_DEFAULT_
+#endif
+
+/** @def ANSI_PRINT_ECH_ON
+ *  Initial ECH setting of every context.  ECH is VT220 and nearly
+ *  universal; set 0 for terminals that only understand cursor moves.
+ *  Default: 1. */
+#ifndef ANSI_PRINT_ECH_ON
+#  define ANSI_PRINT_ECH_ON           1
+#endif
+
+/** @def ANSI_PRINT_COLOR_DEPTH
+ *  Compile support for downsampling colors to what the terminal can show
+ *  (see ansi_ctx_set_depth()): truecolor gradients become 256-color or
+ *  16-color codes through a nearest-color lookup table (256 bytes).
+ *  Default: 1 (0 if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_PRINT_COLOR_DEPTH
+#  define ANSI_PRINT_COLOR_DEPTH      ANSI_PRINT_DEFAULT_
+#endif
+
+/** @def ANSI_PRINT_FORMAT
+ *  Format through the built-in ansi_vsnprintf() instead of the C
+ *  library's vsnprintf() on every internal path: ansi_print(), banners,
+ *  windows, TUI widgets and escape sequences.  Keeps printf (10-20 KB of
+ *  newlib) out of the link.  Supports %d %i %u %x %X %c %s %p %% with the
+ *  - 0 + space flags, width, precision, '*', and the h, l and z length
+ *  modifiers; any other conversion is copied to the output unchanged and
+ *  consumes no argument.  Default: 0 (use the C library). */
+#ifndef ANSI_PRINT_FORMAT
+#  define ANSI_PRINT_FORMAT           0
+#endif
+
+/** @def ANSI_PRINT_FORMAT_FLOAT
+ *  Built-in formatter only: support %f and %g.  Both print in fixed
+ *  notation with at most 9 decimals (%g drops trailing zeros but never
+ *  switches to exponent form); values beyond 1.8e19 print as "inf".
+ *  Default: ANSI_PRINT_FLOAT. */
+#ifndef ANSI_PRINT_FORMAT_FLOAT
+#  define ANSI_PRINT_FORMAT_FLOAT     ANSI_PRINT_FLOAT
+#endif
+
+/** @def ANSI_PRINT_FORMAT_LL
+ *  Built-in formatter only: support the ll length modifier.  Pulls in
+ *  64-bit division on 32-bit targets.  Default: 0. */
+#ifndef ANSI_PRINT_FORMAT_LL
+#  define ANSI_PRINT_FORMAT_LL        0
+#endif
+
+#if defined(ANSI_PRINT_WRITE) && !defined(ANSI_PRINT_PUTC)
+#  error "ANSI_PRINT_WRITE requires ANSI_PRINT_PUTC"
 #endif
 
+/** Color depths for ansi_ctx_set_depth() (bits per color). */
+#define ANSI_DEPTH_16     4    /* SGR 30-37 / 90-97 only          */
+#define ANSI_DEPTH_256    8    /* xterm 256-color palette          */
+#define ANSI_DEPTH_TRUE   24   /* 24-bit RGB (default)             */
+
+/** Longest color name (and resolved SGR sequence) ansi_ctx_color() caches. */
+#define ANSI_PRINT_SGR_MAX  24
+
 #include <stdarg.h>     // va_list
 #include <stddef.h>     // size_t
 #include <stdint.h>     // uint8_t
@@ -239,13 +418,96 @@ typedef void (*ansi_putc_function)(int ch);
  */
 typedef void (*ansi_flush_function)(void);
 
+/**
+ * @brief Output callbacks with a user pointer (see ansi_ctx_set_output()).
+ *
+ * Used when one function serves several contexts, e.g. one per file
+ * descriptor or per in-memory model.
+ */
+typedef void (*ansi_user_putc_function)(void *user, int ch);
+typedef void (*ansi_user_flush_function)(void *user);
+
+/** @brief 24-bit color triple (gradient endpoints). */
+typedef struct { uint8_t r, g, b; } ansi_rgb_t;
+
+/**
+ * @brief Renderer context: output functions, format buffer and markup state.
+ *
+ * Every output function runs against a context.  The classic API
+ * (ansi_init(), ansi_print(), ...) uses a built-in default context; the
+ * ansi_ctx_* variants take one explicitly, so independent outputs (a
+ * console UART and a debug UART, or one RTOS task per port) never share
+ * tag, color or buffer state.  A context is not locked internally: give
+ * each thread its own.
+ *
+ * Fields are private to ansi_print.c -- the struct is public only so
+ * contexts can be allocated statically.  Set up with ansi_ctx_init().
+ */
+typedef struct ansi_ctx {
+    /** @cond INTERNAL */
+    ansi_putc_function  putc_fn;
+    ansi_flush_function flush_fn;
+    char   *buf;
+    size_t  buf_size;
+    char   *sink;          /* non-NULL: output captured here (ansi_sgr) */
+    size_t  sink_room;
+    ansi_user_putc_function  out_fn;    /* non-NULL: replaces putc_fn */
+    ansi_user_flush_function out_flush; /* replaces flush_fn while out_fn set */
+    void                    *out_user;
+    unsigned long out_bytes;  /* bytes emitted, see ansi_ctx_bytes() */
+    /* REP run compression: last glyph sent, repeats held back, the
+       glyph being assembled and the escape-sequence parser state */
+    uint8_t  rep;
+    uint8_t  rep_esc;
+    uint8_t  rep_len;
+    uint8_t  rep_part_len;
+    uint8_t  rep_need;
+    char     rep_glyph[4];
+    char     rep_part[4];
+    unsigned rep_count;
+    uint8_t  ech;          /* blank with ECH, see ansi_ctx_set_erase() */
+    uint8_t  depth;        /* ANSI_DEPTH_*, see ansi_ctx_set_depth() */
+    int     batch_depth;   /* >0 while inside ansi_ctx_batch_begin/end */
+    int     color_enabled;
+    int     no_color_lock; /* set by ansi_ctx_enable() when NO_COLOR is set */
+    /* Colors are small SGR codes (named, fg:N/bg:N or style), turned
+       into escape bytes on output; 0 = none */
+    struct {
+        uint16_t fg;
+        uint16_t bg;
+        uint8_t  styles;
+    } tag;
+    uint16_t default_fg;   /* restored on [/] reset */
+    uint16_t default_bg;
+    /* Effect and window fields are present whatever the feature flags,
+       so the layout matches between the library and a differently
+       configured application (e.g. a minimal build against a full lib). */
+    int rainbow_idx;
+    int rainbow_len;
+    struct {
+        ansi_rgb_t start;
+        ansi_rgb_t end;
+        int        len;
+        int        idx;
+    } gradient;
+    int         window_width;
+    uint16_t    window_fg;
+    struct {
+        char name[ANSI_PRINT_SGR_MAX];
+        char sgr[ANSI_PRINT_SGR_MAX];
+    } sgr_cache[ANSI_PRINT_SGR_CACHE > 0 ? ANSI_PRINT_SGR_CACHE : 1];
+    int sgr_next;
+    /** @endcond */
+} ansi_ctx_t;
+
 /**
  * @brief Initialize ansi_print with platform-specific output functions and buffer.
  *
  * Must be called before any ansi_print output functions (ansi_print, etc.).
  * Follows the same dependency injection pattern as feq_init().
  *
- * @param putc_fn  Character output function, or NULL to suppress all output.
+ * @param putc_fn  Character output function, or NULL to suppress all output
+ *                 (ignored when ANSI_PRINT_PUTC is defined).
  * @param flush_fn Flush function, or NULL for no-op flush.
  * @param buf      Caller-owned buffer for ansi_print string formatting.
  * @param buf_size Size of buf in bytes (512 is typical for line-based output).
@@ -278,6 +540,10 @@ void ansi_init(ansi_putc_function putc_fn, ansi_flush_function flush_fn,
  *    (any value), color output is disabled. See https://no-color.org/.
  * 3. **isatty** -- if stdout is not a terminal (e.g. piped to a file),
  *    color output is disabled (POSIX/Windows only).
+ * 4. **COLORTERM / TERM** -- pick the color depth (ANSI_PRINT_COLOR_DEPTH):
+ *    COLORTERM=truecolor or 24bit keeps 24-bit color, a TERM containing
+ *    "256" selects 256 colors, any other TERM 16 colors.  Without TERM
+ *    the depth is left alone.
  *
  * On embedded/freestanding targets this function is not needed -- color
  * output is enabled by default after ansi_init(). Use ansi_set_enabled()
@@ -300,6 +566,15 @@ void ansi_enable(void);
  */
 void ansi_set_enabled(int enabled);
 
+/** @brief ansi_ctx_set_rep() on the default context. */
+void ansi_set_rep(int enable);
+
+/** @brief ansi_ctx_set_erase() on the default context. */
+void ansi_set_erase(int enable);
+
+/** @brief ansi_ctx_set_depth() on the default context. */
+void ansi_set_depth(int depth);
+
 /**
  * @brief Check if color output is currently enabled.
  *
@@ -591,6 +866,102 @@ char *ansi_get_buf(size_t *out_size);
  */
 void ansi_puts(const char *s);
 
+/**
+ * @brief Defer output flushes until the matching ansi_batch_end().
+ *
+ * Every ansi_print()/ansi_puts() call normally ends with a call to the
+ * flush function.  Between ansi_batch_begin() and ansi_batch_end() those
+ * flushes are suppressed, so a sequence of small writes (e.g. a whole
+ * TUI frame) reaches the device as one transfer.  Calls nest; only the
+ * outermost ansi_batch_end() flushes.
+ *
+ * @code
+ * ansi_batch_begin();
+ * ansi_puts("\x1b[1;1H[green]OK[/]");
+ * ansi_puts("\x1b[2;1H[red]FAIL[/]");
+ * ansi_batch_end();                    // one flush
+ * @endcode
+ */
+void ansi_batch_begin(void);
+
+/**
+ * @brief Close a batch opened with ansi_batch_begin().
+ *
+ * Flushes once when the outermost batch closes.  Unbalanced calls are
+ * ignored.
+ */
+void ansi_batch_end(void);
+
+/**
+ * @brief Write raw bytes with no markup processing.
+ *
+ * For pre-rendered output (cursor moves, cached SGR codes, box glyphs)
+ * that must not pay for tokenizing.  Bytes go straight to the putc
+ * function, followed by the usual flush (deferred inside a batch).
+ * Color enable/disable is not applied -- the caller decides whether to
+ * include SGR codes (see ansi_is_enabled()).
+ *
+ * @param s  Bytes to write (may contain NUL-free escape sequences).
+ * @param n  Number of bytes.
+ */
+void ansi_write(const char *s, size_t n);
+
+/**
+ * @brief Resolve a markup tag body to the SGR escape bytes it emits.
+ *
+ * Lets callers that redraw the same colored output many times resolve
+ * a color name once and then emit it with ansi_write().  The result is
+ * byte-for-byte what ansi_print() emits for @c "[tag]", independent of
+ * the current enable state.  Unknown names resolve to "".
+ *
+ * @param buf       Output buffer (24 bytes fits any single color or style;
+ *                  longer tag bodies are truncated to fit).
+ * @param buf_size  Size of @p buf.
+ * @param tag       Tag body without brackets, e.g. "bold red on white".
+ * @return @p buf, or "" if @p buf is NULL.
+ *
+ * @code
+ * char red[24];
+ * ansi_sgr(red, sizeof(red), "red");      // "\x1b[31m"
+ * @endcode
+ */
+const char *ansi_sgr(char *buf, size_t buf_size, const char *tag);
+
+/**
+ * @brief Count the visible terminal cells a markup string will occupy.
+ *
+ * Tags are zero-width, emoji shortcodes use their declared display width
+ * (1 or 2 cells), and every other character counts as one cell.  This is
+ * the same counter ansi_banner() and ansi_window_line() use for padding.
+ *
+ * @param s  Null-terminated string with optional markup tags, or NULL.
+ * @return Number of visible cells (0 for NULL).
+ *
+ * @code
+ * ansi_visible_width("[red]OK[/] :check:");   // 5
+ * @endcode
+ */
+int ansi_visible_width(const char *s);
+
+/**
+ * @brief Format into a buffer (C99 vsnprintf() semantics).
+ *
+ * The formatter behind every internal format path: the C library's
+ * vsnprintf(), or the built-in one when ANSI_PRINT_FORMAT is 1 (see
+ * there for the supported conversions).  Always NUL-terminates when
+ * @p size > 0.
+ *
+ * @param buf   Output buffer (may be NULL when @p size is 0).
+ * @param size  Size of @p buf in bytes.
+ * @param fmt   printf-style format string.
+ * @param ap    Arguments.
+ * @return Length the full output would have, excluding the NUL.
+ */
+int ansi_vsnprintf(char *buf, size_t size, const char *fmt, va_list ap);
+
+/** @brief Variadic form of ansi_vsnprintf(). */
+int ansi_snprintf(char *buf, size_t size, const char *fmt, ...);
+
 /* ------------------------------------------------------------------------- */
 /* Emoji table access                                                        */
 /* ------------------------------------------------------------------------- */
@@ -609,7 +980,26 @@ typedef struct {
     const char *utf8;   /**< UTF-8 byte sequence for the emoji. */
 } ansi_emoji_entry_t;
 
-/** Return a pointer to the first element of the emoji table. */
+/**
+ * @brief Fetch one emoji table entry.
+ *
+ * The table is stored as a packed string pool with 16-bit offsets; this
+ * fills @p out with pointers into that pool.  No RAM is used.
+ *
+ * @param index  Entry index, 0 to ansi_emoji_count() - 1.
+ * @param out    Receives the entry.
+ * @return 1 on success, 0 if @p index is out of range.
+ */
+int ansi_emoji_get(int index, ansi_emoji_entry_t *out);
+
+/**
+ * @brief Return a pointer to the first element of the emoji table.
+ *
+ * Kept for compatibility: the returned array holds pointers into the
+ * packed pool and costs extra flash (one entry per emoji plus its
+ * relocations), linked in only when this function is used.  Prefer
+ * ansi_emoji_get().
+ */
 const ansi_emoji_entry_t *ansi_emoji_table(void);
 
 /** Return the number of entries in the emoji table. */
@@ -723,6 +1113,176 @@ void ansi_window_line(ansi_align_t align, const char *fmt, ...);
 void ansi_window_end(void);
 #endif
 
+/** @name Explicit contexts
+ *  Each function below behaves exactly like its ansi_* counterpart but
+ *  operates on @p ctx instead of the default context.  ansi_print() and
+ *  friends are thin wrappers over these with ansi_default_ctx().
+ *
+ *  @code
+ *  static ansi_ctx_t console, debug;
+ *  static char console_buf[256], debug_buf[128];
+ *  ansi_ctx_init(&console, uart0_putc, NULL, console_buf, sizeof(console_buf));
+ *  ansi_ctx_init(&debug,   uart1_putc, NULL, debug_buf,   sizeof(debug_buf));
+ *  ansi_ctx_print(&console, "[green]ready[/]\n");
+ *  ansi_ctx_print(&debug,   "[dim]boot %u ms[/]\n", ms);
+ *  @endcode
+ */
+/** @{ */
+
+/**
+ * @brief Initialize a context (see ansi_init()).
+ *
+ * Clears all markup state, so a context may be re-initialized at any time.
+ */
+void ansi_ctx_init(ansi_ctx_t *ctx, ansi_putc_function putc_fn,
+                   ansi_flush_function flush_fn, char *buf, size_t buf_size);
+
+/** @brief The context used by the classic (non-ctx) API. */
+ansi_ctx_t *ansi_default_ctx(void);
+
+/**
+ * @brief Route a context's output through callbacks that take a user pointer.
+ *
+ * Replaces the putc/flush functions given to ansi_ctx_init() until called
+ * again with @p putc_fn NULL.
+ *
+ * @param ctx       Context to redirect.
+ * @param putc_fn   Byte output, or NULL to restore the plain callbacks.
+ * @param flush_fn  Flush, or NULL for none.
+ * @param user      Passed to both callbacks.
+ */
+void ansi_ctx_set_output(ansi_ctx_t *ctx, ansi_user_putc_function putc_fn,
+                         ansi_user_flush_function flush_fn, void *user);
+
+/**
+ * @brief Total bytes a context has written to its output since init.
+ *
+ * Counts what reached the putc callbacks (not ansi_sgr() captures).
+ * The difference across a draw is its exact cost on the wire.
+ */
+unsigned long ansi_ctx_bytes(const ansi_ctx_t *ctx);
+
+/**
+ * @brief Compress runs of a repeated glyph with REP (@c ESC[nb).
+ *
+ * While enabled, a run of identical printable glyphs (ASCII or 2-3 byte
+ * UTF-8, such as box-drawing lines, bar blocks and padding) goes out as
+ * the glyph followed by @c ESC[nb when that is shorter, so an 80-column
+ * double border drops from 240 bytes to 8.  Escape sequences pass through
+ * untouched.  Runs are cut at every flush, so output from another writer
+ * can never become the repeated character.
+ *
+ * REP is ECMA-48 and supported by xterm, VTE, kitty, foot, WezTerm,
+ * Windows Terminal and most serial terminal emulators, but not by every
+ * device: enable it when the terminal is known (e.g. its DA1 reply or
+ * TERM) or build with ANSI_PRINT_REP_ON.  Without ANSI_PRINT_REP this is
+ * a no-op.
+ *
+ * @param ctx     Context to configure.
+ * @param enable  Nonzero to compress.
+ */
+void ansi_ctx_set_rep(ansi_ctx_t *ctx, int enable);
+
+/**
+ * @brief Choose how ansi_ctx_blank() clears cells: ECH or spaces.
+ *
+ * ECH (@c ESC[nX, erase character) blanks @c n cells in the current
+ * background color without moving the cursor.  It is VT220 and supported
+ * by practically every emulator and the Linux console; disable it for
+ * devices that only understand cursor positioning.  Without
+ * ANSI_PRINT_ECH this is a no-op and blanking always uses spaces.
+ *
+ * @param ctx     Context to configure.
+ * @param enable  Nonzero to use ECH (initially ANSI_PRINT_ECH_ON).
+ */
+void ansi_ctx_set_erase(ansi_ctx_t *ctx, int enable);
+
+/**
+ * @brief Blank @p n cells starting at the cursor.
+ *
+ * Sends @c ESC[nX (plus @c ESC[nC when @p advance is set) if that is
+ * shorter than @p n spaces and ECH is enabled, else spaces -- clearing a
+ * 60-column field costs 5 bytes instead of 60.  Either way the cells end
+ * up blank in the current background color.
+ *
+ * @param ctx      Output context.
+ * @param n        Cells to blank (<= 0 does nothing).
+ * @param advance  Nonzero to leave the cursor after the blanked cells;
+ *                 zero when the caller moves it anyway.
+ * @return Columns the cursor moved: @p n, or 0 if it stayed put.
+ */
+int ansi_ctx_blank(ansi_ctx_t *ctx, int n, int advance);
+
+/**
+ * @brief Limit the color codes a context emits to a terminal's depth.
+ *
+ * Colors above the depth are mapped to the nearest color the terminal
+ * has: 24-bit gradient steps (@c ESC[38;2;R;G;Bm, up to 19 bytes) become
+ * @c ESC[38;5;Nm at ANSI_DEPTH_256, and 256-color names, rainbow and
+ * @c fg:N / @c bg:N become @c ESC[3Xm / @c ESC[9Xm at ANSI_DEPTH_16.
+ * ansi_ctx_enable() sets the depth from COLORTERM and TERM.  Without
+ * ANSI_PRINT_COLOR_DEPTH this is a no-op and codes pass unchanged.
+ *
+ * @param ctx    Context to configure.
+ * @param depth  ANSI_DEPTH_16, ANSI_DEPTH_256 or ANSI_DEPTH_TRUE.
+ */
+void ansi_ctx_set_depth(ansi_ctx_t *ctx, int depth);
+
+/** @brief Color depth of a context (ANSI_DEPTH_*). */
+int ansi_ctx_depth(const ansi_ctx_t *ctx);
+
+#if ANSI_PRINT_COLOR_DEPTH
+/** @brief Nearest xterm 256-color palette index for an RGB color. */
+int ansi_rgb_to_256(int r, int g, int b);
+
+/** @brief Nearest of the 16 basic colors (0-15) for a 256-color index. */
+int ansi_256_to_16(int index);
+#endif
+
+void ansi_ctx_enable(ansi_ctx_t *ctx);
+void ansi_ctx_set_enabled(ansi_ctx_t *ctx, int enabled);
+int  ansi_ctx_is_enabled(const ansi_ctx_t *ctx);
+void ansi_ctx_toggle(ansi_ctx_t *ctx);
+void ansi_ctx_set_fg(ansi_ctx_t *ctx, const char *color);
+void ansi_ctx_set_bg(ansi_ctx_t *ctx, const char *color);
+void ansi_ctx_print(ansi_ctx_t *ctx, const char *fmt, ...);
+void ansi_ctx_vprint(ansi_ctx_t *ctx, const char *fmt, va_list ap);
+const char *ansi_ctx_format(ansi_ctx_t *ctx, const char *fmt, ...);
+char *ansi_ctx_get_buf(ansi_ctx_t *ctx, size_t *out_size);
+void ansi_ctx_puts(ansi_ctx_t *ctx, const char *s);
+void ansi_ctx_batch_begin(ansi_ctx_t *ctx);
+void ansi_ctx_batch_end(ansi_ctx_t *ctx);
+void ansi_ctx_write(ansi_ctx_t *ctx, const char *s, size_t n);
+
+/**
+ * @brief Resolve a color name to SGR bytes, cached per context.
+ *
+ * Like ansi_sgr(), but returns "" when @p color is NULL/empty or color
+ * output is disabled on @p ctx, and remembers up to ANSI_PRINT_SGR_CACHE
+ * names so repeated lookups skip the tag parser.  The result is valid
+ * until the next call on the same context.
+ *
+ * @param ctx      Context whose cache and enable state are used.
+ * @param scratch  Fallback buffer (ANSI_PRINT_SGR_MAX bytes) used when
+ *                 the name cannot be cached.
+ * @param color    Color/style tag body, e.g. "cyan" or "bold red".
+ * @return SGR bytes, or "".
+ */
+const char *ansi_ctx_color(ansi_ctx_t *ctx, char *scratch, const char *color);
+
+#if ANSI_PRINT_BANNER
+void ansi_ctx_banner(ansi_ctx_t *ctx, const char *color, int width,
+                     ansi_align_t align, const char *fmt, ...);
+#endif
+#if ANSI_PRINT_WINDOW
+void ansi_ctx_window_start(ansi_ctx_t *ctx, const char *color, int width,
+                           ansi_align_t align, const char *title);
+void ansi_ctx_window_line(ansi_ctx_t *ctx, ansi_align_t align,
+                          const char *fmt, ...);
+void ansi_ctx_window_end(ansi_ctx_t *ctx);
+#endif
+/** @} */
+
 #if ANSI_PRINT_BAR
 
 /** Track character for the unfilled portion of ansi_bar(). */
@@ -735,6 +1295,7 @@ typedef enum {
     ANSI_BAR_LINE,    /**< ─ U+2500  horizontal line         */
 } ansi_bar_track_t;
 
+#if ANSI_PRINT_FLOAT
 /**
  * @brief Generate an inline horizontal bar graph string.
  *
@@ -775,6 +1336,84 @@ const char *ansi_bar(char *buf, size_t buf_size,
                      const char *color, int width, ansi_bar_track_t track,
                      double value, double min, double max);
 
+/**
+ * @brief Quantize a bar value to the fill it renders, in 1/8 cells.
+ *
+ * Uses the same clamping and rounding as ansi_bar(): the result is in
+ * [0, width * 8].  Values that quantize to the same count produce an
+ * identical bar, so callers can compare counts to skip redraws.
+ *
+ * @param width  Bar width in character cells.
+ * @param value  Current value.
+ * @param min    Minimum of the value range.
+ * @param max    Maximum of the value range.
+ * @return Filled eighths, or 0 if @p width < 1.
+ */
+int ansi_bar_eighths(int width, double value, double min, double max);
+#endif /* ANSI_PRINT_FLOAT */
+
+/**
+ * @brief Integer bar graph (no floating point).
+ *
+ * Same output as ansi_bar() for the same value, range and rounding
+ * (fill = fraction * width * 8, rounded half up), computed in 64-bit
+ * integer arithmetic.  Only the ratio (value - min) / (max - min) is
+ * used, so Q16.16 fixed-point values (or any common scale) can be passed
+ * unconverted.
+ *
+ * @param buf       Pointer to caller-provided output buffer.
+ * @param buf_size  Size of the buffer in bytes.
+ * @param color     Color name for the filled portion (NULL for uncolored).
+ * @param width     Total bar width in character cells. Must be >= 1.
+ * @param track     Character for unfilled cells.
+ * @param value     Current value.
+ * @param min       Minimum of the value range.
+ * @param max       Maximum of the value range.
+ * @return Pointer to buf.
+ *
+ * @code
+ * char bar[128];
+ * int32_t rpm_q16 = read_rpm_q16();
+ * ansi_bar_i32(bar, sizeof(bar), "green", 20, ANSI_BAR_LIGHT,
+ *              rpm_q16, 0, 6000 << 16);
+ * @endcode
+ */
+const char *ansi_bar_i32(char *buf, size_t buf_size,
+                         const char *color, int width, ansi_bar_track_t track,
+                         int32_t value, int32_t min, int32_t max);
+
+/**
+ * @brief Integer form of ansi_bar_eighths().
+ *
+ * @param width  Bar width in character cells.
+ * @param value  Current value (integer or fixed-point).
+ * @param min    Minimum of the value range (same scale as @p value).
+ * @param max    Maximum of the value range (same scale as @p value).
+ * @return Filled eighths in [0, width * 8], or 0 if @p width < 1.
+ */
+int ansi_bar_eighths_i32(int width, int32_t value, int32_t min, int32_t max);
+
+/**
+ * @brief Render a horizontal slice of a bar graph.
+ *
+ * Builds cells [@p first, @p first + @p count) of a bar filled to
+ * @p eighths (see ansi_bar_eighths()), in the same markup format as
+ * ansi_bar().  Used to repaint only the cells that change when the fill
+ * boundary moves.  ansi_bar() is equivalent to a span over the whole bar.
+ *
+ * @param buf       Pointer to caller-provided output buffer.
+ * @param buf_size  Size of the buffer in bytes.
+ * @param color     Color name for the filled portion (NULL for uncolored).
+ * @param track     Character for unfilled cells.
+ * @param eighths   Total bar fill in 1/8-cell units.
+ * @param first     Index of the first cell to render (0-based).
+ * @param count     Number of cells to render.
+ * @return Pointer to buf.
+ */
+const char *ansi_bar_span(char *buf, size_t buf_size,
+                          const char *color, ansi_bar_track_t track,
+                          int eighths, int first, int count);
+
 /**
  * @brief Bar graph with " XX%%" appended.
  *
@@ -0,0 +1,250 @@
+/**
+ * @file ansi_sink.c
+ * @brief Non-blocking file descriptor sink and SPSC ring sink.
+ *
+ * fd sink: pending bytes live in buf[head, len).  The buffer is compacted
+ * only when a byte does not fit at the end, so the common case (frame
+ * fits, fd keeps up) is one memcpy-free append per byte and one write()
+ * per flush.
+ *
+ * Ring sink: the producer appends at @c wr and publishes @c head only on
+ * flush (or when the ring fills), so the per-byte path has no barrier and
+ * never reads the consumer's index until its cached room runs out.
+ */
+
+#if !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+#define _POSIX_C_SOURCE 200112L   /* write(), fcntl() under -std=c99 */
+#endif
+
+#include "ansi_sink.h"
+
+#if ANSI_PRINT_FD_SINK
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+
+int ansi_fd_sink_init(ansi_fd_sink_t *s, int fd, char *buf, size_t size)
+{
+    if (!s || fd < 0 || !buf || size == 0) return 0;
+    memset(s, 0, sizeof(*s));
+    s->fd   = fd;
+    s->buf  = buf;
+    s->size = size;
+
+    int flags = fcntl(fd, F_GETFL);
+    if (flags < 0) return 0;
+    s->fd_flags = flags;
+    if (!(flags & O_NONBLOCK) && fcntl(fd, F_SETFL, flags | O_NONBLOCK) < 0)
+        return 0;
+    return 1;
+}
+
+int ansi_fd_sink_close(ansi_fd_sink_t *s)
+{
+    if (!s || s->fd < 0) return 0;
+    if (!(s->fd_flags & O_NONBLOCK) && fcntl(s->fd, F_SETFL, s->fd_flags) < 0)
+        return 0;
+    ansi_fd_sink_drain(s);
+    return 1;
+}
+
+size_t ansi_fd_sink_drain(ansi_fd_sink_t *s)
+{
+    if (!s) return 0;
+    while (s->head < s->len) {
+        ssize_t n = write(s->fd, s->buf + s->head, s->len - s->head);
+        if (n > 0) {
+            s->head    += (size_t)n;
+            s->written += (unsigned long)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            s->would_block++;
+            return s->len - s->head;
+        }
+        /* Hard error (closed peer, ...): discard rather than retry forever */
+        s->dropped += (unsigned long)(s->len - s->head);
+        s->overrun  = 1;
+        break;
+    }
+    s->head = s->len = 0;
+    return 0;
+}
+
+static void fd_sink_putc(void *user, int ch)
+{
+    ansi_fd_sink_t *s = (ansi_fd_sink_t *)user;
+    if (s->len == s->size) {
+        /* Full: let the fd take what it can, then reclaim the front */
+        ansi_fd_sink_drain(s);
+        if (s->head > 0) {
+            memmove(s->buf, s->buf + s->head, s->len - s->head);
+            s->len -= s->head;
+            s->head = 0;
+        }
+        if (s->len == s->size) {
+            s->dropped++;
+            s->overrun = 1;
+            return;
+        }
+    }
+    s->buf[s->len++] = (char)ch;
+}
+
+static void fd_sink_flush(void *user)
+{
+    ansi_fd_sink_drain((ansi_fd_sink_t *)user);
+}
+
+void ansi_fd_sink_attach(ansi_fd_sink_t *s, ansi_ctx_t *ctx)
+{
+    if (!s || !ctx) return;
+    ansi_ctx_set_output(ctx, fd_sink_putc, fd_sink_flush, s);
+}
+
+size_t ansi_fd_sink_pending(const ansi_fd_sink_t *s)
+{
+    return s ? s->len - s->head : 0;
+}
+
+int ansi_fd_sink_ready(void *sink)
+{
+    return ansi_fd_sink_drain((ansi_fd_sink_t *)sink) == 0;
+}
+
+int ansi_fd_sink_overrun(ansi_fd_sink_t *s)
+{
+    if (!s) return 0;
+    int lost = s->overrun;
+    s->overrun = 0;
+    return lost;
+}
+
+#endif /* ANSI_PRINT_FD_SINK */
+
+#if ANSI_PRINT_RING_SINK
+
+int ansi_ring_sink_init(ansi_ring_sink_t *r, char *buf, size_t size)
+{
+    if (!r || !buf || size < 2 || (size & (size - 1))) return 0;
+    r->buf        = buf;
+    r->mask       = size - 1;
+    r->head       = r->tail = 0;
+    r->wr         = 0;
+    r->limit      = size;
+    r->claim      = 0;
+    r->kick       = NULL;
+    r->kick_user  = NULL;
+    r->overrun    = 0;
+    r->high_water = 0;
+    r->dropped    = 0;
+    return 1;
+}
+
+/** Make everything written so far visible to the consumer */
+static void ring_publish(ansi_ring_sink_t *r)
+{
+    if (r->head == r->wr) return;
+    ANSI_BARRIER();            /* bytes land before the index */
+    r->head = r->wr;
+    size_t fill = r->wr - r->tail;
+    if (fill > r->high_water) r->high_water = fill;
+    if (r->kick) r->kick(r->kick_user);
+}
+
+static void ring_putc(void *user, int ch)
+{
+    ansi_ring_sink_t *r = (ansi_ring_sink_t *)user;
+    if (r->wr == r->limit) {
+        /* Cached room used up: let the consumer see the data, re-read tail */
+        ring_publish(r);
+        ANSI_BARRIER();        /* consumer's reads before our writes */
+        r->limit = r->tail + r->mask + 1;
+        if (r->wr == r->limit) {
+            r->dropped++;
+            r->overrun = 1;
+            return;
+        }
+    }
+    r->buf[r->wr & r->mask] = (char)ch;
+    r->wr++;
+}
+
+static void ring_flush(void *user)
+{
+    ring_publish((ansi_ring_sink_t *)user);
+}
+
+void ansi_ring_sink_attach(ansi_ring_sink_t *r, ansi_ctx_t *ctx)
+{
+    if (!r || !ctx) return;
+    ansi_ctx_set_output(ctx, ring_putc, ring_flush, r);
+}
+
+void ansi_ring_sink_set_kick(ansi_ring_sink_t *r, ansi_ring_kick_function fn,
+                             void *user)
+{
+    if (!r) return;
+    r->kick      = fn;
+    r->kick_user = fn ? user : NULL;
+}
+
+int ansi_ring_sink_get(ansi_ring_sink_t *r)
+{
+    if (!r) return -1;
+    size_t tail = r->tail;
+    if (tail == r->head) return -1;
+    ANSI_BARRIER();            /* index before the bytes it covers */
+    int ch = (unsigned char)r->buf[tail & r->mask];
+    ANSI_BARRIER();            /* byte read before the slot is freed */
+    r->tail = tail + 1;
+    return ch;
+}
+
+size_t ansi_ring_sink_claim(ansi_ring_sink_t *r, const char **p, size_t max)
+{
+    if (!r || !p) return 0;
+    size_t tail = r->tail;
+    *p = r->buf + (tail & r->mask);
+    if (r->claim) return r->claim;
+
+    size_t n = r->head - tail;
+    if (!n) return 0;
+    ANSI_BARRIER();
+    size_t to_end = r->mask + 1 - (tail & r->mask);
+    if (n > to_end)       n = to_end;
+    if (max && n > max)   n = max;
+    r->claim = n;
+    return n;
+}
+
+void ansi_ring_sink_release(ansi_ring_sink_t *r)
+{
+    if (!r || !r->claim) return;
+    ANSI_BARRIER();            /* DMA done with the run before reuse */
+    r->tail += r->claim;
+    r->claim = 0;
+}
+
+size_t ansi_ring_sink_pending(const ansi_ring_sink_t *r)
+{
+    return r ? r->wr - r->tail : 0;
+}
+
+int ansi_ring_sink_ready(void *sink)
+{
+    return ansi_ring_sink_pending((const ansi_ring_sink_t *)sink) == 0;
+}
+
+int ansi_ring_sink_overrun(ansi_ring_sink_t *r)
+{
+    if (!r) return 0;
+    int lost = r->overrun;
+    r->overrun = 0;
+    return lost;
+}
+
+#endif /* ANSI_PRINT_RING_SINK */
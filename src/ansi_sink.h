@@ -0,0 +1,301 @@
+/**
+ * @file ansi_sink.h
+ * @brief Output sinks that never stall the caller: a non-blocking file
+ *        descriptor sink (POSIX) and an interrupt-safe ring (any target).
+ *
+ * @section fd_sink File descriptor sink
+ *
+ * A flush callback built on fflush()/write() blocks the thread drawing the
+ * display whenever the terminal is slower than the data (SSH over a bad
+ * link, a 9600-baud serial port).  The fd sink instead buffers a frame in
+ * caller-provided memory and writes it to a non-blocking descriptor as
+ * far as the kernel accepts; the rest stays pending and goes out on later
+ * flushes or ansi_fd_sink_drain() calls.
+ *
+ * Pair it with tui_screen_set_ready(): while a frame is still pending the
+ * screen does not render, its widgets stay dirty and keep only their
+ * latest value, and the next frame that is drawn carries the newest state
+ * instead of every intermediate one.
+ *
+ * @code
+ * static char           tty_buf[4096];     // at least one full frame
+ * static ansi_fd_sink_t tty;
+ * static ansi_ctx_t     tty_ctx;
+ *
+ * ansi_ctx_init(&tty_ctx, NULL, NULL, fmt_buf, sizeof(fmt_buf));
+ * ansi_fd_sink_init(&tty, STDOUT_FILENO, tty_buf, sizeof(tty_buf));
+ * ansi_fd_sink_attach(&tty, &tty_ctx);
+ * tui_screen_set_ctx(&screen, &tty_ctx);
+ * tui_screen_set_ready(&screen, ansi_fd_sink_ready, &tty);
+ *
+ * while (running) {                 // control loop: never blocks on I/O
+ *     control_step();
+ *     tui_tick(&screen, millis());  // skipped while the last frame drains
+ * }
+ * ansi_fd_sink_close(&tty);         // before exit: stdout blocking again
+ * @endcode
+ *
+ * O_NONBLOCK belongs to the open file description, not the descriptor:
+ * every descriptor sharing it sees the change -- for STDOUT_FILENO on a
+ * terminal that is usually stdin, stderr, the parent shell and any other
+ * stdio writer, whose printf()/fwrite() may then fail with EAGAIN.  Keep
+ * other output off the descriptor while the sink is active, and call
+ * ansi_fd_sink_close() before exiting to put the flags back.
+ *
+ * POSIX only (write() and fcntl()).
+ *
+ * @section ring_sink Ring sink
+ *
+ * On a microcontroller the same problem shows up as a putc callback that
+ * spins on the UART TX register.  The ring sink queues output in a
+ * single-producer / single-consumer ring instead: the task that prints is
+ * the producer, and the TX interrupt (one byte at a time) or the
+ * DMA-complete callback (one contiguous chunk at a time) is the consumer.
+ * Neither side takes a lock or disables interrupts.
+ *
+ * @code
+ * static char             tx_ring[1024];   // power of two
+ * static ansi_ring_sink_t tx;
+ *
+ * ansi_ring_sink_init(&tx, tx_ring, sizeof(tx_ring));
+ * ansi_ring_sink_set_kick(&tx, tx_kick, NULL);   // on each flush
+ * ansi_ring_sink_attach(&tx, &console);
+ *
+ * // The kick only wakes the consumer; all consuming happens in the ISR
+ * static void tx_kick(void *user) { NVIC_SetPendingIRQ(DMA_TX_IRQn); }
+ *
+ * // DMA mode: transmit contiguous chunks, release each when done
+ * void DMA_TX_IRQHandler(void) {           // transfer done, or kicked
+ *     if (dma_busy()) return;
+ *     ansi_ring_sink_release(&tx);         // previous run, if any
+ *     const char *p;
+ *     size_t n = ansi_ring_sink_claim(&tx, &p, 0xFFFF);
+ *     if (n) dma_start(p, n);
+ * }
+ * @endcode
+ *
+ * Bytes become visible to the consumer when the context flushes (once
+ * per ansi_print() / frame) or when the ring fills.  A full ring drops
+ * bytes rather than wait: they are counted in @c dropped and reported
+ * by ansi_ring_sink_overrun(), and @c high_water records the deepest
+ * fill so the ring can be sized from a field log.
+ */
+
+#ifndef ANSI_SINK_H
+#define ANSI_SINK_H
+
+#include "ansi_print.h"
+
+/** @def ANSI_PRINT_FD_SINK
+ *  Enable the non-blocking file descriptor sink.
+ *  Default: 1 on POSIX systems (0 elsewhere or if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_PRINT_FD_SINK
+#  if defined(__unix__) || defined(__APPLE__)
+#    define ANSI_PRINT_FD_SINK  ANSI_PRINT_DEFAULT_
+#  else
+#    define ANSI_PRINT_FD_SINK  0
+#  endif
+#endif
+
+#if ANSI_PRINT_FD_SINK
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Non-blocking descriptor sink.  Counters are read-only for the caller. */
+typedef struct {
+    int           fd;
+    char         *buf;
+    size_t        size;
+    size_t        head;          /* next byte to write */
+    size_t        len;           /* end of buffered bytes */
+    int           overrun;       /* bytes were lost since the last check */
+    int           fd_flags;      /* file status flags before init */
+    unsigned long would_block;   /**< Writes cut short by EAGAIN. */
+    unsigned long written;       /**< Bytes accepted by the descriptor. */
+    unsigned long dropped;       /**< Bytes lost to a full buffer or write error. */
+} ansi_fd_sink_t;
+
+/**
+ * @brief Prepare a sink and switch @p fd to non-blocking mode.
+ *
+ * The flag is set on the open file description, so it also applies to
+ * every descriptor sharing it (see @ref fd_sink); ansi_fd_sink_close()
+ * restores the original flags.
+ *
+ * @param s     Sink to initialize.
+ * @param fd    Open descriptor (tty, pty, socket, pipe).
+ * @param buf   Pending-output buffer; size it for the largest frame.
+ * @param size  Size of @p buf.
+ * @return 1 on success, 0 on bad arguments or if O_NONBLOCK cannot be set.
+ */
+int ansi_fd_sink_init(ansi_fd_sink_t *s, int fd, char *buf, size_t size);
+
+/**
+ * @brief Restore the descriptor's original file status flags.
+ *
+ * Output still pending is then written in the original mode, so on a
+ * blocking descriptor this waits for the last frame.  The descriptor is
+ * not closed.
+ *
+ * @return 1 on success, 0 if the flags could not be restored.
+ */
+int ansi_fd_sink_close(ansi_fd_sink_t *s);
+
+/** @brief Route a context's output into the sink (ansi_ctx_set_output()). */
+void ansi_fd_sink_attach(ansi_fd_sink_t *s, ansi_ctx_t *ctx);
+
+/**
+ * @brief Write as much pending output as the descriptor accepts.
+ *
+ * Never blocks.  Call from the main loop, or when poll()/select() reports
+ * the descriptor writable.
+ *
+ * @return Bytes still pending.
+ */
+size_t ansi_fd_sink_drain(ansi_fd_sink_t *s);
+
+/** @brief Bytes buffered but not yet written. */
+size_t ansi_fd_sink_pending(const ansi_fd_sink_t *s);
+
+/**
+ * @brief Readiness hook for tui_screen_set_ready(): drain, then report
+ *        whether the previous frame is fully written.
+ *
+ * @param sink  The ansi_fd_sink_t.
+ * @return 1 if nothing is pending, 0 if the descriptor would block.
+ */
+int ansi_fd_sink_ready(void *sink);
+
+/**
+ * @brief Report and clear the overrun flag.
+ *
+ * Set when output was lost because the buffer filled while the descriptor
+ * would block (or a write failed).  The terminal then no longer matches
+ * the widgets: repaint with tui_screen_redraw_all() or ansi_fb_redraw().
+ *
+ * @return Nonzero if bytes were lost since the last call.
+ */
+int ansi_fd_sink_overrun(ansi_fd_sink_t *s);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANSI_PRINT_FD_SINK */
+
+/** @def ANSI_PRINT_RING_SINK
+ *  Enable the interrupt-safe SPSC ring sink.
+ *  Default: 1 (0 if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_PRINT_RING_SINK
+#  define ANSI_PRINT_RING_SINK  ANSI_PRINT_DEFAULT_
+#endif
+
+#if ANSI_PRINT_RING_SINK
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Ring sink start-transmit hook (see ansi_ring_sink_set_kick()). */
+typedef void (*ansi_ring_kick_function)(void *user);
+
+/**
+ * SPSC ring sink.  head/wr/limit belong to the producer, tail/claim to the
+ * consumer; indices run freely and are masked by size - 1.  Counters are
+ * read-only for the caller.
+ */
+typedef struct {
+    char                   *buf;
+    size_t                  mask;        /* size - 1 */
+    volatile size_t         head;        /* published end (producer) */
+    volatile size_t         tail;        /* consumed start (consumer) */
+    size_t                  wr;          /* producer's unpublished end */
+    size_t                  limit;       /* wr may not pass this (cached tail + size) */
+    size_t                  claim;       /* bytes handed to DMA, not yet released */
+    ansi_ring_kick_function kick;
+    void                   *kick_user;
+    int                     overrun;     /* bytes were lost since the last check */
+    size_t                  high_water;  /**< Deepest fill seen at a flush, in bytes. */
+    unsigned long           dropped;     /**< Bytes lost to a full ring. */
+} ansi_ring_sink_t;
+
+/**
+ * @brief Prepare a ring over caller-provided storage.
+ *
+ * @param r     Ring to initialize.
+ * @param buf   Ring storage.
+ * @param size  Size of @p buf; must be a power of two (>= 2).
+ * @return 1 on success, 0 on bad arguments.
+ */
+int ansi_ring_sink_init(ansi_ring_sink_t *r, char *buf, size_t size);
+
+/** @brief Route a context's output into the ring (ansi_ctx_set_output()). */
+void ansi_ring_sink_attach(ansi_ring_sink_t *r, ansi_ctx_t *ctx);
+
+/**
+ * @brief Call @p fn after each flush that published bytes, e.g. to enable
+ *        the TX-empty interrupt or pend the DMA interrupt.  Runs in the
+ *        producer's context, so it should wake the consumer rather than
+ *        consume itself.  NULL removes the hook.
+ */
+void ansi_ring_sink_set_kick(ansi_ring_sink_t *r, ansi_ring_kick_function fn,
+                             void *user);
+
+/**
+ * @brief Consumer, byte mode: take the next published byte.
+ *
+ * Call from the TX interrupt.
+ *
+ * @return The byte (0-255), or -1 if the ring is empty.
+ */
+int ansi_ring_sink_get(ansi_ring_sink_t *r);
+
+/**
+ * @brief Consumer, DMA mode: hand out the next contiguous run of bytes.
+ *
+ * The run ends at the published head or at the end of the storage,
+ * whichever comes first, so a wrapped ring is sent as two transfers.  The
+ * bytes stay owned by the consumer -- the producer keeps filling the rest
+ * of the ring -- until ansi_ring_sink_release().  Claiming again before
+ * the release returns the same run.
+ *
+ * @param r    Ring.
+ * @param p    Receives the start of the run.
+ * @param max  Largest run the DMA engine accepts (0 = no limit).
+ * @return Bytes in the run, 0 if nothing is published.
+ */
+size_t ansi_ring_sink_claim(ansi_ring_sink_t *r, const char **p, size_t max);
+
+/** @brief Consumer, DMA mode: the claimed run has been sent; free it. */
+void ansi_ring_sink_release(ansi_ring_sink_t *r);
+
+/** @brief Bytes written by the producer and not yet consumed. */
+size_t ansi_ring_sink_pending(const ansi_ring_sink_t *r);
+
+/**
+ * @brief Readiness hook for tui_screen_set_ready().
+ *
+ * @param sink  The ansi_ring_sink_t.
+ * @return 1 once the consumer has sent everything, 0 while bytes remain.
+ */
+int ansi_ring_sink_ready(void *sink);
+
+/**
+ * @brief Report and clear the overrun flag.
+ *
+ * Set when output was dropped because the ring was full.  Repaint with
+ * tui_screen_redraw_all() or ansi_fb_redraw() afterwards.
+ *
+ * @return Nonzero if bytes were lost since the last call.
+ */
+int ansi_ring_sink_overrun(ansi_ring_sink_t *r);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANSI_PRINT_RING_SINK */
+
+#endif /* ANSI_SINK_H */
@@ -2,8 +2,9 @@
  * @file ansi_tui.c
  * @brief Positioned TUI widget layer built on ansi_print.
  *
- * All output flows through ansi_puts() / ansi_print() — the TUI layer
- * does not store its own putc function.  Cursor-positioning escape
+ * All output flows through ansi_ctx_puts() / ansi_ctx_print() on the
+ * context of the widget's screen (else the default context) — the TUI
+ * layer does not store its own putc function.  Cursor-positioning escape
  * sequences pass through the ansi_print tokenizer unchanged because
  * they contain no ']' to close a markup tag.
  */
@@ -23,12 +24,12 @@
                         ANSI_TUI_PBAR  || ANSI_TUI_STATUS || ANSI_TUI_TEXT || \
                         ANSI_TUI_CHECK || ANSI_TUI_METRIC || ANSI_TUI_EBAR)
 
-/* Widgets that use tui_widget_goto() (all content widgets except metric) */
+/* Widgets that use tui_place_goto() (all content widgets except metric) */
 #define ANSI_TUI_GOTO_ (ANSI_TUI_LABEL || ANSI_TUI_BAR || ANSI_TUI_PBAR || \
                          ANSI_TUI_STATUS || ANSI_TUI_TEXT || ANSI_TUI_CHECK || \
                          ANSI_TUI_EBAR)
 
-/* Widgets that use tui_pad() */
+/* Widgets that use tui_clear() */
 #define ANSI_TUI_PAD_ (ANSI_TUI_LABEL || ANSI_TUI_PBAR || ANSI_TUI_STATUS || \
                         ANSI_TUI_TEXT || ANSI_TUI_METRIC || ANSI_TUI_EBAR)
 
@@ -71,65 +72,146 @@
 #define TUI_BR  "\xe2\x95\xaf"  /* U+256F  ╯ */
 #define TUI_HZ  "\xe2\x94\x80"  /* U+2500  ─ */
 #define TUI_VT  "\xe2\x94\x82"  /* U+2502  │ */
+#elif ANSI_PRINT_BOX_STYLE == ANSI_BOX_DEC
+#define TUI_IN  "\x1b(0"        /* G0 = DEC Special Graphics */
+#define TUI_OUT "\x1b(B"        /* G0 = US ASCII */
+#define TUI_TL  "l"             /* ┌ */
+#define TUI_TR  "k"             /* ┐ */
+#define TUI_BL  "m"             /* └ */
+#define TUI_BR  "j"             /* ┘ */
+#define TUI_HZ  "q"             /* ─ */
+#define TUI_VT  "x"             /* │ */
+#elif ANSI_PRINT_BOX_STYLE == ANSI_BOX_ASCII
+#define TUI_TL  "+"
+#define TUI_TR  "+"
+#define TUI_BL  "+"
+#define TUI_BR  "+"
+#define TUI_HZ  "-"
+#define TUI_VT  "|"
 #else
 #error "Unknown ANSI_PRINT_BOX_STYLE value"
 #endif
 
+/* Charset switch around every run of box glyphs (DEC style only) */
+#ifndef TUI_IN
+#define TUI_IN  ""
+#define TUI_OUT ""
+#endif
+
 #endif /* ANSI_TUI_ANY_ */
 
 /* ------------------------------------------------------------------ */
 /* Screen helpers                                                      */
 /* ------------------------------------------------------------------ */
 
-void tui_cls(void)
+void tui_ctx_cls(ansi_ctx_t *ctx)
 {
-    ansi_puts("\x1b[2J\x1b[H");
+    ansi_ctx_puts(ctx, "\x1b[2J\x1b[H");
 }
 
-void tui_goto(int row, int col)
+void tui_ctx_goto(ansi_ctx_t *ctx, int row, int col)
 {
     char seq[24];
-    snprintf(seq, sizeof(seq), "\x1b[%d;%dH", row, col);
-    ansi_puts(seq);
+    int n = ansi_snprintf(seq, sizeof(seq), "\x1b[%d;%dH", row, col);
+    if (n > 0) ansi_ctx_write(ctx, seq, (size_t)n < sizeof(seq) ? (size_t)n : sizeof(seq) - 1);
 }
 
-void tui_cursor_hide(void)
+void tui_ctx_cursor_hide(ansi_ctx_t *ctx)
 {
-    ansi_puts("\x1b[?25l");
+    ansi_ctx_puts(ctx, "\x1b[?25l");
 }
 
-void tui_cursor_show(void)
+void tui_ctx_cursor_show(ansi_ctx_t *ctx)
 {
-    ansi_puts("\x1b[?25h");
+    ansi_ctx_puts(ctx, "\x1b[?25h");
 }
 
-void tui_sync_begin(void)
+void tui_ctx_sync_begin(ansi_ctx_t *ctx)
 {
-    ansi_puts("\x1b[?2026h");
+    ansi_ctx_puts(ctx, "\x1b[?2026h");
 }
 
-void tui_sync_end(void)
+void tui_ctx_sync_end(ansi_ctx_t *ctx)
 {
-    ansi_puts("\x1b[?2026l");
+    ansi_ctx_puts(ctx, "\x1b[?2026l");
 }
 
+void tui_cls(void)               { tui_ctx_cls(ansi_default_ctx()); }
+void tui_goto(int row, int col)  { tui_ctx_goto(ansi_default_ctx(), row, col); }
+void tui_cursor_hide(void)       { tui_ctx_cursor_hide(ansi_default_ctx()); }
+void tui_cursor_show(void)       { tui_ctx_cursor_show(ansi_default_ctx()); }
+void tui_sync_begin(void)        { tui_ctx_sync_begin(ansi_default_ctx()); }
+void tui_sync_end(void)          { tui_ctx_sync_end(ansi_default_ctx()); }
+
 /* ------------------------------------------------------------------ */
 /* Internal helpers — shared drawing primitives (any widget)            */
 /* ------------------------------------------------------------------ */
 
 #if ANSI_TUI_ANY_
 
-/** Build a horizontal run of box-drawing characters into p.
- *  Returns the number of bytes written (not including NUL). */
-static int tui_fill_horz(char *p, size_t avail, int count)
+/* SGR reset appended after colored chrome (same bytes as "[/]") */
+#define TUI_RESET       "\x1b[0m"
+#define TUI_RESET_LEN   (sizeof(TUI_RESET) - 1)
+#define TUI_GLYPH_LEN   (sizeof(TUI_HZ) - 1)   /* all box glyphs are the same size */
+#define TUI_IN_LEN      (sizeof(TUI_IN) - 1)
+#define TUI_OUT_LEN     (sizeof(TUI_OUT) - 1)
+#define TUI_SHIFT_LEN   (TUI_IN_LEN + TUI_OUT_LEN)
+
+/** Append @p n copies of a glyph by doubling memcpy (log2(n) copies). */
+static char *tui_repeat(char *p, const char *glyph, int n)
+{
+    if (n <= 0) return p;
+    char *start = p;
+    memcpy(p, glyph, TUI_GLYPH_LEN);
+    size_t have = TUI_GLYPH_LEN;
+    size_t want = (size_t)n * TUI_GLYPH_LEN;
+    while (have < want) {
+        size_t chunk = have < want - have ? have : want - have;
+        memcpy(start + have, start, chunk);
+        have += chunk;
+    }
+    return start + want;
+}
+
+/** Append a glyph wrapped in the resolved color (or bare). */
+static char *tui_put_glyph(char *p, const char *sgr, size_t sgr_len,
+                           const char *glyph)
 {
-    int written = 0;
-    for (int i = 0; i < count; i++) {
-        int n = snprintf(p + written, avail - (size_t)written, "%s", TUI_HZ);
-        if (n < 0 || (size_t)(written + n) >= avail) break;
-        written += n;
+    memcpy(p, sgr, sgr_len);
+    p += sgr_len;
+    memcpy(p, TUI_IN, TUI_IN_LEN);
+    p += TUI_IN_LEN;
+    memcpy(p, glyph, TUI_GLYPH_LEN);
+    p += TUI_GLYPH_LEN;
+    memcpy(p, TUI_OUT, TUI_OUT_LEN);
+    p += TUI_OUT_LEN;
+    if (sgr_len) {
+        memcpy(p, TUI_RESET, TUI_RESET_LEN);
+        p += TUI_RESET_LEN;
     }
-    return written;
+    return p;
+}
+
+/** Build a horizontal border row (corner, @p n rules, corner). */
+static size_t tui_border_row(char *buf, const char *sgr, size_t sgr_len,
+                             const char *left, const char *right, int n)
+{
+    char *p = buf;
+    memcpy(p, sgr, sgr_len);
+    p += sgr_len;
+    memcpy(p, TUI_IN, TUI_IN_LEN);
+    p += TUI_IN_LEN;
+    memcpy(p, left, TUI_GLYPH_LEN);
+    p = tui_repeat(p + TUI_GLYPH_LEN, TUI_HZ, n);
+    memcpy(p, right, TUI_GLYPH_LEN);
+    p += TUI_GLYPH_LEN;
+    memcpy(p, TUI_OUT, TUI_OUT_LEN);
+    p += TUI_OUT_LEN;
+    if (sgr_len) {
+        memcpy(p, TUI_RESET, TUI_RESET_LEN);
+        p += TUI_RESET_LEN;
+    }
+    return (size_t)(p - buf);
 }
 
 /** Resolve a widget's local (row,col) to absolute screen coordinates
@@ -156,73 +238,56 @@ static void tui_resolve(const tui_frame_t *parent, int row, int col,
 }
 
 /** Draw a complete box border at the given position.
+ *  The color is resolved to SGR bytes once, each row image is built
+ *  with memcpy in the shared format buffer, and rows are written raw
+ *  (no markup parsing).  Side rows re-send one edge image; a filled
+ *  interior is blanked with ansi_ctx_blank().
  *  @param iw    interior width (chars between the side borders)
  *  @param ih    interior height (rows between top and bottom borders)
  *  @param color border color name, or NULL
- *  @param fill  if nonzero, fill interior rows with spaces */
-static void tui_draw_border(int row, int col, int iw, int ih,
+ *  @param fill  if nonzero, blank the interior rows */
+static void tui_draw_border(ansi_ctx_t *c, int row, int col, int iw, int ih,
                             const char *color, int fill)
 {
     size_t buf_size;
-    char *buf = ansi_get_buf(&buf_size);
+    char *buf = ansi_ctx_get_buf(c, &buf_size);
     if (!buf || buf_size < 32) return;
 
-    char *p;
-    char *end = buf + buf_size;
+    char scratch[ANSI_PRINT_SGR_MAX];
+    const char *sgr = ansi_ctx_color(c, scratch, color);
+    size_t sgr_len = strlen(sgr);
+    size_t edge = sgr_len + 2 * TUI_GLYPH_LEN + TUI_SHIFT_LEN +
+                  (sgr_len ? TUI_RESET_LEN : 0);
+
+    /* Clamp the run so every row image fits the buffer (conservatively:
+       a horizontal row plus one extra edge for the filled side row) */
+    int run = iw + 2;
+    if (run < 0) run = 0;
+    size_t fixed = 2 * edge;
+    if (fixed + (size_t)run * TUI_GLYPH_LEN > buf_size)
+        run = buf_size > fixed ? (int)((buf_size - fixed) / TUI_GLYPH_LEN) : 0;
 
     /* --- top border --- */
-    tui_goto(row, col);
-    p = buf;
-    if (color) p += snprintf(p, (size_t)(end - p), "[%s]", color);
-    p += snprintf(p, (size_t)(end - p), "%s", TUI_TL);
-    p += tui_fill_horz(p, (size_t)(end - p), iw + 2);
-    p += snprintf(p, (size_t)(end - p), "%s", TUI_TR);
-    if (color) snprintf(p, (size_t)(end - p), "[/]");
-    ansi_puts(buf);
+    tui_ctx_goto(c, row, col);
+    ansi_ctx_write(c, buf, tui_border_row(buf, sgr, sgr_len, TUI_TL, TUI_TR, run));
 
     /* --- side rows --- */
-    for (int r = 0; r < ih; r++) {
-        /* Left border */
-        tui_goto(row + 1 + r, col);
-        p = buf;
-        if (color) p += snprintf(p, (size_t)(end - p), "[%s]", color);
-        p += snprintf(p, (size_t)(end - p), "%s", TUI_VT);
-        if (color) p += snprintf(p, (size_t)(end - p), "[/]");
-        if (fill) {
-            int n = iw + 2;
-            int avail = (int)(end - p) - 1;
-            if (n > avail) n = avail;
-            memset(p, ' ', (size_t)n);
-            p[n] = '\0';
-            p += n;
-        }
-        if (color) p += snprintf(p, (size_t)(end - p), "[%s]", color);
-        if (fill) {
-            p += snprintf(p, (size_t)(end - p), "%s", TUI_VT);
-            if (color) snprintf(p, (size_t)(end - p), "[/]");
-            ansi_puts(buf);
-        } else {
-            if (color) snprintf(p, (size_t)(end - p), "[/]");
-            ansi_puts(buf);
-            /* Right border at far column */
-            tui_goto(row + 1 + r, col + iw + 3);
-            p = buf;
-            if (color) p += snprintf(p, (size_t)(end - p), "[%s]", color);
-            p += snprintf(p, (size_t)(end - p), "%s", TUI_VT);
-            if (color) snprintf(p, (size_t)(end - p), "[/]");
-            ansi_puts(buf);
+    if (ih > 0) {
+        size_t edge_len = (size_t)(tui_put_glyph(buf, sgr, sgr_len, TUI_VT) - buf);
+        ansi_ctx_batch_begin(c);
+        for (int r = 0; r < ih; r++) {
+            tui_ctx_goto(c, row + 1 + r, col);
+            ansi_ctx_write(c, buf, edge_len);
+            if (fill) ansi_ctx_blank(c, iw + 2, 1);
+            else      tui_ctx_goto(c, row + 1 + r, col + iw + 3);
+            ansi_ctx_write(c, buf, edge_len);   /* same bytes as the left */
         }
+        ansi_ctx_batch_end(c);
     }
 
     /* --- bottom border --- */
-    tui_goto(row + ih + 1, col);
-    p = buf;
-    if (color) p += snprintf(p, (size_t)(end - p), "[%s]", color);
-    p += snprintf(p, (size_t)(end - p), "%s", TUI_BL);
-    p += tui_fill_horz(p, (size_t)(end - p), iw + 2);
-    p += snprintf(p, (size_t)(end - p), "%s", TUI_BR);
-    if (color) snprintf(p, (size_t)(end - p), "[/]");
-    ansi_puts(buf);
+    tui_ctx_goto(c, row + ih + 1, col);
+    ansi_ctx_write(c, buf, tui_border_row(buf, sgr, sgr_len, TUI_BL, TUI_BR, run));
 }
 
 #endif /* ANSI_TUI_ANY_ */
@@ -246,28 +311,31 @@ static int tui_interior_row(tui_border_t border, int row)
     return border == ANSI_TUI_BORDER ? row + 1 : row;
 }
 
-/** Resolve a widget's parent chain, compute the interior origin,
- *  and move the cursor there.  Returns the interior position via
- *  optional out-params for callers that need further offsets
- *  (e.g. past a label prefix). */
-static void tui_widget_goto(const tui_frame_t *parent, int row, int col,
-                             tui_border_t border, int *out_ir, int *out_ic)
+/** Resolve a widget's parent chain and compute the interior origin
+ *  without moving the cursor.  Used by updates that position past a
+ *  prefix so they emit a single cursor move. */
+static void tui_place_pos(const tui_placement_t *p, int col,
+                           int *out_ir, int *out_ic)
 {
     int ar, ac;
-    tui_resolve(parent, row, col, &ar, &ac);
-    int ir = tui_interior_row(border, ar);
-    int ic = tui_interior_col(border, ac);
-    tui_goto(ir, ic);
-    if (out_ir) *out_ir = ir;
-    if (out_ic) *out_ic = ic;
+    tui_resolve(p->parent, p->row, col, &ar, &ac);
+    *out_ir = tui_interior_row(p->border, ar);
+    *out_ic = tui_interior_col(p->border, ac);
 }
 
-/** Placement-aware wrapper for tui_widget_goto().
+/** Resolve a widget's parent chain, compute the interior origin,
+ *  and move the cursor there.  Returns the interior position via
+ *  optional out-params for callers that need further offsets
+ *  (e.g. past a label prefix).
  *  @param col  Column override (may differ from p->col after centering). */
-static void tui_place_goto(const tui_placement_t *p, int col,
+static void tui_place_goto(ansi_ctx_t *c, const tui_placement_t *p, int col,
                             int *out_ir, int *out_ic)
 {
-    tui_widget_goto(p->parent, p->row, col, p->border, out_ir, out_ic);
+    int ir, ic;
+    tui_place_pos(p, col, &ir, &ic);
+    tui_ctx_goto(c, ir, ic);
+    if (out_ir) *out_ir = ir;
+    if (out_ic) *out_ic = ic;
 }
 
 /** Resolve position, draw border (if requested), and goto interior.
@@ -276,37 +344,220 @@ static void tui_place_goto(const tui_placement_t *p, int col,
  *  @param col   Column override (may differ from p->col after centering).
  *  @param iw    Interior width for the border box.
  *  @param color Border/content color, or NULL. */
-static void tui_widget_chrome(const tui_placement_t *p, int col, int iw,
+static void tui_widget_chrome(ansi_ctx_t *c, const tui_placement_t *p, int col, int iw,
                                const char *color, int *out_ir, int *out_ic)
 {
     int ar, ac;
     tui_resolve(p->parent, p->row, col, &ar, &ac);
     if (p->border == ANSI_TUI_BORDER)
-        tui_draw_border(ar, ac, iw, 1, color, 1);
+        tui_draw_border(c, ar, ac, iw, 1, color, 1);
     int ir = tui_interior_row(p->border, ar);
     int ic = tui_interior_col(p->border, ac);
-    tui_goto(ir, ic);
+    tui_ctx_goto(c, ir, ic);
     if (out_ir) *out_ir = ir;
     if (out_ic) *out_ic = ic;
 }
 
 #endif /* ANSI_TUI_GOTO_ */
 
+/* ------------------------------------------------------------------ */
+/* Internal helpers — screen registry hooks                            */
+/* ------------------------------------------------------------------ */
+
+/* Widget state 'dirty' values.  Zero-initialized state is "not on a
+ * screen", so widgets updated without an init call draw immediately. */
+#define TUI_IMMEDIATE  0   /* not on a screen: updates draw at once */
+#define TUI_CLEAN      1   /* on a screen, nothing pending */
+#define TUI_CHANGED    2   /* on a screen, redraw on next render */
+#define TUI_FORCED     3   /* on a screen, forced redraw on next render */
+
+#if ANSI_TUI_SCREEN
+
+/** Find the screen a widget belongs to: its own, else the nearest
+ *  ancestor frame's. */
+static tui_screen_t *tui_screen_of(tui_screen_t *s, const tui_frame_t *parent)
+{
+    for (const tui_frame_t *f = parent; !s && f; f = f->parent)
+        s = f->screen;
+    return s;
+}
+
+#endif /* ANSI_TUI_SCREEN */
+
+#if ANSI_TUI_ANY_
+#if ANSI_TUI_SCREEN
+
+/** The output context a widget draws to: its screen's, else the
+ *  default context. */
+static ansi_ctx_t *tui_ctx_of(tui_screen_t *s, const tui_frame_t *parent)
+{
+    s = tui_screen_of(s, parent);
+    return s && s->ctx ? s->ctx : ansi_default_ctx();
+}
+
+#else
+#define tui_ctx_of(s, parent)  ansi_default_ctx()
+#endif /* ANSI_TUI_SCREEN */
+
+/** The output context for a content widget's placement. */
+#define tui_place_ctx(p)  tui_ctx_of((p)->screen, (p)->parent)
+#endif /* ANSI_TUI_ANY_ */
+
+#if ANSI_TUI_SCREEN && ANSI_TUI_ANY_
+
+/** Register a frame or widget on its screen (its own, else the nearest
+ *  ancestor frame's), keeping entries sorted by absolute (row, col).
+ *  Re-registering the same widget is a no-op.
+ *  @return Nonzero if the widget is on a screen, 0 to draw immediately. */
+static int tui_attach(tui_screen_t *s, const tui_frame_t *parent,
+                      int row, int col, tui_kind_t kind, const void *widget)
+{
+    s = tui_screen_of(s, parent);
+    if (!s || !s->entries) return 0;
+
+    for (int i = 0; i < s->count; i++)
+        if (s->entries[i].widget == widget) return 1;
+    if (s->count >= s->capacity) return 0;
+
+    int ar, ac;
+    tui_resolve(parent, row, col, &ar, &ac);
+
+    /* Insertion sort: registration happens once, rendering every frame */
+    int i = s->count++;
+    while (i > 0 && (s->entries[i - 1].row > ar ||
+                     (s->entries[i - 1].row == ar && s->entries[i - 1].col > ac))) {
+        s->entries[i] = s->entries[i - 1];
+        i--;
+    }
+    s->entries[i].kind   = kind;
+    s->entries[i].widget = widget;
+    s->entries[i].row    = ar;
+    s->entries[i].col    = ac;
+    s->entries[i].cost    = 0;
+    s->entries[i].waiting = 0;
+    s->entries[i].since   = 0;
+    return 1;
+}
+
+/** Register a content widget via its placement.  Init draws the widget
+ *  blank, so its binding (if any) has nothing shown yet. */
+#define tui_place_attach(p, kind, w) \
+    ((p)->bind ? (void)((p)->bind->shown = 0) : (void)0, \
+     tui_attach((p)->screen, (p)->parent, (p)->row, (p)->col, (kind), (w)))
+
+#else
+#define tui_attach(s, parent, row, col, kind, w)  ((void)(w), 0)
+#define tui_place_attach(p, kind, w)              ((void)(p), (void)(w), 0)
+#endif /* ANSI_TUI_SCREEN && ANSI_TUI_ANY_ */
+
+#if ANSI_TUI_SCREEN
+
+/** Mark a widget dirty instead of drawing it.  A forced update stays
+ *  forced until the next render.  An update to a widget that is already
+ *  dirty replaces the pending value and is counted as coalesced.
+ *  @param p      The widget's placement (locates the screen for stats).
+ *  @param dirty  The widget's screen render state, or NULL (no state).
+ *  @return Nonzero if the draw was deferred to tui_screen_render(). */
+static int tui_defer(const tui_placement_t *p, int *dirty, int force)
+{
+    if (!dirty || *dirty == TUI_IMMEDIATE) return 0;
+
+    tui_screen_t *s = tui_screen_of(p->screen, p->parent);
+    if (s) {
+        s->stats.updates++;
+        if (*dirty != TUI_CLEAN) s->pending_coalesced++;
+        else if (s->wake)        s->wake(s->wake_user);
+    }
+    if (force)                    *dirty = TUI_FORCED;
+    else if (*dirty == TUI_CLEAN) *dirty = TUI_CHANGED;
+    return 1;
+}
+
+#else
+#define tui_defer(p, dirty, force)  ((void)(p), (void)(dirty), (void)(force), 0)
+#endif /* ANSI_TUI_SCREEN */
+
 /* ------------------------------------------------------------------ */
 /* Internal helpers — padding and centering                            */
 /* ------------------------------------------------------------------ */
 
 #if ANSI_TUI_PAD_
 
-/** Emit n spaces at the current cursor position. */
-static void tui_pad(int n)
+/** Blank n cells at the cursor where nothing else follows on the row:
+ *  ECH when the context allows it (the cursor then stays put), else
+ *  spaces. */
+static void tui_clear(ansi_ctx_t *c, int n)
+{
+    ansi_ctx_blank(c, n, 0);
+}
+
+#if ANSI_TUI_EBAR
+/** Blank n cells at the cursor and leave the cursor after them. */
+static void tui_pad(ansi_ctx_t *c, int n)
 {
-    if (n <= 0) return;
-    ansi_print("%*s", n, "");
+    ansi_ctx_blank(c, n, 1);
 }
+#endif
 
 #endif /* ANSI_TUI_PAD_ */
 
+#if ANSI_TUI_METRIC || ANSI_TUI_BIND
+
+/** FNV-1a hash of the formatted value text.  Cheaper to store than the
+ *  text itself; a change in the digest means the visible text changed. */
+static uint32_t tui_digest(const char *s)
+{
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (uint8_t)*s++;
+        h *= 16777619u;
+    }
+    return h ? h : 1;   /* 0 is reserved for "nothing drawn" */
+}
+
+#endif /* ANSI_TUI_METRIC || ANSI_TUI_BIND */
+
+#if ANSI_TUI_LABEL || ANSI_TUI_STATUS || ANSI_TUI_TEXT
+
+/** Format an update's text.  Returns the text to draw now (in the
+ *  shared format buffer), or NULL when it was stored in @p text_buf for
+ *  the next screen render (or there is no format buffer).
+ *  @param dirty  The widget's screen render state, or NULL. */
+static const char *tui_format_text(ansi_ctx_t *c, const tui_placement_t *p,
+                                   char *text_buf, size_t text_buf_size,
+                                   int *dirty, const char *fmt, va_list ap)
+{
+    if (text_buf && text_buf_size && tui_defer(p, dirty, 0)) {
+        ansi_vsnprintf(text_buf, text_buf_size, fmt, ap);
+        return NULL;
+    }
+
+    size_t buf_size;
+    char *buf = ansi_ctx_get_buf(c, &buf_size);
+    if (!buf || !buf_size) return NULL;
+    ansi_vsnprintf(buf, buf_size, fmt, ap);
+    return buf;
+}
+
+/** Write a value at the current cursor position, then blank only the
+ *  cells a longer previous value left behind.  Each cell is sent once:
+ *  no pre-clear pass and no second cursor move.
+ *  @param width    Reserved value width in visible chars.
+ *  @param vis_len  Visible width of the previous value (updated), or
+ *                  NULL to blank the remainder of @p width. */
+static void tui_draw_value(ansi_ctx_t *c, int width, int *vis_len, const char *text)
+{
+    int vis  = ansi_visible_width(text);
+    int prev = vis_len ? *vis_len : width;
+    if (prev > width) prev = width;
+
+    ansi_ctx_puts(c, text);
+    tui_clear(c, prev - vis);
+    if (vis_len) *vis_len = vis;
+}
+
+#endif /* ANSI_TUI_LABEL || ANSI_TUI_STATUS || ANSI_TUI_TEXT */
+
 #if ANSI_TUI_CENTER_
 
 /** Resolve col = 0 (center sentinel) to a centered column within the
@@ -349,6 +600,23 @@ static int tui_effective_width(const tui_placement_t *p, int width)
 
 #endif /* ANSI_TUI_STATUS || ANSI_TUI_TEXT || ANSI_TUI_METRIC */
 
+#if ANSI_TUI_BAR || ANSI_TUI_PBAR
+
+/** Compute the cells that differ between two bar fills (in eighths).
+ *  Only the cells from the one holding the lower boundary up to the
+ *  one holding the higher boundary change; everything else is identical. */
+static void tui_bar_dirty_span(int old_eighths, int new_eighths,
+                               int *first, int *count)
+{
+    int lo = old_eighths < new_eighths ? old_eighths : new_eighths;
+    int hi = old_eighths < new_eighths ? new_eighths : old_eighths;
+    if (lo < 0) lo = 0;
+    *first = lo / 8;
+    *count = lo == hi ? 0 : (hi + 7) / 8 - *first;
+}
+
+#endif /* ANSI_TUI_BAR || ANSI_TUI_PBAR */
+
 /* ------------------------------------------------------------------ */
 /* Frame widget                                                        */
 /* ------------------------------------------------------------------ */
@@ -358,17 +626,20 @@ static int tui_effective_width(const tui_placement_t *p, int width)
 void tui_frame_init(const tui_frame_t *f)
 {
     if (!f || f->width < 5 || f->height < 3) return;
+    ansi_ctx_t *c = tui_ctx_of(f->screen, f->parent);
+    tui_attach(f->screen, f->parent, f->row, f->col, ANSI_TUI_KIND_FRAME, f);
+
     int ar, ac;
     tui_resolve(f->parent, f->row, f->col, &ar, &ac);
-    tui_draw_border(ar, ac, f->width - 4, f->height - 2, f->color, 0);
+    tui_draw_border(c, ar, ac, f->width - 4, f->height - 2, f->color, 0);
 
     /* Overlay title on the top border row if provided */
     if (f->title && f->title[0]) {
-        tui_goto(ar, ac + 1);
+        tui_ctx_goto(c, ar, ac + 1);
         if (f->color)
-            ansi_print(" [bold %s]%s[/] ", f->color, f->title);
+            ansi_ctx_print(c, " [bold %s]%s[/] ", f->color, f->title);
         else
-            ansi_print(" [bold]%s[/] ", f->title);
+            ansi_ctx_print(c, " [bold]%s[/] ", f->title);
     }
 }
 
@@ -387,67 +658,77 @@ static int label_interior_width(const tui_label_t *w)
     return label_len + 2 + w->width;   /* "Label: " + value area */
 }
 
+/** Write a formatted value into the label's value area. */
+static void label_draw(const tui_label_t *w, const char *text)
+{
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
+    int ir, ic;
+    tui_place_pos(&w->place, w->place.col, &ir, &ic);
+    int label_len = w->label ? (int)strlen(w->label) : 0;
+    tui_ctx_goto(c, ir, ic + label_len + 2);  /* after "Label: " */
+    tui_draw_value(c, w->width, w->state ? &w->state->vis_len : NULL, text);
+}
+
 void tui_label_init(const tui_label_t *w)
 {
     if (!w) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
-    if (w->state) w->state->enabled = 1;
+    int on_screen = tui_place_attach(&w->place, ANSI_TUI_KIND_LABEL, w);
+    if (w->state) {
+        w->state->enabled = 1;
+        w->state->vis_len = 0;
+        w->state->dirty   = on_screen ? TUI_CLEAN : TUI_IMMEDIATE;
+    }
 
     int iw = label_interior_width(w);
-    tui_widget_chrome(&w->place, w->place.col, iw, w->place.color, NULL, NULL);
+    tui_widget_chrome(c, &w->place, w->place.col, iw, w->place.color, NULL, NULL);
     if (w->label) {
         if (w->place.color)
-            ansi_print("[%s]%s: [/]", w->place.color, w->label);
+            ansi_ctx_print(c, "[%s]%s: [/]", w->place.color, w->label);
         else
-            ansi_print("%s: ", w->label);
+            ansi_ctx_print(c, "%s: ", w->label);
     }
     /* Blank the value area */
-    tui_pad(w->width);
+    tui_clear(c, w->width);
 }
 
 void tui_label_update(const tui_label_t *w, const char *fmt, ...)
 {
     if (!w || !fmt) return;
     if (w->state && !w->state->enabled) return;
-
-    /* Position at value area */
-    int ir, ic;
-    tui_place_goto(&w->place, w->place.col, &ir, &ic);
-    int label_len = w->label ? (int)strlen(w->label) : 0;
-    int value_col = ic + label_len + 2;  /* after "Label: " */
-
-    /* Clear value area first, then reposition and write new value.
-       This avoids over-padding past the right border when the value
-       contains Rich markup (non-printing tags inflate strlen). */
-    tui_goto(ir, value_col);
-    tui_pad(w->width);
-
-    tui_goto(ir, value_col);
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
     va_list ap;
     va_start(ap, fmt);
-    ansi_vprint(fmt, ap);
+    const char *text = tui_format_text(c, &w->place, w->text_buf, w->text_buf_size,
+                                       w->state ? &w->state->dirty : NULL,
+                                       fmt, ap);
     va_end(ap);
+    if (text) label_draw(w, text);
 }
 
 void tui_label_enable(const tui_label_t *w, int enabled)
 {
     if (!w || !w->state) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
     w->state->enabled = enabled;
+    w->state->vis_len = 0;
+    if (w->state->dirty > TUI_CLEAN) w->state->dirty = TUI_CLEAN;
 
     int iw = label_interior_width(w);
     const char *color = enabled ? w->place.color : "dim";
-    tui_widget_chrome(&w->place, w->place.col, iw, color, NULL, NULL);
+    tui_widget_chrome(c, &w->place, w->place.col, iw, color, NULL, NULL);
     if (w->label) {
         if (enabled && w->place.color)
-            ansi_print("[%s]%s: [/]", w->place.color, w->label);
+            ansi_ctx_print(c, "[%s]%s: [/]", w->place.color, w->label);
         else if (!enabled)
-            ansi_print("[dim]%s: [/]", w->label);
+            ansi_ctx_print(c, "[dim]%s: [/]", w->label);
         else
-            ansi_print("%s: ", w->label);
+            ansi_ctx_print(c, "%s: ", w->label);
     }
     /* Blank the value area (clears stale content when disabling) */
-    tui_pad(w->width);
+    tui_clear(c, w->width);
 }
 
 #endif /* ANSI_TUI_LABEL */
@@ -465,79 +746,130 @@ static int bar_interior_width(const tui_bar_t *w)
     return label_len + w->bar_width;
 }
 
+/** Quantize a widget value with the bar math that matches tui_num_t. */
+static int bar_eighths(int width, tui_num_t value, tui_num_t min, tui_num_t max)
+{
+#if ANSI_PRINT_FLOAT
+    return ansi_bar_eighths(width, value, min, max);
+#else
+    return ansi_bar_eighths_i32(width, value, min, max);
+#endif
+}
+
+/** Draw the bar fill, rewriting only the changed cells unless forced. */
+static void bar_draw(const tui_bar_t *w,
+                     tui_num_t value, tui_num_t min, tui_num_t max, int force)
+{
+    if (!w->bar_buf) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
+
+    int eighths = bar_eighths(w->bar_width, value, min, max);
+    int first = 0, count = w->bar_width;
+
+    if (w->state) {
+        w->state->value = value;
+        w->state->min   = min;
+        w->state->max   = max;
+        if (!force) {
+            /* Skip when the rendered fill is unchanged */
+            int old = w->state->eighths;
+            if (old == eighths) return;
+            tui_bar_dirty_span(old, eighths, &first, &count);
+        }
+        w->state->eighths = eighths;
+    }
+
+    ansi_bar_span(w->bar_buf, w->bar_buf_size, w->place.color, w->track,
+                  eighths, first, count);
+
+    /* Position cursor at the first changed cell (after label) */
+    int ir, ic;
+    tui_place_pos(&w->place, w->place.col, &ir, &ic);
+    int label_len = w->label ? (int)strlen(w->label) : 0;
+
+    tui_ctx_goto(c, ir, ic + label_len + first);
+    ansi_ctx_puts(c, w->bar_buf);
+}
+
 void tui_bar_init(const tui_bar_t *w)
 {
     if (!w) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
-    if (w->state) w->state->enabled = 1;
+    int on_screen = tui_place_attach(&w->place, ANSI_TUI_KIND_BAR, w);
+    if (w->state) {
+        w->state->enabled = 1;
+        w->state->dirty   = on_screen ? TUI_CLEAN : TUI_IMMEDIATE;
+    }
 
     int iw = bar_interior_width(w);
-    tui_widget_chrome(&w->place, w->place.col, iw, w->place.color, NULL, NULL);
-    if (w->label) ansi_puts(w->label);
+    tui_widget_chrome(c, &w->place, w->place.col, iw, w->place.color, NULL, NULL);
+    if (w->label) ansi_ctx_puts(c, w->label);
 
     /* Draw empty bar (value = min = 0) */
-    tui_bar_update(w, 0.0, 0.0, 100.0, 1);
+    bar_draw(w, 0, 0, 100, 1);
 }
 
-void tui_bar_update(const tui_bar_t *w,
-                         double value, double min, double max, int force)
+/** Common body of tui_bar_update() and tui_bar_update_i32(). */
+static void bar_update(const tui_bar_t *w,
+                       tui_num_t value, tui_num_t min, tui_num_t max, int force)
 {
     if (!w || !w->bar_buf) return;
     if (w->state && !w->state->enabled) return;
 
-    if (!force && w->state &&
-        w->state->value == value &&
-        w->state->min   == min   &&
-        w->state->max   == max)
-        return;
-
-    if (w->state) {
+    if (w->state && tui_defer(&w->place, &w->state->dirty, force)) {
         w->state->value = value;
         w->state->min   = min;
         w->state->max   = max;
+        return;
     }
+    bar_draw(w, value, min, max, force);
+}
 
-    ansi_bar(w->bar_buf, w->bar_buf_size,
-             w->place.color, w->bar_width, w->track,
-             value, min, max);
-
-    /* Position cursor at bar area (after label) */
-    int ir, ic;
-    tui_place_goto(&w->place, w->place.col, &ir, &ic);
-    int label_len = w->label ? (int)strlen(w->label) : 0;
+#if ANSI_PRINT_FLOAT
+void tui_bar_update(const tui_bar_t *w,
+                    double value, double min, double max, int force)
+{
+    bar_update(w, value, min, max, force);
+}
+#endif
 
-    tui_goto(ir, ic + label_len);
-    ansi_print("%s", w->bar_buf);
+void tui_bar_update_i32(const tui_bar_t *w,
+                        int32_t value, int32_t min, int32_t max, int force)
+{
+    bar_update(w, value, min, max, force);
 }
 
 void tui_bar_enable(const tui_bar_t *w, int enabled)
 {
     if (!w || !w->state) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
     w->state->enabled = enabled;
+    if (w->state->dirty > TUI_CLEAN) w->state->dirty = TUI_CLEAN;
 
     int iw = bar_interior_width(w);
     const char *color = enabled ? w->place.color : "dim";
     int ir, ic;
-    tui_widget_chrome(&w->place, w->place.col, iw, color, &ir, &ic);
+    tui_widget_chrome(c, &w->place, w->place.col, iw, color, &ir, &ic);
     if (w->label) {
         if (!enabled)
-            ansi_print("[dim]%s[/]", w->label);
+            ansi_ctx_print(c, "[dim]%s[/]", w->label);
         else
-            ansi_puts(w->label);
+            ansi_ctx_puts(c, w->label);
     }
 
     if (enabled) {
         /* Re-render the bar with stored values */
-        w->state->enabled = 1;   /* allow update through */
-        tui_bar_update(w, w->state->value, w->state->min, w->state->max, 1);
+        bar_draw(w, w->state->value, w->state->min, w->state->max, 1);
     } else {
         /* Draw a dim empty track */
+        w->state->eighths = 0;
         if (w->bar_buf) {
-            ansi_bar(w->bar_buf, w->bar_buf_size,
-                     "dim", w->bar_width, w->track, 0.0, 0.0, 100.0);
+            ansi_bar_i32(w->bar_buf, w->bar_buf_size,
+                         "dim", w->bar_width, w->track, 0, 0, 100);
             int label_len = w->label ? (int)strlen(w->label) : 0;
-            tui_goto(ir, ic + label_len);
-            ansi_print("%s", w->bar_buf);
+            tui_ctx_goto(c, ir, ic + label_len);
+            ansi_ctx_print(c, "%s", w->bar_buf);
         }
     }
 }
@@ -557,18 +889,74 @@ static int pbar_interior_width(const tui_pbar_t *w)
     return label_len + w->bar_width + 5;   /* bar + " 100%" max */
 }
 
+/** Visible length of the " XX%" suffix for a clamped percent. */
+static int pbar_suffix_len(int pct)
+{
+    return pct >= 100 ? 5 : pct >= 10 ? 4 : 3;
+}
+
+/** Draw the bar and percent text for a clamped percent, rewriting only
+ *  what changed since the last draw unless forced. */
+static void pbar_draw(const tui_pbar_t *w, int pct, int force)
+{
+    if (!w->bar_buf) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
+
+    int eighths = ansi_bar_eighths_i32(w->bar_width, pct, 0, 100);
+    int first = 0, count = w->bar_width;
+    int old_len = 5;   /* widest suffix, " 100%" */
+
+    if (w->state) {
+        if (!force) {
+            int old = w->state->shown;
+            if (old == pct) return;
+            tui_bar_dirty_span(ansi_bar_eighths_i32(w->bar_width, old, 0, 100),
+                               eighths, &first, &count);
+            old_len = pbar_suffix_len(old);
+        }
+        w->state->percent = pct;
+        w->state->shown   = pct;
+    }
+
+    /* Position at the first changed cell (after label) */
+    int ir, ic;
+    tui_place_pos(&w->place, w->place.col, &ir, &ic);
+    int label_len = w->label ? (int)strlen(w->label) : 0;
+    int bar_col = ic + label_len;
+
+    if (count > 0) {
+        ansi_bar_span(w->bar_buf, w->bar_buf_size, w->place.color, w->track,
+                      eighths, first, count);
+        tui_ctx_goto(c, ir, bar_col + first);
+        ansi_ctx_puts(c, w->bar_buf);
+    }
+
+    /* Percent text, blanking what a longer previous suffix left behind */
+    if (count == 0 || first + count != w->bar_width)
+        tui_ctx_goto(c, ir, bar_col + w->bar_width);
+    char tmp[8];
+    int len = ansi_snprintf(tmp, sizeof(tmp), " %d%%", pct);
+    ansi_ctx_puts(c, tmp);
+    tui_clear(c, old_len - len);
+}
+
 void tui_pbar_init(const tui_pbar_t *w)
 {
     if (!w) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
-    if (w->state) w->state->enabled = 1;
+    int on_screen = tui_place_attach(&w->place, ANSI_TUI_KIND_PBAR, w);
+    if (w->state) {
+        w->state->enabled = 1;
+        w->state->dirty   = on_screen ? TUI_CLEAN : TUI_IMMEDIATE;
+    }
 
     int iw = pbar_interior_width(w);
-    tui_widget_chrome(&w->place, w->place.col, iw, w->place.color, NULL, NULL);
-    if (w->label) ansi_puts(w->label);
+    tui_widget_chrome(c, &w->place, w->place.col, iw, w->place.color, NULL, NULL);
+    if (w->label) ansi_ctx_puts(c, w->label);
 
     /* Draw empty bar (0%) */
-    tui_pbar_update(w, 0, 1);
+    pbar_draw(w, 0, 1);
 }
 
 void tui_pbar_update(const tui_pbar_t *w, int percent, int force)
@@ -577,58 +965,44 @@ void tui_pbar_update(const tui_pbar_t *w, int percent, int force)
     if (w->state && !w->state->enabled) return;
 
     int pct = percent < 0 ? 0 : percent > 100 ? 100 : percent;
-
-    if (!force && w->state && w->state->percent == pct) return;
-
-    if (w->state) w->state->percent = pct;
-
-    ansi_bar_percent(w->bar_buf, w->bar_buf_size,
-                     w->place.color, w->bar_width, w->track, pct);
-
-    /* Position cursor at bar area (after label) */
-    int ir, ic;
-    tui_place_goto(&w->place, w->place.col, &ir, &ic);
-    int label_len = w->label ? (int)strlen(w->label) : 0;
-    int bar_col = ic + label_len;
-
-    /* Clear bar + percent area, then rewrite */
-    tui_goto(ir, bar_col);
-    tui_pad(w->bar_width + 5);
-
-    tui_goto(ir, bar_col);
-    ansi_print("%s", w->bar_buf);
+    if (w->state && tui_defer(&w->place, &w->state->dirty, force)) {
+        w->state->percent = pct;
+        return;
+    }
+    pbar_draw(w, pct, force);
 }
 
 void tui_pbar_enable(const tui_pbar_t *w, int enabled)
 {
     if (!w || !w->state) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
     w->state->enabled = enabled;
+    if (w->state->dirty > TUI_CLEAN) w->state->dirty = TUI_CLEAN;
 
     int iw = pbar_interior_width(w);
     const char *color = enabled ? w->place.color : "dim";
     int ir, ic;
-    tui_widget_chrome(&w->place, w->place.col, iw, color, &ir, &ic);
+    tui_widget_chrome(c, &w->place, w->place.col, iw, color, &ir, &ic);
     if (w->label) {
         if (!enabled)
-            ansi_print("[dim]%s[/]", w->label);
+            ansi_ctx_print(c, "[dim]%s[/]", w->label);
         else
-            ansi_puts(w->label);
+            ansi_ctx_puts(c, w->label);
     }
 
     if (enabled) {
         /* Re-render the bar with stored percent */
-        w->state->enabled = 1;   /* allow update through */
-        tui_pbar_update(w, w->state->percent, 1);
+        pbar_draw(w, w->state->percent, 1);
     } else {
         /* Draw a dim empty track */
         if (w->bar_buf) {
             ansi_bar_percent(w->bar_buf, w->bar_buf_size,
                              "dim", w->bar_width, w->track, 0);
             int label_len = w->label ? (int)strlen(w->label) : 0;
-            tui_goto(ir, ic + label_len);
-            tui_pad(w->bar_width + 5);
-            tui_goto(ir, ic + label_len);
-            ansi_print("%s", w->bar_buf);
+            tui_ctx_goto(c, ir, ic + label_len);
+            tui_clear(c, w->bar_width + 5);
+            tui_ctx_goto(c, ir, ic + label_len);
+            ansi_ctx_print(c, "%s", w->bar_buf);
         }
     }
 }
@@ -641,16 +1015,32 @@ void tui_pbar_enable(const tui_pbar_t *w, int enabled)
 
 #if ANSI_TUI_STATUS
 
+/** Write formatted text into the status field. */
+static void status_draw(const tui_status_t *w, const char *text)
+{
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
+    int ew = tui_effective_width(&w->place, w->width);
+    int col = tui_center_col(w->place.col, w->place.parent, ew, w->place.border);
+    tui_place_goto(c, &w->place, col, NULL, NULL);
+    tui_draw_value(c, ew, w->state ? &w->state->vis_len : NULL, text);
+}
+
 void tui_status_init(const tui_status_t *w)
 {
     if (!w) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
-    if (w->state) w->state->enabled = 1;
+    int on_screen = tui_place_attach(&w->place, ANSI_TUI_KIND_STATUS, w);
+    if (w->state) {
+        w->state->enabled = 1;
+        w->state->vis_len = 0;
+        w->state->dirty   = on_screen ? TUI_CLEAN : TUI_IMMEDIATE;
+    }
 
     int ew = tui_effective_width(&w->place, w->width);
     int col = tui_center_col(w->place.col, w->place.parent, ew, w->place.border);
-    tui_widget_chrome(&w->place, col, ew, w->place.color, NULL, NULL);
-    tui_pad(ew);
+    tui_widget_chrome(c, &w->place, col, ew, w->place.color, NULL, NULL);
+    tui_clear(c, ew);
 }
 
 void tui_status_update(const tui_status_t *w,
@@ -658,33 +1048,30 @@ void tui_status_update(const tui_status_t *w,
 {
     if (!w || !fmt) return;
     if (w->state && !w->state->enabled) return;
-
-    int ew = tui_effective_width(&w->place, w->width);
-    int col = tui_center_col(w->place.col, w->place.parent, ew, w->place.border);
-    int ir, ic;
-    tui_place_goto(&w->place, col, &ir, &ic);
-
-    /* Clear interior first, then reposition and write new text */
-    tui_pad(ew);
-
-    tui_goto(ir, ic);
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
     va_list ap;
     va_start(ap, fmt);
-    ansi_vprint(fmt, ap);
+    const char *text = tui_format_text(c, &w->place, w->text_buf, w->text_buf_size,
+                                       w->state ? &w->state->dirty : NULL,
+                                       fmt, ap);
     va_end(ap);
+    if (text) status_draw(w, text);
 }
 
 void tui_status_enable(const tui_status_t *w, int enabled)
 {
     if (!w || !w->state) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
     w->state->enabled = enabled;
+    w->state->vis_len = 0;
+    if (w->state->dirty > TUI_CLEAN) w->state->dirty = TUI_CLEAN;
 
     int ew = tui_effective_width(&w->place, w->width);
     int col = tui_center_col(w->place.col, w->place.parent, ew, w->place.border);
     const char *color = enabled ? w->place.color : "dim";
-    tui_widget_chrome(&w->place, col, ew, color, NULL, NULL);
-    tui_pad(ew);
+    tui_widget_chrome(c, &w->place, col, ew, color, NULL, NULL);
+    tui_clear(c, ew);
 }
 
 #endif /* ANSI_TUI_STATUS */
@@ -695,49 +1082,62 @@ void tui_status_enable(const tui_status_t *w, int enabled)
 
 #if ANSI_TUI_TEXT
 
+/** Write formatted text into the text widget. */
+static void text_draw(const tui_text_t *w, const char *text)
+{
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
+    int ew = tui_effective_width(&w->place, w->width);
+    int col = tui_center_col(w->place.col, w->place.parent, ew, w->place.border);
+    tui_place_goto(c, &w->place, col, NULL, NULL);
+    tui_draw_value(c, ew, w->state ? &w->state->vis_len : NULL, text);
+}
+
 void tui_text_init(const tui_text_t *w)
 {
     if (!w) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
-    if (w->state) w->state->enabled = 1;
+    int on_screen = tui_place_attach(&w->place, ANSI_TUI_KIND_TEXT, w);
+    if (w->state) {
+        w->state->enabled = 1;
+        w->state->vis_len = 0;
+        w->state->dirty   = on_screen ? TUI_CLEAN : TUI_IMMEDIATE;
+    }
 
     int ew = tui_effective_width(&w->place, w->width);
     int col = tui_center_col(w->place.col, w->place.parent, ew, w->place.border);
-    tui_widget_chrome(&w->place, col, ew, w->place.color, NULL, NULL);
-    tui_pad(ew);
+    tui_widget_chrome(c, &w->place, col, ew, w->place.color, NULL, NULL);
+    tui_clear(c, ew);
 }
 
 void tui_text_update(const tui_text_t *w, const char *fmt, ...)
 {
     if (!w || !fmt) return;
     if (w->state && !w->state->enabled) return;
-
-    int ew = tui_effective_width(&w->place, w->width);
-    int col = tui_center_col(w->place.col, w->place.parent, ew, w->place.border);
-    int ir, ic;
-    tui_place_goto(&w->place, col, &ir, &ic);
-
-    /* Clear interior first, then reposition and write new text */
-    tui_pad(ew);
-
-    tui_goto(ir, ic);
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
     va_list ap;
     va_start(ap, fmt);
-    ansi_vprint(fmt, ap);
+    const char *text = tui_format_text(c, &w->place, w->text_buf, w->text_buf_size,
+                                       w->state ? &w->state->dirty : NULL,
+                                       fmt, ap);
     va_end(ap);
+    if (text) text_draw(w, text);
 }
 
 void tui_text_enable(const tui_text_t *w, int enabled)
 {
     if (!w || !w->state) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
     w->state->enabled = enabled;
+    w->state->vis_len = 0;
+    if (w->state->dirty > TUI_CLEAN) w->state->dirty = TUI_CLEAN;
 
     int ew = tui_effective_width(&w->place, w->width);
     int col = tui_center_col(w->place.col, w->place.parent, ew, w->place.border);
     const char *color = enabled ? w->place.color : "dim";
-    tui_widget_chrome(&w->place, col, ew, color, NULL, NULL);
-    tui_pad(ew);
+    tui_widget_chrome(c, &w->place, col, ew, color, NULL, NULL);
+    tui_clear(c, ew);
 }
 
 #endif /* ANSI_TUI_TEXT */
@@ -755,21 +1155,33 @@ static int check_interior_width(const tui_check_t *w)
     return 2 + 1 + label_len;   /* emoji(2 cols) + space + label */
 }
 
+/** Overwrite just the emoji indicator. */
+static void check_draw(const tui_check_t *w, int state)
+{
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
+    if (w->state) w->state->checked = state;
+    tui_place_goto(c, &w->place, w->place.col, NULL, NULL);
+    ansi_ctx_puts(c, state ? "[green]:check:[/]" : "[red]:cross:[/]");
+}
+
 void tui_check_init(const tui_check_t *w, int state)
 {
     if (!w) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
+    int on_screen = tui_place_attach(&w->place, ANSI_TUI_KIND_CHECK, w);
     if (w->state) {
         w->state->enabled = 1;
         w->state->checked = state;
+        w->state->dirty   = on_screen ? TUI_CLEAN : TUI_IMMEDIATE;
     }
 
     int iw = w->width > 0 ? w->width : check_interior_width(w);
-    tui_widget_chrome(&w->place, w->place.col, iw, w->place.color, NULL, NULL);
-    ansi_puts(state ? "[green]:check:[/]" : "[red]:cross:[/]");
+    tui_widget_chrome(c, &w->place, w->place.col, iw, w->place.color, NULL, NULL);
+    ansi_ctx_puts(c, state ? "[green]:check:[/]" : "[red]:cross:[/]");
     if (w->label) {
-        ansi_puts(" ");
-        ansi_puts(w->label);
+        ansi_ctx_puts(c, " ");
+        ansi_ctx_puts(c, w->label);
     }
 }
 
@@ -780,11 +1192,11 @@ void tui_check_update(const tui_check_t *w, int state, int force)
 
     if (!force && w->state && w->state->checked == state) return;
 
-    if (w->state) w->state->checked = state;
-
-    /* Overwrite just the emoji indicator */
-    tui_place_goto(&w->place, w->place.col, NULL, NULL);
-    ansi_puts(state ? "[green]:check:[/]" : "[red]:cross:[/]");
+    if (w->state && tui_defer(&w->place, &w->state->dirty, force)) {
+        w->state->checked = state;
+        return;
+    }
+    check_draw(w, state);
 }
 
 void tui_check_toggle(const tui_check_t *w)
@@ -796,24 +1208,26 @@ void tui_check_toggle(const tui_check_t *w)
 void tui_check_enable(const tui_check_t *w, int enabled)
 {
     if (!w || !w->state) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
     w->state->enabled = enabled;
+    if (w->state->dirty > TUI_CLEAN) w->state->dirty = TUI_CLEAN;
 
     int iw = w->width > 0 ? w->width : check_interior_width(w);
     const char *color = enabled ? w->place.color : "dim";
-    tui_widget_chrome(&w->place, w->place.col, iw, color, NULL, NULL);
+    tui_widget_chrome(c, &w->place, w->place.col, iw, color, NULL, NULL);
     if (enabled) {
         /* Restore from stored state */
-        ansi_puts(w->state->checked ? "[green]:check:[/]" : "[red]:cross:[/]");
+        ansi_ctx_puts(c, w->state->checked ? "[green]:check:[/]" : "[red]:cross:[/]");
     } else {
         /* Dim indicator */
-        ansi_puts("[dim]:cross:[/]");
+        ansi_ctx_puts(c, "[dim]:cross:[/]");
     }
     if (w->label) {
-        ansi_puts(" ");
+        ansi_ctx_puts(c, " ");
         if (!enabled)
-            ansi_print("[dim]%s[/]", w->label);
+            ansi_ctx_print(c, "[dim]%s[/]", w->label);
         else
-            ansi_puts(w->label);
+            ansi_ctx_puts(c, w->label);
     }
 }
 
@@ -835,28 +1249,65 @@ static int ebar_interior_width(const tui_ebar_t *w)
     int suffix_len = 0;
     if (w->show_value) {
         char tmp[16];
-        suffix_len = snprintf(tmp, sizeof(tmp), " %d/%d", w->count, w->count);
+        suffix_len = ansi_snprintf(tmp, sizeof(tmp), " %d/%d", w->count, w->count);
     }
     return label_len + emoji_area + suffix_len;
 }
 
+/** Draw the slots and optional suffix for a clamped value. */
+static void ebar_draw(const tui_ebar_t *w, int value)
+{
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
+    if (w->state) w->state->value = value;
+
+    /* Position cursor after label */
+    int ir, ic;
+    tui_place_goto(c, &w->place, w->place.col, &ir, &ic);
+    int label_len = w->label ? (int)strlen(w->label) : 0;
+    tui_ctx_goto(c, ir, ic + label_len);
+
+    /* Emit filled and empty slots */
+    for (int i = 0; i < w->count; i++) {
+        if (i < value) {
+            ansi_ctx_print(c, "%s", w->emoji[i]);
+        } else if (w->empty) {
+            ansi_ctx_print(c, "%s", w->empty);
+        } else {
+            tui_pad(c, w->slot_width);
+        }
+    }
+
+    /* Emit value/count suffix */
+    if (w->show_value) {
+        char tmp[16];
+        int max_len = ansi_snprintf(tmp, sizeof(tmp), " %d/%d", w->count, w->count);
+        int cur_len = ansi_snprintf(tmp, sizeof(tmp), " %d/%d", value, w->count);
+        ansi_ctx_puts(c, tmp);
+        /* Pad to max width so border stays clean */
+        tui_clear(c, max_len - cur_len);
+    }
+}
+
 void tui_ebar_init(const tui_ebar_t *w)
 {
     if (!w) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
+    int on_screen = tui_place_attach(&w->place, ANSI_TUI_KIND_EBAR, w);
     if (w->state) {
         w->state->enabled = 1;
         w->state->value   = 0;
+        w->state->dirty   = on_screen ? TUI_CLEAN : TUI_IMMEDIATE;
     }
 
     int iw = ebar_interior_width(w);
-    tui_widget_chrome(&w->place, w->place.col, iw, w->place.color, NULL, NULL);
+    tui_widget_chrome(c, &w->place, w->place.col, iw, w->place.color, NULL, NULL);
 
     /* Draw label prefix */
-    if (w->label) ansi_puts(w->label);
+    if (w->label) ansi_ctx_puts(c, w->label);
 
     /* Initial draw with value 0 */
-    tui_ebar_update(w, 0, 1);
+    ebar_draw(w, 0);
 }
 
 void tui_ebar_update(const tui_ebar_t *w, int value, int force)
@@ -871,65 +1322,42 @@ void tui_ebar_update(const tui_ebar_t *w, int value, int force)
     /* Skip if unchanged */
     if (!force && w->state && w->state->value == value) return;
 
-    if (w->state) w->state->value = value;
-
-    /* Position cursor after label */
-    int ir, ic;
-    tui_place_goto(&w->place, w->place.col, &ir, &ic);
-    int label_len = w->label ? (int)strlen(w->label) : 0;
-    tui_goto(ir, ic + label_len);
-
-    /* Emit filled and empty slots */
-    for (int i = 0; i < w->count; i++) {
-        if (i < value) {
-            ansi_print("%s", w->emoji[i]);
-        } else if (w->empty) {
-            ansi_print("%s", w->empty);
-        } else {
-            tui_pad(w->slot_width);
-        }
-    }
-
-    /* Emit value/count suffix */
-    if (w->show_value) {
-        char tmp[16];
-        int max_len = snprintf(tmp, sizeof(tmp), " %d/%d", w->count, w->count);
-        int cur_len = snprintf(tmp, sizeof(tmp), " %d/%d", value, w->count);
-        ansi_puts(tmp);
-        /* Pad to max width so border stays clean */
-        tui_pad(max_len - cur_len);
+    if (w->state && tui_defer(&w->place, &w->state->dirty, force)) {
+        w->state->value = value;
+        return;
     }
+    ebar_draw(w, value);
 }
 
 void tui_ebar_enable(const tui_ebar_t *w, int enabled)
 {
     if (!w || !w->state) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
     w->state->enabled = enabled;
+    if (w->state->dirty > TUI_CLEAN) w->state->dirty = TUI_CLEAN;
 
     int iw = ebar_interior_width(w);
     const char *color = enabled ? w->place.color : "dim";
-    tui_widget_chrome(&w->place, w->place.col, iw, color, NULL, NULL);
+    tui_widget_chrome(c, &w->place, w->place.col, iw, color, NULL, NULL);
 
     if (w->label) {
         if (!enabled)
-            ansi_print("[dim]%s[/]", w->label);
+            ansi_ctx_print(c, "[dim]%s[/]", w->label);
         else
-            ansi_puts(w->label);
+            ansi_ctx_puts(c, w->label);
     }
 
     if (enabled) {
         /* Restore from stored state */
-        w->state->enabled = 1;  /* allow update through */
-        tui_ebar_update(w, w->state->value, 1);
+        ebar_draw(w, w->state->value);
     } else {
-        /* Dim all slots */
-        for (int i = 0; i < w->count; i++)
-            tui_pad(w->slot_width);
+        /* Blank all slots and the value suffix in one run */
+        int n = w->count * w->slot_width;
         if (w->show_value) {
             char tmp[16];
-            int max_len = snprintf(tmp, sizeof(tmp), " %d/%d", w->count, w->count);
-            tui_pad(max_len);
+            n += ansi_snprintf(tmp, sizeof(tmp), " %d/%d", w->count, w->count);
         }
+        tui_clear(c, n);
     }
 }
 
@@ -942,13 +1370,24 @@ void tui_ebar_enable(const tui_ebar_t *w, int enabled)
 #if ANSI_TUI_METRIC
 
 /** Determine which zone a value falls in. */
-static int metric_zone(const tui_metric_t *w, double value)
+static int metric_zone(const tui_metric_t *w, tui_num_t value)
 {
     if (value < w->thresh_lo) return -1;
     if (value > w->thresh_hi) return  1;
     return 0;
 }
 
+/** Format a value through w->fmt (a long when ANSI_PRINT_FLOAT is 0). */
+static void metric_format(const tui_metric_t *w, tui_num_t value,
+                          char *buf, size_t size)
+{
+#if ANSI_PRINT_FLOAT
+    ansi_snprintf(buf, size, w->fmt, value);
+#else
+    ansi_snprintf(buf, size, w->fmt, (long)value);
+#endif
+}
+
 /** Return the color string for a given zone. */
 static const char *metric_color(const tui_metric_t *w, int zone)
 {
@@ -960,27 +1399,25 @@ static const char *metric_color(const tui_metric_t *w, int zone)
 }
 
 /** Center a title on the top border row of a metric widget. */
-static void metric_draw_title(const tui_metric_t *w,
+static void metric_draw_title(ansi_ctx_t *c, const tui_metric_t *w,
                                int ar, int ac, int iw, const char *color)
 {
     if (!w->title || !w->title[0]) return;
     int title_len = (int)strlen(w->title);
     int offset = (iw + 2 - title_len - 2) / 2;  /* center in hz span */
     if (offset < 0) offset = 0;
-    tui_goto(ar, ac + 1 + offset);
+    tui_ctx_goto(c, ar, ac + 1 + offset);
     if (color)
-        ansi_print(" [bold %s]%s[/] ", color, w->title);
+        ansi_ctx_print(c, " [bold %s]%s[/] ", color, w->title);
     else
-        ansi_print(" [bold]%s[/] ", w->title);
+        ansi_ctx_print(c, " [bold]%s[/] ", w->title);
 }
 
-/** Draw the metric value as colored foreground text, centered in the interior.
+/** Draw the metric value text as colored foreground, centered in the interior.
  *  Pads to iw+2 chars at ac+1 to clear the full span between borders. */
-static void metric_draw_value(const tui_metric_t *w, int ar, int ac,
-                               int iw, double value, const char *zone_color)
+static void metric_draw_value(ansi_ctx_t *c, int ar, int ac, int iw,
+                               const char *vbuf, const char *zone_color)
 {
-    char vbuf[64];
-    snprintf(vbuf, sizeof(vbuf), w->fmt, value);
     int vlen = (int)strlen(vbuf);
     int fill = iw + 2;
     int left_pad = (fill - vlen) / 2;
@@ -988,20 +1425,24 @@ static void metric_draw_value(const tui_metric_t *w, int ar, int ac,
     int right_pad = fill - vlen - left_pad;
     if (right_pad < 0) right_pad = 0;
 
-    tui_goto(ar + 1, ac + 1);
-    ansi_print("%*s[%s]%s[/]%*s",
+    tui_ctx_goto(c, ar + 1, ac + 1);
+    ansi_ctx_print(c, "%*s[%s]%s[/]%*s",
                left_pad, "", zone_color, vbuf, right_pad, "");
 }
 
 void tui_metric_init(const tui_metric_t *w)
 {
     if (!w) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
 
     const char *color = w->place.color;
+    int on_screen = tui_place_attach(&w->place, ANSI_TUI_KIND_METRIC, w);
     if (w->state) {
         w->state->enabled = 1;
-        w->state->value   = 0.0;
+        w->state->value   = 0;
         w->state->zone    = 0;
+        w->state->digest  = 0;
+        w->state->dirty   = on_screen ? TUI_CLEAN : TUI_IMMEDIATE;
     }
 
     int ew = tui_effective_width(&w->place, w->width);
@@ -1009,24 +1450,34 @@ void tui_metric_init(const tui_metric_t *w)
     int ar, ac;
     tui_resolve(w->place.parent, w->place.row, col, &ar, &ac);
 
-    tui_draw_border(ar, ac, ew, 1, color, 0);
-    metric_draw_title(w, ar, ac, ew, color);
+    tui_draw_border(c, ar, ac, ew, 1, color, 0);
+    metric_draw_title(c, w, ar, ac, ew, color);
 
     /* Blank the interior */
-    tui_goto(ar + 1, ac + 1);
-    tui_pad(ew + 2);
+    tui_ctx_goto(c, ar + 1, ac + 1);
+    tui_clear(c, ew + 2);
 }
 
-void tui_metric_update(const tui_metric_t *w, double value, int force)
+/** Draw the value (and the border when the zone changed), skipping
+ *  unchanged text unless forced. */
+static void metric_draw(const tui_metric_t *w, tui_num_t value, int force)
 {
-    if (!w) return;
-    if (w->state && !w->state->enabled) return;
-
-    if (!force && w->state && w->state->value == value) return;
-
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
     int zone = metric_zone(w, value);
     const char *color = metric_color(w, zone);
 
+    /* Compare the rendered text, not the raw value: a noisy input that
+       still formats identically through w->fmt produces no output. */
+    char vbuf[64];
+    metric_format(w, value, vbuf, sizeof(vbuf));
+    uint32_t digest = tui_digest(vbuf);
+    if (w->state) {
+        w->state->value = value;
+        if (!force && w->state->digest == digest && w->state->zone == zone)
+            return;
+        w->state->digest = digest;
+    }
+
     int ew = tui_effective_width(&w->place, w->width);
     int col = tui_center_col(w->place.col, w->place.parent, ew, w->place.border);
     int ar, ac;
@@ -1037,22 +1488,35 @@ void tui_metric_update(const tui_metric_t *w, double value, int force)
     if (w->state) {
         if (!need_border) need_border = (zone != w->state->zone);
         w->state->zone  = zone;
-        w->state->value = value;
     } else {
         need_border = 1;
     }
     if (need_border) {
-        tui_draw_border(ar, ac, ew, 1, color, 0);
-        metric_draw_title(w, ar, ac, ew, color);
+        tui_draw_border(c, ar, ac, ew, 1, color, 0);
+        metric_draw_title(c, w, ar, ac, ew, color);
     }
 
-    metric_draw_value(w, ar, ac, ew, value, color);
+    metric_draw_value(c, ar, ac, ew, vbuf, color);
+}
+
+void tui_metric_update(const tui_metric_t *w, tui_num_t value, int force)
+{
+    if (!w) return;
+    if (w->state && !w->state->enabled) return;
+
+    if (w->state && tui_defer(&w->place, &w->state->dirty, force)) {
+        w->state->value = value;
+        return;
+    }
+    metric_draw(w, value, force);
 }
 
 void tui_metric_enable(const tui_metric_t *w, int enabled)
 {
     if (!w || !w->state) return;
+    ansi_ctx_t *c = tui_place_ctx(&w->place);
     w->state->enabled = enabled;
+    if (w->state->dirty > TUI_CLEAN) w->state->dirty = TUI_CLEAN;
 
     int ew = tui_effective_width(&w->place, w->width);
     int col = tui_center_col(w->place.col, w->place.parent, ew, w->place.border);
@@ -1060,15 +1524,746 @@ void tui_metric_enable(const tui_metric_t *w, int enabled)
     tui_resolve(w->place.parent, w->place.row, col, &ar, &ac);
 
     if (enabled) {
-        /* Force zone mismatch so update redraws border */
+        /* Force zone mismatch so the draw redraws the border */
         w->state->zone = -2;
-        tui_metric_update(w, w->state->value, 1);
+        metric_draw(w, w->state->value, 1);
     } else {
-        tui_draw_border(ar, ac, ew, 1, "dim", 0);
-        metric_draw_title(w, ar, ac, ew, "dim");
-        tui_goto(ar + 1, ac + 1);
-        tui_pad(ew + 2);
+        w->state->digest = 0;
+        tui_draw_border(c, ar, ac, ew, 1, "dim", 0);
+        metric_draw_title(c, w, ar, ac, ew, "dim");
+        tui_ctx_goto(c, ar + 1, ac + 1);
+        tui_clear(c, ew + 2);
     }
 }
 
 #endif /* ANSI_TUI_METRIC */
+
+/* ------------------------------------------------------------------ */
+/* Screen registry                                                     */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_TUI_SCREEN
+
+void tui_screen_init(tui_screen_t *s, tui_screen_entry_t *entries,
+                     int capacity)
+{
+    if (!s) return;
+    memset(s, 0, sizeof(*s));
+    s->entries  = entries;
+    s->capacity = entries && capacity > 0 ? capacity : 0;
+}
+
+void tui_screen_set_ctx(tui_screen_t *s, ansi_ctx_t *ctx)
+{
+    if (s) s->ctx = ctx;
+}
+
+void tui_screen_set_ready(tui_screen_t *s, int (*ready)(void *user), void *user)
+{
+    if (!s) return;
+    s->ready      = ready;
+    s->ready_user = user;
+}
+
+void tui_screen_set_wake(tui_screen_t *s, void (*wake)(void *user), void *user)
+{
+    if (!s) return;
+    s->wake      = wake;
+    s->wake_user = user;
+}
+
+#if ANSI_TUI_BUDGET
+void tui_screen_set_budget(tui_screen_t *s, uint32_t bytes_per_sec)
+{
+    if (!s) return;
+    s->budget_bps = bytes_per_sec;
+    s->credited   = 0;
+}
+#endif
+
+void tui_screen_set_fps(tui_screen_t *s, int fps)
+{
+    if (!s) return;
+    s->frame_ms = fps > 0 ? (uint32_t)((1000 + fps - 1) / fps) : 0;
+}
+
+/** Return a registered widget's screen render state, or NULL (frames
+ *  and widgets without state never defer). */
+static int *screen_entry_dirty(const tui_screen_entry_t *e)
+{
+    switch (e->kind) {
+#if ANSI_TUI_LABEL
+    case ANSI_TUI_KIND_LABEL: {
+        const tui_label_t *w = (const tui_label_t *)e->widget;
+        return w->state ? &w->state->dirty : NULL;
+    }
+#endif
+#if ANSI_TUI_BAR
+    case ANSI_TUI_KIND_BAR: {
+        const tui_bar_t *w = (const tui_bar_t *)e->widget;
+        return w->state ? &w->state->dirty : NULL;
+    }
+#endif
+#if ANSI_TUI_PBAR
+    case ANSI_TUI_KIND_PBAR: {
+        const tui_pbar_t *w = (const tui_pbar_t *)e->widget;
+        return w->state ? &w->state->dirty : NULL;
+    }
+#endif
+#if ANSI_TUI_STATUS
+    case ANSI_TUI_KIND_STATUS: {
+        const tui_status_t *w = (const tui_status_t *)e->widget;
+        return w->state ? &w->state->dirty : NULL;
+    }
+#endif
+#if ANSI_TUI_TEXT
+    case ANSI_TUI_KIND_TEXT: {
+        const tui_text_t *w = (const tui_text_t *)e->widget;
+        return w->state ? &w->state->dirty : NULL;
+    }
+#endif
+#if ANSI_TUI_CHECK
+    case ANSI_TUI_KIND_CHECK: {
+        const tui_check_t *w = (const tui_check_t *)e->widget;
+        return w->state ? &w->state->dirty : NULL;
+    }
+#endif
+#if ANSI_TUI_EBAR
+    case ANSI_TUI_KIND_EBAR: {
+        const tui_ebar_t *w = (const tui_ebar_t *)e->widget;
+        return w->state ? &w->state->dirty : NULL;
+    }
+#endif
+#if ANSI_TUI_METRIC
+    case ANSI_TUI_KIND_METRIC: {
+        const tui_metric_t *w = (const tui_metric_t *)e->widget;
+        return w->state ? &w->state->dirty : NULL;
+    }
+#endif
+    default:
+        return NULL;
+    }
+}
+
+/** Draw a dirty widget from the value its deferred update stored. */
+static void screen_entry_draw(const tui_screen_entry_t *e, int force)
+{
+    switch (e->kind) {
+#if ANSI_TUI_LABEL
+    case ANSI_TUI_KIND_LABEL: {
+        const tui_label_t *w = (const tui_label_t *)e->widget;
+        label_draw(w, w->text_buf);
+        break;
+    }
+#endif
+#if ANSI_TUI_BAR
+    case ANSI_TUI_KIND_BAR: {
+        const tui_bar_t *w = (const tui_bar_t *)e->widget;
+        bar_draw(w, w->state->value, w->state->min, w->state->max, force);
+        break;
+    }
+#endif
+#if ANSI_TUI_PBAR
+    case ANSI_TUI_KIND_PBAR: {
+        const tui_pbar_t *w = (const tui_pbar_t *)e->widget;
+        pbar_draw(w, w->state->percent, force);
+        break;
+    }
+#endif
+#if ANSI_TUI_STATUS
+    case ANSI_TUI_KIND_STATUS: {
+        const tui_status_t *w = (const tui_status_t *)e->widget;
+        status_draw(w, w->text_buf);
+        break;
+    }
+#endif
+#if ANSI_TUI_TEXT
+    case ANSI_TUI_KIND_TEXT: {
+        const tui_text_t *w = (const tui_text_t *)e->widget;
+        text_draw(w, w->text_buf);
+        break;
+    }
+#endif
+#if ANSI_TUI_CHECK
+    case ANSI_TUI_KIND_CHECK: {
+        const tui_check_t *w = (const tui_check_t *)e->widget;
+        check_draw(w, w->state->checked);
+        break;
+    }
+#endif
+#if ANSI_TUI_EBAR
+    case ANSI_TUI_KIND_EBAR: {
+        const tui_ebar_t *w = (const tui_ebar_t *)e->widget;
+        ebar_draw(w, w->state->value);
+        break;
+    }
+#endif
+#if ANSI_TUI_METRIC
+    case ANSI_TUI_KIND_METRIC: {
+        const tui_metric_t *w = (const tui_metric_t *)e->widget;
+        metric_draw(w, w->state->value, force);
+        break;
+    }
+#endif
+    default:
+        (void)force;
+        break;
+    }
+}
+
+/** Redraw a widget's chrome and value from scratch (state restored via
+ *  the enable path, stateless widgets re-initialized). */
+static void screen_entry_redraw(const tui_screen_entry_t *e)
+{
+    switch (e->kind) {
+#if ANSI_TUI_LABEL
+    case ANSI_TUI_KIND_LABEL: {
+        const tui_label_t *w = (const tui_label_t *)e->widget;
+        if (!w->state) { tui_label_init(w); break; }
+        tui_label_enable(w, w->state->enabled);
+        if (w->state->enabled && w->text_buf && w->text_buf[0])
+            label_draw(w, w->text_buf);
+        break;
+    }
+#endif
+#if ANSI_TUI_BAR
+    case ANSI_TUI_KIND_BAR: {
+        const tui_bar_t *w = (const tui_bar_t *)e->widget;
+        if (w->state) tui_bar_enable(w, w->state->enabled);
+        else          tui_bar_init(w);
+        break;
+    }
+#endif
+#if ANSI_TUI_PBAR
+    case ANSI_TUI_KIND_PBAR: {
+        const tui_pbar_t *w = (const tui_pbar_t *)e->widget;
+        if (w->state) tui_pbar_enable(w, w->state->enabled);
+        else          tui_pbar_init(w);
+        break;
+    }
+#endif
+#if ANSI_TUI_STATUS
+    case ANSI_TUI_KIND_STATUS: {
+        const tui_status_t *w = (const tui_status_t *)e->widget;
+        if (!w->state) { tui_status_init(w); break; }
+        tui_status_enable(w, w->state->enabled);
+        if (w->state->enabled && w->text_buf && w->text_buf[0])
+            status_draw(w, w->text_buf);
+        break;
+    }
+#endif
+#if ANSI_TUI_TEXT
+    case ANSI_TUI_KIND_TEXT: {
+        const tui_text_t *w = (const tui_text_t *)e->widget;
+        if (!w->state) { tui_text_init(w); break; }
+        tui_text_enable(w, w->state->enabled);
+        if (w->state->enabled && w->text_buf && w->text_buf[0])
+            text_draw(w, w->text_buf);
+        break;
+    }
+#endif
+#if ANSI_TUI_CHECK
+    case ANSI_TUI_KIND_CHECK: {
+        const tui_check_t *w = (const tui_check_t *)e->widget;
+        if (w->state) tui_check_enable(w, w->state->enabled);
+        else          tui_check_init(w, 0);
+        break;
+    }
+#endif
+#if ANSI_TUI_EBAR
+    case ANSI_TUI_KIND_EBAR: {
+        const tui_ebar_t *w = (const tui_ebar_t *)e->widget;
+        if (w->state) tui_ebar_enable(w, w->state->enabled);
+        else          tui_ebar_init(w);
+        break;
+    }
+#endif
+#if ANSI_TUI_METRIC
+    case ANSI_TUI_KIND_METRIC: {
+        const tui_metric_t *w = (const tui_metric_t *)e->widget;
+        if (w->state) tui_metric_enable(w, w->state->enabled);
+        else          tui_metric_init(w);
+        break;
+    }
+#endif
+    default:
+        break;
+    }
+}
+
+/** Entry still waiting to be drawn by a render pass. */
+static int *screen_entry_pending(const tui_screen_entry_t *e)
+{
+    int *dirty = screen_entry_dirty(e);
+    return dirty && *dirty >= TUI_CHANGED ? dirty : NULL;
+}
+
+int tui_screen_dirty(const tui_screen_t *s)
+{
+    if (!s) return 0;
+    int n = 0;
+    for (int i = 0; i < s->count; i++)
+        if (screen_entry_pending(&s->entries[i])) n++;
+    return n;
+}
+
+/** Draw one dirty entry, opening the frame transaction on the first. */
+static void screen_draw_dirty(ansi_ctx_t *c, const tui_screen_entry_t *e,
+                              int *dirty, int drawn)
+{
+    if (drawn == 0) {
+        ansi_ctx_batch_begin(c);
+        tui_ctx_sync_begin(c);
+    }
+    int force = *dirty == TUI_FORCED;
+    *dirty = TUI_CLEAN;
+    screen_entry_draw(e, force);
+}
+
+#if ANSI_TUI_BUDGET
+
+/** Accrue credit for the time since the last tick, capped at the burst. */
+static void budget_accrue(tui_screen_t *s, uint32_t now_ms)
+{
+    int64_t cap = (int64_t)s->budget_bps * ANSI_TUI_BUDGET_BURST_MS / 1000;
+    if (cap < 1) cap = 1;
+    if (!s->credited) {
+        s->credit    = (int32_t)(cap > INT32_MAX ? INT32_MAX : cap);
+        s->credit_ms = now_ms;
+        s->credited  = 1;
+        return;
+    }
+    uint32_t dt  = now_ms - s->credit_ms;
+    int64_t  add = (int64_t)dt * s->budget_bps / 1000;
+    int64_t  c   = s->credit + add;
+    if (c >= cap) {
+        c = cap;
+        s->credit_ms = now_ms;
+    } else {
+        /* Advance only by the time actually converted, keeping the
+           fraction of a byte for the next tick */
+        s->credit_ms += (uint32_t)(add * 1000 / s->budget_bps);
+    }
+    s->credit = (int32_t)c;
+}
+
+/** Draw dirty widgets by priority while the credit lasts. */
+static int screen_render_budget(tui_screen_t *s, ansi_ctx_t *c, uint32_t now_ms)
+{
+    unsigned long start = ansi_ctx_bytes(c);
+    int drawn = 0, full = 0, level = 256;
+
+    budget_accrue(s, now_ms);
+    s->stats.deferred       = 0;
+    s->stats.frame_stale_ms = 0;
+
+    for (;;) {
+        /* Next lower priority level that still has dirty widgets */
+        int next = -1;
+        for (int i = 0; i < s->count; i++) {
+            const tui_screen_entry_t *e = &s->entries[i];
+            if (!screen_entry_pending(e)) continue;   /* frames have no placement */
+            int p = ((const tui_placement_t *)e->widget)->priority;
+            if (p < level && p > next) next = p;
+        }
+        if (next < 0) break;
+        level = next;
+
+        for (int i = 0; i < s->count; i++) {
+            tui_screen_entry_t *e = &s->entries[i];
+            int *dirty = screen_entry_pending(e);
+            if (!dirty || ((const tui_placement_t *)e->widget)->priority != level)
+                continue;
+
+            int64_t left = (int64_t)s->credit - (int64_t)(ansi_ctx_bytes(c) - start);
+            int64_t cost = e->cost ? e->cost : ANSI_TUI_BUDGET_COST;
+            if (full || (cost > left && (drawn || left < 0))) {
+                /* Out of budget: later widgets wait too, so priority holds */
+                full = 1;
+                if (!e->waiting) {
+                    e->waiting = 1;
+                    e->since   = now_ms;
+                }
+                s->stats.deferred++;
+                continue;
+            }
+
+            unsigned long before = ansi_ctx_bytes(c);
+            screen_draw_dirty(c, e, dirty, drawn);
+            unsigned long spent = ansi_ctx_bytes(c) - before;
+            e->cost = (uint16_t)(spent > 0xFFFF ? 0xFFFF : spent);
+            if (e->waiting) {
+                uint32_t stale = now_ms - e->since;
+                if (stale > s->stats.frame_stale_ms) s->stats.frame_stale_ms = stale;
+                if (stale > s->stats.stale_max_ms)   s->stats.stale_max_ms   = stale;
+                e->waiting = 0;
+            }
+            drawn++;
+        }
+    }
+    return drawn;
+}
+
+#endif /* ANSI_TUI_BUDGET */
+
+/** Render pass shared by tui_screen_render() and tui_tick(). */
+static int screen_render(tui_screen_t *s, uint32_t now_ms, int budgeted)
+{
+    if (!s) return 0;
+    ansi_ctx_t *c = s->ctx ? s->ctx : ansi_default_ctx();
+
+    if (s->ready) {
+        int dirty_any = 0;
+        for (int i = 0; i < s->count && !dirty_any; i++)
+            dirty_any = screen_entry_pending(&s->entries[i]) != NULL;
+        if (!dirty_any) return 0;
+        if (!s->ready(s->ready_user)) {
+            s->stats.held++;       /* widgets stay dirty with their latest value */
+            return 0;
+        }
+    }
+
+    s->stats.frame_coalesced = s->pending_coalesced;
+    s->stats.coalesced      += s->pending_coalesced;
+    s->pending_coalesced     = 0;
+
+    unsigned long start = ansi_ctx_bytes(c);
+    int drawn = 0;
+#if ANSI_TUI_BUDGET
+    if (budgeted && s->budget_bps) {
+        drawn = screen_render_budget(s, c, now_ms);
+    } else
+#endif
+    {
+        (void)now_ms;
+        (void)budgeted;
+        for (int i = 0; i < s->count; i++) {
+            int *dirty = screen_entry_pending(&s->entries[i]);
+            if (!dirty) continue;
+            screen_draw_dirty(c, &s->entries[i], dirty, drawn);
+            drawn++;
+        }
+    }
+
+    if (drawn) {
+        tui_ctx_sync_end(c);
+        ansi_ctx_batch_end(c);
+        s->stats.frames++;
+    }
+
+    uint32_t bytes = (uint32_t)(ansi_ctx_bytes(c) - start);
+    s->stats.frame_bytes = bytes;
+    s->stats.bytes      += bytes;
+    s->rate_bytes       += bytes;
+#if ANSI_TUI_BUDGET
+    if (budgeted && s->budget_bps) s->credit -= (int32_t)bytes;
+#endif
+    return drawn;
+}
+
+int tui_screen_render(tui_screen_t *s)
+{
+    return screen_render(s, 0, 0);
+}
+
+int tui_tick(tui_screen_t *s, uint32_t now_ms)
+{
+    if (!s) return 0;
+
+    /* Achieved throughput, refreshed once per second of ticks */
+    uint32_t window = now_ms - s->rate_ms;
+    if (window >= 1000) {
+        if (s->ticked) s->stats.bps = (uint32_t)((uint64_t)s->rate_bytes * 1000 / window);
+        s->rate_ms    = now_ms;
+        s->rate_bytes = 0;
+    }
+
+    /* Unsigned difference stays correct across millisecond wraparound */
+    if (s->frame_ms && s->ticked && (uint32_t)(now_ms - s->last_ms) < s->frame_ms)
+        return 0;
+
+    int drawn = screen_render(s, now_ms, 1);
+    if (drawn) {
+        /* Only a drawn frame starts a new interval, so the first update
+           after an idle period is shown on the next tick */
+        s->last_ms = now_ms;
+        s->ticked  = 1;
+    }
+    return drawn;
+}
+
+void tui_screen_redraw_all(tui_screen_t *s)
+{
+    if (!s) return;
+    ansi_ctx_t *c = s->ctx ? s->ctx : ansi_default_ctx();
+
+    ansi_ctx_batch_begin(c);
+    tui_ctx_sync_begin(c);
+    tui_ctx_cls(c);
+
+    /* Frames first so nested widgets are never overdrawn by a border */
+#if ANSI_TUI_FRAME
+    for (int i = 0; i < s->count; i++)
+        if (s->entries[i].kind == ANSI_TUI_KIND_FRAME)
+            tui_frame_init((const tui_frame_t *)s->entries[i].widget);
+#endif
+    for (int i = 0; i < s->count; i++)
+        if (s->entries[i].kind != ANSI_TUI_KIND_FRAME)
+            screen_entry_redraw(&s->entries[i]);
+
+    tui_ctx_sync_end(c);
+    ansi_ctx_batch_end(c);
+}
+
+#endif /* ANSI_TUI_SCREEN */
+
+/* ------------------------------------------------------------------ */
+/* Data binding                                                        */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_TUI_BIND
+
+/** Torn seqlock snapshots retried before a widget is skipped for a poll. */
+#define TUI_BIND_RETRIES  4
+
+void tui_seq_begin(volatile uint32_t *seq)
+{
+    if (!seq) return;
+    *seq = *seq + 1;
+    ANSI_BARRIER();
+}
+
+void tui_seq_end(volatile uint32_t *seq)
+{
+    if (!seq) return;
+    ANSI_BARRIER();
+    *seq = *seq + 1;
+}
+
+/** A sampled binding: the number (for numeric widgets) and its text. */
+typedef struct {
+    tui_num_t num;
+    char      text[64];
+} tui_sample_t;
+
+/** Copy the source once, without seqlock checks. */
+static void bind_copy(const tui_bind_t *b, tui_sample_t *v)
+{
+    switch (b->type) {
+    case ANSI_TUI_BIND_INT:
+        v->num = *(const volatile int *)b->src;
+        break;
+#if ANSI_PRINT_FLOAT
+    case ANSI_TUI_BIND_DOUBLE:
+        v->num = *(const volatile double *)b->src;
+        break;
+#endif
+    case ANSI_TUI_BIND_BOOL:
+        v->num = *(const volatile _Bool *)b->src ? 1 : 0;
+        break;
+    case ANSI_TUI_BIND_STRING: {
+        const volatile char *p = (const volatile char *)b->src;
+        size_t i = 0;
+        while (i < sizeof(v->text) - 1 && p[i]) { v->text[i] = p[i]; i++; }
+        v->text[i] = '\0';
+        v->num = 0;
+        break;
+    }
+    }
+}
+
+/** Take a consistent snapshot.  Returns 0 if every attempt overlapped a
+ *  write (odd or changing counter). */
+static int bind_read(const tui_bind_t *b, tui_sample_t *v)
+{
+    if (!b->seq) { bind_copy(b, v); return 1; }
+    for (int i = 0; i < TUI_BIND_RETRIES; i++) {
+        uint32_t s0 = *b->seq;
+        if (s0 & 1u) continue;
+        ANSI_BARRIER();
+        bind_copy(b, v);
+        ANSI_BARRIER();
+        if (*b->seq == s0) return 1;
+    }
+    return 0;
+}
+
+#if ANSI_TUI_LABEL || ANSI_TUI_STATUS || ANSI_TUI_TEXT
+/** Format the sample for a text widget (in place for strings). */
+static const char *bind_text(const tui_bind_t *b, tui_sample_t *v)
+{
+    char num[sizeof(v->text)];
+    switch (b->type) {
+    case ANSI_TUI_BIND_STRING:
+        if (b->fmt) {
+            ansi_snprintf(num, sizeof(num), b->fmt, v->text);
+            memcpy(v->text, num, sizeof(num));
+        }
+        break;
+#if ANSI_PRINT_FLOAT
+    case ANSI_TUI_BIND_DOUBLE:
+        ansi_snprintf(v->text, sizeof(v->text), b->fmt ? b->fmt : "%g", v->num);
+        break;
+#endif
+    default:
+        ansi_snprintf(v->text, sizeof(v->text), b->fmt ? b->fmt : "%d", (int)v->num);
+        break;
+    }
+    return v->text;
+}
+#endif
+
+/** Nonzero unless the widget is disabled (disabled widgets ignore
+ *  updates, so a binding must not record their value as shown). */
+static int bind_enabled(const tui_screen_entry_t *e)
+{
+    switch (e->kind) {
+#if ANSI_TUI_LABEL
+    case ANSI_TUI_KIND_LABEL: {
+        const tui_label_t *w = (const tui_label_t *)e->widget;
+        return !w->state || w->state->enabled;
+    }
+#endif
+#if ANSI_TUI_BAR
+    case ANSI_TUI_KIND_BAR: {
+        const tui_bar_t *w = (const tui_bar_t *)e->widget;
+        return !w->state || w->state->enabled;
+    }
+#endif
+#if ANSI_TUI_PBAR
+    case ANSI_TUI_KIND_PBAR: {
+        const tui_pbar_t *w = (const tui_pbar_t *)e->widget;
+        return !w->state || w->state->enabled;
+    }
+#endif
+#if ANSI_TUI_STATUS
+    case ANSI_TUI_KIND_STATUS: {
+        const tui_status_t *w = (const tui_status_t *)e->widget;
+        return !w->state || w->state->enabled;
+    }
+#endif
+#if ANSI_TUI_TEXT
+    case ANSI_TUI_KIND_TEXT: {
+        const tui_text_t *w = (const tui_text_t *)e->widget;
+        return !w->state || w->state->enabled;
+    }
+#endif
+#if ANSI_TUI_CHECK
+    case ANSI_TUI_KIND_CHECK: {
+        const tui_check_t *w = (const tui_check_t *)e->widget;
+        return !w->state || w->state->enabled;
+    }
+#endif
+#if ANSI_TUI_EBAR
+    case ANSI_TUI_KIND_EBAR: {
+        const tui_ebar_t *w = (const tui_ebar_t *)e->widget;
+        return !w->state || w->state->enabled;
+    }
+#endif
+#if ANSI_TUI_METRIC
+    case ANSI_TUI_KIND_METRIC: {
+        const tui_metric_t *w = (const tui_metric_t *)e->widget;
+        return !w->state || w->state->enabled;
+    }
+#endif
+    default:
+        return 1;
+    }
+}
+
+/** Apply the sample if the displayed value changed since the last poll. */
+static void bind_apply(const tui_screen_entry_t *e, tui_bind_t *b, tui_sample_t *v)
+{
+    uint32_t key;
+    switch (e->kind) {
+#if ANSI_TUI_LABEL
+    case ANSI_TUI_KIND_LABEL: {
+        const char *t = bind_text(b, v);
+        if ((key = tui_digest(t)) == b->shown) return;
+        tui_label_update((const tui_label_t *)e->widget, "%s", t);
+        break;
+    }
+#endif
+#if ANSI_TUI_STATUS
+    case ANSI_TUI_KIND_STATUS: {
+        const char *t = bind_text(b, v);
+        if ((key = tui_digest(t)) == b->shown) return;
+        tui_status_update((const tui_status_t *)e->widget, "%s", t);
+        break;
+    }
+#endif
+#if ANSI_TUI_TEXT
+    case ANSI_TUI_KIND_TEXT: {
+        const char *t = bind_text(b, v);
+        if ((key = tui_digest(t)) == b->shown) return;
+        tui_text_update((const tui_text_t *)e->widget, "%s", t);
+        break;
+    }
+#endif
+#if ANSI_TUI_BAR
+    case ANSI_TUI_KIND_BAR: {
+        const tui_bar_t *w = (const tui_bar_t *)e->widget;
+        tui_num_t min = b->min, max = b->max;
+        if (min == max) { min = 0; max = 100; }
+        key = (uint32_t)bar_eighths(w->bar_width, v->num, min, max) + 1u;
+        if (key == b->shown) return;
+        bar_update(w, v->num, min, max, 0);
+        break;
+    }
+#endif
+#if ANSI_TUI_PBAR
+    case ANSI_TUI_KIND_PBAR: {
+        int pct = (int)v->num;
+        pct = pct < 0 ? 0 : pct > 100 ? 100 : pct;
+        if ((key = (uint32_t)pct + 1u) == b->shown) return;
+        tui_pbar_update((const tui_pbar_t *)e->widget, pct, 0);
+        break;
+    }
+#endif
+#if ANSI_TUI_CHECK
+    case ANSI_TUI_KIND_CHECK:
+        if ((key = v->num != 0 ? 2u : 1u) == b->shown) return;
+        tui_check_update((const tui_check_t *)e->widget, v->num != 0, 0);
+        break;
+#endif
+#if ANSI_TUI_EBAR
+    case ANSI_TUI_KIND_EBAR:
+        if ((key = (uint32_t)(int)v->num + 1u) == b->shown) return;
+        tui_ebar_update((const tui_ebar_t *)e->widget, (int)v->num, 0);
+        break;
+#endif
+#if ANSI_TUI_METRIC
+    case ANSI_TUI_KIND_METRIC: {
+        const tui_metric_t *w = (const tui_metric_t *)e->widget;
+        char vbuf[64];
+        metric_format(w, v->num, vbuf, sizeof(vbuf));
+        key = tui_digest(vbuf) ^ (uint32_t)(metric_zone(w, v->num) + 2);
+        if (key == b->shown) return;
+        tui_metric_update(w, v->num, 0);
+        break;
+    }
+#endif
+    default:
+        return;
+    }
+    b->shown = key;
+}
+
+int tui_poll(tui_screen_t *s)
+{
+    if (!s) return 0;
+    for (int i = 0; i < s->count; i++) {
+        const tui_screen_entry_t *e = &s->entries[i];
+        if (e->kind == ANSI_TUI_KIND_FRAME) continue;
+        /* Every content widget starts with its placement */
+        tui_bind_t *b = ((const tui_placement_t *)e->widget)->bind;
+        if (!b || !b->src) continue;
+
+        tui_sample_t v;
+        if (!bind_enabled(e)) { b->shown = 0; continue; }
+        if (bind_read(b, &v)) bind_apply(e, b, &v);
+    }
+    return tui_screen_render(s);
+}
+
+#endif /* ANSI_TUI_BIND */
@@ -28,6 +28,9 @@
  * | ANSI_TUI_PBAR    | 1       | Percent bar widget (requires ANSI_PRINT_BAR) |
  * | ANSI_TUI_CHECK   | 1       | Check/cross indicator (requires ANSI_PRINT_EMOJI) |
  * | ANSI_TUI_METRIC  | 1       | Threshold-based metric gauge             |
+ * | ANSI_TUI_SCREEN  | 1       | Widget registry with batched rendering   |
+ * | ANSI_TUI_BIND    | 1       | Widgets bound to live variables, tui_poll() (requires ANSI_TUI_SCREEN) |
+ * | ANSI_TUI_BUDGET  | 1       | Bytes-per-second budget with widget priorities (requires ANSI_TUI_SCREEN) |
  */
 
 #ifndef ANSI_TUI_H
@@ -118,6 +121,52 @@
 #  define ANSI_TUI_METRIC   ANSI_PRINT_DEFAULT_
 #endif
 
+/** @def ANSI_TUI_SCREEN
+ *  Enable the tui_screen_t widget registry (deferred, batched rendering).
+ *  Default: 1 (0 if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_TUI_SCREEN
+#  define ANSI_TUI_SCREEN   ANSI_PRINT_DEFAULT_
+#endif
+
+/** @def ANSI_TUI_BIND
+ *  Enable data binding: widgets read a source variable in tui_poll().
+ *  Requires ANSI_TUI_SCREEN.  Default: 1 (0 if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_TUI_BIND
+#  define ANSI_TUI_BIND     ANSI_PRINT_DEFAULT_
+#endif
+/* Force off if the screen registry is disabled */
+#if ANSI_TUI_BIND && !ANSI_TUI_SCREEN
+#  undef  ANSI_TUI_BIND
+#  define ANSI_TUI_BIND     0
+#endif
+
+/** @def ANSI_TUI_BUDGET
+ *  Enable the output budget: tui_tick() sends at most a configured number
+ *  of bytes per second, highest-priority widgets first.
+ *  Requires ANSI_TUI_SCREEN.  Default: 1 (0 if ANSI_PRINT_MINIMAL). */
+#ifndef ANSI_TUI_BUDGET
+#  define ANSI_TUI_BUDGET   ANSI_PRINT_DEFAULT_
+#endif
+#if ANSI_TUI_BUDGET && !ANSI_TUI_SCREEN
+#  undef  ANSI_TUI_BUDGET
+#  define ANSI_TUI_BUDGET   0
+#endif
+
+/** @def ANSI_TUI_BUDGET_COST
+ *  Assumed cost in bytes of a widget that has not been drawn by the
+ *  budgeted scheduler yet; afterwards its last measured cost is used.
+ *  Default: 32. */
+#ifndef ANSI_TUI_BUDGET_COST
+#  define ANSI_TUI_BUDGET_COST      32
+#endif
+
+/** @def ANSI_TUI_BUDGET_BURST_MS
+ *  Unused budget kept while the screen is idle, in milliseconds of line
+ *  time.  Bounds the burst sent after a quiet period.  Default: 100. */
+#ifndef ANSI_TUI_BUDGET_BURST_MS
+#  define ANSI_TUI_BUDGET_BURST_MS  100
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -147,6 +196,17 @@ void tui_sync_begin(void);
  *  The terminal flushes the buffered frame at once. */
 void tui_sync_end(void);
 
+/** @name Screen helpers on an explicit ansi_print context
+ *  Same as the functions above, which use ansi_default_ctx(). */
+/** @{ */
+void tui_ctx_cls(ansi_ctx_t *ctx);
+void tui_ctx_goto(ansi_ctx_t *ctx, int row, int col);
+void tui_ctx_cursor_hide(ansi_ctx_t *ctx);
+void tui_ctx_cursor_show(ansi_ctx_t *ctx);
+void tui_ctx_sync_begin(ansi_ctx_t *ctx);
+void tui_ctx_sync_end(ansi_ctx_t *ctx);
+/** @} */
+
 /* ------------------------------------------------------------------ */
 /* Common types (always available — used by macros and parent ptrs)     */
 /* ------------------------------------------------------------------ */
@@ -160,6 +220,9 @@ typedef enum {
 /** Forward declaration for self-referential parent pointer. */
 typedef struct tui_frame tui_frame_t;
 
+/** Forward declaration for the widget registry (see tui_screen_init()). */
+typedef struct tui_screen tui_screen_t;
+
 /**
  * Frame descriptor: a pure border box with no content.
  *
@@ -181,8 +244,52 @@ struct tui_frame {
     const char *title;  /**< Optional title on top border, or NULL. */
     const char *color;  /**< Border color name, or NULL. */
     const tui_frame_t *parent; /**< Parent frame, or NULL for absolute. */
+    tui_screen_t *screen; /**< Screen registry, or NULL to inherit from parent. */
 };
 
+/**
+ * Numeric type of the bar and metric widget values: double, or int32_t
+ * (integer or fixed-point) when ANSI_PRINT_FLOAT is 0.
+ */
+#if ANSI_PRINT_FLOAT
+typedef double  tui_num_t;
+#else
+typedef int32_t tui_num_t;
+#endif
+
+/** Source variable type of a data binding. */
+typedef enum {
+    ANSI_TUI_BIND_INT,     /**< int */
+#if ANSI_PRINT_FLOAT
+    ANSI_TUI_BIND_DOUBLE,  /**< double */
+#endif
+    ANSI_TUI_BIND_BOOL,    /**< _Bool / bool */
+    ANSI_TUI_BIND_STRING   /**< NUL-terminated char array */
+} tui_bind_type_t;
+
+/**
+ * Data binding: a widget that samples a live variable in tui_poll().
+ *
+ * Lives in RAM (referenced from the widget's placement, like @c state).
+ * The source may be written by an ISR or another thread; with @c seq
+ * set, tui_poll() only accepts a snapshot taken while the counter was
+ * even and unchanged (writers bracket updates with tui_seq_begin() and
+ * tui_seq_end()).
+ *
+ * The struct is always defined because tui_placement_t references it.
+ * Set ANSI_TUI_BIND=1 to enable tui_poll().
+ */
+typedef struct {
+    tui_bind_type_t          type;   /**< Source type. */
+    const volatile void     *src;    /**< Source variable. */
+    const volatile uint32_t *seq;    /**< Seqlock counter, or NULL. */
+    tui_num_t                min;    /**< Bar range minimum. */
+    tui_num_t                max;    /**< Bar range maximum (min == max: 0..100). */
+    const char              *fmt;    /**< Label/status/text printf format for the
+                                          value, or NULL ("%d", "%g" or "%s"). */
+    uint32_t                 shown;  /**< Display key last applied (0 = none). */
+} tui_bind_t;
+
 /**
  * Common positioning fields shared by all content widgets.
  *
@@ -197,6 +304,9 @@ typedef struct {
     tui_border_t       border; /**< Border option. */
     const char        *color;  /**< Border/content color name, or NULL. */
     const tui_frame_t *parent; /**< Parent frame, or NULL for absolute. */
+    tui_screen_t      *screen; /**< Screen registry, or NULL to inherit from parent. */
+    tui_bind_t        *bind;   /**< Data binding sampled by tui_poll(), or NULL. */
+    uint8_t            priority; /**< Output budget priority (higher drawn first). */
 } tui_placement_t;
 
 /* ------------------------------------------------------------------ */
@@ -274,20 +384,26 @@ void tui_frame_init(const tui_frame_t *f);
 /** Mutable state for a label widget (lives in RAM). */
 typedef struct {
     int enabled;    /**< Nonzero = active, 0 = disabled (drawn dim). */
+    int vis_len;    /**< Visible width of the last drawn value (for shrink padding). */
+    int dirty;      /**< Screen render state (0 = not on a screen, 1 = clean, 2 = changed, 3 = forced). */
 } tui_label_state_t;
 
 /**
  * Label widget: "Label: value" at a fixed screen position.
  *
  * @c width is the number of visible characters reserved for the
- * value area (after the "label: " prefix).  On update, the value
- * is padded or truncated to this width.
+ * value area (after the "label: " prefix).  On update, the value is
+ * written in place and only the cells left over from a longer previous
+ * value are blanked (tracked in @c state; without state the rest of the
+ * value area is blanked).
  */
 typedef struct {
     tui_placement_t    place;   /**< Common positioning (row, col, border, color, parent). */
     int                width;   /**< Value area width in visible chars. */
     const char        *label;   /**< Label text (e.g. "CPU"). */
     tui_label_state_t *state;   /**< Mutable state in RAM, or NULL. */
+    char              *text_buf;      /**< Pending value for screen rendering, or NULL. */
+    size_t             text_buf_size; /**< Size of text_buf in bytes. */
 } tui_label_t;
 
 void tui_label_init(const tui_label_t *w);
@@ -304,19 +420,29 @@ void tui_label_enable(const tui_label_t *w, int enabled);
 
 /** Mutable state for a bar widget (lives in RAM). */
 typedef struct {
-    int    enabled; /**< Nonzero = active, 0 = disabled (drawn dim). */
-    double value;   /**< Current value. */
-    double min;     /**< Current range minimum. */
-    double max;     /**< Current range maximum. */
+    int       enabled; /**< Nonzero = active, 0 = disabled (drawn dim). */
+    tui_num_t value;   /**< Current value. */
+    tui_num_t min;     /**< Current range minimum. */
+    tui_num_t max;     /**< Current range maximum. */
+    int       eighths; /**< Fill on screen in 1/8 cells (see ansi_bar_eighths()). */
+    int       dirty;   /**< Screen render state (0 = not on a screen, 1 = clean, 2 = changed, 3 = forced). */
 } tui_bar_state_t;
 
 /**
  * Bar widget: positioned bar graph using ansi_bar().
  *
- * The widget calls ansi_bar() into the caller-provided @c bar_buf
- * on every update.  Multiple bar widgets need separate buffers.
- * The const descriptor may live in flash; mutable state is stored
- * via the @c state pointer.
+ * The widget renders into the caller-provided @c bar_buf on every
+ * redraw.  Multiple bar widgets need separate buffers.  The const
+ * descriptor may live in flash; mutable state is stored via the
+ * @c state pointer.
+ *
+ * With state, change detection compares the quantized fill (eighths)
+ * rather than the raw value, and only the cells between the old and
+ * new fill boundary are rewritten.
+ *
+ * tui_bar_update_i32() takes integer or Q16.16 fixed-point values (any
+ * scale shared by value, min and max) and is the only update call when
+ * ANSI_PRINT_FLOAT is 0.
  */
 typedef struct {
     tui_placement_t    place;        /**< Common positioning (row, col, border, color, parent). */
@@ -329,8 +455,12 @@ typedef struct {
 } tui_bar_t;
 
 void tui_bar_init(const tui_bar_t *w);
+#if ANSI_PRINT_FLOAT
 void tui_bar_update(const tui_bar_t *w, double value, double min, double max,
                     int force);
+#endif
+void tui_bar_update_i32(const tui_bar_t *w, int32_t value, int32_t min,
+                        int32_t max, int force);
 void tui_bar_enable(const tui_bar_t *w, int enabled);
 
 #endif /* ANSI_TUI_BAR */
@@ -345,6 +475,8 @@ void tui_bar_enable(const tui_bar_t *w, int enabled);
 typedef struct {
     int enabled; /**< Nonzero = active, 0 = disabled (drawn dim). */
     int percent; /**< Current percent value (0-100). */
+    int shown;   /**< Percent on screen (lags @c percent while a screen render is pending). */
+    int dirty;   /**< Screen render state (0 = not on a screen, 1 = clean, 2 = changed, 3 = forced). */
 } tui_pbar_state_t;
 
 /**
@@ -354,7 +486,9 @@ typedef struct {
  * instead of value/min/max.  The " XX%" text is appended automatically
  * by ansi_bar_percent().  The @c bar_width field specifies only the
  * bar character cells; the total interior width is bar_width + 5
- * (for " 100%") plus any label prefix.
+ * (for " 100%") plus any label prefix.  With state, an update rewrites
+ * only the cells between the old and new fill boundary plus the
+ * percent text.
  */
 typedef struct {
     tui_placement_t    place;        /**< Common positioning (row, col, border, color, parent). */
@@ -381,18 +515,23 @@ void tui_pbar_enable(const tui_pbar_t *w, int enabled);
 /** Mutable state for a status widget (lives in RAM). */
 typedef struct {
     int enabled;    /**< Nonzero = active, 0 = disabled (drawn dim). */
+    int vis_len;    /**< Visible width of the last drawn value (for shrink padding). */
+    int dirty;      /**< Screen render state (0 = not on a screen, 1 = clean, 2 = changed, 3 = forced). */
 } tui_status_state_t;
 
 /**
  * Status widget: single-line text field at a fixed screen position.
  *
- * On update, the entire width is overwritten (padded with spaces).
- * Supports Rich markup tags in the update text.
+ * On update, the new text is written in place and only the cells left
+ * over from a longer previous text are blanked.  Supports Rich markup
+ * tags in the update text.
  */
 typedef struct {
     tui_placement_t      place;  /**< Common positioning (row, col, border, color, parent). */
     int                  width;  /**< Visible chars, or -1 to fill parent. */
     tui_status_state_t  *state;  /**< Mutable state in RAM, or NULL. */
+    char                *text_buf;      /**< Pending text for screen rendering, or NULL. */
+    size_t               text_buf_size; /**< Size of text_buf in bytes. */
 } tui_status_t;
 
 void tui_status_init(const tui_status_t *w);
@@ -410,13 +549,15 @@ void tui_status_enable(const tui_status_t *w, int enabled);
 /** Mutable state for a text widget (lives in RAM). */
 typedef struct {
     int enabled;    /**< Nonzero = active, 0 = disabled (drawn dim). */
+    int vis_len;    /**< Visible width of the last drawn value (for shrink padding). */
+    int dirty;      /**< Screen render state (0 = not on a screen, 1 = clean, 2 = changed, 3 = forced). */
 } tui_text_state_t;
 
 /**
  * Text widget: single line of text at a fixed screen position.
  *
- * On update, the entire width is overwritten (padded with spaces),
- * then the new text is written.  Supports Rich markup tags.
+ * On update, the new text is written in place and only the cells left
+ * over from a longer previous text are blanked.  Supports Rich markup tags.
  * If @c width is -1 and @c parent is non-NULL, the width auto-fills
  * from the widget column to the parent frame's right interior edge.
  */
@@ -424,6 +565,8 @@ typedef struct {
     tui_placement_t    place;   /**< Common positioning (row, col, border, color, parent). */
     int                width;   /**< Visible chars, or -1 to fill parent. */
     tui_text_state_t  *state;   /**< Mutable state in RAM, or NULL. */
+    char              *text_buf;      /**< Pending text for screen rendering, or NULL. */
+    size_t             text_buf_size; /**< Size of text_buf in bytes. */
 } tui_text_t;
 
 void tui_text_init(const tui_text_t *w);
@@ -442,6 +585,7 @@ void tui_text_enable(const tui_text_t *w, int enabled);
 typedef struct {
     int enabled;    /**< Nonzero = active, 0 = disabled (drawn dim). */
     int checked;    /**< Current boolean state (0 = cross, nonzero = check). */
+    int dirty;      /**< Screen render state (0 = not on a screen, 1 = clean, 2 = changed, 3 = forced). */
 } tui_check_state_t;
 
 /**
@@ -476,6 +620,7 @@ void tui_check_enable(const tui_check_t *w, int enabled);
 typedef struct {
     int enabled;    /**< Nonzero = active, 0 = disabled (drawn dim). */
     int value;      /**< Current fill count (0 .. count). */
+    int dirty;      /**< Screen render state (0 = not on a screen, 1 = clean, 2 = changed, 3 = forced). */
 } tui_ebar_state_t;
 
 /**
@@ -516,41 +661,306 @@ void tui_ebar_enable(const tui_ebar_t *w, int enabled);
 
 /** Mutable state for a metric widget (lives in RAM). */
 typedef struct {
-    int    enabled;  /**< Nonzero = active, 0 = disabled (drawn dim). */
-    double value;    /**< Current value (for restore on enable). */
-    int    zone;     /**< -1=lo, 0=nom, 1=hi (tracks zone for border redraw). */
+    int       enabled; /**< Nonzero = active, 0 = disabled (drawn dim). */
+    tui_num_t value;   /**< Current value (for restore on enable). */
+    int       zone;    /**< -1=lo, 0=nom, 1=hi (tracks zone for border redraw). */
+    uint32_t  digest;  /**< Hash of the value text on screen (0 = none drawn). */
+    int       dirty;   /**< Screen render state (0 = not on a screen, 1 = clean, 2 = changed, 3 = forced). */
 } tui_metric_state_t;
 
 /**
  * Metric widget: bordered gauge with threshold-based color coding.
  *
- * Displays a formatted floating-point value centered inside a
- * bordered box.  The border and value text color change based on
+ * Displays a formatted value centered inside a bordered box.  The
+ * value is a double, or an int32_t when ANSI_PRINT_FLOAT is 0; @c fmt
+ * then receives it as a long (e.g. "%ld rpm").  The border and value text color change based on
  * three zones: below @c thresh_lo (low), between thresholds
  * (nominal), and above @c thresh_hi (high).
  *
  * The widget always draws a border; @c border should be set to
  * @c ANSI_TUI_BORDER for @c tui_below() compatibility.  The title
  * is centered on the top border.
+ *
+ * With state, an update is skipped when both the zone and the
+ * formatted text are unchanged, so a noisy value that still prints
+ * the same through @c fmt costs no output.
  */
 typedef struct {
     tui_placement_t      place;      /**< Common positioning; place.color = nominal color. */
     int                  width;      /**< Interior width in visible chars. */
     const char          *title;      /**< Centered title on top border. */
-    const char          *fmt;        /**< printf format, e.g. "%0.2f m/sec". */
+    const char          *fmt;        /**< printf format, e.g. "%0.2f m/sec" ("%ld" without float). */
     const char          *color_lo;   /**< Border/text color when value < thresh_lo. */
     const char          *color_hi;   /**< Border/text color when value > thresh_hi. */
-    double               thresh_lo;  /**< Low threshold. */
-    double               thresh_hi;  /**< High threshold. */
+    tui_num_t            thresh_lo;  /**< Low threshold. */
+    tui_num_t            thresh_hi;  /**< High threshold. */
     tui_metric_state_t  *state;      /**< Mutable state in RAM, or NULL. */
 } tui_metric_t;
 
 void tui_metric_init(const tui_metric_t *w);
-void tui_metric_update(const tui_metric_t *w, double value, int force);
+void tui_metric_update(const tui_metric_t *w, tui_num_t value, int force);
 void tui_metric_enable(const tui_metric_t *w, int enabled);
 
 #endif /* ANSI_TUI_METRIC */
 
+/* ------------------------------------------------------------------ */
+/* Screen registry                                                     */
+/* ------------------------------------------------------------------ */
+
+/** Widget type tag stored in a screen registry entry. */
+typedef enum {
+    ANSI_TUI_KIND_FRAME,
+    ANSI_TUI_KIND_LABEL,
+    ANSI_TUI_KIND_BAR,
+    ANSI_TUI_KIND_PBAR,
+    ANSI_TUI_KIND_STATUS,
+    ANSI_TUI_KIND_TEXT,
+    ANSI_TUI_KIND_CHECK,
+    ANSI_TUI_KIND_EBAR,
+    ANSI_TUI_KIND_METRIC
+} tui_kind_t;
+
+#if ANSI_TUI_SCREEN
+
+/** One registered widget (caller-provided storage, see tui_screen_init()). */
+typedef struct {
+    tui_kind_t  kind;    /**< Widget type. */
+    const void *widget;  /**< Widget descriptor (const, may live in flash). */
+    int         row;     /**< Absolute screen row (sort key). */
+    int         col;     /**< Absolute screen column (sort key). */
+    uint16_t    cost;    /**< Bytes of the last budgeted draw (0 = not measured). */
+    uint8_t     waiting; /**< Held back by the output budget since @c since. */
+    uint32_t    since;   /**< Tick time the widget was first held back. */
+} tui_screen_entry_t;
+
+/** Update coalescing counters (see tui_tick()). */
+typedef struct {
+    uint32_t frames;          /**< Renders that drew at least one widget. */
+    uint32_t updates;         /**< Updates deferred to a render. */
+    uint32_t coalesced;       /**< Updates replaced by a newer value before being drawn. */
+    uint32_t frame_coalesced; /**< Coalesced updates in the most recent render. */
+    uint32_t held;            /**< Renders postponed because the output was not ready. */
+    uint32_t bytes;           /**< Bytes written by renders. */
+    uint32_t frame_bytes;     /**< Bytes written by the most recent render. */
+    uint32_t bps;             /**< Achieved bytes/second over the last second of tui_tick(). */
+    uint32_t deferred;        /**< Dirty widgets the budget held back in the last tick. */
+    uint32_t frame_stale_ms;  /**< Longest budget wait of a widget drawn in the last tick. */
+    uint32_t stale_max_ms;    /**< Longest budget wait of any drawn widget. */
+} tui_screen_stats_t;
+
+/**
+ * Screen registry: the set of widgets that make up one display.
+ *
+ * Widgets join a screen in their @c *_init call when their placement
+ * (or any ancestor frame) names it in @c screen.  The registry keeps
+ * entries sorted by absolute position, so a render pass walks the
+ * display top-to-bottom, left-to-right instead of in update order.
+ *
+ * While a widget with state is on a screen, its @c *_update call only
+ * records the new value and marks the widget dirty; nothing is written
+ * until tui_screen_render().  Label, status and text widgets also need
+ * @c text_buf to hold the pending text; without it they keep drawing
+ * immediately.  Init and enable calls always draw immediately.
+ *
+ * Every frame and widget that names a screen (directly or through a
+ * parent) draws to the screen's ansi_print context, so two screens on
+ * two contexts can be driven from different threads.
+ */
+struct tui_screen {
+    ansi_ctx_t         *ctx;      /**< Output context (NULL = ansi_default_ctx()). */
+    tui_screen_entry_t *entries;  /**< Caller-provided entry array. */
+    int                 capacity; /**< Number of elements in @c entries. */
+    int                 count;    /**< Entries in use. */
+    uint32_t            frame_ms; /**< Minimum ms between tui_tick() frames (0 = no limit). */
+    uint32_t            last_ms;  /**< Time of the last frame drawn by tui_tick(). */
+    int                 ticked;   /**< Nonzero once tui_tick() has drawn a frame. */
+    uint32_t            pending_coalesced; /**< Coalesced updates since the last render. */
+    tui_screen_stats_t  stats;    /**< Coalescing counters (read-only). */
+    int               (*ready)(void *user); /**< Output readiness hook, or NULL. */
+    void               *ready_user;         /**< Passed to @c ready. */
+    void              (*wake)(void *user);  /**< Called when a clean widget turns dirty, or NULL. */
+    void               *wake_user;          /**< Passed to @c wake. */
+    uint32_t            budget_bps; /**< Output budget in bytes/second (0 = unlimited). */
+    int32_t             credit;     /**< Bytes the budget currently allows (may be negative). */
+    uint32_t            credit_ms;  /**< Time credit was last accrued to. */
+    int                 credited;   /**< Nonzero once credit has a start time. */
+    uint32_t            rate_ms;    /**< Start of the current throughput window. */
+    uint32_t            rate_bytes; /**< Bytes written in the current window. */
+};
+
+/**
+ * @brief Prepare a screen registry over caller-provided storage.
+ *
+ * @param s         Screen to initialize.
+ * @param entries   Entry array (one slot per frame or widget).
+ * @param capacity  Number of elements in @p entries.  Widgets initialized
+ *                  after the registry is full keep drawing immediately.
+ */
+void tui_screen_init(tui_screen_t *s, tui_screen_entry_t *entries,
+                     int capacity);
+
+/**
+ * @brief Cap the frame rate of tui_tick().
+ *
+ * @param s    Screen to configure.
+ * @param fps  Maximum frames per second, or 0 to render on every tick.
+ */
+void tui_screen_set_fps(tui_screen_t *s, int fps);
+
+/**
+ * @brief Send a screen's output to an explicit ansi_print context.
+ *
+ * Applies to every widget on the screen, including widgets that draw
+ * immediately (registry full, or no @c state).  A screen initialized
+ * with no entries is a pure output binding.
+ *
+ * @param s    Screen to configure.
+ * @param ctx  Context from ansi_ctx_init(), or NULL for the default.
+ */
+void tui_screen_set_ctx(tui_screen_t *s, ansi_ctx_t *ctx);
+
+/**
+ * @brief Hold frames back while the output cannot take them.
+ *
+ * Before drawing, tui_screen_render() asks @p ready; if it returns 0 the
+ * render is skipped and counted in @c stats.held.  Dirty widgets keep
+ * only their latest value, so when the output catches up the next frame
+ * shows the newest state instead of every frame that was missed.  Use
+ * ansi_fd_sink_ready() for a non-blocking descriptor.
+ *
+ * @param s      Screen to configure.
+ * @param ready  Returns nonzero when a frame can be written, or NULL.
+ * @param user   Passed to @p ready.
+ */
+void tui_screen_set_ready(tui_screen_t *s, int (*ready)(void *user), void *user);
+
+/**
+ * @brief Be told when the screen has something new to draw.
+ *
+ * @p wake runs inside a widget's *_update call each time a clean widget
+ * on the screen turns dirty (at most once per widget per frame).  An
+ * event loop uses it to arm its frame timer only while there is work,
+ * as tui_driver_init() does.
+ *
+ * @param s     Screen to configure.
+ * @param wake  Notification, or NULL.
+ * @param user  Passed to @p wake.
+ */
+void tui_screen_set_wake(tui_screen_t *s, void (*wake)(void *user), void *user);
+
+/** @brief Number of widgets waiting to be drawn by the next render. */
+int tui_screen_dirty(const tui_screen_t *s);
+
+#if ANSI_TUI_BUDGET
+/**
+ * @brief Limit the bytes per second tui_tick() writes.
+ *
+ * Each tick earns credit at @p bytes_per_sec.  Dirty widgets are drawn in
+ * order of @c place.priority (highest first, row-major within a level)
+ * while their estimated cost fits the credit; the rest stay dirty, keep
+ * only their latest value, and are drawn on a later tick.  A widget's
+ * estimate is the byte count of its previous budgeted draw
+ * (ANSI_TUI_BUDGET_COST before the first).  When nothing fits, the first
+ * widget in line is drawn anyway as long as the credit is not negative,
+ * and the overdraft is repaid from later ticks, so a large widget is
+ * never starved and the long-run rate still holds.
+ *
+ * Only tui_tick() applies the budget; tui_screen_render() and tui_poll()
+ * draw everything dirty.  @c stats.deferred, @c frame_stale_ms and
+ * @c stale_max_ms report what the budget held back and for how long.
+ *
+ * @param s              Screen to configure.
+ * @param bytes_per_sec  Budget, or 0 for none (a 115200 8N1 UART
+ *                       carries 11520).
+ */
+void tui_screen_set_budget(tui_screen_t *s, uint32_t bytes_per_sec);
+#endif
+
+/**
+ * @brief Draw every dirty widget in row-major order as one transaction.
+ *
+ * Output is wrapped in synchronized-update mode (tui_sync_begin/end)
+ * and a single ansi_batch_begin/end, so the frame reaches the terminal
+ * in one flush.  Nothing is emitted when no widget is dirty, or while the
+ * tui_screen_set_ready() hook reports the output busy.
+ *
+ * @return Number of widgets drawn.
+ */
+int tui_screen_render(tui_screen_t *s);
+
+/**
+ * @brief Fixed-rate refresh: render if a frame interval has elapsed.
+ *
+ * Call from the main loop as often as convenient.  Updates between
+ * frames only overwrite the stored value (last write wins), so a widget
+ * updated many times per frame is drawn once with its latest value;
+ * the dropped intermediate updates are counted in @c s->stats.  An idle
+ * screen does not consume a frame slot: the first update after a quiet
+ * period is drawn on the next tick.
+ *
+ * @param s       Screen to refresh.
+ * @param now_ms  Monotonic millisecond clock (wraparound safe).
+ * @return Number of widgets drawn (0 if throttled or nothing dirty).
+ *
+ * @code
+ * tui_screen_set_fps(&screen, 30);
+ * for (;;) {
+ *     tui_metric_update(&speed, read_speed(), 0);   // as often as data arrives
+ *     tui_tick(&screen, millis());
+ * }
+ * @endcode
+ */
+int tui_tick(tui_screen_t *s, uint32_t now_ms);
+
+/**
+ * @brief Clear the terminal and redraw every registered frame and widget.
+ *
+ * Recovers from terminal corruption (resize, stray output, reconnect)
+ * without the application re-running its @c *_init calls.  Widgets
+ * with state are restored from it (including their enabled/disabled
+ * look and the last text in @c text_buf); widgets without state are
+ * redrawn as freshly initialized.
+ */
+void tui_screen_redraw_all(tui_screen_t *s);
+
+#endif /* ANSI_TUI_SCREEN */
+
+#if ANSI_TUI_BIND
+
+/**
+ * @brief Sample every bound widget on a screen and render the changes.
+ *
+ * Each binding is read (retrying a torn seqlock snapshot a few times,
+ * then skipping the widget until the next poll) and reduced to the value
+ * the widget would display: bar fill in eighths, percent, check state,
+ * ebar count, or the formatted text of a metric, label, status or text
+ * widget.  Only widgets whose displayed value changed are updated, so a
+ * poll over unchanged data emits nothing.
+ *
+ * @param s  Screen whose entries are sampled.
+ * @return Number of widgets drawn (see tui_screen_render()).
+ *
+ * @code
+ * static volatile double cpu_load;
+ * static tui_bind_t      cpu_bind = { ANSI_TUI_BIND_DOUBLE, &cpu_load };
+ * static const tui_bar_t cpu_bar = {
+ *     .place = { .row = 2, .col = 1, .screen = &screen, .bind = &cpu_bind },
+ *     ...
+ * };
+ *
+ * for (;;) { tui_poll(&screen); sleep_ms(33); }
+ * @endcode
+ */
+int tui_poll(tui_screen_t *s);
+
+/** @brief Start a seqlock write: the counter becomes odd. */
+void tui_seq_begin(volatile uint32_t *seq);
+
+/** @brief End a seqlock write: the counter becomes even again. */
+void tui_seq_end(volatile uint32_t *seq);
+
+#endif /* ANSI_TUI_BIND */
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,8 +1,14 @@
 #include "ansi_print.h"
 #include "ansi_tui.h"
+#include "ansi_defer.h"
+#include "ansi_driver.h"
+#include <ctype.h>
 #include <stdio.h>
 #include <string.h>
 #include <unistd.h>
+#if ANSI_TUI_DRIVER
+#include <poll.h>
+#endif
 
 static void my_putc(int ch)  { putchar(ch); }
 static void my_flush(void)   { fflush(stdout); }
@@ -188,6 +194,26 @@ static const double tmp_vals[]  = { 78.3, 80.1, 76.5, 83.7, 74.2, 79.0 };
 static const double vlt_vals[]  = { 3.30, 3.28, 3.25, 3.15, 3.22, 3.31 };
 static const double freq_vals[] = { 1200.0, 1800.0, 1500.0, 2100.0, 800.0, 1600.0 };
 static const int    check_states[] = { 1, 1, 0, 0, 1, 1 };
+
+/* Live readings: the simulated sensor writes them each frame under a
+ * seqlock, and the bound widgets (CPU bar/pbar, TEMP metric and label)
+ * sample them in tui_poll() instead of being updated one by one. */
+static volatile int      cpu_load;
+static volatile double   cpu_temp;
+static volatile uint32_t sensor_seq;
+static tui_bind_t cpu_bar_bind   = { ANSI_TUI_BIND_INT, &cpu_load, &sensor_seq, 0.0, 100.0, NULL, 0 };
+static tui_bind_t cpu_pbar_bind  = { ANSI_TUI_BIND_INT, &cpu_load, &sensor_seq, 0.0, 0.0, NULL, 0 };
+static tui_bind_t tmp_label_bind = { ANSI_TUI_BIND_DOUBLE, &cpu_temp, &sensor_seq, 0.0, 0.0,
+                                     "[red]%.1f C[/]", 0 };
+static tui_bind_t tmp_metric_bind = { ANSI_TUI_BIND_DOUBLE, &cpu_temp, &sensor_seq, 0.0, 0.0, NULL, 0 };
+
+#if ANSI_TUI_BIND
+static tui_screen_entry_t live_entries[8];
+static tui_screen_t       live_screen;
+#define LIVE_SCREEN (&live_screen)
+#else
+#define LIVE_SCREEN NULL
+#endif
 static const char  *status_msgs[] = {
     "[green]All systems nominal[/]",
     "[cyan]Sensor calibrating...[/]",
@@ -275,7 +301,8 @@ static const tui_label_t mem_label = {
 };
 static const tui_label_t tmp_label = {
     .place = { .row = 7, .col = 1, .border = ANSI_TUI_BORDER,
-               .color = "cyan", .parent = &sensors_frame },
+               .color = "cyan", .parent = &sensors_frame,
+               .screen = LIVE_SCREEN, .bind = &tmp_label_bind },
     .width = 10, .label = "TMP", .state = &tmp_label_st
 };
 
@@ -285,7 +312,8 @@ static char cpu_pbar_buf[256];
 static tui_pbar_state_t cpu_pbar_st;
 static const tui_pbar_t cpu_pbar = {
     .place = { .row = 10, .col = 1, .border = ANSI_TUI_BORDER,
-               .color = "green", .parent = &sensors_frame },
+               .color = "green", .parent = &sensors_frame,
+               .screen = LIVE_SCREEN, .bind = &cpu_pbar_bind },
     .bar_width = 30, .label = "CPU ",
     .track = ANSI_BAR_LIGHT,
     .bar_buf = cpu_pbar_buf, .bar_buf_size = sizeof(cpu_pbar_buf),
@@ -299,7 +327,8 @@ static char cpu_bar_buf[256], mem_bar_buf[256];
 static tui_bar_state_t cpu_bar_st, mem_bar_st;
 static const tui_bar_t cpu_bar = {
     .place = { .row = 1, .col = 1, .border = ANSI_TUI_BORDER,
-               .color = "green", .parent = &monitors_frame },
+               .color = "green", .parent = &monitors_frame,
+               .screen = LIVE_SCREEN, .bind = &cpu_bar_bind },
     .bar_width = 35, .label = "CPU ",
     .track = ANSI_BAR_LIGHT,
     .bar_buf = cpu_bar_buf, .bar_buf_size = sizeof(cpu_bar_buf),
@@ -319,7 +348,8 @@ static const tui_bar_t mem_bar = {
 static tui_metric_state_t tmp_metric_st, vlt_metric_st;
 static const tui_metric_t tmp_metric = {
     .place = { .row = 7, .col = 1, .border = ANSI_TUI_BORDER,
-               .color = "green", .parent = &monitors_frame },
+               .color = "green", .parent = &monitors_frame,
+               .screen = LIVE_SCREEN, .bind = &tmp_metric_bind },
     .width = 16, .title = "TEMP", .fmt = "%5.1f \xc2\xb0""F",
     .color_lo = "blue", .color_hi = "red",
     .thresh_lo = 76.0, .thresh_hi = 82.0,
@@ -477,20 +507,35 @@ static void draw_tui(int frame, int tick, int force)
 #endif
 
     
+    /* The "sensor" publishes a new reading */
+#if ANSI_TUI_BIND
+    tui_seq_begin(&sensor_seq);
+#endif
+    cpu_load = cpu_vals[frame];
+    cpu_temp = tmp_vals[frame];
+#if ANSI_TUI_BIND
+    tui_seq_end(&sensor_seq);
+#endif
+
     /* Color CPU label by load */
-    const char *cpu_color = cpu_vals[frame] >= 90 ? "red"
-                          : cpu_vals[frame] >= 70 ? "yellow" : "green";
-    tui_label_update(&cpu_label, "[%s]%d%%[/]", cpu_color, cpu_vals[frame]);
+    const char *cpu_color = cpu_load >= 90 ? "red"
+                          : cpu_load >= 70 ? "yellow" : "green";
+    tui_label_update(&cpu_label, "[%s]%d%%[/]", cpu_color, cpu_load);
     tui_label_update(&mem_label, "[yellow]%d%%[/]", mem_vals[frame]);
-    tui_label_update(&tmp_label, "[red]%.1f C[/]", tmp_vals[frame]);
 
 #if ANSI_PRINT_BAR
-    tui_bar_update(&cpu_bar, (double)cpu_vals[frame], 0.0, 100.0, force);
     tui_bar_update(&mem_bar, (double)mem_vals[frame], 0.0, 100.0, force);
-    tui_pbar_update(&cpu_pbar, cpu_vals[frame], force);
+#endif
+#if !ANSI_TUI_BIND
+    /* Without binding, push the live readings by hand */
+    tui_label_update(&tmp_label, "[red]%.1f C[/]", cpu_temp);
+#if ANSI_PRINT_BAR
+    tui_bar_update(&cpu_bar, (double)cpu_load, 0.0, 100.0, force);
+    tui_pbar_update(&cpu_pbar, cpu_load, force);
+#endif
+    tui_metric_update(&tmp_metric, cpu_temp, force);
 #endif
 
-    tui_metric_update(&tmp_metric, tmp_vals[frame], force);
     tui_metric_update(&vlt_metric, vlt_vals[frame], force);
     tui_metric_update(&freq_metric, freq_vals[frame], force);
     tui_check_update(&sys_check, check_states[frame], force);
@@ -512,13 +557,16 @@ static void draw_tui(int frame, int tick, int force)
     tui_text_update(&tick_text, "[dim]t=%d[/]", tick);
 
     tui_sync_end();
+
+#if ANSI_TUI_BIND
+    /* Bound widgets redraw only if their displayed value changed */
+    tui_poll(&live_screen);
+#endif
 }
 
-static void tui_demo(void)
+/* Draw every frame and widget from scratch (start-up and after a resize) */
+static void tui_demo_paint(void)
 {
-    tui_cls();
-    tui_cursor_hide();
-
     tui_sync_begin();
 
     /* Init frames */
@@ -557,9 +605,57 @@ static void tui_demo(void)
     tui_text_init(&tick_text);
 
     tui_sync_end();
+}
+
+#if ANSI_TUI_DRIVER && ANSI_TUI_BIND
+/* Demo steps paced by the driver's frame clock instead of usleep() */
+static int demo_step, demo_total, demo_repaint;
 
-    /* Draw loop: four full cycles, quarter-second steps */
+static void demo_frame(tui_driver_t *d, uint32_t now_ms)
+{
+    (void)d;
+    (void)now_ms;
+    if (demo_step >= demo_total) return;
+    if (demo_repaint) tui_demo_paint();
+    draw_tui(demo_step % nframes, demo_step, demo_step == 0 || demo_repaint);
+    demo_repaint = 0;
+    demo_step++;
+}
+
+static void demo_resize(tui_driver_t *d, int rows, int cols)
+{
+    (void)d;
+    (void)rows;
+    (void)cols;
+    demo_repaint = 1;   /* the driver clears the screen; repaint next step */
+}
+#endif
+
+static void tui_demo(void)
+{
+    tui_cls();
+    tui_cursor_hide();
+#if ANSI_TUI_BIND
+    tui_screen_init(&live_screen, live_entries, 8);
+#endif
+    tui_demo_paint();
+
+    /* Draw loop: four full cycles, 120 ms steps */
     int total = nframes * 4;
+#if ANSI_TUI_DRIVER && ANSI_TUI_BIND
+    tui_driver_t drv;
+    if (tui_driver_init(&drv, &live_screen, 8, STDOUT_FILENO)) {
+        struct pollfd pfd = { .fd = tui_driver_fd(&drv), .events = POLLIN };
+        demo_step     = 0;
+        demo_total    = total;
+        drv.on_frame  = demo_frame;
+        drv.on_resize = demo_resize;
+        tui_driver_wake(&drv);
+        while (demo_step < demo_total && poll(&pfd, 1, -1) >= 0)
+            tui_driver_dispatch(&drv);
+        tui_driver_close(&drv);
+    } else
+#endif
     for (int i = 0; i < total; i++) {
         draw_tui(i % nframes, i, i == 0 ? 1 : 0);
         my_flush();
@@ -573,13 +669,12 @@ static void tui_demo(void)
 
 static void emoji_test(void)
 {
-    const ansi_emoji_entry_t *table = ansi_emoji_table();
-    int count = ansi_emoji_count();
+    ansi_emoji_entry_t e;
     char line[128];
 
     ansi_window_start("cyan", 24, ANSI_ALIGN_CENTER, "Emoji Width Test");
-    for (int i = 0; i < count; i++) {
-        snprintf(line, sizeof(line), ":%s: %-14s", table[i].name, table[i].name);
+    for (int i = 0; ansi_emoji_get(i, &e); i++) {
+        snprintf(line, sizeof(line), ":%s: %-14s", e.name, e.name);
         ansi_window_line(ANSI_ALIGN_LEFT, "%s", line);
     }
     ansi_window_end();
@@ -618,6 +713,150 @@ static void quick_start(void)
     ansi_puts("[bold][rainbow]All systems operational[/rainbow][/]\n");
 }
 
+#if ANSI_PRINT_DEFER
+/* ------------------------------------------------------------------ */
+/* --decode: render deferred log records using the target's table      */
+/* ------------------------------------------------------------------ */
+
+#define DECODE_MAX_FMTS  1024
+
+static char        decode_src[65536];
+static char        decode_pool[65536];
+static const char *decode_fmts[DECODE_MAX_FMTS];
+
+/** Decode one C escape sequence; @p p points just past the backslash. */
+static char unescape(const char **p)
+{
+    const char *s = *p;
+    char ch = *s++;
+    int v = 0, n = 0;
+
+    switch (ch) {
+    case 'n': ch = '\n'; break;
+    case 't': ch = '\t'; break;
+    case 'r': ch = '\r'; break;
+    case 'a': ch = '\a'; break;
+    case 'b': ch = '\b'; break;
+    case 'f': ch = '\f'; break;
+    case 'v': ch = '\v'; break;
+    case 'e': ch = '\x1b'; break;
+    case 'x':
+        while (isxdigit((unsigned char)*s)) {
+            v = v * 16 + (isdigit((unsigned char)*s) ? *s - '0'
+                                                     : (tolower((unsigned char)*s) - 'a' + 10));
+            s++;
+        }
+        ch = (char)v;
+        break;
+    default:
+        if (ch >= '0' && ch <= '7') {
+            s--;
+            while (n < 3 && *s >= '0' && *s <= '7') { v = v * 8 + (*s++ - '0'); n++; }
+            ch = (char)v;
+        }
+        break;   /* \\ \" \' and unknown escapes map to themselves */
+    }
+    *p = s;
+    return ch;
+}
+
+/** Load ANSI_DEFER_FMT(ID, "...") entries from an X-macro table, in order.
+ *  Comments are skipped; entries without a string literal (such as the
+ *  #define of the macro itself) are ignored.  Returns the entry count. */
+static unsigned load_formats(const char *path)
+{
+    static const char key[] = "ANSI_DEFER_FMT";
+    FILE *f = fopen(path, "rb");
+    if (!f) return 0;
+    size_t n = fread(decode_src, 1, sizeof(decode_src) - 1, f);
+    fclose(f);
+    decode_src[n] = '\0';
+
+    unsigned count = 0;
+    size_t pool = 0;
+    const char *p = decode_src;
+    while (*p && count < DECODE_MAX_FMTS) {
+        if (p[0] == '/' && p[1] == '*') {
+            const char *e = strstr(p + 2, "*/");
+            p = e ? e + 2 : p + strlen(p);
+            continue;
+        }
+        if (p[0] == '/' && p[1] == '/') {
+            while (*p && *p != '\n') p++;
+            continue;
+        }
+        if (strncmp(p, key, sizeof(key) - 1) != 0 ||
+            (p > decode_src && (isalnum((unsigned char)p[-1]) || p[-1] == '_'))) {
+            p++;
+            continue;
+        }
+        p += sizeof(key) - 1;
+        while (isspace((unsigned char)*p)) p++;
+        if (*p != '(') continue;
+        while (*p && *p != ',' && *p != ')') p++;
+        if (*p != ',') continue;
+        p++;
+
+        /* One or more adjacent string literals */
+        size_t start = pool;
+        int literals = 0;
+        for (;;) {
+            while (isspace((unsigned char)*p)) p++;
+            if (*p != '"') break;
+            literals++;
+            p++;
+            while (*p && *p != '"') {
+                char ch = *p++;
+                if (ch == '\\' && *p) ch = unescape(&p);
+                if (pool < sizeof(decode_pool) - 1) decode_pool[pool++] = ch;
+            }
+            if (*p == '"') p++;
+        }
+        if (!literals || pool >= sizeof(decode_pool) - 1) {
+            pool = start;
+            continue;
+        }
+        decode_pool[pool++] = '\0';
+        decode_fmts[count++] = decode_pool + start;
+    }
+    return count;
+}
+
+static int decode(const char *table, const char *capture)
+{
+    unsigned count = load_formats(table);
+    if (!count) {
+        fprintf(stderr, "ansiprint: no ANSI_DEFER_FMT entries in %s\n", table);
+        return 1;
+    }
+    FILE *in = capture ? fopen(capture, "rb") : stdin;
+    if (!in) {
+        fprintf(stderr, "ansiprint: cannot open %s\n", capture);
+        return 1;
+    }
+
+    ansi_defer_t d;
+    ansi_defer_init(&d, NULL, decode_fmts, count);
+
+    static unsigned char buf[4096];
+    size_t len = 0, got;
+    while ((got = fread(buf + len, 1, sizeof(buf) - len, in)) > 0) {
+        len += got;
+        size_t pos = 0, n;
+        while ((n = ansi_defer_decode(&d, buf + pos, len - pos)) > 0) pos += n;
+        memmove(buf, buf + pos, len - pos);
+        len -= pos;
+        if (len == sizeof(buf)) break;   /* record larger than the buffer */
+    }
+    if (capture) fclose(in);
+    if (len) {
+        fprintf(stderr, "ansiprint: %u trailing bytes (truncated record)\n", (unsigned)len);
+        return 1;
+    }
+    return 0;
+}
+#endif /* ANSI_PRINT_DEFER */
+
 int main(int argc, char *argv[])
 {
     ansi_init(my_putc, my_flush, fmt_buf, sizeof(fmt_buf));
@@ -643,13 +882,25 @@ int main(int argc, char *argv[])
         return 0;
     }
 
+#if ANSI_PRINT_DEFER
+    if (argc >= 3 && strcmp(argv[1], "--decode") == 0) {
+        return decode(argv[2], argc >= 4 ? argv[3] : NULL);
+    }
+#endif
+
     if (argc < 2) {
         fprintf(stderr, "Usage: ansiprint [--demo | --tui-demo | --quick-start | --emoji-test] "
                         "[<markup string> ...]\n");
+#if ANSI_PRINT_DEFER
+        fprintf(stderr, "       ansiprint --decode <formats.inc> [capture.bin]\n");
+#endif
         fprintf(stderr, "  --demo        Show feature showcase\n");
         fprintf(stderr, "  --tui-demo    Show positioned TUI widget demo\n");
         fprintf(stderr, "  --quick-start Quick start example output\n");
         fprintf(stderr, "  --emoji-test  Show all emoji in a window (width test)\n");
+#if ANSI_PRINT_DEFER
+        fprintf(stderr, "  --decode      Render deferred log records (stdin if no capture file)\n");
+#endif
         fprintf(stderr, "Example: ansiprint \"[bold red]Error:[/] something broke\"\n");
         return 1;
     }
@@ -0,0 +1,17 @@
+/* app_cfg.h for test_putc: bind the output sink at compile time.
+ * Only on the include path of the test_putc build. */
+#ifndef TEST_PUTC_APP_CFG_H
+#define TEST_PUTC_APP_CFG_H
+
+#include <stddef.h>
+#include <string.h>
+
+extern char   test_sink[];
+extern size_t test_sink_len;
+extern int    test_write_calls;
+
+#define ANSI_PRINT_PUTC(ch)     (test_sink[test_sink_len++] = (char)(ch))
+#define ANSI_PRINT_WRITE(p, n)  \
+    (test_write_calls++, memcpy(test_sink + test_sink_len, (p), (n)), test_sink_len += (n))
+
+#endif
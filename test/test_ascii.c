@@ -0,0 +1,147 @@
+/* test_ascii.c -- the ANSI_PRINT_ASCII profile (7-bit glyph tables).
+ *
+ * Built with -DANSI_PRINT_ASCII so the library and the tests share the
+ * same emoji, box and bar tables. */
+#include "unity.h"
+#include "ansi_print.h"
+#include "ansi_tui.h"
+#include <stdio.h>
+#include <string.h>
+
+#if !ANSI_PRINT_ASCII_
+#  error "test_ascii must be built with -DANSI_PRINT_ASCII"
+#endif
+
+#define CAPTURE_SIZE 2048
+
+static char capture_buf[CAPTURE_SIZE];
+static int  capture_pos;
+
+static void capture_putc(int ch)
+{
+    if (capture_pos < CAPTURE_SIZE - 1)
+        capture_buf[capture_pos++] = (char)ch;
+}
+
+static void capture_flush(void) { /* no-op */ }
+
+static char fmt_buf[512];
+
+void setUp(void)
+{
+    memset(capture_buf, 0, sizeof(capture_buf));
+    capture_pos = 0;
+    ansi_init(capture_putc, capture_flush, fmt_buf, sizeof(fmt_buf));
+    ansi_set_enabled(0);
+}
+
+void tearDown(void) { }
+
+/** Every byte the library sent is 7-bit. */
+static void assert_seven_bit(const char *s)
+{
+    for (; *s; s++)
+        TEST_ASSERT_TRUE((unsigned char)*s < 0x80);
+}
+
+/* ------------------------------------------------------------------ */
+/* Emoji                                                               */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_PRINT_EMOJI
+void test_emoji_become_ascii_tags(void)
+{
+    ansi_print(":check: :cross: :warning: :thumbs_up:");
+    TEST_ASSERT_EQUAL_STRING("+ x ! +1", capture_buf);
+}
+
+void test_emoji_width_matches_tag(void)
+{
+    const ansi_emoji_entry_t *t = ansi_emoji_table();
+    for (int i = 0; i < ansi_emoji_count(); i++) {
+        char markup[40];
+        snprintf(markup, sizeof(markup), ":%s:", t[i].name);
+        TEST_ASSERT_EQUAL_MESSAGE((int)strlen(t[i].utf8),
+                                  ansi_visible_width(markup), t[i].name);
+        assert_seven_bit(t[i].utf8);
+    }
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Boxes                                                               */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_PRINT_BANNER
+void test_banner_is_plain_ascii(void)
+{
+    ansi_banner(NULL, 0, ANSI_ALIGN_LEFT, "hi");
+    TEST_ASSERT_EQUAL_STRING("+----+\n| hi |\n+----+\n", capture_buf);
+}
+
+#if ANSI_PRINT_EMOJI
+void test_banner_aligns_around_tags(void)
+{
+    ansi_banner(NULL, 6, ANSI_ALIGN_LEFT, ":thumbs_up: ok");
+    TEST_ASSERT_EQUAL_STRING("+--------+\n| +1 ok  |\n+--------+\n", capture_buf);
+}
+#endif
+#endif
+
+#if ANSI_TUI_FRAME
+void test_tui_frame_is_plain_ascii(void)
+{
+    const tui_frame_t f = { .row = 1, .col = 1, .width = 5, .height = 3 };
+    tui_frame_init(&f);
+    TEST_ASSERT_EQUAL_STRING("\x1b[1;1H+---+\x1b[2;1H|\x1b[2;5H|\x1b[3;1H+---+",
+                             capture_buf);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Bars                                                                */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_PRINT_BAR
+void test_bar_full_and_half_cells(void)
+{
+    char buf[64];
+    TEST_ASSERT_EQUAL_STRING("##..", ansi_bar(buf, sizeof(buf), NULL, 4, ANSI_BAR_LIGHT, 50, 0, 100));
+    TEST_ASSERT_EQUAL_STRING("##=.", ansi_bar(buf, sizeof(buf), NULL, 4, ANSI_BAR_LIGHT, 62.5, 0, 100));
+    TEST_ASSERT_EQUAL_STRING("####", ansi_bar(buf, sizeof(buf), NULL, 4, ANSI_BAR_LIGHT, 100, 0, 100));
+}
+
+void test_bar_rounds_to_nearest_half(void)
+{
+    char buf[64];
+    /* 10% of 4 cells = 3.2 eighths -> half a cell */
+    TEST_ASSERT_EQUAL_STRING("=---", ansi_bar(buf, sizeof(buf), NULL, 4, ANSI_BAR_LINE, 10, 0, 100));
+    /* 2% = 0.64 eighths -> nothing */
+    TEST_ASSERT_EQUAL_STRING("    ", ansi_bar(buf, sizeof(buf), NULL, 4, ANSI_BAR_BLANK, 2, 0, 100));
+    /* 23% = 7.36 eighths -> one full cell */
+    TEST_ASSERT_EQUAL_STRING("#:::", ansi_bar(buf, sizeof(buf), NULL, 4, ANSI_BAR_MED, 23, 0, 100));
+}
+#endif
+
+int main(void)
+{
+    UNITY_BEGIN();
+#if ANSI_PRINT_EMOJI
+    RUN_TEST(test_emoji_become_ascii_tags);
+    RUN_TEST(test_emoji_width_matches_tag);
+#endif
+#if ANSI_PRINT_BANNER
+    RUN_TEST(test_banner_is_plain_ascii);
+#if ANSI_PRINT_EMOJI
+    RUN_TEST(test_banner_aligns_around_tags);
+#endif
+#endif
+#if ANSI_TUI_FRAME
+    RUN_TEST(test_tui_frame_is_plain_ascii);
+#endif
+#if ANSI_PRINT_BAR
+    RUN_TEST(test_bar_full_and_half_cells);
+    RUN_TEST(test_bar_rounds_to_nearest_half);
+#endif
+    return UNITY_END();
+}
@@ -0,0 +1,212 @@
+#include "unity.h"
+#include "ansi_async.h"
+#include <string.h>
+#include <stdio.h>
+
+#if ANSI_PRINT_ASYNC
+#include <pthread.h>
+#include <sched.h>
+
+/* ------------------------------------------------------------------ */
+/* Capture buffer — written only by the consumer (drain) side          */
+/* ------------------------------------------------------------------ */
+
+#define CAPTURE_SIZE 32768
+
+static char capture_buf[CAPTURE_SIZE];
+static int  capture_pos;
+static int  flush_count;
+
+static void capture_putc(int ch)
+{
+    if (capture_pos < CAPTURE_SIZE - 1)
+        capture_buf[capture_pos++] = (char)ch;
+}
+
+static void capture_flush(void) { flush_count++; }
+
+static void yield(void) { sched_yield(); }
+
+static ansi_ctx_t out;
+static char       out_buf[256];
+
+void setUp(void)
+{
+    memset(capture_buf, 0, sizeof(capture_buf));
+    capture_pos = 0;
+    flush_count = 0;
+    ansi_ctx_init(&out, capture_putc, capture_flush, out_buf, sizeof(out_buf));
+}
+
+void tearDown(void) { }
+
+/* ------------------------------------------------------------------ */
+/* Single-threaded behavior                                            */
+/* ------------------------------------------------------------------ */
+
+void test_async_init_requires_power_of_two(void)
+{
+    ansi_async_slot_t slots[6];
+    ansi_async_t q;
+    TEST_ASSERT_EQUAL(0, ansi_async_init(&q, slots, 6, &out, ANSI_ASYNC_BLOCK, NULL));
+    TEST_ASSERT_EQUAL(0, ansi_async_init(&q, slots, 1, &out, ANSI_ASYNC_BLOCK, NULL));
+    TEST_ASSERT_EQUAL(1, ansi_async_init(&q, slots, 4, &out, ANSI_ASYNC_BLOCK, NULL));
+}
+
+void test_async_renders_in_order_one_flush(void)
+{
+    ansi_async_slot_t slots[4];
+    ansi_async_t q;
+    ansi_async_init(&q, slots, 4, &out, ANSI_ASYNC_BLOCK, NULL);
+
+    ansi_async_print(&q, "[red]%d[/]", 1);
+    ansi_async_puts(&q, "b");
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);   /* nothing until drained */
+
+    TEST_ASSERT_EQUAL(2, ansi_async_drain(&q, 0));
+    TEST_ASSERT_EQUAL_STRING("\x1b[31m1\x1b[0mb", capture_buf);
+    TEST_ASSERT_EQUAL(1, flush_count);
+    TEST_ASSERT_EQUAL(0, ansi_async_drain(&q, 0));
+}
+
+void test_async_drain_max(void)
+{
+    ansi_async_slot_t slots[4];
+    ansi_async_t q;
+    ansi_async_init(&q, slots, 4, &out, ANSI_ASYNC_BLOCK, NULL);
+    ansi_async_puts(&q, "a");
+    ansi_async_puts(&q, "b");
+    ansi_async_puts(&q, "c");
+    TEST_ASSERT_EQUAL(2, ansi_async_drain(&q, 2));
+    TEST_ASSERT_EQUAL_STRING("ab", capture_buf);
+    TEST_ASSERT_EQUAL(1, ansi_async_drain(&q, 2));
+    TEST_ASSERT_EQUAL_STRING("abc", capture_buf);
+}
+
+void test_async_drop_newest(void)
+{
+    ansi_async_slot_t slots[2];
+    ansi_async_t q;
+    ansi_async_init(&q, slots, 2, &out, ANSI_ASYNC_DROP_NEWEST, NULL);
+    TEST_ASSERT_EQUAL(1, ansi_async_puts(&q, "a"));
+    TEST_ASSERT_EQUAL(1, ansi_async_puts(&q, "b"));
+    TEST_ASSERT_EQUAL(0, ansi_async_puts(&q, "c"));
+    TEST_ASSERT_EQUAL(1, (int)ansi_async_dropped(&q));
+    ansi_async_drain(&q, 0);
+    TEST_ASSERT_EQUAL_STRING("ab", capture_buf);
+}
+
+void test_async_drop_oldest(void)
+{
+    ansi_async_slot_t slots[2];
+    ansi_async_t q;
+    ansi_async_init(&q, slots, 2, &out, ANSI_ASYNC_DROP_OLDEST, NULL);
+    ansi_async_puts(&q, "a");
+    ansi_async_puts(&q, "b");
+    TEST_ASSERT_EQUAL(1, ansi_async_puts(&q, "c"));
+    TEST_ASSERT_EQUAL(1, ansi_async_print(&q, "%c", 'd'));
+    TEST_ASSERT_EQUAL(2, (int)ansi_async_dropped(&q));
+    ansi_async_drain(&q, 0);
+    TEST_ASSERT_EQUAL_STRING("cd", capture_buf);
+}
+
+void test_async_truncates_long_record(void)
+{
+    ansi_async_slot_t slots[2];
+    ansi_async_t q;
+    ansi_async_init(&q, slots, 2, &out, ANSI_ASYNC_BLOCK, NULL);
+    char big[ANSI_PRINT_ASYNC_RECORD * 2];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    ansi_async_puts(&q, big);
+    ansi_async_drain(&q, 0);
+    TEST_ASSERT_EQUAL(ANSI_PRINT_ASYNC_RECORD - 1, (int)strlen(capture_buf));
+}
+
+/* ------------------------------------------------------------------ */
+/* Threads: many producers, one consumer, flush barrier                */
+/* ------------------------------------------------------------------ */
+
+#define PRODUCERS   4
+#define PER_THREAD  500
+
+static ansi_async_t     mt_q;
+static atomic_int       mt_stop;
+
+static void *producer(void *arg)
+{
+    int id = (int)(size_t)arg;
+    for (int i = 0; i < PER_THREAD; i++)
+        ansi_async_print(&mt_q, "%d:%d\n", id, i);
+    return NULL;
+}
+
+static void *consumer(void *arg)
+{
+    (void)arg;
+    while (!mt_stop)
+        if (!ansi_async_drain(&mt_q, 0)) sched_yield();
+    return NULL;
+}
+
+void test_async_multi_producer_flush(void)
+{
+    static ansi_async_slot_t slots[64];
+    ansi_async_init(&mt_q, slots, 64, &out, ANSI_ASYNC_BLOCK, yield);
+    mt_stop = 0;
+
+    pthread_t cons, prod[PRODUCERS];
+    pthread_create(&cons, NULL, consumer, NULL);
+    for (int i = 0; i < PRODUCERS; i++)
+        pthread_create(&prod[i], NULL, producer, (void *)(size_t)i);
+    for (int i = 0; i < PRODUCERS; i++)
+        pthread_join(prod[i], NULL);
+
+    ansi_async_flush(&mt_q);
+    int lines_at_flush = 0;
+    for (const char *p = capture_buf; *p; p++) lines_at_flush += *p == '\n';
+
+    mt_stop = 1;
+    pthread_join(cons, NULL);
+
+    /* Flush returned only after every record was written */
+    TEST_ASSERT_EQUAL(PRODUCERS * PER_THREAD, lines_at_flush);
+    TEST_ASSERT_EQUAL(0, (int)ansi_async_dropped(&mt_q));
+
+    /* Each producer's records appear in its own order */
+    int next[PRODUCERS] = {0};
+    const char *p = capture_buf;
+    int id, seq, n;
+    while (sscanf(p, "%d:%d\n%n", &id, &seq, &n) == 2) {
+        TEST_ASSERT_TRUE(id >= 0 && id < PRODUCERS);
+        TEST_ASSERT_EQUAL(next[id], seq);
+        next[id]++;
+        p += n;
+    }
+    for (int i = 0; i < PRODUCERS; i++)
+        TEST_ASSERT_EQUAL(PER_THREAD, next[i]);
+}
+
+#else
+
+void setUp(void) { }
+void tearDown(void) { }
+
+#endif /* ANSI_PRINT_ASYNC */
+
+int main(void)
+{
+    UNITY_BEGIN();
+#if ANSI_PRINT_ASYNC
+    RUN_TEST(test_async_init_requires_power_of_two);
+    RUN_TEST(test_async_renders_in_order_one_flush);
+    RUN_TEST(test_async_drain_max);
+    RUN_TEST(test_async_drop_newest);
+    RUN_TEST(test_async_drop_oldest);
+    RUN_TEST(test_async_truncates_long_record);
+    RUN_TEST(test_async_multi_producer_flush);
+#else
+    printf("ANSI_PRINT_ASYNC=0: async tests skipped (make test-async)\n");
+#endif
+    return UNITY_END();
+}
@@ -49,6 +49,277 @@ void tearDown(void) { }
 /* Core tests (always compiled)                                       */
 /* ------------------------------------------------------------------ */
 
+static int flush_count;
+static void counting_flush(void) { flush_count++; }
+
+void test_batch_defers_flush(void)
+{
+    ansi_init(capture_putc, counting_flush, fmt_buf, sizeof(fmt_buf));
+    flush_count = 0;
+    ansi_batch_begin();
+    ansi_puts("a");
+    ansi_batch_begin();           /* nested */
+    ansi_print("%s", "b");
+    ansi_batch_end();
+    TEST_ASSERT_EQUAL(0, flush_count);
+    ansi_batch_end();
+    TEST_ASSERT_EQUAL(1, flush_count);
+    TEST_ASSERT_EQUAL_STRING("ab", capture_buf);
+
+    /* Unbalanced end is ignored; flushing resumes per call */
+    ansi_batch_end();
+    ansi_puts("c");
+    TEST_ASSERT_EQUAL(2, flush_count);
+}
+
+void test_write_raw_bytes(void)
+{
+    ansi_write("[red]x\x1b[1;1H", 13);
+    /* No markup processing: tags pass through verbatim */
+    TEST_ASSERT_EQUAL_STRING("[red]x\x1b[1;1H", capture_buf);
+}
+
+void test_sgr_matches_markup(void)
+{
+    char sgr[24];
+    TEST_ASSERT_EQUAL_STRING("\x1b[31m", ansi_sgr(sgr, sizeof(sgr), "red"));
+    ansi_print("[red on blue]x");
+    char expect[64];
+    snprintf(expect, sizeof(expect), "%sx\x1b[0m",
+             ansi_sgr(sgr, sizeof(sgr), "red on blue"));
+    TEST_ASSERT_EQUAL_STRING(expect, capture_buf);
+    TEST_ASSERT_EQUAL_STRING("", ansi_sgr(sgr, sizeof(sgr), "nosuchcolor"));
+}
+
+void test_sgr_ignores_enable_state(void)
+{
+    char sgr[24];
+    ansi_set_enabled(0);
+    TEST_ASSERT_EQUAL_STRING("\x1b[32m", ansi_sgr(sgr, sizeof(sgr), "green"));
+    ansi_print("[green]x[/]");
+    TEST_ASSERT_EQUAL_STRING("x", capture_buf);   /* state restored */
+}
+
+/* Second output for context tests */
+static char ctx_out[256];
+static int  ctx_pos;
+static void ctx_putc(int ch)
+{
+    if (ctx_pos < (int)sizeof(ctx_out) - 1) ctx_out[ctx_pos++] = (char)ch;
+}
+
+void test_ctx_outputs_independent(void)
+{
+    static char cbuf[64];
+    ansi_ctx_t ctx;
+    ansi_ctx_init(&ctx, ctx_putc, NULL, cbuf, sizeof(cbuf));
+    memset(ctx_out, 0, sizeof(ctx_out));
+    ctx_pos = 0;
+
+    ansi_ctx_print(&ctx, "[red]%d", 7);
+    ansi_print("plain");
+    TEST_ASSERT_EQUAL_STRING("\x1b[31m7\x1b[0m", ctx_out);
+    TEST_ASSERT_EQUAL_STRING("plain", capture_buf);
+    TEST_ASSERT_EQUAL_PTR(cbuf, ansi_ctx_get_buf(&ctx, NULL));
+    TEST_ASSERT_EQUAL_PTR(fmt_buf, ansi_get_buf(NULL));
+}
+
+static int user_flushes;
+static void user_putc(void *user, int ch)
+{
+    char **p = (char **)user;
+    *(*p)++ = (char)ch;
+}
+static void user_flush(void *user) { (void)user; user_flushes++; }
+
+void test_ctx_set_output_user_callbacks(void)
+{
+    static char cbuf[64];
+    char out[32] = {0};
+    char *cursor = out;
+    ansi_ctx_t ctx;
+    ansi_ctx_init(&ctx, ctx_putc, NULL, cbuf, sizeof(cbuf));
+    memset(ctx_out, 0, sizeof(ctx_out));
+    ctx_pos = 0;
+    user_flushes = 0;
+
+    ansi_ctx_set_output(&ctx, user_putc, user_flush, &cursor);
+    ansi_ctx_puts(&ctx, "[red]u[/]");
+    TEST_ASSERT_EQUAL_STRING("\x1b[31mu\x1b[0m", out);
+    TEST_ASSERT_EQUAL(1, user_flushes);
+    TEST_ASSERT_EQUAL_STRING("", ctx_out);
+
+    /* NULL restores the plain callbacks */
+    ansi_ctx_set_output(&ctx, NULL, NULL, NULL);
+    ansi_ctx_puts(&ctx, "p");
+    TEST_ASSERT_EQUAL_STRING("p", ctx_out);
+}
+
+void test_ctx_bytes_counts_output(void)
+{
+    static char cbuf[64];
+    ansi_ctx_t ctx;
+    ansi_ctx_init(&ctx, ctx_putc, NULL, cbuf, sizeof(cbuf));
+    memset(ctx_out, 0, sizeof(ctx_out));
+    ctx_pos = 0;
+
+    TEST_ASSERT_EQUAL(0, (int)ansi_ctx_bytes(&ctx));
+    ansi_ctx_puts(&ctx, "[red]ab[/]");
+    TEST_ASSERT_EQUAL((int)strlen(ctx_out), (int)ansi_ctx_bytes(&ctx));
+    TEST_ASSERT_EQUAL(0, (int)ansi_ctx_bytes(NULL));
+}
+
+#if ANSI_PRINT_REP
+static ansi_ctx_t rep_ctx;
+
+static void rep_setup(void)
+{
+    static char cbuf[128];
+    ansi_ctx_init(&rep_ctx, ctx_putc, NULL, cbuf, sizeof(cbuf));
+    ansi_ctx_set_rep(&rep_ctx, 1);
+    memset(ctx_out, 0, sizeof(ctx_out));
+    ctx_pos = 0;
+}
+
+void test_rep_compresses_runs(void)
+{
+    rep_setup();
+    ansi_ctx_puts(&rep_ctx, "a----------b");
+    TEST_ASSERT_EQUAL_STRING("a-\x1b[9bb", ctx_out);
+
+    /* Short runs are cheaper as copies */
+    rep_setup();
+    ansi_ctx_puts(&rep_ctx, "xx---y");
+    TEST_ASSERT_EQUAL_STRING("xx---y", ctx_out);
+}
+
+void test_rep_box_glyph_border(void)
+{
+    char line[80 * 3 + 1];
+    for (int i = 0; i < 80; i++) memcpy(line + i * 3, "\xe2\x95\x90", 3);   /* U+2550 */
+    line[240] = '\0';
+
+    rep_setup();
+    ansi_ctx_puts(&rep_ctx, line);
+    TEST_ASSERT_EQUAL_STRING("\xe2\x95\x90\x1b[79b", ctx_out);
+    TEST_ASSERT_EQUAL(8, (int)ansi_ctx_bytes(&rep_ctx));
+}
+
+void test_rep_leaves_escapes_alone(void)
+{
+    rep_setup();
+    ansi_ctx_puts(&rep_ctx, "[red]======[/]");
+    TEST_ASSERT_EQUAL_STRING("\x1b[31m=\x1b[5b\x1b[0m", ctx_out);
+
+    /* An escape sequence ends the run */
+    rep_setup();
+    ansi_ctx_puts(&rep_ctx, "======[red]======[/]");
+    TEST_ASSERT_EQUAL_STRING("=\x1b[5b\x1b[31m=\x1b[5b\x1b[0m", ctx_out);
+
+    /* The final byte of a charset switch is not a glyph */
+    rep_setup();
+    ansi_ctx_puts(&rep_ctx, "\x1b(0qqqqqqq\x1b(B");
+    TEST_ASSERT_EQUAL_STRING("\x1b(0q\x1b[6b\x1b(B", ctx_out);
+}
+
+void test_rep_runs_end_at_flush(void)
+{
+    rep_setup();
+    ansi_ctx_puts(&rep_ctx, "======");
+    ansi_ctx_puts(&rep_ctx, "======");
+    TEST_ASSERT_EQUAL_STRING("=\x1b[5b=\x1b[5b", ctx_out);
+
+    /* Inside a batch nothing is flushed, so the run continues */
+    rep_setup();
+    ansi_ctx_batch_begin(&rep_ctx);
+    ansi_ctx_puts(&rep_ctx, "======");
+    ansi_ctx_puts(&rep_ctx, "======");
+    ansi_ctx_batch_end(&rep_ctx);
+    TEST_ASSERT_EQUAL_STRING("=\x1b[11b", ctx_out);
+
+    /* Disabled: byte for byte */
+    rep_setup();
+    ansi_ctx_set_rep(&rep_ctx, 0);
+    ansi_ctx_puts(&rep_ctx, "======");
+    TEST_ASSERT_EQUAL_STRING("======", ctx_out);
+}
+#endif /* ANSI_PRINT_REP */
+
+#if ANSI_PRINT_ECH
+void test_blank_uses_ech_when_shorter(void)
+{
+    static char cbuf[64];
+    ansi_ctx_t ctx;
+    ansi_ctx_init(&ctx, ctx_putc, NULL, cbuf, sizeof(cbuf));
+    ansi_ctx_set_erase(&ctx, 1);
+    memset(ctx_out, 0, sizeof(ctx_out));
+    ctx_pos = 0;
+
+    TEST_ASSERT_EQUAL(0, ansi_ctx_blank(&ctx, 60, 0));
+    TEST_ASSERT_EQUAL_STRING("\x1b[60X", ctx_out);
+    TEST_ASSERT_EQUAL(5, (int)ansi_ctx_bytes(&ctx));
+
+    /* Advancing adds a cursor-forward */
+    ctx_pos = 0;
+    memset(ctx_out, 0, sizeof(ctx_out));
+    TEST_ASSERT_EQUAL(60, ansi_ctx_blank(&ctx, 60, 1));
+    TEST_ASSERT_EQUAL_STRING("\x1b[60X\x1b[60C", ctx_out);
+
+    /* Short blanks are cheaper as spaces */
+    ctx_pos = 0;
+    memset(ctx_out, 0, sizeof(ctx_out));
+    TEST_ASSERT_EQUAL(4, ansi_ctx_blank(&ctx, 4, 0));
+    TEST_ASSERT_EQUAL_STRING("    ", ctx_out);
+}
+
+void test_blank_falls_back_to_spaces(void)
+{
+    static char cbuf[64];
+    ansi_ctx_t ctx;
+    ansi_ctx_init(&ctx, ctx_putc, NULL, cbuf, sizeof(cbuf));
+    ansi_ctx_set_erase(&ctx, 0);
+    memset(ctx_out, 0, sizeof(ctx_out));
+    ctx_pos = 0;
+
+    TEST_ASSERT_EQUAL(12, ansi_ctx_blank(&ctx, 12, 0));
+    TEST_ASSERT_EQUAL_STRING("            ", ctx_out);
+    TEST_ASSERT_EQUAL(0, ansi_ctx_blank(&ctx, 0, 1));
+    TEST_ASSERT_EQUAL(0, ansi_ctx_blank(NULL, 5, 1));
+}
+#endif /* ANSI_PRINT_ECH */
+
+void test_ctx_state_isolated(void)
+{
+    static char cbuf[64];
+    ansi_ctx_t ctx;
+    ansi_ctx_init(&ctx, ctx_putc, NULL, cbuf, sizeof(cbuf));
+    memset(ctx_out, 0, sizeof(ctx_out));
+    ctx_pos = 0;
+
+    /* Disabling color on one context leaves the other untouched */
+    ansi_ctx_set_enabled(&ctx, 0);
+    ansi_ctx_puts(&ctx, "[green]a[/]");
+    ansi_puts("[green]b[/]");
+    TEST_ASSERT_EQUAL_STRING("a", ctx_out);
+    TEST_ASSERT_EQUAL_STRING("\x1b[32mb\x1b[0m", capture_buf);
+    TEST_ASSERT_TRUE(ansi_is_enabled());
+    TEST_ASSERT_EQUAL_PTR(ansi_default_ctx(), ansi_default_ctx());
+}
+
+void test_ctx_color_cached(void)
+{
+    char scratch[ANSI_PRINT_SGR_MAX];
+    ansi_ctx_t *ctx = ansi_default_ctx();
+    const char *a = ansi_ctx_color(ctx, scratch, "red");
+    TEST_ASSERT_EQUAL_STRING("\x1b[31m", a);
+#if ANSI_PRINT_SGR_CACHE > 0
+    TEST_ASSERT_EQUAL_PTR(a, ansi_ctx_color(ctx, scratch, "red"));
+#endif
+    TEST_ASSERT_EQUAL_STRING("", ansi_ctx_color(ctx, scratch, NULL));
+    ansi_set_enabled(0);
+    TEST_ASSERT_EQUAL_STRING("", ansi_ctx_color(ctx, scratch, "red"));
+}
+
 void test_plain_text_no_tags(void)
 {
     ansi_print("hello world");
@@ -302,6 +573,29 @@ void test_adjacent_emoji(void)
     TEST_ASSERT_EQUAL_STRING(
         "\xf0\x9f\x94\xa5\xf0\x9f\x94\xa5", capture_buf);
 }
+
+void test_emoji_get_matches_table(void)
+{
+    const ansi_emoji_entry_t *t = ansi_emoji_table();
+    ansi_emoji_entry_t e;
+    int n = ansi_emoji_count();
+    for (int i = 0; i < n; i++) {
+        TEST_ASSERT_TRUE(ansi_emoji_get(i, &e));
+        TEST_ASSERT_EQUAL_STRING(t[i].name, e.name);
+        TEST_ASSERT_EQUAL_STRING(t[i].utf8, e.utf8);
+        TEST_ASSERT_EQUAL((int)strlen(e.name), e.len);
+    }
+    TEST_ASSERT_FALSE(ansi_emoji_get(n, &e));
+    TEST_ASSERT_FALSE(ansi_emoji_get(-1, &e));
+
+    /* Entries come from the same pool the markup parser reads */
+    ansi_emoji_get(n - 1, &e);
+    char markup[40];
+    snprintf(markup, sizeof(markup), ":%s:", e.name);
+    ansi_set_enabled(0);
+    ansi_print(markup);
+    TEST_ASSERT_EQUAL_STRING(e.utf8, capture_buf);
+}
 #endif /* ANSI_PRINT_EMOJI */
 
 /* ------------------------------------------------------------------ */
@@ -537,6 +831,23 @@ void test_numeric_bg(void)
     TEST_ASSERT_NOT_NULL(strstr(capture_buf, "dark"));
 }
 
+#if ANSI_PRINT_BRIGHT_COLORS && ANSI_PRINT_EXTENDED_COLORS
+void test_color_codes_fg_and_bg(void)
+{
+    /* One table code per color; fg and bg escapes are built from it */
+    ansi_print("[bright_red on bright_blue]a[/] [orange on teal]b[/]");
+    TEST_ASSERT_EQUAL_STRING("\x1b[91m\x1b[104ma\x1b[0m "
+                             "\x1b[38;5;208m\x1b[48;5;37mb\x1b[0m", capture_buf);
+}
+#endif
+
+void test_numeric_fg_close_matches_code(void)
+{
+    /* [/red] names basic red, not palette index 1: fg:1 stays active */
+    ansi_print("[fg:1]a[/red]b");
+    TEST_ASSERT_EQUAL_STRING("\x1b[38;5;1ma\x1b[0m\x1b[38;5;1mb\x1b[0m", capture_buf);
+}
+
 void test_numeric_fg_disabled(void)
 {
     ansi_set_enabled(0);
@@ -768,6 +1079,87 @@ void test_gradient_rejects_style(void)
 #endif
 #endif /* ANSI_PRINT_GRADIENTS */
 
+/* ------------------------------------------------------------------ */
+/* Color depth downsampling                                           */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_PRINT_COLOR_DEPTH
+void test_rgb_to_256_nearest(void)
+{
+    TEST_ASSERT_EQUAL(196, ansi_rgb_to_256(255, 0, 0));
+    TEST_ASSERT_EQUAL(231, ansi_rgb_to_256(255, 255, 255));
+    TEST_ASSERT_EQUAL(16,  ansi_rgb_to_256(0, 0, 0));
+    TEST_ASSERT_EQUAL(244, ansi_rgb_to_256(128, 128, 128));   /* gray ramp */
+    TEST_ASSERT_EQUAL(9,   ansi_256_to_16(196));
+    TEST_ASSERT_EQUAL(4,   ansi_256_to_16(4));
+}
+
+void test_depth_16_maps_palette_colors(void)
+{
+    ansi_set_depth(ANSI_DEPTH_16);
+    ansi_print("[fg:196]a[/] [red on bg:21]b[/]");
+    TEST_ASSERT_NULL(strstr(capture_buf, ";5;"));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\x1b[91ma"));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\x1b[31m\x1b[44mb"));
+
+    /* Cached colors are re-resolved at the new depth */
+    char scratch[ANSI_PRINT_SGR_MAX];
+    TEST_ASSERT_EQUAL_STRING("\x1b[91m", ansi_ctx_color(ansi_default_ctx(), scratch, "fg:196"));
+    ansi_set_depth(ANSI_DEPTH_TRUE);
+    TEST_ASSERT_EQUAL_STRING("\x1b[38;5;196m", ansi_ctx_color(ansi_default_ctx(), scratch, "fg:196"));
+}
+
+#if ANSI_PRINT_GRADIENTS
+void test_depth_shrinks_gradient(void)
+{
+    ansi_print("[gradient red blue]gradient![/gradient]");
+    size_t full = strlen(capture_buf);
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\x1b[38;2;255;0;0mg"));
+
+    capture_reset();
+    ansi_set_depth(ANSI_DEPTH_256);
+    ansi_print("[gradient red blue]gradient![/gradient]");
+    TEST_ASSERT_NULL(strstr(capture_buf, ";2;"));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\x1b[38;5;196mg"));
+    size_t at256 = strlen(capture_buf);
+
+    capture_reset();
+    ansi_set_depth(ANSI_DEPTH_16);
+    ansi_print("[gradient red blue]gradient![/gradient][rainbow]ab[/rainbow]");
+    TEST_ASSERT_NULL(strstr(capture_buf, "38;"));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\x1b[91mg"));
+    TEST_ASSERT_TRUE(at256 < full);
+    TEST_ASSERT_TRUE(strlen(capture_buf) < at256);
+}
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+void test_enable_detects_depth(void)
+{
+    static char ct[] = "COLORTERM=", t256[] = "TERM=xterm-256color", t16[] = "TERM=linux";
+    const char *old = getenv("TERM");
+    static char saved[64];
+    snprintf(saved, sizeof(saved), "TERM=%s", old ? old : "");
+
+    putenv(ct);
+    putenv(t256);
+    ansi_enable();
+    TEST_ASSERT_EQUAL(ANSI_DEPTH_256, ansi_ctx_depth(ansi_default_ctx()));
+    putenv(t16);
+    ansi_enable();
+    TEST_ASSERT_EQUAL(ANSI_DEPTH_16, ansi_ctx_depth(ansi_default_ctx()));
+    static char truecolor[] = "COLORTERM=truecolor";
+    putenv(truecolor);
+    ansi_enable();
+    TEST_ASSERT_EQUAL(ANSI_DEPTH_TRUE, ansi_ctx_depth(ansi_default_ctx()));
+
+    unsetenv("COLORTERM");
+    if (old) putenv(saved); else unsetenv("TERM");
+}
+#endif
+#endif /* ANSI_PRINT_COLOR_DEPTH */
+
+
 /* ------------------------------------------------------------------ */
 /* Unicode 2-byte range test                                          */
 /* ------------------------------------------------------------------ */
@@ -1432,6 +1824,55 @@ void test_bar_track_line(void)
         TEST_ASSERT_EQUAL_MEMORY("\xe2\x94\x80", bar + i*3, 3);
 }
 
+void test_bar_eighths(void)
+{
+    TEST_ASSERT_EQUAL(0,  ansi_bar_eighths(4, 0, 0, 100));
+    TEST_ASSERT_EQUAL(16, ansi_bar_eighths(4, 50, 0, 100));
+    TEST_ASSERT_EQUAL(32, ansi_bar_eighths(4, 200, 0, 100));
+    TEST_ASSERT_EQUAL(32, ansi_bar_eighths(4, 5, 5, 5));   /* degenerate range -> full */
+    /* 50.1% and 50% of a 4-cell bar quantize to the same fill */
+    TEST_ASSERT_EQUAL(ansi_bar_eighths(4, 50, 0, 100),
+                      ansi_bar_eighths(4, 50.1, 0, 100));
+}
+
+void test_bar_eighths_i32_matches_double(void)
+{
+    for (int width = 1; width <= 20; width++)
+        for (int v = -10; v <= 110; v++)
+            TEST_ASSERT_EQUAL(ansi_bar_eighths(width, v, 0, 100),
+                              ansi_bar_eighths_i32(width, v, 0, 100));
+    TEST_ASSERT_EQUAL(32, ansi_bar_eighths_i32(4, 5, 5, 5));   /* degenerate range -> full */
+    TEST_ASSERT_EQUAL(8,  ansi_bar_eighths_i32(4, 75, 100, 0)); /* inverted range */
+    TEST_ASSERT_EQUAL(0,  ansi_bar_eighths_i32(0, 50, 0, 100));
+    /* Full int32_t span does not overflow */
+    TEST_ASSERT_EQUAL(16, ansi_bar_eighths_i32(4, 0, INT32_MIN, INT32_MAX));
+}
+
+void test_bar_eighths_i32_rounds_half_up(void)
+{
+    /* 1/16 of a 1-cell bar is exactly half an eighth */
+    TEST_ASSERT_EQUAL(1, ansi_bar_eighths_i32(1, 1, 0, 16));
+    TEST_ASSERT_EQUAL(0, ansi_bar_eighths_i32(1, 1, 0, 17));
+}
+
+void test_bar_i32_q16(void)
+{
+    char a[128], b[128];
+    /* Q16.16 value and range quantize like the integer ones */
+    ansi_bar(a, sizeof(a), "green", 10, ANSI_BAR_LIGHT, 37.5, 0, 100);
+    ansi_bar_i32(b, sizeof(b), "green", 10, ANSI_BAR_LIGHT,
+                 (int32_t)(37.5 * 65536), 0, 100 << 16);
+    TEST_ASSERT_EQUAL_STRING(a, b);
+}
+
+void test_bar_span_middle_cells(void)
+{
+    char bar[128];
+    /* 12 eighths = 1 full block + half block; render cells 1..2 only */
+    ansi_bar_span(bar, sizeof(bar), NULL, ANSI_BAR_LIGHT, 12, 1, 2);
+    TEST_ASSERT_EQUAL_STRING("\xe2\x96\x8c\xe2\x96\x91", bar);
+}
+
 void test_bar_null_buf(void)
 {
     /* NULL buffer should return "" without crashing */
@@ -1685,6 +2126,25 @@ int main(void)
 
     /* Core (always run) */
     RUN_TEST(test_plain_text_no_tags);
+    RUN_TEST(test_batch_defers_flush);
+    RUN_TEST(test_write_raw_bytes);
+    RUN_TEST(test_sgr_matches_markup);
+    RUN_TEST(test_sgr_ignores_enable_state);
+    RUN_TEST(test_ctx_outputs_independent);
+    RUN_TEST(test_ctx_state_isolated);
+    RUN_TEST(test_ctx_set_output_user_callbacks);
+    RUN_TEST(test_ctx_bytes_counts_output);
+#if ANSI_PRINT_REP
+    RUN_TEST(test_rep_compresses_runs);
+    RUN_TEST(test_rep_box_glyph_border);
+    RUN_TEST(test_rep_leaves_escapes_alone);
+    RUN_TEST(test_rep_runs_end_at_flush);
+#endif
+#if ANSI_PRINT_ECH
+    RUN_TEST(test_blank_uses_ech_when_shorter);
+    RUN_TEST(test_blank_falls_back_to_spaces);
+#endif
+    RUN_TEST(test_ctx_color_cached);
     RUN_TEST(test_printf_formatting);
     RUN_TEST(test_color_disabled_strips_tags);
     RUN_TEST(test_color_enabled_emits_ansi);
@@ -1725,6 +2185,10 @@ int main(void)
     /* Numeric colors */
     RUN_TEST(test_numeric_fg);
     RUN_TEST(test_numeric_bg);
+#if ANSI_PRINT_BRIGHT_COLORS && ANSI_PRINT_EXTENDED_COLORS
+    RUN_TEST(test_color_codes_fg_and_bg);
+#endif
+    RUN_TEST(test_numeric_fg_close_matches_code);
     RUN_TEST(test_numeric_fg_disabled);
     RUN_TEST(test_numeric_fg_clamp_high);
     RUN_TEST(test_numeric_fg_clamp_negative);
@@ -1812,6 +2276,11 @@ int main(void)
     RUN_TEST(test_bar_track_med);
     RUN_TEST(test_bar_track_heavy);
     RUN_TEST(test_bar_track_dot);
+    RUN_TEST(test_bar_eighths);
+    RUN_TEST(test_bar_eighths_i32_matches_double);
+    RUN_TEST(test_bar_eighths_i32_rounds_half_up);
+    RUN_TEST(test_bar_i32_q16);
+    RUN_TEST(test_bar_span_middle_cells);
     RUN_TEST(test_bar_track_line);
     RUN_TEST(test_bar_null_buf);
     RUN_TEST(test_bar_tiny_buf);
@@ -1854,6 +2323,16 @@ int main(void)
     RUN_TEST(test_gradient_rejects_style);
 #endif
 #endif
+#if ANSI_PRINT_COLOR_DEPTH
+    RUN_TEST(test_rgb_to_256_nearest);
+    RUN_TEST(test_depth_16_maps_palette_colors);
+#if ANSI_PRINT_GRADIENTS
+    RUN_TEST(test_depth_shrinks_gradient);
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    RUN_TEST(test_enable_detects_depth);
+#endif
+#endif
 
 #if ANSI_PRINT_EMOJI
     RUN_TEST(test_emoji_fire);
@@ -1866,6 +2345,7 @@ int main(void)
     RUN_TEST(test_bare_colon);
     RUN_TEST(test_colon_at_end);
     RUN_TEST(test_adjacent_emoji);
+    RUN_TEST(test_emoji_get_matches_table);
 #endif
 
 #if ANSI_PRINT_UNICODE
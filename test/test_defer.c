@@ -0,0 +1,170 @@
+#include "unity.h"
+#include "ansi_defer.h"
+#include <string.h>
+#include <stdio.h>
+
+#if ANSI_PRINT_DEFER
+
+#define ANSI_DEFER_FMT(id, fmt) id,
+enum {
+#include "defer_formats.inc"
+    LOG_COUNT
+};
+#undef ANSI_DEFER_FMT
+
+#define ANSI_DEFER_FMT(id, fmt) fmt,
+static const char *const formats[] = {
+#include "defer_formats.inc"
+};
+#undef ANSI_DEFER_FMT
+
+/* ------------------------------------------------------------------ */
+/* Two contexts: the target's wire and the host's terminal             */
+/* ------------------------------------------------------------------ */
+
+#define CAPTURE_SIZE 1024
+
+static unsigned char wire[CAPTURE_SIZE];
+static size_t        wire_len;
+static char          term[CAPTURE_SIZE];
+static size_t        term_len;
+
+static void wire_putc(int ch)
+{
+    if (wire_len < CAPTURE_SIZE) wire[wire_len++] = (unsigned char)ch;
+}
+
+static void term_putc(int ch)
+{
+    if (term_len < CAPTURE_SIZE - 1) term[term_len++] = (char)ch;
+}
+
+static void no_flush(void) { }
+
+static ansi_ctx_t   target_ctx, host_ctx;
+static char         target_buf[64], host_buf[256];
+static ansi_defer_t target, host;
+
+void setUp(void)
+{
+    memset(wire, 0, sizeof(wire));
+    memset(term, 0, sizeof(term));
+    wire_len = term_len = 0;
+    ansi_ctx_init(&target_ctx, wire_putc, no_flush, target_buf, sizeof(target_buf));
+    ansi_ctx_init(&host_ctx, term_putc, no_flush, host_buf, sizeof(host_buf));
+    ansi_ctx_set_enabled(&host_ctx, 1);
+    ansi_defer_init(&target, &target_ctx, formats, LOG_COUNT);
+    ansi_defer_init(&host, &host_ctx, formats, LOG_COUNT);
+}
+
+void tearDown(void) { }
+
+/** Decode everything on the wire into term. */
+static int decode_all(void)
+{
+    size_t pos = 0;
+    int records = 0;
+    while (pos < wire_len) {
+        size_t n = ansi_defer_decode(&host, wire + pos, wire_len - pos);
+        if (!n) break;
+        pos += n;
+        records++;
+    }
+    return records;
+}
+
+/* ------------------------------------------------------------------ */
+/* Tests                                                               */
+/* ------------------------------------------------------------------ */
+
+void test_defer_wire_bytes(void)
+{
+    /* len=2, id=2, zigzag(-3)=5 */
+    TEST_ASSERT_EQUAL(3, (int)ansi_defer_log(&target, LOG_INT, -3));
+    TEST_ASSERT_EQUAL(3, (int)wire_len);
+    TEST_ASSERT_EQUAL_HEX8(0x02, wire[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, wire[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x05, wire[2]);
+}
+
+void test_defer_smaller_than_text(void)
+{
+    size_t n = ansi_defer_log(&target, LOG_TEMP, 41250, "on");
+    char text[128];
+    size_t text_len = (size_t)snprintf(text, sizeof(text),
+        "\x1b[33mtemp\x1b[0m %d mC  fan %s\n", 41250, "on");
+    TEST_ASSERT_TRUE(n > 0);
+    TEST_ASSERT_TRUE(n * 3 < text_len);
+}
+
+void test_defer_round_trip_renders_markup(void)
+{
+    ansi_defer_log(&target, LOG_PLAIN);
+    ansi_defer_log(&target, LOG_TEMP, -5, "off");
+    TEST_ASSERT_EQUAL(2, decode_all());
+    TEST_ASSERT_EQUAL_STRING("hello\n\x1b[33mtemp\x1b[0m -5 mC  fan off\n", term);
+}
+
+void test_defer_round_trip_conversions(void)
+{
+    char expect[128];
+    snprintf(expect, sizeof(expect), formats[LOG_MIXED], 3.25, "ab", 255u, 'z',
+             6, -42, 2, "xyz", -9000000000LL, (unsigned char)200, 4000000000UL);
+    ansi_defer_log(&target, LOG_MIXED, 3.25, "ab", 255u, 'z',
+                   6, -42, 2, "xyz", -9000000000LL, (unsigned char)200, 4000000000UL);
+    TEST_ASSERT_EQUAL(1, decode_all());
+    TEST_ASSERT_EQUAL_STRING(expect, term);
+}
+
+void test_defer_partial_record_waits(void)
+{
+    ansi_defer_log(&target, LOG_TEMP, 1, "x");
+    TEST_ASSERT_EQUAL(0, (int)ansi_defer_decode(&host, wire, wire_len - 1));
+    TEST_ASSERT_EQUAL_STRING("", term);
+    TEST_ASSERT_EQUAL((int)wire_len, (int)ansi_defer_decode(&host, wire, wire_len));
+}
+
+void test_defer_unknown_id_skipped(void)
+{
+    ansi_defer_t short_table;
+    ansi_defer_init(&short_table, &host_ctx, formats, LOG_INT);
+    ansi_defer_log(&target, LOG_INT, 7);
+    ansi_defer_log(&target, LOG_PLAIN);
+
+    size_t n = ansi_defer_decode(&short_table, wire, wire_len);
+    TEST_ASSERT_EQUAL(3, (int)n);
+    ansi_defer_decode(&short_table, wire + n, wire_len - n);
+    TEST_ASSERT_EQUAL_STRING("<defer: unknown id 2>\nhello\n", term);
+}
+
+void test_defer_oversize_dropped(void)
+{
+    char big[ANSI_PRINT_DEFER_RECORD + 1];
+    memset(big, 'x', sizeof(big) - 1);
+    big[sizeof(big) - 1] = '\0';
+    TEST_ASSERT_EQUAL(0, (int)ansi_defer_log(&target, LOG_STR, big));
+    TEST_ASSERT_EQUAL(0, (int)ansi_defer_log(&target, LOG_COUNT));
+    TEST_ASSERT_EQUAL(0, (int)wire_len);
+}
+
+#else
+
+void setUp(void) { }
+void tearDown(void) { }
+
+#endif /* ANSI_PRINT_DEFER */
+
+int main(void)
+{
+    UNITY_BEGIN();
+#if ANSI_PRINT_DEFER
+    RUN_TEST(test_defer_wire_bytes);
+    RUN_TEST(test_defer_smaller_than_text);
+    RUN_TEST(test_defer_round_trip_renders_markup);
+    RUN_TEST(test_defer_round_trip_conversions);
+    RUN_TEST(test_defer_partial_record_waits);
+    RUN_TEST(test_defer_unknown_id_skipped);
+    RUN_TEST(test_defer_oversize_dropped);
+#endif
+    return UNITY_END();
+}
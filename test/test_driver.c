@@ -0,0 +1,194 @@
+#if !defined(_XOPEN_SOURCE) && !defined(_GNU_SOURCE)
+#define _XOPEN_SOURCE 600   /* posix_openpt() under -std=c99 */
+#endif
+
+#include "unity.h"
+#include "ansi_driver.h"
+#include <string.h>
+#include <stdio.h>
+
+#if ANSI_TUI_DRIVER && ANSI_TUI_TEXT
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+/* ------------------------------------------------------------------ */
+/* Capture buffer                                                      */
+/* ------------------------------------------------------------------ */
+
+#define CAPTURE_SIZE 4096
+
+static char capture_buf[CAPTURE_SIZE];
+static int  capture_pos;
+
+static void capture_putc(int ch)
+{
+    if (capture_pos < CAPTURE_SIZE - 1)
+        capture_buf[capture_pos++] = (char)ch;
+}
+
+static void capture_reset(void)
+{
+    memset(capture_buf, 0, sizeof(capture_buf));
+    capture_pos = 0;
+}
+
+static ansi_ctx_t         out;
+static char               out_buf[256];
+static tui_screen_entry_t entries[2];
+static tui_screen_t       scr;
+static tui_driver_t       drv;
+
+static char             tbuf[32];
+static tui_text_state_t tst;
+static const tui_text_t text = {
+    .place = { .row = 1, .col = 1, .screen = &scr },
+    .width = 10, .state = &tst, .text_buf = tbuf, .text_buf_size = sizeof(tbuf)
+};
+
+void setUp(void)
+{
+    capture_reset();
+    ansi_ctx_init(&out, capture_putc, NULL, out_buf, sizeof(out_buf));
+    ansi_ctx_set_enabled(&out, 0);
+    tui_screen_init(&scr, entries, 2);
+    tui_screen_set_ctx(&scr, &out);
+    memset(&tst, 0, sizeof(tst));
+}
+
+void tearDown(void)
+{
+    tui_driver_close(&drv);
+}
+
+/** Wait up to @p ms for the driver's descriptor; 1 if it became readable. */
+static int wait_ready(int ms)
+{
+    struct pollfd p = { .fd = tui_driver_fd(&drv), .events = POLLIN };
+    return poll(&p, 1, ms) == 1;
+}
+
+/* ------------------------------------------------------------------ */
+/* Tests                                                               */
+/* ------------------------------------------------------------------ */
+
+void test_driver_rejects_bad_arguments(void)
+{
+    TEST_ASSERT_EQUAL(0, tui_driver_init(&drv, NULL, 30, -1));
+    TEST_ASSERT_EQUAL(0, tui_driver_init(&drv, &scr, 0, -1));
+    TEST_ASSERT_EQUAL(1, tui_driver_init(&drv, &scr, 30, -1));
+    TEST_ASSERT_TRUE(tui_driver_fd(&drv) >= 0);
+}
+
+void test_driver_renders_update_then_goes_idle(void)
+{
+    TEST_ASSERT_EQUAL(1, tui_driver_init(&drv, &scr, 100, -1));
+    tui_text_init(&text);
+    capture_reset();
+
+    /* Nothing dirty: the clock is stopped and the descriptor stays quiet */
+    TEST_ASSERT_EQUAL(0, drv.armed);
+    TEST_ASSERT_EQUAL(0, wait_ready(30));
+
+    /* Two updates in one pass arm the clock and share one frame */
+    tui_text_update(&text, "one");
+    tui_text_update(&text, "two");
+    TEST_ASSERT_EQUAL(1, drv.armed);
+    TEST_ASSERT_EQUAL(1, wait_ready(100));
+    TEST_ASSERT_EQUAL(1, tui_driver_dispatch(&drv));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "two"));
+    TEST_ASSERT_NULL(strstr(capture_buf, "one"));
+
+    /* Nothing more to draw: stopped again */
+    TEST_ASSERT_EQUAL(0, drv.armed);
+    TEST_ASSERT_EQUAL(1, (int)drv.idles);
+    TEST_ASSERT_EQUAL(0, wait_ready(50));
+}
+
+static int frame_calls;
+static void count_frame(tui_driver_t *d, uint32_t now_ms)
+{
+    (void)now_ms;
+    frame_calls++;
+    tui_text_update(&text, "f%d", frame_calls);
+    (void)d;
+}
+
+void test_driver_on_frame_keeps_clock_running(void)
+{
+    TEST_ASSERT_EQUAL(1, tui_driver_init(&drv, &scr, 100, -1));
+    tui_text_init(&text);
+    drv.on_frame = count_frame;
+    frame_calls  = 0;
+    tui_driver_wake(&drv);
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(1, wait_ready(200));
+        TEST_ASSERT_EQUAL(1, tui_driver_dispatch(&drv));
+    }
+    TEST_ASSERT_EQUAL(3, frame_calls);
+    TEST_ASSERT_EQUAL(1, drv.armed);
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "f3"));
+}
+
+static int resize_rows, resize_cols;
+static void note_resize(tui_driver_t *d, int rows, int cols)
+{
+    (void)d;
+    resize_rows = rows;
+    resize_cols = cols;
+}
+
+void test_driver_resize_relayouts_and_redraws(void)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    TEST_ASSERT_TRUE(master >= 0);
+    TEST_ASSERT_EQUAL(0, grantpt(master));
+    TEST_ASSERT_EQUAL(0, unlockpt(master));
+    int tty = open(ptsname(master), O_RDWR | O_NOCTTY);
+    TEST_ASSERT_TRUE(tty >= 0);
+    struct winsize ws = { .ws_row = 30, .ws_col = 100 };
+    TEST_ASSERT_EQUAL(0, ioctl(tty, TIOCSWINSZ, &ws));
+
+    TEST_ASSERT_EQUAL(1, tui_driver_init(&drv, &scr, 100, tty));
+    drv.on_resize = note_resize;
+    tui_text_init(&text);
+    tui_text_update(&text, "kept");
+    tui_screen_render(&scr);
+    capture_reset();
+
+    raise(SIGWINCH);                       /* blocked: queued for the signalfd */
+    TEST_ASSERT_EQUAL(1, wait_ready(100));
+    tui_driver_dispatch(&drv);
+    TEST_ASSERT_EQUAL(1, (int)drv.resizes);
+    TEST_ASSERT_EQUAL(30, resize_rows);
+    TEST_ASSERT_EQUAL(100, resize_cols);
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\x1b[2J"));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "kept"));
+
+    tui_driver_close(&drv);
+    close(tty);
+    close(master);
+}
+
+#else
+
+void setUp(void) { }
+void tearDown(void) { }
+
+#endif /* ANSI_TUI_DRIVER */
+
+int main(void)
+{
+    UNITY_BEGIN();
+#if ANSI_TUI_DRIVER && ANSI_TUI_TEXT
+    RUN_TEST(test_driver_rejects_bad_arguments);
+    RUN_TEST(test_driver_renders_update_then_goes_idle);
+    RUN_TEST(test_driver_on_frame_keeps_clock_running);
+    RUN_TEST(test_driver_resize_relayouts_and_redraws);
+#endif
+    return UNITY_END();
+}
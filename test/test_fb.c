@@ -0,0 +1,559 @@
+#if defined(__unix__) || defined(__APPLE__)
+#define _XOPEN_SOURCE 600   /* posix_openpt, grantpt, ptsname */
+#endif
+
+#include "unity.h"
+#include "ansi_fb.h"
+#include "ansi_tui.h"
+#include <string.h>
+#include <stdio.h>
+
+#if ANSI_PRINT_FB
+
+/* ------------------------------------------------------------------ */
+/* Capture clients: each ansi_fb_client_t writes into its own buffer   */
+/* ------------------------------------------------------------------ */
+
+#define ROWS 6
+#define COLS 20
+#define CAPTURE_SIZE 16384
+
+typedef struct {
+    char   buf[CAPTURE_SIZE];
+    size_t len;
+    int    flushes;
+} capture_t;
+
+static void capture_putc(void *user, int ch)
+{
+    capture_t *c = (capture_t *)user;
+    if (c->len < CAPTURE_SIZE - 1) c->buf[c->len++] = (char)ch;
+}
+
+static void capture_flush(void *user) { ((capture_t *)user)->flushes++; }
+
+static void capture_reset(capture_t *c) { memset(c, 0, sizeof(*c)); }
+
+static ansi_cell_t model[ROWS * COLS];
+static char        fb_buf[128];
+static ansi_fb_t   fb;
+
+static ansi_cell_t      last_a[ROWS * COLS], last_b[ROWS * COLS];
+static ansi_ctx_t       ctx_a, ctx_b;
+static char             buf_a[16], buf_b[16];
+static capture_t        cap_a, cap_b;
+static ansi_fb_client_t cl_a, cl_b;
+
+void setUp(void)
+{
+    ansi_fb_init(&fb, model, ROWS, COLS, fb_buf, sizeof(fb_buf));
+    capture_reset(&cap_a);
+    capture_reset(&cap_b);
+    ansi_ctx_init(&ctx_a, NULL, NULL, buf_a, sizeof(buf_a));
+    ansi_ctx_init(&ctx_b, NULL, NULL, buf_b, sizeof(buf_b));
+    ansi_ctx_set_output(&ctx_a, capture_putc, capture_flush, &cap_a);
+    ansi_ctx_set_output(&ctx_b, capture_putc, capture_flush, &cap_b);
+}
+
+void tearDown(void) { }
+
+/* ------------------------------------------------------------------ */
+/* Model                                                               */
+/* ------------------------------------------------------------------ */
+
+void test_fb_interprets_cursor_and_sgr(void)
+{
+    ansi_ctx_t *c = ansi_fb_ctx(&fb);
+    tui_ctx_goto(c, 2, 3);
+    ansi_ctx_puts(c, "[bold red]hi[/] x");
+
+    const ansi_cell_t *h = ansi_fb_cell(&fb, 2, 3);
+    TEST_ASSERT_EQUAL_CHAR('h', h->glyph[0]);
+    TEST_ASSERT_EQUAL_HEX32(ANSI_CELL_PALETTE | 1, h->fg);
+    TEST_ASSERT_EQUAL_HEX8(ANSI_CELL_BOLD, h->styles);
+    const ansi_cell_t *x = ansi_fb_cell(&fb, 2, 6);
+    TEST_ASSERT_EQUAL_CHAR('x', x->glyph[0]);
+    TEST_ASSERT_EQUAL_HEX32(ANSI_CELL_DEFAULT, x->fg);
+    TEST_ASSERT_EQUAL(0, x->styles);
+    TEST_ASSERT_NULL(ansi_fb_cell(&fb, ROWS + 1, 1));
+}
+
+void test_fb_rep_repeats_last_glyph(void)
+{
+    ansi_ctx_t *c = ansi_fb_ctx(&fb);
+    tui_ctx_goto(c, 1, 1);
+    ansi_ctx_write(c, "x\x1b[9b", 5);
+    for (int col = 1; col <= 10; col++)
+        TEST_ASSERT_EQUAL_CHAR('x', ansi_fb_cell(&fb, 1, col)->glyph[0]);
+    TEST_ASSERT_NOT_EQUAL('x', ansi_fb_cell(&fb, 1, 11)->glyph[0]);
+
+    /* Clipped at the right edge */
+    tui_ctx_goto(c, 2, COLS - 1);
+    ansi_ctx_write(c, "y\x1b[99b", 7);
+    TEST_ASSERT_EQUAL_CHAR('y', ansi_fb_cell(&fb, 2, COLS)->glyph[0]);
+
+    /* A REP-enabled client receives the run compressed */
+    ansi_ctx_set_rep(&ctx_a, 1);
+    ansi_fb_attach(&fb, &cl_a, &ctx_a, last_a);
+    ansi_fb_present(&fb);
+    TEST_ASSERT_NOT_NULL(strstr(cap_a.buf, "x\x1b[9b"));
+}
+
+void test_fb_dec_line_drawing(void)
+{
+    ansi_ctx_t *c = ansi_fb_ctx(&fb);
+    tui_ctx_goto(c, 1, 1);
+    ansi_ctx_puts(c, "\x1b(0lqqk\x1b(Bxq");
+    TEST_ASSERT_EQUAL_STRING("\xe2\x94\x8c", ansi_fb_cell(&fb, 1, 1)->glyph);
+    TEST_ASSERT_EQUAL_STRING("\xe2\x94\x80", ansi_fb_cell(&fb, 1, 2)->glyph);
+    TEST_ASSERT_EQUAL_STRING("\xe2\x94\x90", ansi_fb_cell(&fb, 1, 4)->glyph);
+    /* Back in ASCII: letters are letters */
+    TEST_ASSERT_EQUAL_CHAR('x', ansi_fb_cell(&fb, 1, 5)->glyph[0]);
+    TEST_ASSERT_EQUAL_CHAR('q', ansi_fb_cell(&fb, 1, 6)->glyph[0]);
+}
+
+void test_fb_erase_and_clip(void)
+{
+    ansi_ctx_t *c = ansi_fb_ctx(&fb);
+    tui_ctx_goto(c, 1, 1);
+    ansi_ctx_puts(c, "abcdef");
+    ansi_ctx_write(c, "\x1b[1;3H\x1b[K", 9);
+    TEST_ASSERT_EQUAL_CHAR('b', ansi_fb_cell(&fb, 1, 2)->glyph[0]);
+    TEST_ASSERT_EQUAL_CHAR(' ', ansi_fb_cell(&fb, 1, 3)->glyph[0]);
+
+    /* Past the right edge is clipped, not wrapped */
+    tui_ctx_goto(c, 1, COLS - 1);
+    ansi_ctx_puts(c, "xyz");
+    TEST_ASSERT_EQUAL_CHAR('y', ansi_fb_cell(&fb, 1, COLS)->glyph[0]);
+    TEST_ASSERT_EQUAL_CHAR(' ', ansi_fb_cell(&fb, 2, 1)->glyph[0]);
+}
+
+#if ANSI_PRINT_EMOJI
+void test_fb_wide_glyph_takes_two_cells(void)
+{
+    ansi_ctx_t *c = ansi_fb_ctx(&fb);
+    tui_ctx_goto(c, 1, 1);
+    ansi_ctx_puts(c, ":check:!");
+    TEST_ASSERT_EQUAL(3, ansi_fb_cell(&fb, 1, 1)->len);
+    TEST_ASSERT_EQUAL(0, ansi_fb_cell(&fb, 1, 2)->len);
+    TEST_ASSERT_EQUAL_CHAR('!', ansi_fb_cell(&fb, 1, 3)->glyph[0]);
+
+    /* Overwriting the right half blanks the left half */
+    tui_ctx_goto(c, 1, 2);
+    ansi_ctx_puts(c, "x");
+    TEST_ASSERT_EQUAL_CHAR(' ', ansi_fb_cell(&fb, 1, 1)->glyph[0]);
+    TEST_ASSERT_EQUAL_CHAR('x', ansi_fb_cell(&fb, 1, 2)->glyph[0]);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Presenting                                                          */
+/* ------------------------------------------------------------------ */
+
+void test_fb_first_present_is_full_redraw(void)
+{
+    ansi_ctx_t *c = ansi_fb_ctx(&fb);
+    tui_ctx_goto(c, 3, 2);
+    ansi_ctx_puts(c, "ok");
+    ansi_fb_attach(&fb, &cl_a, &ctx_a, last_a);
+
+    size_t n = ansi_fb_present(&fb);
+    TEST_ASSERT_EQUAL_STRING("\x1b[?2026h\x1b[0m\x1b[2J\x1b[3;2H\x1b[0mok"
+                             "\x1b[?25l\x1b[?2026l", cap_a.buf);
+    TEST_ASSERT_EQUAL((int)cap_a.len, (int)n);
+    TEST_ASSERT_EQUAL(1, cap_a.flushes);
+
+    /* Nothing changed: nothing sent, no flush */
+    TEST_ASSERT_EQUAL(0, (int)ansi_fb_present(&fb));
+    TEST_ASSERT_EQUAL(1, cap_a.flushes);
+    TEST_ASSERT_EQUAL(1, (int)cl_a.frames);
+}
+
+void test_fb_sends_only_the_diff(void)
+{
+    ansi_ctx_t *c = ansi_fb_ctx(&fb);
+    tui_ctx_goto(c, 3, 2);
+    ansi_ctx_puts(c, "value: 10");
+    ansi_fb_attach(&fb, &cl_a, &ctx_a, last_a);
+    ansi_fb_present(&fb);
+    capture_reset(&cap_a);
+
+    tui_ctx_goto(c, 3, 2);
+    ansi_ctx_puts(c, "value: [green]12[/]");
+    ansi_fb_present(&fb);
+    TEST_ASSERT_EQUAL_STRING("\x1b[?2026h\x1b[3;9H\x1b[0;32m12"
+                             "\x1b[?2026l", cap_a.buf);
+}
+
+void test_fb_color_disabled_client_gets_no_sgr(void)
+{
+    ansi_ctx_set_enabled(&ctx_a, 0);
+    ansi_ctx_puts(ansi_fb_ctx(&fb), "[red]r[/]");
+    ansi_fb_attach(&fb, &cl_a, &ctx_a, last_a);
+    ansi_fb_present(&fb);
+    TEST_ASSERT_EQUAL_STRING("\x1b[?2026h\x1b[2J\x1b[1;1Hr\x1b[?25l\x1b[?2026l",
+                             cap_a.buf);
+}
+
+#if ANSI_PRINT_COLOR_DEPTH
+void test_fb_client_depth_downsamples_colors(void)
+{
+    ansi_ctx_set_depth(&ctx_a, ANSI_DEPTH_16);
+    ansi_ctx_puts(ansi_fb_ctx(&fb), "[fg:196]r[/]");
+    ansi_fb_attach(&fb, &cl_a, &ctx_a, last_a);
+    ansi_fb_attach(&fb, &cl_b, &ctx_b, last_b);
+    ansi_fb_present(&fb);
+    TEST_ASSERT_NOT_NULL(strstr(cap_a.buf, "\x1b[0;91mr"));
+    TEST_ASSERT_NOT_NULL(strstr(cap_b.buf, "\x1b[0;38;5;196mr"));
+}
+#endif
+
+void test_fb_late_client_gets_full_redraw_only(void)
+{
+    ansi_ctx_t *c = ansi_fb_ctx(&fb);
+    tui_ctx_goto(c, 1, 1);
+    ansi_ctx_puts(c, "AAAA");
+    ansi_fb_attach(&fb, &cl_a, &ctx_a, last_a);
+    ansi_fb_present(&fb);
+    capture_reset(&cap_a);
+
+    tui_ctx_goto(c, 2, 1);
+    ansi_ctx_puts(c, "B");
+    ansi_fb_attach(&fb, &cl_b, &ctx_b, last_b);
+    ansi_fb_present(&fb);
+
+    /* A sees only the new cell, B sees the whole scene */
+    TEST_ASSERT_EQUAL_STRING("\x1b[?2026h\x1b[2;1H\x1b[0mB\x1b[?2026l", cap_a.buf);
+    TEST_ASSERT_NOT_NULL(strstr(cap_b.buf, "\x1b[2J"));
+    TEST_ASSERT_NOT_NULL(strstr(cap_b.buf, "\x1b[1;1H\x1b[0mAAAA"));
+    TEST_ASSERT_NOT_NULL(strstr(cap_b.buf, "B"));
+
+    /* Detached clients receive nothing */
+    ansi_fb_detach(&fb, &cl_b);
+    capture_reset(&cap_b);
+    ansi_ctx_puts(c, "C");
+    ansi_fb_present(&fb);
+    TEST_ASSERT_EQUAL(0, (int)cap_b.len);
+    TEST_ASSERT_TRUE(cap_a.len > 0);
+}
+
+void test_fb_redraw_resends_scene(void)
+{
+    ansi_ctx_puts(ansi_fb_ctx(&fb), "z");
+    ansi_fb_attach(&fb, &cl_a, &ctx_a, last_a);
+    ansi_fb_present(&fb);
+    capture_reset(&cap_a);
+
+    ansi_fb_redraw(&cl_a);
+    ansi_fb_present(&fb);
+    TEST_ASSERT_NOT_NULL(strstr(cap_a.buf, "\x1b[2J\x1b[1;1H\x1b[0mz"));
+}
+
+#if ANSI_TUI_SCREEN && ANSI_TUI_TEXT
+void test_fb_tui_screen_renders_once_for_all_clients(void)
+{
+    tui_screen_entry_t entries[2];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 2);
+    tui_screen_set_ctx(&scr, ansi_fb_ctx(&fb));
+
+    char tbuf[16];
+    tui_text_state_t st = {0};
+    const tui_text_t w = { .place = { .row = 4, .col = 2, .screen = &scr },
+                           .width = 4, .state = &st,
+                           .text_buf = tbuf, .text_buf_size = sizeof(tbuf) };
+    tui_text_init(&w);
+    ansi_fb_attach(&fb, &cl_a, &ctx_a, last_a);
+    ansi_fb_attach(&fb, &cl_b, &ctx_b, last_b);
+    tui_screen_render(&scr);
+    ansi_fb_present(&fb);
+    capture_reset(&cap_a);
+    capture_reset(&cap_b);
+
+    tui_text_update(&w, "hi");
+    tui_screen_render(&scr);
+    ansi_fb_present(&fb);
+    TEST_ASSERT_EQUAL_STRING("\x1b[?2026h\x1b[4;2H\x1b[0mhi\x1b[?2026l", cap_a.buf);
+    TEST_ASSERT_EQUAL_STRING(cap_a.buf, cap_b.buf);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Sharded present: same bytes with any number of workers              */
+/* ------------------------------------------------------------------ */
+
+#define BIG_ROWS 40
+#define BIG_COLS 30
+
+static ansi_cell_t big_model[BIG_ROWS * BIG_COLS], big_last[BIG_ROWS * BIG_COLS];
+static char        shard_mem[8][1024];
+static ansi_fb_shard_t shards[8];
+
+/** Deterministic scene: frame 0 fills the screen, later frames touch
+ *  scattered cells in varying colors. */
+static void draw_scene(ansi_fb_t *f, int frame)
+{
+    static const char *const colors[] = { "red", "green", "fg:208", "bold blue", "dim" };
+    ansi_ctx_t *c = ansi_fb_ctx(f);
+    unsigned seed = 12345u + (unsigned)frame;
+    int writes = frame == 0 ? 300 : 40;
+    for (int i = 0; i < writes; i++) {
+        seed = seed * 1103515245u + 12345u;
+        int row = (int)(seed >> 8) % BIG_ROWS + 1;
+        int col = (int)(seed >> 16) % (BIG_COLS - 4) + 1;
+        tui_ctx_goto(c, row, col);
+        ansi_ctx_print(c, "[%s]%02u[/]", colors[(seed >> 4) % 5], (seed >> 20) % 100);
+    }
+}
+
+/** Render frames 0..2 of the scene with the given hook; return bytes in cap_a. */
+static void present_scene(ansi_fb_parallel_fn run, void *user)
+{
+    static char big_buf[64];
+    ansi_fb_t f;
+    ansi_fb_client_t cl;
+    ansi_fb_init(&f, big_model, BIG_ROWS, BIG_COLS, big_buf, sizeof(big_buf));
+    for (int i = 0; i < 8; i++) {
+        shards[i].buf  = shard_mem[i];
+        shards[i].size = sizeof(shard_mem[i]);
+    }
+    ansi_fb_set_parallel(&f, run, user, shards, 8);
+    capture_reset(&cap_a);
+    ansi_fb_attach(&f, &cl, &ctx_a, big_last);
+    for (int frame = 0; frame < 3; frame++) {
+        draw_scene(&f, frame);
+        ansi_fb_present(&f);
+    }
+}
+
+/** Runs the jobs backwards, as an unlucky scheduler might. */
+static void run_reversed(void *user, int count, ansi_fb_job_fn job, void *arg)
+{
+    (void)user;
+    for (int i = count - 1; i >= 0; i--) job(arg, i);
+}
+
+static capture_t serial_out;
+
+void test_fb_shards_match_serial_output(void)
+{
+    TEST_ASSERT_EQUAL(5, (BIG_ROWS + ANSI_FB_SHARD_ROWS - 1) / ANSI_FB_SHARD_ROWS);
+    present_scene(NULL, NULL);
+    serial_out = cap_a;
+    TEST_ASSERT_TRUE(serial_out.len > 1000);
+
+    present_scene(run_reversed, NULL);
+    TEST_ASSERT_EQUAL((int)serial_out.len, (int)cap_a.len);
+    TEST_ASSERT_EQUAL_MEMORY(serial_out.buf, cap_a.buf, serial_out.len);
+}
+
+void test_fb_shard_overflow_streams_on_caller(void)
+{
+    /* Shard buffers smaller than one row's diff: every shard overflows
+       and is streamed by the caller, with the serial path's bytes */
+    static char small[8][16];
+    static ansi_fb_shard_t tiny[8];
+    present_scene(NULL, NULL);
+    serial_out = cap_a;
+
+    static char big_buf[64];
+    ansi_fb_t f;
+    ansi_fb_client_t cl;
+    ansi_fb_init(&f, big_model, BIG_ROWS, BIG_COLS, big_buf, sizeof(big_buf));
+    for (int i = 0; i < 8; i++) { tiny[i].buf = small[i]; tiny[i].size = sizeof(small[i]); }
+    ansi_fb_set_parallel(&f, run_reversed, NULL, tiny, 8);
+    capture_reset(&cap_a);
+    ansi_fb_attach(&f, &cl, &ctx_a, big_last);
+    for (int frame = 0; frame < 3; frame++) {
+        draw_scene(&f, frame);
+        ansi_fb_present(&f);
+    }
+    TEST_ASSERT_TRUE(tiny[0].overflow);
+    TEST_ASSERT_EQUAL((int)serial_out.len, (int)cap_a.len);
+    TEST_ASSERT_EQUAL_MEMORY(serial_out.buf, cap_a.buf, serial_out.len);
+    TEST_ASSERT_EQUAL_MEMORY(big_model, big_last, sizeof(big_model));
+
+    /* Nothing left over for the next present */
+    TEST_ASSERT_EQUAL(0, (int)ansi_fb_present(&f));
+}
+
+#if defined(_REENTRANT) && (defined(__unix__) || defined(__APPLE__))
+#include <pthread.h>
+
+typedef struct {
+    pthread_mutex_t lock;
+    int             next;
+    int             count;
+    ansi_fb_job_fn  job;
+    void           *arg;
+} pool_t;
+
+static void *pool_worker(void *p)
+{
+    pool_t *pool = (pool_t *)p;
+    for (;;) {
+        pthread_mutex_lock(&pool->lock);
+        int i = pool->next++;
+        pthread_mutex_unlock(&pool->lock);
+        if (i >= pool->count) return NULL;
+        pool->job(pool->arg, i);
+    }
+}
+
+/** Parallel-for over @p user worker threads. */
+static void run_threads(void *user, int count, ansi_fb_job_fn job, void *arg)
+{
+    int workers = *(int *)user;
+    pthread_t t[8];
+    pool_t pool = { PTHREAD_MUTEX_INITIALIZER, 0, count, job, arg };
+    for (int i = 0; i < workers; i++) pthread_create(&t[i], NULL, pool_worker, &pool);
+    for (int i = 0; i < workers; i++) pthread_join(t[i], NULL);
+}
+
+void test_fb_threads_match_serial_output(void)
+{
+    present_scene(NULL, NULL);
+    serial_out = cap_a;
+    for (int workers = 1; workers <= 4; workers *= 2) {
+        present_scene(run_threads, &workers);
+        TEST_ASSERT_EQUAL((int)serial_out.len, (int)cap_a.len);
+        TEST_ASSERT_EQUAL_MEMORY(serial_out.buf, cap_a.buf, serial_out.len);
+    }
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Real transports: a pty and a Unix socket pair                       */
+/* ------------------------------------------------------------------ */
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+
+typedef struct {
+    int    fd;
+    char   buf[256];
+    size_t len;
+} fd_out_t;
+
+static void fd_flush(void *user)
+{
+    fd_out_t *o = (fd_out_t *)user;
+    size_t off = 0;
+    while (off < o->len) {
+        ssize_t n = write(o->fd, o->buf + off, o->len - off);
+        if (n <= 0) break;
+        off += (size_t)n;
+    }
+    o->len = 0;
+}
+
+static void fd_putc(void *user, int ch)
+{
+    fd_out_t *o = (fd_out_t *)user;
+    if (o->len == sizeof(o->buf)) fd_flush(o);
+    o->buf[o->len++] = (char)ch;
+}
+
+static size_t read_all(int fd, char *buf, size_t size)
+{
+    size_t len = 0;
+    ssize_t n;
+    while (len < size - 1 && (n = read(fd, buf + len, size - 1 - len)) > 0)
+        len += (size_t)n;
+    buf[len] = '\0';
+    return len;
+}
+
+void test_fb_clients_over_pty_and_socket(void)
+{
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master < 0 || grantpt(master) || unlockpt(master)) {
+        TEST_IGNORE_MESSAGE("no pty available");
+    }
+    int slave = open(ptsname(master), O_RDWR | O_NOCTTY);
+    TEST_ASSERT_TRUE(slave >= 0);
+    struct termios t;
+    tcgetattr(slave, &t);
+    t.c_oflag &= (tcflag_t)~OPOST;          /* raw output: no \n -> \r\n */
+    tcsetattr(slave, TCSANOW, &t);
+
+    int sv[2];
+    TEST_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, sv));
+
+    static fd_out_t pty_out, sock_out;
+    pty_out.fd = slave;  pty_out.len = 0;
+    sock_out.fd = sv[0]; sock_out.len = 0;
+    ansi_ctx_set_output(&ctx_a, fd_putc, fd_flush, &pty_out);
+    ansi_ctx_set_output(&ctx_b, fd_putc, fd_flush, &sock_out);
+
+    ansi_ctx_t *c = ansi_fb_ctx(&fb);
+    tui_ctx_goto(c, 2, 2);
+    ansi_ctx_puts(c, "[cyan]up[/]");
+    ansi_fb_attach(&fb, &cl_a, &ctx_a, last_a);
+    ansi_fb_attach(&fb, &cl_b, &ctx_b, last_b);
+    size_t sent = ansi_fb_present(&fb);
+
+    fcntl(master, F_SETFL, O_NONBLOCK);
+    fcntl(sv[1], F_SETFL, O_NONBLOCK);
+    char pty_rx[512], sock_rx[512];
+    usleep(10000);
+    size_t a = read_all(master, pty_rx, sizeof(pty_rx));
+    size_t b = read_all(sv[1], sock_rx, sizeof(sock_rx));
+
+    TEST_ASSERT_EQUAL((int)sent, (int)(a + b));
+    TEST_ASSERT_EQUAL_STRING(pty_rx, sock_rx);
+    TEST_ASSERT_NOT_NULL(strstr(pty_rx, "\x1b[2;2H\x1b[0;36mu"));
+
+    close(slave);
+    close(master);
+    close(sv[0]);
+    close(sv[1]);
+}
+#endif /* unix */
+
+#else
+
+void setUp(void) { }
+void tearDown(void) { }
+
+#endif /* ANSI_PRINT_FB */
+
+int main(void)
+{
+    UNITY_BEGIN();
+#if ANSI_PRINT_FB
+    RUN_TEST(test_fb_interprets_cursor_and_sgr);
+    RUN_TEST(test_fb_erase_and_clip);
+#if ANSI_PRINT_REP
+    RUN_TEST(test_fb_rep_repeats_last_glyph);
+#endif
+    RUN_TEST(test_fb_dec_line_drawing);
+#if ANSI_PRINT_EMOJI
+    RUN_TEST(test_fb_wide_glyph_takes_two_cells);
+#endif
+    RUN_TEST(test_fb_first_present_is_full_redraw);
+    RUN_TEST(test_fb_sends_only_the_diff);
+    RUN_TEST(test_fb_color_disabled_client_gets_no_sgr);
+#if ANSI_PRINT_COLOR_DEPTH
+    RUN_TEST(test_fb_client_depth_downsamples_colors);
+#endif
+    RUN_TEST(test_fb_late_client_gets_full_redraw_only);
+    RUN_TEST(test_fb_redraw_resends_scene);
+#if ANSI_TUI_SCREEN && ANSI_TUI_TEXT
+    RUN_TEST(test_fb_tui_screen_renders_once_for_all_clients);
+#endif
+    RUN_TEST(test_fb_shards_match_serial_output);
+    RUN_TEST(test_fb_shard_overflow_streams_on_caller);
+#if defined(_REENTRANT) && (defined(__unix__) || defined(__APPLE__))
+    RUN_TEST(test_fb_threads_match_serial_output);
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+    RUN_TEST(test_fb_clients_over_pty_and_socket);
+#endif
+#endif
+    return UNITY_END();
+}
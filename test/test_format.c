@@ -0,0 +1,126 @@
+/* test_format.c -- the built-in formatter (ANSI_PRINT_FORMAT=1).
+ *
+ * Built with -DANSI_PRINT_FORMAT=1 -DANSI_PRINT_FORMAT_LL=1; supported
+ * conversions are checked byte for byte against the C library. */
+#include "unity.h"
+#include "ansi_print.h"
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+#if !ANSI_PRINT_FORMAT
+#  error "test_format must be built with -DANSI_PRINT_FORMAT=1"
+#endif
+
+#define CAPTURE_SIZE 512
+
+static char capture_buf[CAPTURE_SIZE];
+static int  capture_pos;
+
+static void capture_putc(int ch)
+{
+    if (capture_pos < CAPTURE_SIZE - 1)
+        capture_buf[capture_pos++] = (char)ch;
+}
+
+static void capture_flush(void) { /* no-op */ }
+
+static char fmt_buf[256];
+
+void setUp(void)
+{
+    memset(capture_buf, 0, sizeof(capture_buf));
+    capture_pos = 0;
+    ansi_init(capture_putc, capture_flush, fmt_buf, sizeof(fmt_buf));
+    ansi_set_enabled(1);
+}
+
+void tearDown(void) { }
+
+/* Format one value both ways and compare text and return value */
+#define CHECK(fmt, ...) do {                                            \
+        char want[128], got[128];                                       \
+        int wn = snprintf(want, sizeof(want), fmt, __VA_ARGS__);        \
+        int gn = ansi_snprintf(got, sizeof(got), fmt, __VA_ARGS__);     \
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(want, got, fmt);               \
+        TEST_ASSERT_EQUAL_INT_MESSAGE(wn, gn, fmt);                     \
+    } while (0)
+
+void test_integers_match_libc(void)
+{
+    static const int values[] = { 0, 1, -1, 42, -305, INT_MAX, INT_MIN };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        int v = values[i];
+        CHECK("%d", v);       CHECK("%i", v);      CHECK("%5d|", v);
+        CHECK("%-5d|", v);    CHECK("%05d", v);    CHECK("%+d", v);
+        CHECK("% d", v);      CHECK("%.3d", v);    CHECK("%8.3d|", v);
+        CHECK("%u", (unsigned)v);  CHECK("%x", (unsigned)v);
+        CHECK("%X", (unsigned)v);  CHECK("%08x", (unsigned)v);
+        CHECK("%hd", v);      CHECK("%hhu", (unsigned)v);
+        CHECK("%*d|", -6, v);
+        CHECK("%ld", (long)v);     CHECK("%lu", (unsigned long)v);
+        CHECK("%lld", (long long)v * 100000);
+        CHECK("%zu", (size_t)(unsigned)v);
+    }
+    CHECK("%.0d|", 0);
+    CHECK("\x1b[%d;%dH", 12, 80);
+}
+
+void test_strings_match_libc(void)
+{
+    CHECK("%s", "hello");      CHECK("%10s|", "hello");
+    CHECK("%-10s|", "hello");  CHECK("%.2s|", "hello");
+    CHECK("%*s|", 7, "ab");    CHECK("%-*s|", 7, "ab");
+    CHECK("%.*s|", 3, "abcdef");
+    CHECK("%c%c", 'o', 'k');   CHECK("%3c|", 'x');
+    CHECK("100%% %s", "done");
+}
+
+#if ANSI_PRINT_FORMAT_FLOAT
+void test_floats_match_libc(void)
+{
+    static const double values[] = { 0.0, 1.5, -2.25, 3.14159, 1234.5678, 0.001, 98.6 };
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        double v = values[i];
+        CHECK("%f", v);        CHECK("%.2f", v);     CHECK("%8.3f|", v);
+        CHECK("%-8.1f|", v);   CHECK("%08.2f", v);   CHECK("%+.1f", v);
+        CHECK("%.0f", v);      CHECK("%g", v);       CHECK("%0.2f m/sec", v);
+    }
+}
+#endif
+
+void test_truncates_and_returns_full_length(void)
+{
+    char buf[4];
+    TEST_ASSERT_EQUAL_INT(5, ansi_snprintf(buf, sizeof(buf), "%d", 12345));
+    TEST_ASSERT_EQUAL_STRING("123", buf);
+    TEST_ASSERT_EQUAL_INT(7, ansi_snprintf(NULL, 0, "%s-%d", "abc", 100));
+}
+
+void test_unsupported_conversion_is_copied(void)
+{
+    char buf[32];
+    /* %q consumes no argument, so the %d still gets 7 */
+    ansi_snprintf(buf, sizeof(buf), "[%5q] %d", 7);
+    TEST_ASSERT_EQUAL_STRING("[%5q] 7", buf);
+}
+
+void test_print_uses_builtin_formatter(void)
+{
+    ansi_print("[red]%-4s|%03d[/]", "id", 7);
+    TEST_ASSERT_EQUAL_STRING("\x1b[31mid  |007\x1b[0m", capture_buf);
+}
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_integers_match_libc);
+    RUN_TEST(test_strings_match_libc);
+#if ANSI_PRINT_FORMAT_FLOAT
+    RUN_TEST(test_floats_match_libc);
+#endif
+    RUN_TEST(test_truncates_and_returns_full_length);
+    RUN_TEST(test_unsupported_conversion_is_copied);
+    RUN_TEST(test_print_uses_builtin_formatter);
+    return UNITY_END();
+}
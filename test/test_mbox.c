@@ -0,0 +1,265 @@
+#include "unity.h"
+#include "ansi_mbox.h"
+#include <string.h>
+#include <stdio.h>
+
+#if ANSI_TUI_MBOX && ANSI_TUI_METRIC && ANSI_TUI_BAR
+#include <pthread.h>
+#include <sched.h>
+
+/* ------------------------------------------------------------------ */
+/* Capture buffer — written only by the UI (drain/render) side         */
+/* ------------------------------------------------------------------ */
+
+#define CAPTURE_SIZE 32768
+
+static char capture_buf[CAPTURE_SIZE];
+static int  capture_pos;
+
+static void capture_putc(int ch)
+{
+    if (capture_pos < CAPTURE_SIZE - 1)
+        capture_buf[capture_pos++] = (char)ch;
+}
+
+static int flush_count;
+static void capture_flush(void) { flush_count++; }
+
+static void capture_reset(void)
+{
+    memset(capture_buf, 0, sizeof(capture_buf));
+    capture_pos = 0;
+}
+
+static ansi_ctx_t         out;
+static char               out_buf[256];
+static tui_screen_entry_t entries[8];
+static tui_screen_t       scr;
+
+void setUp(void)
+{
+    capture_reset();
+    ansi_ctx_init(&out, capture_putc, capture_flush, out_buf, sizeof(out_buf));
+    ansi_ctx_set_enabled(&out, 0);
+    tui_screen_init(&scr, entries, 8);
+    tui_screen_set_ctx(&scr, &out);
+}
+
+void tearDown(void) { }
+
+static tui_metric_state_t temp_st;
+static const tui_metric_t temp = {
+    .place = { .row = 1, .col = 1, .border = ANSI_TUI_BORDER, .screen = &scr },
+    .width = 8, .title = "T", .fmt = "%.0f",
+    .thresh_lo = -100.0, .thresh_hi = 100.0,
+    .state = &temp_st
+};
+
+/* ------------------------------------------------------------------ */
+/* Single-threaded behavior                                            */
+/* ------------------------------------------------------------------ */
+
+void test_mbox_init_requires_power_of_two(void)
+{
+    tui_mbox_slot_t slots[6];
+    tui_mbox_t mb;
+    TEST_ASSERT_EQUAL(0, tui_mbox_init(&mb, &scr, slots, 6));
+    TEST_ASSERT_EQUAL(0, tui_mbox_init(&mb, &scr, slots, 1));
+    TEST_ASSERT_EQUAL(0, tui_mbox_init(&mb, NULL, slots, 4));
+    TEST_ASSERT_EQUAL(1, tui_mbox_init(&mb, &scr, slots, 4));
+}
+
+void test_mbox_nothing_drawn_until_drain_and_render(void)
+{
+    tui_mbox_slot_t slots[16];
+    tui_mbox_t mb;
+    tui_mbox_init(&mb, &scr, slots, 16);
+    tui_metric_init(&temp);
+    tui_screen_render(&scr);
+    capture_reset();
+
+    for (int i = 1; i <= 10; i++)
+        TEST_ASSERT_EQUAL(1, tui_mbox_metric(&mb, &temp, i));
+    TEST_ASSERT_EQUAL(10, (int)tui_mbox_depth(&mb));
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);
+
+    /* Draining only records values; the render draws the latest once */
+    TEST_ASSERT_EQUAL(10, tui_mbox_drain(&mb));
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);
+    TEST_ASSERT_EQUAL(1, tui_screen_render(&scr));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "10"));
+    TEST_ASSERT_NULL(strstr(capture_buf, " 9 "));
+    TEST_ASSERT_EQUAL(9, (int)scr.stats.coalesced);
+
+    tui_mbox_stats_t st;
+    tui_mbox_stats(&mb, &st);
+    TEST_ASSERT_EQUAL(10, (int)st.posted);
+    TEST_ASSERT_EQUAL(10, (int)st.applied);
+    TEST_ASSERT_EQUAL(0, (int)st.dropped);
+    TEST_ASSERT_EQUAL(0, (int)st.depth);
+    TEST_ASSERT_EQUAL(10, (int)st.depth_max);
+}
+
+void test_mbox_full_ring_drops_oldest(void)
+{
+    tui_mbox_slot_t slots[4];
+    tui_mbox_t mb;
+    tui_mbox_init(&mb, &scr, slots, 4);
+    tui_metric_init(&temp);
+
+    for (int i = 1; i <= 6; i++) tui_mbox_metric(&mb, &temp, i);
+
+    tui_mbox_stats_t st;
+    tui_mbox_stats(&mb, &st);
+    TEST_ASSERT_EQUAL(6, (int)st.posted);
+    TEST_ASSERT_EQUAL(2, (int)st.dropped);
+    TEST_ASSERT_EQUAL(4, (int)st.depth);
+    TEST_ASSERT_EQUAL(4, (int)st.depth_max);
+
+    /* The newest value survives */
+    TEST_ASSERT_EQUAL(4, tui_mbox_drain(&mb));
+    TEST_ASSERT_TRUE(temp_st.value == 6.0);
+    TEST_ASSERT_EQUAL(0, tui_mbox_drain(&mb));
+}
+
+void test_mbox_full_ring_with_unpublished_oldest_drops_newest(void)
+{
+    tui_mbox_slot_t slots[4];
+    tui_mbox_t mb;
+    tui_mbox_init(&mb, &scr, slots, 4);
+    tui_metric_init(&temp);
+    for (int i = 1; i <= 4; i++) tui_mbox_metric(&mb, &temp, i);
+
+    /* A producer claimed the oldest slot and was preempted mid-write */
+    atomic_store(&slots[0].seq, 0);
+    TEST_ASSERT_EQUAL(0, tui_mbox_metric(&mb, &temp, 5));   /* returns, no spin */
+
+    tui_mbox_stats_t st;
+    tui_mbox_stats(&mb, &st);
+    TEST_ASSERT_EQUAL(4, (int)st.posted);
+    TEST_ASSERT_EQUAL(1, (int)st.dropped);
+
+    /* Once the writer publishes, posting drops the oldest again */
+    atomic_store(&slots[0].seq, 1);
+    TEST_ASSERT_EQUAL(1, tui_mbox_metric(&mb, &temp, 6));
+    TEST_ASSERT_EQUAL(4, tui_mbox_drain(&mb));
+    TEST_ASSERT_TRUE(temp_st.value == 6);
+}
+
+void test_mbox_immediate_widgets_flush_once(void)
+{
+    tui_mbox_slot_t slots[8];
+    tui_mbox_t mb;
+    char bbuf[64];
+    /* No state: each update draws on the spot */
+    const tui_bar_t bar = {
+        .place = { .row = 3, .col = 1, .screen = &scr },
+        .bar_width = 10, .bar_buf = bbuf, .bar_buf_size = sizeof(bbuf)
+    };
+    tui_mbox_init(&mb, &scr, slots, 8);
+    tui_bar_init(&bar);
+    capture_reset();
+    flush_count = 0;
+
+    for (int i = 1; i <= 3; i++) tui_mbox_bar(&mb, &bar, i * 30, 0, 100);
+    TEST_ASSERT_EQUAL(3, tui_mbox_drain(&mb));
+    TEST_ASSERT_TRUE(capture_pos > 0);
+    TEST_ASSERT_EQUAL(1, flush_count);
+}
+
+/* ------------------------------------------------------------------ */
+/* Many producers, one UI thread                                       */
+/* ------------------------------------------------------------------ */
+
+#define PRODUCERS   4
+#define PER_THREAD  5000
+
+static tui_mbox_t      mt_mb;
+static tui_bar_state_t bar_st[PRODUCERS];
+static char            bar_buf[PRODUCERS][64];
+static tui_bar_t       bars[PRODUCERS];
+static volatile int    mt_stop;
+
+static void *producer(void *arg)
+{
+    int id = (int)(size_t)arg;
+    for (int i = 1; i <= PER_THREAD; i++) {
+        tui_mbox_bar(&mt_mb, &bars[id], i, 0, PER_THREAD);
+        sched_yield();   /* a sensor, not a busy loop */
+    }
+    return NULL;
+}
+
+static void *ui_thread(void *arg)
+{
+    (void)arg;
+    while (!mt_stop) {
+        tui_mbox_drain(&mt_mb);
+        tui_screen_render(&scr);
+        sched_yield();
+    }
+    return NULL;
+}
+
+void test_mbox_multi_producer_converges(void)
+{
+    static tui_mbox_slot_t slots[64];
+    for (int i = 0; i < PRODUCERS; i++) {
+        tui_bar_t b = {
+            .place = { .row = i + 1, .col = 1, .screen = &scr },
+            .bar_width = 10, .bar_buf = bar_buf[i],
+            .bar_buf_size = sizeof(bar_buf[i]), .state = &bar_st[i]
+        };
+        bars[i] = b;
+        tui_bar_init(&bars[i]);
+    }
+    tui_mbox_init(&mt_mb, &scr, slots, 64);
+    mt_stop = 0;
+
+    pthread_t ui, prod[PRODUCERS];
+    pthread_create(&ui, NULL, ui_thread, NULL);
+    for (int i = 0; i < PRODUCERS; i++)
+        pthread_create(&prod[i], NULL, producer, (void *)(size_t)i);
+    for (int i = 0; i < PRODUCERS; i++)
+        pthread_join(prod[i], NULL);
+    mt_stop = 1;
+    pthread_join(ui, NULL);
+    tui_mbox_drain(&mt_mb);
+    tui_screen_render(&scr);
+
+    /* Every event was applied or counted as dropped */
+    tui_mbox_stats_t st;
+    tui_mbox_stats(&mt_mb, &st);
+    TEST_ASSERT_EQUAL(PRODUCERS * PER_THREAD, (int)st.posted);
+    TEST_ASSERT_EQUAL((int)st.posted, (int)(st.applied + st.dropped));
+    TEST_ASSERT_EQUAL(0, (int)st.depth);
+    TEST_ASSERT_TRUE(st.depth_max <= 64);
+
+    /* With no drops every bar ends on its producer's last value */
+    for (int i = 0; i < PRODUCERS; i++) {
+        TEST_ASSERT_TRUE(bar_st[i].value >= 0.0 && bar_st[i].value <= PER_THREAD);
+        if (st.dropped == 0)
+            TEST_ASSERT_TRUE(bar_st[i].value == (double)PER_THREAD);
+    }
+}
+
+#else
+
+void setUp(void) { }
+void tearDown(void) { }
+
+#endif /* ANSI_TUI_MBOX */
+
+int main(void)
+{
+    UNITY_BEGIN();
+#if ANSI_TUI_MBOX && ANSI_TUI_METRIC && ANSI_TUI_BAR
+    RUN_TEST(test_mbox_init_requires_power_of_two);
+    RUN_TEST(test_mbox_nothing_drawn_until_drain_and_render);
+    RUN_TEST(test_mbox_full_ring_drops_oldest);
+    RUN_TEST(test_mbox_full_ring_with_unpublished_oldest_drops_newest);
+    RUN_TEST(test_mbox_immediate_widgets_flush_once);
+    RUN_TEST(test_mbox_multi_producer_converges);
+#endif
+    return UNITY_END();
+}
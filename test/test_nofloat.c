@@ -0,0 +1,151 @@
+/* test_nofloat.c -- integer-only bars and metrics (ANSI_PRINT_FLOAT=0).
+ *
+ * Built with -DANSI_PRINT_FLOAT=0 so the library and the tests share the
+ * int32_t widget layouts. */
+#include "unity.h"
+#include "ansi_print.h"
+#include "ansi_tui.h"
+#include "ansi_defer.h"
+#include <string.h>
+
+#if ANSI_PRINT_FLOAT
+#  error "test_nofloat must be built with -DANSI_PRINT_FLOAT=0"
+#endif
+
+#define CAPTURE_SIZE 2048
+
+static char capture_buf[CAPTURE_SIZE];
+static int  capture_pos;
+
+static void capture_putc(int ch)
+{
+    if (capture_pos < CAPTURE_SIZE - 1)
+        capture_buf[capture_pos++] = (char)ch;
+}
+
+static void capture_flush(void) { /* no-op */ }
+
+static void capture_reset(void)
+{
+    memset(capture_buf, 0, sizeof(capture_buf));
+    capture_pos = 0;
+}
+
+static char fmt_buf[512];
+
+void setUp(void)
+{
+    capture_reset();
+    ansi_init(capture_putc, capture_flush, fmt_buf, sizeof(fmt_buf));
+    ansi_set_enabled(0);
+}
+
+void tearDown(void) { }
+
+/* ------------------------------------------------------------------ */
+/* Inline bars                                                         */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_PRINT_BAR
+void test_bar_i32_integer_and_q16_agree(void)
+{
+    char a[128], b[128];
+    ansi_bar_i32(a, sizeof(a), NULL, 8, ANSI_BAR_BLANK, 30, 0, 100);
+    ansi_bar_i32(b, sizeof(b), NULL, 8, ANSI_BAR_BLANK, 30 << 16, 0, 100 << 16);
+    TEST_ASSERT_EQUAL_STRING(a, b);
+    TEST_ASSERT_EQUAL(19, ansi_bar_eighths_i32(8, 30, 0, 100));   /* 19.2 */
+}
+
+void test_bar_percent_without_float(void)
+{
+    char bar[128];
+    ansi_bar_percent(bar, sizeof(bar), NULL, 4, ANSI_BAR_BLANK, 150);
+    TEST_ASSERT_EQUAL_STRING("\xe2\x96\x88\xe2\x96\x88\xe2\x96\x88\xe2\x96\x88 100%", bar);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Widgets                                                             */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_TUI_BAR
+void test_tui_bar_update_i32(void)
+{
+    char bar_buf[128];
+    tui_bar_state_t st = {0};
+    const tui_bar_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_NO_BORDER },
+        .bar_width = 4, .track = ANSI_BAR_BLANK,
+        .bar_buf = bar_buf, .bar_buf_size = sizeof(bar_buf), .state = &st
+    };
+    tui_bar_init(&w);
+    tui_bar_update_i32(&w, 1 << 15, 0, 1 << 16, 0);   /* 0.5 in Q16 */
+    TEST_ASSERT_EQUAL_INT(16, st.eighths);
+    TEST_ASSERT_EQUAL_INT(1 << 15, st.value);
+
+    /* Disable/enable restores from the stored int32_t values */
+    tui_bar_enable(&w, 0);
+    tui_bar_enable(&w, 1);
+    TEST_ASSERT_EQUAL_INT(16, st.eighths);
+}
+#endif
+
+#if ANSI_TUI_METRIC
+void test_tui_metric_formats_long(void)
+{
+    tui_metric_state_t st = {0};
+    const tui_metric_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_BORDER, .color = "green" },
+        .width = 10, .title = "RPM", .fmt = "%ld rpm",
+        .color_lo = "blue", .color_hi = "red",
+        .thresh_lo = 100, .thresh_hi = 5000, .state = &st
+    };
+    tui_metric_init(&w);
+    capture_reset();
+    tui_metric_update(&w, 6200, 0);
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "6200 rpm"));
+    TEST_ASSERT_EQUAL_INT(1, st.zone);
+    TEST_ASSERT_EQUAL_INT(6200, st.value);
+}
+#endif
+
+/* ------------------------------------------------------------------ */
+/* Deferred logging                                                    */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_PRINT_DEFER
+void test_defer_without_float(void)
+{
+    static const char *const fmts[] = { "t=%d\n", "t=%f\n" };
+    ansi_defer_t d;
+    ansi_defer_init(&d, NULL, fmts, 2);
+
+    TEST_ASSERT_TRUE(ansi_defer_log(&d, 0, 42) > 0);
+    TEST_ASSERT_EQUAL(0, (int)ansi_defer_log(&d, 1, 1.5));   /* dropped */
+
+    /* A float field from a float-capable target decodes as raw bits */
+    static const unsigned char wire[] = { 5, 1, 0x00, 0x00, 0xc0, 0x3f };
+    capture_reset();
+    TEST_ASSERT_EQUAL((int)sizeof(wire), (int)ansi_defer_decode(&d, wire, sizeof(wire)));
+    TEST_ASSERT_EQUAL_STRING("t=<f:3fc00000>\n", capture_buf);
+}
+#endif
+
+int main(void)
+{
+    UNITY_BEGIN();
+#if ANSI_PRINT_BAR
+    RUN_TEST(test_bar_i32_integer_and_q16_agree);
+    RUN_TEST(test_bar_percent_without_float);
+#endif
+#if ANSI_TUI_BAR
+    RUN_TEST(test_tui_bar_update_i32);
+#endif
+#if ANSI_TUI_METRIC
+    RUN_TEST(test_tui_metric_formats_long);
+#endif
+#if ANSI_PRINT_DEFER
+    RUN_TEST(test_defer_without_float);
+#endif
+    return UNITY_END();
+}
@@ -0,0 +1,88 @@
+/* test_putc.c -- compile-time output sink (ANSI_PRINT_PUTC / _WRITE).
+ *
+ * Built with test/putc on the include path, whose app_cfg.h binds the
+ * sink macros to test_sink[] below. */
+#include "unity.h"
+#include "ansi_print.h"
+#include <string.h>
+
+#ifndef ANSI_PRINT_PUTC
+#  error "test_putc must be built with -I test/putc"
+#endif
+
+char   test_sink[1024];
+size_t test_sink_len;
+int    test_write_calls;
+
+static int callback_calls;
+static void callback_putc(int ch) { (void)ch; callback_calls++; }
+
+static char fmt_buf[256];
+
+void setUp(void)
+{
+    memset(test_sink, 0, sizeof(test_sink));
+    test_sink_len    = 0;
+    test_write_calls = 0;
+    callback_calls   = 0;
+    ansi_init(callback_putc, NULL, fmt_buf, sizeof(fmt_buf));
+    ansi_set_enabled(1);
+}
+
+void tearDown(void) { }
+
+void test_print_goes_to_macro_sink(void)
+{
+    ansi_print("[red]hi[/]");
+    TEST_ASSERT_EQUAL_STRING("\x1b[31mhi\x1b[0m", test_sink);
+    TEST_ASSERT_EQUAL_INT(0, callback_calls);
+    TEST_ASSERT_EQUAL_UINT32(test_sink_len, ansi_ctx_bytes(ansi_default_ctx()));
+}
+
+void test_write_is_one_bulk_call(void)
+{
+    ansi_write("raw bytes", 9);
+    TEST_ASSERT_EQUAL_STRING("raw bytes", test_sink);
+    TEST_ASSERT_EQUAL_INT(1, test_write_calls);
+}
+
+static char user_buf[64];
+static int  user_len;
+static void user_putc(void *user, int ch) { (void)user; user_buf[user_len++] = (char)ch; }
+
+void test_set_output_takes_precedence(void)
+{
+    memset(user_buf, 0, sizeof(user_buf));
+    user_len = 0;
+    ansi_ctx_set_output(ansi_default_ctx(), user_putc, NULL, NULL);
+    ansi_print("x");
+    TEST_ASSERT_EQUAL_STRING("x", user_buf);
+    TEST_ASSERT_EQUAL_size_t(0, test_sink_len);
+
+    ansi_ctx_set_output(ansi_default_ctx(), NULL, NULL, NULL);
+    ansi_print("y");
+    TEST_ASSERT_EQUAL_STRING("y", test_sink);
+}
+
+#if ANSI_PRINT_REP
+void test_rep_still_compresses(void)
+{
+    ansi_set_rep(1);
+    ansi_write("----------", 10);
+    TEST_ASSERT_EQUAL_STRING("-\x1b[9b", test_sink);
+    TEST_ASSERT_EQUAL_INT(0, test_write_calls);
+    ansi_set_rep(0);
+}
+#endif
+
+int main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_print_goes_to_macro_sink);
+    RUN_TEST(test_write_is_one_bulk_call);
+    RUN_TEST(test_set_output_takes_precedence);
+#if ANSI_PRINT_REP
+    RUN_TEST(test_rep_still_compresses);
+#endif
+    return UNITY_END();
+}
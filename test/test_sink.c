@@ -0,0 +1,389 @@
+#if !defined(_POSIX_C_SOURCE) && !defined(_GNU_SOURCE)
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include "unity.h"
+#include "ansi_sink.h"
+#include "ansi_tui.h"
+#include <string.h>
+#include <stdio.h>
+
+#if ANSI_PRINT_FD_SINK
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+/* ------------------------------------------------------------------ */
+/* A pipe stands in for a slow terminal: fill it and writes would block */
+/* ------------------------------------------------------------------ */
+
+static int            pfd[2];
+static char           sink_buf[512];
+static ansi_fd_sink_t sink;
+static ansi_ctx_t     ctx;
+static char           fmt_buf[256];
+
+void setUp(void)
+{
+    TEST_ASSERT_EQUAL(0, pipe(pfd));
+    fcntl(pfd[0], F_SETFL, fcntl(pfd[0], F_GETFL) | O_NONBLOCK);
+    TEST_ASSERT_EQUAL(1, ansi_fd_sink_init(&sink, pfd[1], sink_buf, sizeof(sink_buf)));
+    ansi_ctx_init(&ctx, NULL, NULL, fmt_buf, sizeof(fmt_buf));
+    ansi_ctx_set_enabled(&ctx, 0);
+    ansi_fd_sink_attach(&sink, &ctx);
+}
+
+void tearDown(void)
+{
+    close(pfd[0]);
+    close(pfd[1]);
+}
+
+/** Fill the pipe until the kernel refuses more. */
+static void stall_pipe(void)
+{
+    static const char junk[1024];
+    while (write(pfd[1], junk, sizeof(junk)) > 0) { }
+    TEST_ASSERT_TRUE(errno == EAGAIN || errno == EWOULDBLOCK);
+}
+
+/** Read everything the pipe holds into @p out (NUL-terminated, tail kept). */
+static size_t read_pipe(char *out, size_t size)
+{
+    static char chunk[4096];
+    size_t n = 0;
+    ssize_t r;
+    while ((r = read(pfd[0], chunk, sizeof(chunk))) > 0) {
+        for (ssize_t i = 0; i < r; i++) {
+            if (n == size - 1) memmove(out, out + 1, --n);
+            out[n++] = chunk[i];
+        }
+    }
+    out[n] = '\0';
+    return n;
+}
+
+/* ------------------------------------------------------------------ */
+/* Sink                                                                */
+/* ------------------------------------------------------------------ */
+
+void test_sink_writes_on_flush(void)
+{
+    char got[64];
+    ansi_ctx_puts(&ctx, "hello\n");
+    TEST_ASSERT_EQUAL(0, (int)ansi_fd_sink_pending(&sink));   /* puts flushes */
+    read_pipe(got, sizeof(got));
+    TEST_ASSERT_EQUAL_STRING("hello\n", got);
+    TEST_ASSERT_EQUAL(6, (int)sink.written);
+}
+
+void test_sink_keeps_output_pending_when_fd_blocks(void)
+{
+    char got[8192];
+    stall_pipe();
+    ansi_ctx_puts(&ctx, "frame");
+    TEST_ASSERT_EQUAL(5, (int)ansi_fd_sink_pending(&sink));
+    TEST_ASSERT_EQUAL(0, ansi_fd_sink_ready(&sink));
+    TEST_ASSERT_TRUE(sink.would_block > 0);
+
+    read_pipe(got, sizeof(got));             /* the terminal catches up */
+    TEST_ASSERT_EQUAL(1, ansi_fd_sink_ready(&sink));
+    read_pipe(got, sizeof(got));
+    TEST_ASSERT_EQUAL_STRING("frame", got);
+    TEST_ASSERT_EQUAL(0, ansi_fd_sink_overrun(&sink));
+}
+
+void test_sink_overrun_when_buffer_fills(void)
+{
+    char line[100];
+    memset(line, 'x', sizeof(line) - 1);
+    line[sizeof(line) - 1] = '\0';
+    stall_pipe();
+    for (int i = 0; i < 6; i++) ansi_ctx_puts(&ctx, line);
+    TEST_ASSERT_EQUAL((int)sizeof(sink_buf), (int)ansi_fd_sink_pending(&sink));
+    TEST_ASSERT_EQUAL(6 * 99 - (int)sizeof(sink_buf), (int)sink.dropped);
+    TEST_ASSERT_EQUAL(1, ansi_fd_sink_overrun(&sink));
+    TEST_ASSERT_EQUAL(0, ansi_fd_sink_overrun(&sink));
+}
+
+void test_sink_close_restores_blocking_mode(void)
+{
+    char got[8192];
+    int other = dup(pfd[1]);                 /* shares the file description */
+    TEST_ASSERT_TRUE(fcntl(other, F_GETFL) & O_NONBLOCK);
+
+    stall_pipe();
+    ansi_ctx_puts(&ctx, "last");
+    TEST_ASSERT_EQUAL(4, (int)ansi_fd_sink_pending(&sink));
+    read_pipe(got, sizeof(got));             /* room for the pending frame */
+
+    TEST_ASSERT_EQUAL(1, ansi_fd_sink_close(&sink));
+    TEST_ASSERT_FALSE(fcntl(pfd[1], F_GETFL) & O_NONBLOCK);
+    TEST_ASSERT_FALSE(fcntl(other, F_GETFL) & O_NONBLOCK);
+    TEST_ASSERT_EQUAL(0, (int)ansi_fd_sink_pending(&sink));
+    read_pipe(got, sizeof(got));
+    TEST_ASSERT_EQUAL_STRING("last", got);
+    close(other);
+}
+
+/* ------------------------------------------------------------------ */
+/* Screen backpressure                                                 */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_TUI_SCREEN && ANSI_TUI_TEXT
+void test_screen_holds_frames_and_sends_latest(void)
+{
+    char got[8192];
+    tui_screen_entry_t entries[1];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 1);
+    tui_screen_set_ctx(&scr, &ctx);
+    tui_screen_set_ready(&scr, ansi_fd_sink_ready, &sink);
+
+    char tbuf[32];
+    tui_text_state_t st = {0};
+    const tui_text_t w = {
+        .place = { .row = 1, .col = 1, .screen = &scr },
+        .width = 8, .state = &st, .text_buf = tbuf, .text_buf_size = sizeof(tbuf)
+    };
+    tui_text_init(&w);
+    tui_text_update(&w, "v=1");
+    TEST_ASSERT_EQUAL(1, tui_screen_render(&scr));
+    read_pipe(got, sizeof(got));
+
+    /* The terminal stalls with a frame in flight */
+    stall_pipe();
+    tui_text_update(&w, "v=2");
+    TEST_ASSERT_EQUAL(1, tui_screen_render(&scr));
+    TEST_ASSERT_TRUE(ansi_fd_sink_pending(&sink) > 0);
+
+    /* Later frames are held, not queued behind it */
+    size_t pending = ansi_fd_sink_pending(&sink);
+    for (int i = 3; i <= 9; i++) {
+        tui_text_update(&w, "v=%d", i);
+        TEST_ASSERT_EQUAL(0, tui_screen_render(&scr));
+    }
+    TEST_ASSERT_EQUAL((int)pending, (int)ansi_fd_sink_pending(&sink));
+    TEST_ASSERT_EQUAL(7, (int)scr.stats.held);
+
+    /* Once it drains, one frame with the newest value goes out */
+    read_pipe(got, sizeof(got));
+    TEST_ASSERT_EQUAL(1, tui_screen_render(&scr));
+    read_pipe(got, sizeof(got));
+    TEST_ASSERT_NOT_NULL(strstr(got, "v=2"));
+    TEST_ASSERT_NOT_NULL(strstr(got, "v=9"));
+    for (int i = 3; i <= 8; i++) {
+        char v[8];
+        snprintf(v, sizeof(v), "v=%d", i);
+        TEST_ASSERT_NULL(strstr(got, v));
+    }
+    TEST_ASSERT_EQUAL(6, (int)scr.stats.coalesced);
+}
+#endif
+
+#else
+
+void setUp(void) { }
+void tearDown(void) { }
+
+#endif /* ANSI_PRINT_FD_SINK */
+
+/* ------------------------------------------------------------------ */
+/* Ring sink                                                           */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_PRINT_RING_SINK
+
+static char             ring_buf[16];
+static ansi_ring_sink_t ring;
+static ansi_ctx_t       rctx;
+static char             rfmt_buf[128];
+static int              kicks;
+
+static void count_kick(void *user) { (void)user; kicks++; }
+
+static void ring_setup(size_t size)
+{
+    TEST_ASSERT_EQUAL(1, ansi_ring_sink_init(&ring, ring_buf, size));
+    ansi_ctx_init(&rctx, NULL, NULL, rfmt_buf, sizeof(rfmt_buf));
+    ansi_ctx_set_enabled(&rctx, 0);
+    ansi_ring_sink_attach(&ring, &rctx);
+    kicks = 0;
+    ansi_ring_sink_set_kick(&ring, count_kick, NULL);
+}
+
+/** Drain in byte mode (the TX interrupt's view) into @p out. */
+static void ring_read(char *out, size_t size)
+{
+    size_t n = 0;
+    int ch;
+    while (n < size - 1 && (ch = ansi_ring_sink_get(&ring)) >= 0) out[n++] = (char)ch;
+    out[n] = '\0';
+}
+
+void test_ring_init_needs_power_of_two(void)
+{
+    TEST_ASSERT_EQUAL(0, ansi_ring_sink_init(&ring, ring_buf, 12));
+    TEST_ASSERT_EQUAL(0, ansi_ring_sink_init(&ring, ring_buf, 1));
+    TEST_ASSERT_EQUAL(0, ansi_ring_sink_init(&ring, NULL, 16));
+    TEST_ASSERT_EQUAL(1, ansi_ring_sink_init(&ring, ring_buf, 16));
+}
+
+void test_ring_byte_mode(void)
+{
+    char got[32];
+    ring_setup(16);
+    ansi_ctx_puts(&rctx, "hello");
+    TEST_ASSERT_EQUAL(1, kicks);
+    TEST_ASSERT_EQUAL(5, (int)ansi_ring_sink_pending(&ring));
+    ring_read(got, sizeof(got));
+    TEST_ASSERT_EQUAL_STRING("hello", got);
+    TEST_ASSERT_EQUAL(-1, ansi_ring_sink_get(&ring));
+    TEST_ASSERT_EQUAL(1, ansi_ring_sink_ready(&ring));
+}
+
+void test_ring_publishes_on_flush(void)
+{
+    char got[32];
+    ring_setup(16);
+    ansi_ctx_batch_begin(&rctx);
+    ansi_ctx_puts(&rctx, "ab");
+    ansi_ctx_puts(&rctx, "cd");
+    /* Written, but not yet visible to the consumer */
+    TEST_ASSERT_EQUAL(4, (int)ansi_ring_sink_pending(&ring));
+    TEST_ASSERT_EQUAL(-1, ansi_ring_sink_get(&ring));
+    TEST_ASSERT_EQUAL(0, kicks);
+    ansi_ctx_batch_end(&rctx);
+    TEST_ASSERT_EQUAL(1, kicks);
+    ring_read(got, sizeof(got));
+    TEST_ASSERT_EQUAL_STRING("abcd", got);
+}
+
+void test_ring_claim_stops_at_wrap(void)
+{
+    char got[32];
+    const char *p;
+    ring_setup(8);
+    ansi_ctx_puts(&rctx, "abcdef");
+    ring_read(got, sizeof(got));
+    ansi_ctx_puts(&rctx, "123456");     /* slots 6,7 then 0..3 */
+
+    TEST_ASSERT_EQUAL(2, (int)ansi_ring_sink_claim(&ring, &p, 0));
+    TEST_ASSERT_EQUAL_MEMORY("12", p, 2);
+    /* Not released yet: the same run again */
+    TEST_ASSERT_EQUAL(2, (int)ansi_ring_sink_claim(&ring, &p, 0));
+    ansi_ring_sink_release(&ring);
+
+    TEST_ASSERT_EQUAL(3, (int)ansi_ring_sink_claim(&ring, &p, 3));
+    TEST_ASSERT_EQUAL_MEMORY("345", p, 3);
+    ansi_ring_sink_release(&ring);
+    TEST_ASSERT_EQUAL(1, (int)ansi_ring_sink_claim(&ring, &p, 0));
+    TEST_ASSERT_EQUAL('6', *p);
+    ansi_ring_sink_release(&ring);
+    TEST_ASSERT_EQUAL(0, (int)ansi_ring_sink_claim(&ring, &p, 0));
+    TEST_ASSERT_EQUAL(0, (int)ansi_ring_sink_pending(&ring));
+}
+
+void test_ring_overrun_and_high_water(void)
+{
+    char got[32];
+    ring_setup(8);
+    ansi_ctx_puts(&rctx, "0123456789");
+    TEST_ASSERT_EQUAL(2, (int)ring.dropped);
+    TEST_ASSERT_EQUAL(8, (int)ring.high_water);
+    TEST_ASSERT_EQUAL(1, ansi_ring_sink_overrun(&ring));
+    TEST_ASSERT_EQUAL(0, ansi_ring_sink_overrun(&ring));
+    ring_read(got, sizeof(got));
+    TEST_ASSERT_EQUAL_STRING("01234567", got);
+
+    /* Room again once the consumer caught up */
+    ansi_ctx_puts(&rctx, "xy");
+    ring_read(got, sizeof(got));
+    TEST_ASSERT_EQUAL_STRING("xy", got);
+    TEST_ASSERT_EQUAL(0, ansi_ring_sink_overrun(&ring));
+}
+
+/* A thread stands in for the DMA-complete interrupt */
+#if defined(_REENTRANT) && (defined(__unix__) || defined(__APPLE__))
+#include <pthread.h>
+#include <sched.h>
+
+#define RING_LINES 3000
+
+static char          dma_out[RING_LINES * 8];
+static size_t        dma_len;
+static volatile int  producer_done;
+
+static void *dma_consumer(void *arg)
+{
+    (void)arg;
+    for (;;) {
+        const char *p;
+        size_t n = ansi_ring_sink_claim(&ring, &p, 5);
+        if (n) {
+            memcpy(dma_out + dma_len, p, n);
+            dma_len += n;
+            ansi_ring_sink_release(&ring);
+        } else if (producer_done && ansi_ring_sink_pending(&ring) == 0) {
+            return NULL;
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+void test_ring_threaded_consumer_sees_every_byte(void)
+{
+    ring_setup(16);
+    ansi_ring_sink_set_kick(&ring, NULL, NULL);
+    dma_len = 0;
+    producer_done = 0;
+
+    pthread_t t;
+    pthread_create(&t, NULL, dma_consumer, NULL);
+    for (int i = 0; i < RING_LINES; i++) {
+        while (ansi_ring_sink_pending(&ring) > 8) sched_yield();   /* lines fit */
+        ansi_ctx_print(&rctx, "%d\n", i % 1000);
+    }
+    producer_done = 1;
+    pthread_join(t, NULL);
+
+    TEST_ASSERT_EQUAL(0, (int)ring.dropped);
+    size_t pos = 0;
+    for (int i = 0; i < RING_LINES; i++) {
+        char line[8];
+        int n = snprintf(line, sizeof(line), "%d\n", i % 1000);
+        TEST_ASSERT_TRUE(pos + (size_t)n <= dma_len);
+        TEST_ASSERT_EQUAL_MEMORY(line, dma_out + pos, n);
+        pos += (size_t)n;
+    }
+    TEST_ASSERT_EQUAL((int)pos, (int)dma_len);
+}
+#endif
+
+#endif /* ANSI_PRINT_RING_SINK */
+
+int main(void)
+{
+    UNITY_BEGIN();
+#if ANSI_PRINT_FD_SINK
+    RUN_TEST(test_sink_writes_on_flush);
+    RUN_TEST(test_sink_keeps_output_pending_when_fd_blocks);
+    RUN_TEST(test_sink_overrun_when_buffer_fills);
+    RUN_TEST(test_sink_close_restores_blocking_mode);
+#if ANSI_TUI_SCREEN && ANSI_TUI_TEXT
+    RUN_TEST(test_screen_holds_frames_and_sends_latest);
+#endif
+#endif
+#if ANSI_PRINT_RING_SINK
+    RUN_TEST(test_ring_init_needs_power_of_two);
+    RUN_TEST(test_ring_byte_mode);
+    RUN_TEST(test_ring_publishes_on_flush);
+    RUN_TEST(test_ring_claim_stops_at_wrap);
+    RUN_TEST(test_ring_overrun_and_high_water);
+#if defined(_REENTRANT) && (defined(__unix__) || defined(__APPLE__))
+    RUN_TEST(test_ring_threaded_consumer_sees_every_byte);
+#endif
+#endif
+    return UNITY_END();
+}
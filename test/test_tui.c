@@ -30,6 +30,17 @@ static void capture_reset(void)
 /* Format buffer */
 static char fmt_buf[512];      /* for ansi_init */
 
+#if ANSI_TUI_STATUS || ANSI_TUI_TEXT
+/** Cells blanked at @p p: a run of spaces or one ECH (ESC[nX). */
+static int blank_run(const char *p)
+{
+    int n = 0;
+    if (sscanf(p, "\x1b[%dX", &n) == 1) return n;
+    while (*p == ' ') { n++; p++; }
+    return n;
+}
+#endif
+
 /* ------------------------------------------------------------------ */
 /* Unity setUp / tearDown                                              */
 /* ------------------------------------------------------------------ */
@@ -112,6 +123,50 @@ void test_frame_init_colored(void)
     TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\x1b[2;3H"));
 }
 
+void test_frame_border_bytes(void)
+{
+    const tui_frame_t f = {
+        .row = 1, .col = 1, .width = 5, .height = 3, .color = "red"
+    };
+    tui_frame_init(&f);
+#if ANSI_PRINT_BOX_STYLE == ANSI_BOX_LIGHT
+    TEST_ASSERT_EQUAL_STRING(
+        "\x1b[1;1H" "\x1b[31m" "┌───┐" "\x1b[0m"
+        "\x1b[2;1H" "\x1b[31m" "│"     "\x1b[0m"
+        "\x1b[2;5H" "\x1b[31m" "│"     "\x1b[0m"
+        "\x1b[3;1H" "\x1b[31m" "└───┘" "\x1b[0m", capture_buf);
+#elif ANSI_PRINT_BOX_STYLE == ANSI_BOX_ASCII
+    TEST_ASSERT_EQUAL_STRING(
+        "\x1b[1;1H" "\x1b[31m" "+---+" "\x1b[0m"
+        "\x1b[2;1H" "\x1b[31m" "|"     "\x1b[0m"
+        "\x1b[2;5H" "\x1b[31m" "|"     "\x1b[0m"
+        "\x1b[3;1H" "\x1b[31m" "+---+" "\x1b[0m", capture_buf);
+#endif
+}
+
+void test_frame_border_color_disabled(void)
+{
+    ansi_set_enabled(0);
+    const tui_frame_t f = {
+        .row = 1, .col = 1, .width = 6, .height = 3, .color = "red"
+    };
+    tui_frame_init(&f);
+    TEST_ASSERT_NULL(strstr(capture_buf, "\x1b[31m"));
+    TEST_ASSERT_NULL(strstr(capture_buf, "\x1b[0m"));
+}
+
+void test_frame_border_wider_than_buffer(void)
+{
+    /* 200 rule glyphs (600 bytes) cannot fit the 512-byte format buffer:
+       the row is clamped, never overrun */
+    const tui_frame_t f = {
+        .row = 1, .col = 1, .width = 202, .height = 3, .color = "red"
+    };
+    tui_frame_init(&f);
+    TEST_ASSERT_TRUE(capture_pos > 0);
+    TEST_ASSERT_TRUE(capture_pos < CAPTURE_SIZE - 1);
+}
+
 void test_frame_null_widget(void)
 {
     tui_frame_init(NULL);
@@ -596,13 +651,10 @@ void test_status_fill_width(void)
 
     tui_status_update(&w, "test");
     TEST_ASSERT_NOT_NULL(strstr(capture_buf, "test"));
-    /* Find the goto and count padding spaces — should be 26 */
-    const char *goto_pos = strstr(capture_buf, "\x1b[2;3H");
+    /* Text follows the goto, then blanks fill the rest: 26 - 4 = 22 */
+    const char *goto_pos = strstr(capture_buf, "\x1b[2;3Htest");
     TEST_ASSERT_NOT_NULL(goto_pos);
-    int spaces = 0;
-    const char *p = goto_pos + strlen("\x1b[2;3H");
-    while (*p == ' ') { spaces++; p++; }
-    TEST_ASSERT_EQUAL_INT(26, spaces);
+    TEST_ASSERT_EQUAL_INT(22, blank_run(goto_pos + strlen("\x1b[2;3Htest")));
 }
 
 void test_status_fill_bordered(void)
@@ -701,6 +753,38 @@ void test_label_update_pads_to_width(void)
     TEST_ASSERT_NOT_NULL(pad);
 }
 
+void test_label_update_single_goto(void)
+{
+    tui_label_state_t st = {0};
+    tui_label_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_NO_BORDER,
+                   .color = NULL },
+        .width = 10, .label = "V", .state = &st
+    };
+    tui_label_init(&w);
+    tui_label_update(&w, "1234");
+
+    capture_reset();
+    tui_label_update(&w, "12");
+    /* One move straight to the value column, then value + 2 blanks */
+    TEST_ASSERT_EQUAL_STRING("\x1b[1;4H12  ", capture_buf);
+}
+
+void test_label_update_no_state_pads_width(void)
+{
+    tui_label_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_NO_BORDER,
+                   .color = NULL },
+        .width = 6, .label = "V"
+    };
+    tui_label_init(&w);
+    capture_reset();
+
+    /* Without state the previous length is unknown: blank the rest */
+    tui_label_update(&w, "ab");
+    TEST_ASSERT_EQUAL_STRING("\x1b[1;4Hab    ", capture_buf);
+}
+
 void test_label_update_with_markup(void)
 {
     tui_label_t w = {
@@ -1091,6 +1175,34 @@ void test_pbar_force0_redraws_on_change(void)
     TEST_ASSERT_TRUE(capture_pos > 0);
 }
 
+void test_pbar_partial_redraw(void)
+{
+    char bar_buf[128];
+    tui_pbar_state_t st = {0};
+    const tui_pbar_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_NO_BORDER,
+                   .color = NULL },
+        .bar_width = 10, .label = NULL,
+        .track = ANSI_BAR_BLANK,
+        .bar_buf = bar_buf, .bar_buf_size = sizeof(bar_buf),
+        .state = &st
+    };
+    tui_pbar_init(&w);
+    tui_pbar_update(&w, 20, 0);        /* 16 eighths: cells 0-1 full */
+
+    capture_reset();
+    tui_pbar_update(&w, 40, 0);        /* 32 eighths: cells 2-3 change */
+    TEST_ASSERT_EQUAL_STRING("\x1b[1;3H\xe2\x96\x88\xe2\x96\x88"
+                             "\x1b[1;11H 40%", capture_buf);
+
+    /* 100 -> 5: the suffix shrinks by 2, so exactly 2 blanks follow */
+    tui_pbar_update(&w, 100, 0);
+    capture_reset();
+    tui_pbar_update(&w, 5, 0);
+    TEST_ASSERT_TRUE(capture_pos >= 5);
+    TEST_ASSERT_EQUAL_STRING(" 5%  ", capture_buf + capture_pos - 5);
+}
+
 void test_pbar_force1_redraws_same(void)
 {
     char bar_buf[128];
@@ -1270,13 +1382,54 @@ void test_text_update_pads(void)
     capture_reset();
 
     tui_text_update(&w, "Hi");
-    /* Short text present, and cursor was repositioned to write it */
+    /* Short text present, written with a single cursor move */
     TEST_ASSERT_NOT_NULL(strstr(capture_buf, "Hi"));
-    /* Two goto sequences: first from tui_widget_goto, second to reposition */
     int goto_count = 0;
     for (const char *p = capture_buf; (p = strstr(p, "\x1b[1;1H")) != NULL; p++)
         goto_count++;
-    TEST_ASSERT_TRUE(goto_count >= 2);
+    TEST_ASSERT_EQUAL_INT(1, goto_count);
+}
+
+void test_text_update_pads_only_shrink(void)
+{
+    tui_text_state_t st = {0};
+    tui_text_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_NO_BORDER,
+                   .color = NULL },
+        .width = 20, .state = &st
+    };
+    tui_text_init(&w);
+
+    /* Growing from empty: text only, no trailing blanks */
+    capture_reset();
+    tui_text_update(&w, "Hello");
+    TEST_ASSERT_EQUAL_STRING("\x1b[1;1HHello", capture_buf);
+    TEST_ASSERT_EQUAL_INT(5, st.vis_len);
+
+    /* Shrinking: blank exactly the 3 cells the old text left behind */
+    capture_reset();
+    tui_text_update(&w, "Hi");
+    TEST_ASSERT_EQUAL_STRING("\x1b[1;1HHi   ", capture_buf);
+    TEST_ASSERT_EQUAL_INT(2, st.vis_len);
+}
+
+void test_text_update_markup_width(void)
+{
+    tui_text_state_t st = {0};
+    tui_text_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_NO_BORDER,
+                   .color = NULL },
+        .width = 20, .state = &st
+    };
+    tui_text_init(&w);
+    tui_text_update(&w, "ABCD");
+
+    /* Tags are zero-width: "[red]AB[/]" is 2 cells, so 2 cells of padding */
+    capture_reset();
+    tui_text_update(&w, "[red]AB[/]");
+    TEST_ASSERT_EQUAL_INT(2, st.vis_len);
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "B\x1b[0m  "));
+    TEST_ASSERT_NULL(strstr(capture_buf, "B\x1b[0m   "));
 }
 
 void test_text_fill_width(void)
@@ -1296,14 +1449,10 @@ void test_text_fill_width(void)
 
     tui_text_update(&w, "test");
     TEST_ASSERT_NOT_NULL(strstr(capture_buf, "test"));
-    /* Count spaces in the padding run — should be at least 26 */
-    const char *goto_pos = strstr(capture_buf, "\x1b[2;3H");
+    /* Text follows the goto, then blanks fill the rest: 26 - 4 = 22 */
+    const char *goto_pos = strstr(capture_buf, "\x1b[2;3Htest");
     TEST_ASSERT_NOT_NULL(goto_pos);
-    /* After the first goto there should be 26 spaces for padding */
-    int spaces = 0;
-    const char *p = goto_pos + strlen("\x1b[2;3H");
-    while (*p == ' ') { spaces++; p++; }
-    TEST_ASSERT_EQUAL_INT(26, spaces);
+    TEST_ASSERT_EQUAL_INT(22, blank_run(goto_pos + strlen("\x1b[2;3Htest")));
 }
 
 void test_text_fill_bordered(void)
@@ -1323,6 +1472,10 @@ void test_text_fill_bordered(void)
     TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\xe2\x95\x94"));
     /* Interior position at (2+1, 3+2) = (3, 5) */
     TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\x1b[3;5H"));
+#if ANSI_PRINT_ECH && ANSI_PRINT_ECH_ON
+    /* Side row interior (22 + 2 padding cells) erased, not spaced */
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\x1b[24X\x1b[24C\xe2\x95\x91"));
+#endif
 }
 
 void test_text_null_widget(void)
@@ -2173,7 +2326,59 @@ static void test_bar_force0_redraws_on_change(void)
     TEST_ASSERT_TRUE(capture_pos > 0);
 }
 
-static void test_bar_force0_redraws_on_range_change(void)
+static void test_bar_force0_skips_same_eighths(void)
+{
+    char bar_buf[128];
+    tui_bar_state_t st = {0};
+    const tui_bar_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_NO_BORDER,
+                   .color = "green" },
+        .bar_width = 10, .label = NULL,
+        .track = ANSI_BAR_LIGHT,
+        .bar_buf = bar_buf, .bar_buf_size = sizeof(bar_buf),
+        .state = &st
+    };
+    tui_bar_init(&w);
+    tui_bar_update(&w, 50.0, 0.0, 100.0, 0);
+    TEST_ASSERT_EQUAL_INT(40, st.eighths);
+
+    /* Noise below 1/8 cell renders the same bar: no output */
+    capture_reset();
+    tui_bar_update(&w, 50.3, 0.0, 100.0, 0);
+    TEST_ASSERT_EQUAL_INT(0, capture_pos);
+    /* Latest value is still stored for enable restore */
+    TEST_ASSERT_EQUAL_FLOAT(50.3, st.value);
+}
+
+void test_bar_partial_redraw(void)
+{
+    char bar_buf[128];
+    tui_bar_state_t st = {0};
+    const tui_bar_t w = {
+        .place = { .row = 2, .col = 5, .border = ANSI_TUI_NO_BORDER,
+                   .color = NULL },
+        .bar_width = 10, .label = "L",
+        .track = ANSI_BAR_BLANK,
+        .bar_buf = bar_buf, .bar_buf_size = sizeof(bar_buf),
+        .state = &st
+    };
+    tui_bar_init(&w);
+    tui_bar_update(&w, 25.0, 0.0, 100.0, 0);   /* 20 eighths */
+
+    /* 20 -> 44 eighths: cells 2..5 change (half block -> full ... half) */
+    capture_reset();
+    tui_bar_update(&w, 55.0, 0.0, 100.0, 0);
+    TEST_ASSERT_EQUAL_STRING("\x1b[2;8H"
+                             "\xe2\x96\x88\xe2\x96\x88\xe2\x96\x88\xe2\x96\x8c",
+                             capture_buf);
+
+    /* Shrinking back repaints the same cells with track */
+    capture_reset();
+    tui_bar_update(&w, 25.0, 0.0, 100.0, 0);
+    TEST_ASSERT_EQUAL_STRING("\x1b[2;8H\xe2\x96\x8c   ", capture_buf);
+}
+
+void test_bar_force0_redraws_on_range_change(void)
 {
     char bar_buf[128];
     tui_bar_state_t st;
@@ -2189,6 +2394,33 @@ static void test_bar_force0_redraws_on_range_change(void)
     tui_bar_update(&w, 50.0, 0.0, 200.0, 0);
     TEST_ASSERT_TRUE(capture_pos > 0);
 }
+
+void test_bar_update_i32_matches_double(void)
+{
+    char bar_buf[128], expect[256];
+    tui_bar_state_t st = {0};
+    const tui_bar_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_NO_BORDER,
+                   .color = "green" },
+        .bar_width = 10, .track = ANSI_BAR_LIGHT,
+        .bar_buf = bar_buf, .bar_buf_size = sizeof(bar_buf), .state = &st
+    };
+    tui_bar_init(&w);
+    capture_reset();
+    tui_bar_update(&w, 55.0, 0.0, 100.0, 1);
+    strcpy(expect, capture_buf);
+
+    tui_bar_init(&w);
+    capture_reset();
+    tui_bar_update_i32(&w, 55, 0, 100, 1);
+    TEST_ASSERT_EQUAL_STRING(expect, capture_buf);
+    TEST_ASSERT_EQUAL_INT(44, st.eighths);
+
+    /* Same fill in Q16.16: nothing to redraw */
+    capture_reset();
+    tui_bar_update_i32(&w, 55 << 16, 0, 100 << 16, 0);
+    TEST_ASSERT_EQUAL_INT(0, capture_pos);
+}
 #endif
 
 #if ANSI_TUI_METRIC
@@ -2210,7 +2442,32 @@ static void test_metric_force0_redraws_on_change(void)
     TEST_ASSERT_TRUE(capture_pos > 0);
 }
 
-static void test_metric_force1_redraws_border(void)
+static void test_metric_force0_skips_same_text(void)
+{
+    tui_metric_state_t st = {0};
+    const tui_metric_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_BORDER,
+                   .color = "green" },
+        .width = 10, .title = "T", .fmt = "%0.2f",
+        .color_lo = "blue", .color_hi = "red",
+        .thresh_lo = 0.0, .thresh_hi = 100.0,
+        .state = &st
+    };
+    tui_metric_init(&w);
+    tui_metric_update(&w, 12.341, 0);
+
+    /* Formats to the same "12.34": nothing is sent */
+    capture_reset();
+    tui_metric_update(&w, 12.338, 0);
+    TEST_ASSERT_EQUAL_INT(0, capture_pos);
+    TEST_ASSERT_EQUAL_FLOAT(12.338, st.value);
+
+    /* Visible change redraws the value */
+    tui_metric_update(&w, 12.36, 0);
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "12.36"));
+}
+
+void test_metric_force1_redraws_border(void)
 {
     tui_metric_init(&m_metric_default);
     tui_metric_update(&m_metric_default, 50.0, 1);
@@ -2246,6 +2503,581 @@ static void print_config(void)
     printf("\n");
 }
 
+/* ------------------------------------------------------------------ */
+/* Screen registry                                                     */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_TUI_SCREEN
+
+static int flush_count;
+static void counting_flush(void) { flush_count++; }
+
+#if ANSI_TUI_TEXT
+void test_screen_update_defers_until_render(void)
+{
+    tui_screen_entry_t entries[4];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 4);
+
+    char tbuf[32];
+    tui_text_state_t st = {0};
+    const tui_text_t w = {
+        .place = { .row = 2, .col = 3, .border = ANSI_TUI_NO_BORDER,
+                   .screen = &scr },
+        .width = 8, .state = &st,
+        .text_buf = tbuf, .text_buf_size = sizeof(tbuf)
+    };
+    tui_text_init(&w);
+    TEST_ASSERT_EQUAL(1, scr.count);
+
+    capture_reset();
+    tui_text_update(&w, "v=%d", 1);
+    tui_text_update(&w, "v=%d", 2);
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);
+
+    TEST_ASSERT_EQUAL(1, tui_screen_render(&scr));
+    TEST_ASSERT_EQUAL_STRING("\x1b[?2026h\x1b[2;3Hv=2\x1b[?2026l", capture_buf);
+
+    /* Nothing dirty: nothing emitted */
+    capture_reset();
+    TEST_ASSERT_EQUAL(0, tui_screen_render(&scr));
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);
+}
+
+void test_screen_render_row_major(void)
+{
+    tui_screen_entry_t entries[4];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 4);
+
+    char b1[16], b2[16], b3[16];
+    tui_text_state_t s1 = {0}, s2 = {0}, s3 = {0};
+    const tui_text_t w3 = { .place = { .row = 3, .col = 1, .screen = &scr },
+                            .width = 4, .state = &s3,
+                            .text_buf = b3, .text_buf_size = sizeof(b3) };
+    const tui_text_t w1 = { .place = { .row = 1, .col = 9, .screen = &scr },
+                            .width = 4, .state = &s1,
+                            .text_buf = b1, .text_buf_size = sizeof(b1) };
+    const tui_text_t w2 = { .place = { .row = 1, .col = 2, .screen = &scr },
+                            .width = 4, .state = &s2,
+                            .text_buf = b2, .text_buf_size = sizeof(b2) };
+    tui_text_init(&w3);
+    tui_text_init(&w1);
+    tui_text_init(&w2);
+
+    capture_reset();
+    tui_text_update(&w3, "c");
+    tui_text_update(&w1, "b");
+    tui_text_update(&w2, "a");
+    TEST_ASSERT_EQUAL(3, tui_screen_render(&scr));
+    TEST_ASSERT_EQUAL_STRING("\x1b[?2026h"
+                             "\x1b[1;2Ha" "\x1b[1;9Hb" "\x1b[3;1Hc"
+                             "\x1b[?2026l", capture_buf);
+}
+
+void test_screen_render_flushes_once(void)
+{
+    tui_screen_entry_t entries[2];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 2);
+
+    char b1[16], b2[16];
+    tui_text_state_t s1 = {0}, s2 = {0};
+    const tui_text_t w1 = { .place = { .row = 1, .col = 1, .screen = &scr },
+                            .width = 4, .state = &s1,
+                            .text_buf = b1, .text_buf_size = sizeof(b1) };
+    const tui_text_t w2 = { .place = { .row = 2, .col = 1, .screen = &scr },
+                            .width = 4, .state = &s2,
+                            .text_buf = b2, .text_buf_size = sizeof(b2) };
+    tui_text_init(&w1);
+    tui_text_init(&w2);
+    tui_text_update(&w1, "x");
+    tui_text_update(&w2, "y");
+
+    ansi_init(capture_putc, counting_flush, fmt_buf, sizeof(fmt_buf));
+    flush_count = 0;
+    tui_screen_render(&scr);
+    TEST_ASSERT_EQUAL(1, flush_count);
+}
+
+void test_screen_full_draws_immediately(void)
+{
+    tui_screen_entry_t entries[1];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 1);
+
+    char b1[16], b2[16];
+    tui_text_state_t s1 = {0}, s2 = {0};
+    const tui_text_t w1 = { .place = { .row = 1, .col = 1, .screen = &scr },
+                            .width = 4, .state = &s1,
+                            .text_buf = b1, .text_buf_size = sizeof(b1) };
+    const tui_text_t w2 = { .place = { .row = 2, .col = 1, .screen = &scr },
+                            .width = 4, .state = &s2,
+                            .text_buf = b2, .text_buf_size = sizeof(b2) };
+    tui_text_init(&w1);
+    tui_text_init(&w2);
+    TEST_ASSERT_EQUAL(1, scr.count);
+
+    capture_reset();
+    tui_text_update(&w2, "now");
+    TEST_ASSERT_EQUAL_STRING("\x1b[2;1Hnow", capture_buf);
+}
+
+void test_screen_text_without_buf_draws_immediately(void)
+{
+    tui_screen_entry_t entries[1];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 1);
+
+    tui_text_state_t st = {0};
+    const tui_text_t w = { .place = { .row = 1, .col = 1, .screen = &scr },
+                           .width = 4, .state = &st };
+    tui_text_init(&w);
+
+    capture_reset();
+    tui_text_update(&w, "ab");
+    TEST_ASSERT_EQUAL_STRING("\x1b[1;1Hab", capture_buf);
+    TEST_ASSERT_EQUAL(0, tui_screen_render(&scr));
+}
+
+static char ctx_out[256];
+static int  ctx_pos;
+static void ctx_putc(int ch)
+{
+    if (ctx_pos < (int)sizeof(ctx_out) - 1) ctx_out[ctx_pos++] = (char)ch;
+}
+
+void test_screen_ctx_routes_output(void)
+{
+    static char cbuf[128];
+    ansi_ctx_t ctx;
+    ansi_ctx_init(&ctx, ctx_putc, NULL, cbuf, sizeof(cbuf));
+    memset(ctx_out, 0, sizeof(ctx_out));
+    ctx_pos = 0;
+
+    tui_screen_entry_t entries[2];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 2);
+    tui_screen_set_ctx(&scr, &ctx);
+
+    char tbuf[16];
+    tui_text_state_t st = {0};
+    const tui_text_t w = { .place = { .row = 4, .col = 2, .screen = &scr },
+                           .width = 4, .state = &st,
+                           .text_buf = tbuf, .text_buf_size = sizeof(tbuf) };
+    tui_text_init(&w);
+    tui_text_update(&w, "hi");
+    tui_screen_render(&scr);
+
+    /* Everything went to the screen's context, nothing to the default */
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);
+    TEST_ASSERT_EQUAL_STRING("\x1b[4;2H    "
+                             "\x1b[?2026h\x1b[4;2Hhi\x1b[?2026l", ctx_out);
+}
+#endif /* ANSI_TUI_TEXT */
+
+#if ANSI_TUI_FRAME && ANSI_TUI_LABEL
+void test_screen_inherited_from_frame(void)
+{
+    tui_screen_entry_t entries[4];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 4);
+
+    const tui_frame_t f = { .row = 1, .col = 1, .width = 20, .height = 5,
+                            .screen = &scr };
+    char lbuf[16];
+    tui_label_state_t st = {0};
+    const tui_label_t w = {
+        .place = { .row = 1, .col = 1, .parent = &f },
+        .width = 5, .label = "A", .state = &st,
+        .text_buf = lbuf, .text_buf_size = sizeof(lbuf)
+    };
+    tui_frame_init(&f);
+    tui_label_init(&w);
+    TEST_ASSERT_EQUAL(2, scr.count);
+    TEST_ASSERT_EQUAL_PTR(&f, scr.entries[0].widget);
+
+    capture_reset();
+    tui_label_update(&w, "42");
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);
+    TEST_ASSERT_EQUAL(1, tui_screen_render(&scr));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "\x1b[2;6H42"));
+}
+
+void test_screen_redraw_all(void)
+{
+    tui_screen_entry_t entries[4];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 4);
+
+    const tui_frame_t f = { .row = 1, .col = 1, .width = 20, .height = 5,
+                            .title = "Box", .screen = &scr };
+    char lbuf[16];
+    tui_label_state_t st = {0};
+    const tui_label_t w = {
+        .place = { .row = 1, .col = 1, .parent = &f },
+        .width = 5, .label = "A", .state = &st,
+        .text_buf = lbuf, .text_buf_size = sizeof(lbuf)
+    };
+    tui_frame_init(&f);
+    tui_label_init(&w);
+    tui_label_update(&w, "42");
+    tui_screen_render(&scr);
+
+    capture_reset();
+    tui_screen_redraw_all(&scr);
+    char *cls   = strstr(capture_buf, "\x1b[2J");
+    char *title = strstr(capture_buf, "Box");
+    char *value = strstr(capture_buf, "\x1b[2;6H42");
+    TEST_ASSERT_NOT_NULL(cls);
+    TEST_ASSERT_NOT_NULL(title);
+    TEST_ASSERT_NOT_NULL(value);
+    TEST_ASSERT_TRUE(cls < title && title < value);
+    TEST_ASSERT_EQUAL(2, scr.count);   /* redraw does not re-register */
+}
+#endif /* ANSI_TUI_FRAME && ANSI_TUI_LABEL */
+
+#if ANSI_TUI_BAR
+void test_screen_bar_coalesces_updates(void)
+{
+    tui_screen_entry_t entries[1];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 1);
+
+    char bar_buf[128];
+    tui_bar_state_t st = {0};
+    const tui_bar_t w = {
+        .place = { .row = 2, .col = 5, .screen = &scr },
+        .bar_width = 10, .label = "L", .track = ANSI_BAR_BLANK,
+        .bar_buf = bar_buf, .bar_buf_size = sizeof(bar_buf),
+        .state = &st
+    };
+    tui_bar_init(&w);
+    tui_bar_update(&w, 25.0, 0.0, 100.0, 0);
+    tui_screen_render(&scr);
+
+    /* Intermediate values never reach the terminal */
+    capture_reset();
+    tui_bar_update(&w, 90.0, 0.0, 100.0, 0);
+    tui_bar_update(&w, 10.0, 0.0, 100.0, 0);
+    tui_bar_update(&w, 55.0, 0.0, 100.0, 0);
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);
+    tui_screen_render(&scr);
+    TEST_ASSERT_EQUAL_STRING("\x1b[?2026h" "\x1b[2;8H"
+                             "\xe2\x96\x88\xe2\x96\x88\xe2\x96\x88\xe2\x96\x8c"
+                             "\x1b[?2026l", capture_buf);
+}
+#endif /* ANSI_TUI_BAR */
+
+#if ANSI_TUI_PBAR
+void test_screen_pbar_diffs_against_shown(void)
+{
+    tui_screen_entry_t entries[1];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 1);
+
+    char bar_buf[128];
+    tui_pbar_state_t st = {0};
+    const tui_pbar_t w = {
+        .place = { .row = 1, .col = 1, .screen = &scr },
+        .bar_width = 10, .track = ANSI_BAR_BLANK,
+        .bar_buf = bar_buf, .bar_buf_size = sizeof(bar_buf),
+        .state = &st
+    };
+    tui_pbar_init(&w);
+    tui_pbar_update(&w, 40, 0);
+    TEST_ASSERT_EQUAL(40, st.percent);
+    TEST_ASSERT_EQUAL(0, st.shown);
+    tui_screen_render(&scr);
+    TEST_ASSERT_EQUAL(40, st.shown);
+
+    /* Back to the shown value before the render: nothing to redraw */
+    tui_pbar_update(&w, 70, 0);
+    tui_pbar_update(&w, 40, 0);
+    capture_reset();
+    tui_screen_render(&scr);
+    TEST_ASSERT_EQUAL_STRING("\x1b[?2026h\x1b[?2026l", capture_buf);
+}
+#endif /* ANSI_TUI_PBAR */
+
+#if ANSI_TUI_METRIC
+void test_tick_coalesces_to_latest(void)
+{
+    tui_screen_entry_t entries[1];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 1);
+    tui_screen_set_fps(&scr, 10);            /* 100 ms frames */
+
+    tui_metric_state_t st = {0};
+    const tui_metric_t w = {
+        .place = { .row = 1, .col = 1, .border = ANSI_TUI_BORDER,
+                   .color = "green", .screen = &scr },
+        .width = 10, .title = "T", .fmt = "%.0f",
+        .color_lo = "blue", .color_hi = "red",
+        .thresh_lo = 0.0, .thresh_hi = 1000.0, .state = &st
+    };
+    tui_metric_init(&w);
+
+    tui_metric_update(&w, 11.0, 0);
+    tui_metric_update(&w, 12.0, 0);
+    tui_metric_update(&w, 13.0, 0);
+    capture_reset();
+    TEST_ASSERT_EQUAL(1, tui_tick(&scr, 1000));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "13"));
+    TEST_ASSERT_NULL(strstr(capture_buf, "12"));
+    TEST_ASSERT_EQUAL(3, scr.stats.updates);
+    TEST_ASSERT_EQUAL(2, scr.stats.frame_coalesced);
+    TEST_ASSERT_EQUAL(1, scr.stats.frames);
+
+    /* Inside the frame interval: throttled, value kept */
+    tui_metric_update(&w, 14.0, 0);
+    capture_reset();
+    TEST_ASSERT_EQUAL(0, tui_tick(&scr, 1050));
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);
+    tui_metric_update(&w, 15.0, 0);
+    TEST_ASSERT_EQUAL(1, tui_tick(&scr, 1100));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "15"));
+    TEST_ASSERT_EQUAL(1, scr.stats.frame_coalesced);
+    TEST_ASSERT_EQUAL(3, scr.stats.coalesced);
+    TEST_ASSERT_EQUAL(2, scr.stats.frames);
+}
+#endif /* ANSI_TUI_METRIC */
+
+#if ANSI_TUI_BAR
+void test_tick_idle_does_not_delay_next_frame(void)
+{
+    tui_screen_entry_t entries[1];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 1);
+    tui_screen_set_fps(&scr, 20);            /* 50 ms frames */
+
+    char bar_buf[128];
+    tui_bar_state_t st = {0};
+    const tui_bar_t w = {
+        .place = { .row = 1, .col = 1, .screen = &scr },
+        .bar_width = 4, .track = ANSI_BAR_BLANK,
+        .bar_buf = bar_buf, .bar_buf_size = sizeof(bar_buf),
+        .state = &st
+    };
+    tui_bar_init(&w);
+    tui_bar_update(&w, 50.0, 0.0, 100.0, 0);
+    TEST_ASSERT_EQUAL(1, tui_tick(&scr, 0xFFFFFFF0u));
+
+    /* Nothing dirty for a while, then an update: drawn on the next tick,
+       measured across the 32-bit wrap */
+    TEST_ASSERT_EQUAL(0, tui_tick(&scr, 0x00000100u));
+    tui_bar_update(&w, 100.0, 0.0, 100.0, 0);
+    TEST_ASSERT_EQUAL(1, tui_tick(&scr, 0x00000101u));
+    TEST_ASSERT_EQUAL(0, scr.stats.coalesced);
+}
+#endif /* ANSI_TUI_BAR */
+
+/* ------------------------------------------------------------------ */
+/* Output budget                                                       */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_TUI_BUDGET && ANSI_TUI_TEXT
+void test_budget_draws_high_priority_first(void)
+{
+    tui_screen_entry_t entries[2];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 2);
+    tui_screen_set_budget(&scr, 200);        /* 20 bytes of burst */
+
+    char lo_buf[16], hi_buf[16];
+    tui_text_state_t lo_st = {0}, hi_st = {0};
+    const tui_text_t lo = {
+        .place = { .row = 1, .col = 1, .screen = &scr },
+        .width = 8, .state = &lo_st, .text_buf = lo_buf, .text_buf_size = sizeof(lo_buf)
+    };
+    const tui_text_t hi = {
+        .place = { .row = 2, .col = 1, .screen = &scr, .priority = 5 },
+        .width = 8, .state = &hi_st, .text_buf = hi_buf, .text_buf_size = sizeof(hi_buf)
+    };
+    tui_text_init(&lo);
+    tui_text_init(&hi);
+    tui_text_update(&lo, "lo-1");
+    tui_text_update(&hi, "hi-1");
+
+    /* Only one fits: the bottom row goes first because of its priority */
+    capture_reset();
+    TEST_ASSERT_EQUAL(1, tui_tick(&scr, 0));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "hi-1"));
+    TEST_ASSERT_NULL(strstr(capture_buf, "lo-1"));
+    TEST_ASSERT_EQUAL(1, scr.stats.deferred);
+    TEST_ASSERT_TRUE(entries[1].cost > 0 || entries[0].cost > 0);
+
+    /* The overdraft is repaid before anything else is sent */
+    capture_reset();
+    TEST_ASSERT_EQUAL(0, tui_tick(&scr, 10));
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);
+
+    /* A second later the waiting widget is drawn with its latest value */
+    tui_text_update(&lo, "lo-2");
+    capture_reset();
+    TEST_ASSERT_EQUAL(1, tui_tick(&scr, 1000));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "lo-2"));
+    TEST_ASSERT_EQUAL(0, scr.stats.deferred);
+    TEST_ASSERT_EQUAL(1000, scr.stats.frame_stale_ms);
+    TEST_ASSERT_EQUAL(1000, scr.stats.stale_max_ms);
+}
+
+void test_budget_holds_long_run_rate(void)
+{
+    enum { N = 4, BPS = 2000, SECONDS = 5 };
+    tui_screen_entry_t entries[N];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, N);
+    tui_screen_set_budget(&scr, BPS);
+
+    char bufs[N][16];
+    tui_text_state_t st[N];
+    tui_text_t w[N];
+    memset(st, 0, sizeof(st));
+    for (int i = 0; i < N; i++) {
+        tui_text_t t = {
+            .place = { .row = i + 1, .col = 1, .screen = &scr },
+            .width = 10, .state = &st[i], .text_buf = bufs[i], .text_buf_size = sizeof(bufs[i])
+        };
+        w[i] = t;
+        tui_text_init(&w[i]);
+    }
+
+    /* Every widget changes every 10 ms: far more than 2000 B/s */
+    uint32_t now = 0;
+    for (; now < SECONDS * 1000; now += 10) {
+        for (int i = 0; i < N; i++) tui_text_update(&w[i], "%u", (unsigned)now);
+        tui_tick(&scr, now);
+    }
+    TEST_ASSERT_TRUE(scr.stats.bytes <= (uint32_t)BPS * SECONDS + BPS / 10 + 64);
+    TEST_ASSERT_TRUE(scr.stats.bytes >= (uint32_t)BPS * SECONDS * 9 / 10);
+    TEST_ASSERT_TRUE(scr.stats.bps > 0 && scr.stats.bps <= BPS * 11 / 10);
+    TEST_ASSERT_TRUE(scr.stats.stale_max_ms > 0);
+
+    /* Once the updates stop, every widget catches up to its latest value */
+    for (int i = 0; i < 100; i++, now += 10) tui_tick(&scr, now);
+    TEST_ASSERT_EQUAL(0, scr.stats.deferred);
+    for (int i = 0; i < N; i++) TEST_ASSERT_EQUAL(1, st[i].dirty);   /* clean */
+}
+#endif /* ANSI_TUI_BUDGET && ANSI_TUI_TEXT */
+
+/* ------------------------------------------------------------------ */
+/* Data binding                                                        */
+/* ------------------------------------------------------------------ */
+
+#if ANSI_TUI_BIND
+
+#if ANSI_TUI_BAR
+void test_poll_redraws_only_on_quantized_change(void)
+{
+    tui_screen_entry_t entries[1];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 1);
+
+    volatile double load = 50.0;
+    tui_bind_t bind = { ANSI_TUI_BIND_DOUBLE, &load, NULL, 0.0, 100.0, NULL, 0 };
+    char bar_buf[128];
+    tui_bar_state_t st = {0};
+    const tui_bar_t w = {
+        .place = { .row = 1, .col = 1, .screen = &scr, .bind = &bind },
+        .bar_width = 4, .track = ANSI_BAR_BLANK,
+        .bar_buf = bar_buf, .bar_buf_size = sizeof(bar_buf),
+        .state = &st
+    };
+    tui_bar_init(&w);
+    TEST_ASSERT_EQUAL(1, tui_poll(&scr));
+    TEST_ASSERT_TRUE(st.value == 50.0);
+
+    /* Unchanged, then below one eighth of a cell: nothing emitted */
+    capture_reset();
+    TEST_ASSERT_EQUAL(0, tui_poll(&scr));
+    load = 51.0;
+    TEST_ASSERT_EQUAL(0, tui_poll(&scr));
+    TEST_ASSERT_EQUAL_STRING("", capture_buf);
+    TEST_ASSERT_EQUAL(1, (int)scr.stats.updates);   /* not even deferred */
+
+    load = 75.0;
+    TEST_ASSERT_EQUAL(1, tui_poll(&scr));
+    TEST_ASSERT_TRUE(capture_pos > 0);
+}
+
+void test_poll_skips_torn_seqlock_snapshot(void)
+{
+    tui_screen_entry_t entries[1];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 1);
+
+    volatile int load = 0;
+    volatile uint32_t seq = 0;
+    tui_bind_t bind = { ANSI_TUI_BIND_INT, &load, &seq, 0.0, 0.0, NULL, 0 };
+    char bar_buf[128];
+    tui_bar_state_t st = {0};
+    const tui_bar_t w = {
+        .place = { .row = 1, .col = 1, .screen = &scr, .bind = &bind },
+        .bar_width = 4, .track = ANSI_BAR_BLANK,
+        .bar_buf = bar_buf, .bar_buf_size = sizeof(bar_buf),
+        .state = &st
+    };
+    tui_bar_init(&w);
+    tui_poll(&scr);
+
+    /* Writer in progress: the half-written value is not shown */
+    tui_seq_begin(&seq);
+    load = 100;
+    TEST_ASSERT_EQUAL(1u, seq);
+    TEST_ASSERT_EQUAL(0, tui_poll(&scr));
+    TEST_ASSERT_TRUE(st.value == 0.0);
+
+    tui_seq_end(&seq);
+    TEST_ASSERT_EQUAL(1, tui_poll(&scr));
+    TEST_ASSERT_TRUE(st.value == 100.0);
+}
+#endif /* ANSI_TUI_BAR */
+
+#if ANSI_TUI_TEXT && ANSI_TUI_CHECK
+void test_poll_binds_text_and_bool(void)
+{
+    tui_screen_entry_t entries[2];
+    tui_screen_t scr;
+    tui_screen_init(&scr, entries, 2);
+
+    volatile char mode[16] = "idle";
+    volatile _Bool ok = 0;
+    tui_bind_t mode_bind = { ANSI_TUI_BIND_STRING, mode, NULL, 0.0, 0.0, "<%s>", 0 };
+    tui_bind_t ok_bind   = { ANSI_TUI_BIND_BOOL, &ok, NULL, 0.0, 0.0, NULL, 0 };
+    char tbuf[32];
+    tui_text_state_t tst = {0};
+    const tui_text_t text = {
+        .place = { .row = 1, .col = 1, .screen = &scr, .bind = &mode_bind },
+        .width = 8, .state = &tst, .text_buf = tbuf, .text_buf_size = sizeof(tbuf)
+    };
+    tui_check_state_t cst = {0};
+    const tui_check_t check = {
+        .place = { .row = 2, .col = 1, .screen = &scr, .bind = &ok_bind },
+        .label = "OK", .state = &cst
+    };
+    tui_text_init(&text);
+    tui_check_init(&check, 0);
+
+    /* The check already shows a cross: only the text is drawn */
+    capture_reset();
+    TEST_ASSERT_EQUAL(1, tui_poll(&scr));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "<idle>"));
+    TEST_ASSERT_EQUAL(0, tui_poll(&scr));
+
+    mode[0] = 'b'; mode[1] = 'u'; mode[2] = 's'; mode[3] = 'y';
+    ok = 1;
+    capture_reset();
+    TEST_ASSERT_EQUAL(2, tui_poll(&scr));
+    TEST_ASSERT_NOT_NULL(strstr(capture_buf, "<busy>"));
+    TEST_ASSERT_EQUAL(1, cst.checked);
+}
+#endif /* ANSI_TUI_TEXT && ANSI_TUI_CHECK */
+
+#endif /* ANSI_TUI_BIND */
+
+#endif /* ANSI_TUI_SCREEN */
+
 int main(void)
 {
     print_config();
@@ -2263,6 +3095,9 @@ int main(void)
 #if ANSI_TUI_FRAME
     RUN_TEST(test_frame_init_basic);
     RUN_TEST(test_frame_init_colored);
+    RUN_TEST(test_frame_border_bytes);
+    RUN_TEST(test_frame_border_color_disabled);
+    RUN_TEST(test_frame_border_wider_than_buffer);
     RUN_TEST(test_frame_null_widget);
     RUN_TEST(test_frame_min_size);
     RUN_TEST(test_frame_too_small);
@@ -2330,6 +3165,8 @@ int main(void)
     RUN_TEST(test_label_init_bordered);
     RUN_TEST(test_label_update_basic);
     RUN_TEST(test_label_update_pads_to_width);
+    RUN_TEST(test_label_update_single_goto);
+    RUN_TEST(test_label_update_no_state_pads_width);
     RUN_TEST(test_label_update_with_markup);
     RUN_TEST(test_label_update_bordered);
     RUN_TEST(test_label_null_widget);
@@ -2401,6 +3238,8 @@ int main(void)
     RUN_TEST(test_text_init_bordered);
     RUN_TEST(test_text_update_basic);
     RUN_TEST(test_text_update_pads);
+    RUN_TEST(test_text_update_pads_only_shrink);
+    RUN_TEST(test_text_update_markup_width);
     RUN_TEST(test_text_fill_width);
     RUN_TEST(test_text_fill_bordered);
     RUN_TEST(test_text_null_widget);
@@ -2469,21 +3308,64 @@ int main(void)
     RUN_TEST(test_bar_force0_skips_same);
     RUN_TEST(test_bar_force0_redraws_on_change);
     RUN_TEST(test_bar_force0_redraws_on_range_change);
+    RUN_TEST(test_bar_update_i32_matches_double);
+    RUN_TEST(test_bar_force0_skips_same_eighths);
+    RUN_TEST(test_bar_partial_redraw);
 #endif
 #if ANSI_TUI_PBAR
     RUN_TEST(test_pbar_force0_skips_same);
     RUN_TEST(test_pbar_force0_redraws_on_change);
     RUN_TEST(test_pbar_force1_redraws_same);
+    RUN_TEST(test_pbar_partial_redraw);
 #endif
 #if ANSI_TUI_METRIC
     RUN_TEST(test_metric_force0_skips_same);
     RUN_TEST(test_metric_force0_redraws_on_change);
     RUN_TEST(test_metric_force1_redraws_border);
+    RUN_TEST(test_metric_force0_skips_same_text);
 #endif
 #if ANSI_TUI_EBAR
     RUN_TEST(test_ebar_force0_skips_same);
     RUN_TEST(test_ebar_force1_redraws_same);
 #endif
 
+#if ANSI_TUI_SCREEN
+#if ANSI_TUI_TEXT
+    RUN_TEST(test_screen_update_defers_until_render);
+    RUN_TEST(test_screen_render_row_major);
+    RUN_TEST(test_screen_render_flushes_once);
+    RUN_TEST(test_screen_full_draws_immediately);
+    RUN_TEST(test_screen_text_without_buf_draws_immediately);
+    RUN_TEST(test_screen_ctx_routes_output);
+#endif
+#if ANSI_TUI_FRAME && ANSI_TUI_LABEL
+    RUN_TEST(test_screen_inherited_from_frame);
+    RUN_TEST(test_screen_redraw_all);
+#endif
+#if ANSI_TUI_BAR
+    RUN_TEST(test_screen_bar_coalesces_updates);
+#endif
+#if ANSI_TUI_PBAR
+    RUN_TEST(test_screen_pbar_diffs_against_shown);
+#endif
+#if ANSI_TUI_METRIC
+    RUN_TEST(test_tick_coalesces_to_latest);
+#endif
+#if ANSI_TUI_BAR
+    RUN_TEST(test_tick_idle_does_not_delay_next_frame);
+#endif
+#if ANSI_TUI_BUDGET && ANSI_TUI_TEXT
+    RUN_TEST(test_budget_draws_high_priority_first);
+    RUN_TEST(test_budget_holds_long_run_rate);
+#endif
+#if ANSI_TUI_BIND && ANSI_TUI_BAR
+    RUN_TEST(test_poll_redraws_only_on_quantized_change);
+    RUN_TEST(test_poll_skips_torn_seqlock_snapshot);
+#endif
+#if ANSI_TUI_BIND && ANSI_TUI_TEXT && ANSI_TUI_CHECK
+    RUN_TEST(test_poll_binds_text_and_bool);
+#endif
+#endif
+
     return UNITY_END();
 }